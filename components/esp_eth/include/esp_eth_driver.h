@@ -158,11 +158,21 @@ typedef enum {
     ETH_CMD_S_PHY_LOOPBACK,           /*!< Set PHY loopback */
     ETH_CMD_READ_PHY_REG,             /*!< Read PHY register */
     ETH_CMD_WRITE_PHY_REG,            /*!< Write PHY register */
+    ETH_CMD_G_OFFLOAD,                /*!< Get checksums computed by MAC */
 
     ETH_CMD_CUSTOM_MAC_CMDS = ETH_CMD_CUSTOM_MAC_CMDS_OFFSET, // Offset for start of MAC custom commands
     ETH_CMD_CUSTOM_PHY_CMDS = ETH_CMD_CUSTOM_PHY_CMDS_OFFSET, // Offset for start of PHY custom commands
 } esp_eth_io_cmd_t;
 
+/**
+* @brief Protocol processing done by MAC in place of the TCP/IP stack
+*
+*/
+typedef enum {
+    ETH_OFFLOAD_TX_CHECKSUM = 1 << 0, /*!< MAC inserts IPv4 header, TCP, UDP and ICMP checksums of transmitted frames */
+    ETH_OFFLOAD_RX_CHECKSUM = 1 << 1, /*!< MAC checks IPv4 header, TCP, UDP and ICMP checksums of received frames and drops the wrong ones */
+} eth_offload_t;
+
 /**
  * @brief Default configuration for Ethernet driver
  *
@@ -317,6 +327,8 @@ esp_err_t esp_eth_transmit_vargs(esp_eth_handle_t hdl, uint32_t argc, ...);
 *                            Preconditions: Ethernet driver needs to be stopped and auto-negotiation disabled.
 * @li @c ETH_CMD_G_DUPLEX_MODE gets current Ethernet link duplex mode.  @c data argument is pointer to memory of eth_duplex_t datatype to which the duplex mode is to be stored.
 * @li @c ETH_CMD_S_PHY_LOOPBACK sets/resets PHY to/from loopback mode. @c data argument is pointer to memory of bool datatype from which the configuration option is read.
+* @li @c ETH_CMD_G_OFFLOAD gets checksums computed by MAC. @c data argument is pointer to memory of uint32_t datatype to which the eth_offload_t flags are to be stored.
+*                           MACs without custom ioctl support report no offload.
 *
 * @li Note that additional control commands may be available for specific MAC or PHY chips. Please consult specific MAC or PHY documentation or driver code.
 */
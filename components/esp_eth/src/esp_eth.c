@@ -485,6 +485,14 @@ esp_err_t esp_eth_ioctl(esp_eth_handle_t hdl, esp_eth_io_cmd_t cmd, void *data)
                           phy_addr, phy_w_data->reg_addr, *(phy_w_data->reg_value_p)), err, TAG, "failed to write PHY register");
         }
         break;
+    case ETH_CMD_G_OFFLOAD:
+        ESP_GOTO_ON_FALSE(data, ESP_ERR_INVALID_ARG, err, TAG, "no mem to store offload flags");
+        *(uint32_t *)data = 0;
+        // MACs which don't know the command compute no checksum
+        if (mac->custom_ioctl != NULL && mac->custom_ioctl(mac, cmd, data) != ESP_OK) {
+            *(uint32_t *)data = 0;
+        }
+        break;
     default:
         if (phy->custom_ioctl != NULL && cmd >= ETH_CMD_CUSTOM_PHY_CMDS) {
             ret = phy->custom_ioctl(phy, cmd, data);
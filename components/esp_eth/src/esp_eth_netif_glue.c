@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2019-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2019-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -17,6 +17,15 @@
 
 const static char *TAG = "esp_eth.netif.netif_glue";
 
+// frames of the internal MACs in flight to the stack, the SPI modules receive one frame at a time
+#if CONFIG_ETH_USE_ESP32_EMAC
+#define ETH_NETIF_RX_BUFFER_NUM CONFIG_ETH_DMA_RX_BUFFER_NUM
+#elif CONFIG_ETH_USE_OPENETH
+#define ETH_NETIF_RX_BUFFER_NUM CONFIG_ETH_OPENETH_DMA_RX_BUFFER_NUM
+#else
+#define ETH_NETIF_RX_BUFFER_NUM 0
+#endif
+
 typedef struct esp_eth_netif_glue_t esp_eth_netif_glue_t;
 
 struct esp_eth_netif_glue_t {
@@ -54,11 +63,17 @@ static esp_err_t esp_eth_post_attach(esp_netif_t *esp_netif, void *args)
 
     esp_eth_update_input_path(netif_glue->eth_driver, eth_input_to_netif, esp_netif);
 
+    uint32_t eth_offload = 0;
+    esp_eth_ioctl(netif_glue->eth_driver, ETH_CMD_G_OFFLOAD, &eth_offload);
+
     // set driver related config to esp-netif
     esp_netif_driver_ifconfig_t driver_ifconfig = {
         .handle =  netif_glue->eth_driver,
         .transmit = esp_eth_transmit,
-        .driver_free_rx_buffer = eth_l2_free
+        .driver_free_rx_buffer = eth_l2_free,
+        .rx_buffer_num = ETH_NETIF_RX_BUFFER_NUM,
+        .offload = ((eth_offload & ETH_OFFLOAD_TX_CHECKSUM) ? ESP_NETIF_OFFLOAD_TX_CHECKSUM : 0) |
+                   ((eth_offload & ETH_OFFLOAD_RX_CHECKSUM) ? ESP_NETIF_OFFLOAD_RX_CHECKSUM : 0)
     };
 
     ESP_ERROR_CHECK(esp_netif_set_driver_config(esp_netif, &driver_ifconfig));
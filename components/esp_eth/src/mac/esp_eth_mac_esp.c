@@ -272,6 +272,14 @@ esp_err_t emac_esp_custom_ioctl(esp_eth_mac_t *mac, int cmd, void *data)
         ESP_RETURN_ON_FALSE(data != NULL, ESP_ERR_INVALID_ARG, TAG, "cannot clear DMA tx desc flag with null");
         emac_esp_dma_clear_tdes0_ctrl_bits(emac->emac_dma_hndl, *(uint32_t *)data);
         break;
+    case ETH_CMD_G_OFFLOAD:
+        ESP_RETURN_ON_FALSE(data != NULL, ESP_ERR_INVALID_ARG, TAG, "no mem to store offload flags");
+#if CONFIG_ETH_CHECKSUM_OFFLOAD
+        *(uint32_t *)data = ETH_OFFLOAD_TX_CHECKSUM | ETH_OFFLOAD_RX_CHECKSUM;
+#else
+        *(uint32_t *)data = 0;
+#endif
+        break;
     default:
         ESP_RETURN_ON_ERROR(ESP_ERR_INVALID_ARG, TAG, "unknown io command: %i", cmd);
     }
@@ -562,6 +570,10 @@ static esp_err_t emac_esp_alloc_driver_obj(const eth_mac_config_t *config, emac_
     ESP_GOTO_ON_FALSE(emac, ESP_ERR_NO_MEM, err, TAG, "no mem for esp emac object");
 
     ESP_GOTO_ON_ERROR(emac_esp_new_dma(NULL, &emac->emac_dma_hndl), err, TAG, "create EMAC DMA object failed");
+#if CONFIG_ETH_CHECKSUM_OFFLOAD
+    /* insert IPv4 header and TCP/UDP/ICMP checksums (including pseudo-header) in every transmitted frame */
+    emac_esp_dma_set_tdes0_ctrl_bits(emac->emac_dma_hndl, EMAC_HAL_TDES0_IP_CRC_INSERT_HDR_PAYLOAD_PSEUDO);
+#endif
 
     /* alloc PM lock */
 #ifdef CONFIG_PM_ENABLE
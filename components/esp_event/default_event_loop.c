@@ -76,6 +76,28 @@ esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
                              event_data, event_data_size, ticks_to_wait);
 }
 
+esp_err_t esp_event_post_with_priority(esp_event_base_t event_base, int32_t event_id,
+                                       const void* event_data, size_t event_data_size, uint8_t priority,
+                                       TickType_t ticks_to_wait)
+{
+    if (s_default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_event_post_to_with_priority(s_default_loop, event_base, event_id,
+                                           event_data, event_data_size, priority, ticks_to_wait);
+}
+
+esp_err_t esp_event_post_nocopy(esp_event_base_t event_base, int32_t event_id,
+                                void* event_data, TickType_t ticks_to_wait)
+{
+    if (s_default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_event_post_to_nocopy(s_default_loop, event_base, event_id, event_data, ticks_to_wait);
+}
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 esp_err_t esp_event_isr_post(esp_event_base_t event_base, int32_t event_id,
                              const void* event_data, size_t event_data_size, BaseType_t* task_unblocked)
@@ -87,6 +109,18 @@ esp_err_t esp_event_isr_post(esp_event_base_t event_base, int32_t event_id,
     return esp_event_isr_post_to(s_default_loop, event_base, event_id,
                                  event_data, event_data_size, task_unblocked);
 }
+
+esp_err_t esp_event_isr_post_with_priority(esp_event_base_t event_base, int32_t event_id,
+                                           const void* event_data, size_t event_data_size, uint8_t priority,
+                                           BaseType_t* task_unblocked)
+{
+    if (s_default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_event_isr_post_to_with_priority(s_default_loop, event_base, event_id,
+                                               event_data, event_data_size, priority, task_unblocked);
+}
 #endif
 
 esp_err_t esp_event_loop_create_default(void)
@@ -100,7 +134,12 @@ esp_err_t esp_event_loop_create_default(void)
         .task_name = "sys_evt",
         .task_stack_size = ESP_TASKD_EVENT_STACK,
         .task_priority = ESP_TASKD_EVENT_PRIO,
-        .task_core_id = 0
+        .task_core_id = 0,
+        .priority_lanes = CONFIG_ESP_EVENT_DEFAULT_LOOP_PRIORITY_LANES,
+#if CONFIG_ESP_EVENT_DEFAULT_LOOP_DATA_POOL_SIZE
+        .data_pool_size = CONFIG_ESP_EVENT_DEFAULT_LOOP_DATA_POOL_SIZE,
+        .data_pool_block_size = CONFIG_ESP_EVENT_DEFAULT_LOOP_DATA_POOL_BLOCK_SIZE,
+#endif
     };
 
     esp_err_t err;
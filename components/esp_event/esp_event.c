@@ -26,6 +26,9 @@
 #define LOOP_DUMP_FORMAT              "LOOP @%p,%s rx:%" PRIu32 " dr:%" PRIu32 "\n"
 // handler @<address> ev:<base, id> inv:<times invoked> time:<runtime>
 #define HANDLER_DUMP_FORMAT           "  HANDLER @%p ev:%s,%s inv:%" PRIu32 " time:%lld us\n"
+// lane <priority> lat<queue latency histogram>
+#define LANE_DUMP_FORMAT              "  LANE %d lat<10us:%" PRIu32 " <100us:%" PRIu32 " <1ms:%" PRIu32 " <10ms:%" PRIu32 \
+                                      " <100ms:%" PRIu32 " <1s:%" PRIu32 " >=1s:%" PRIu32 "\n"
 
 #define PRINT_DUMP_INFO(dst, sz, ...)  do { \
                                             int cb = snprintf(dst, sz, __VA_ARGS__); \
@@ -60,7 +63,7 @@ static int esp_event_dump_prepare(void)
     esp_event_handler_node_t* handler_it;
 
     // Count the number of items to be printed. This is needed to compute how much memory to reserve.
-    int loops = 0, handlers = 0;
+    int loops = 0, handlers = 0, lanes = 0;
 
     portENTER_CRITICAL(&s_event_loops_spinlock);
 
@@ -82,6 +85,7 @@ static int esp_event_dump_prepare(void)
             }
         }
         loops++;
+        lanes += loop_it->lane_count;
     }
 
     portEXIT_CRITICAL(&s_event_loops_spinlock);
@@ -89,7 +93,8 @@ static int esp_event_dump_prepare(void)
     // Reserve slightly more memory than computed
     int allowance = 3;
     int size = (((loops + allowance) * (sizeof(LOOP_DUMP_FORMAT) + 10 + 20 + 2 * 11)) +
-                ((handlers + allowance) * (sizeof(HANDLER_DUMP_FORMAT) + 10 + 2 * 20 + 11 + 20)));
+                ((handlers + allowance) * (sizeof(HANDLER_DUMP_FORMAT) + 10 + 2 * 20 + 11 + 20)) +
+                ((lanes + allowance) * (sizeof(LANE_DUMP_FORMAT) + 3 + ESP_EVENT_LATENCY_BUCKETS * 10)));
 
     return size;
 }
@@ -113,30 +118,16 @@ static void esp_event_loop_run_task(void* args)
     vTaskSuspend(NULL);
 }
 
-static void handler_execute(esp_event_loop_instance_t* loop, esp_event_handler_node_t *handler, esp_event_post_instance_t post)
+static void handler_execute(esp_event_loop_instance_t* loop, esp_event_handler_node_t *handler, const esp_event_post_instance_t* post, void* data)
 {
-    ESP_LOGD(TAG, "running post %s:%"PRIu32" with handler %p and context %p on loop %p", post.base, post.id, handler->handler_ctx->handler, &handler->handler_ctx, loop);
+    ESP_LOGD(TAG, "running post %s:%"PRIu32" with handler %p and context %p on loop %p", post->base, post->id, handler->handler_ctx->handler, &handler->handler_ctx, loop);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     int64_t start, diff;
     start = esp_timer_get_time();
 #endif
     // Execute the handler
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    void* data_ptr = NULL;
-
-    if (post.data_set) {
-        if (post.data_allocated) {
-            data_ptr = post.data.ptr;
-        } else {
-            data_ptr = &post.data.val;
-        }
-    }
-
-    (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post.base, post.id, data_ptr);
-#else
-    (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post.base, post.id, post.data.ptr);
-#endif
+    (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post->base, post->id, data);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     diff = esp_timer_get_time() - start;
@@ -146,6 +137,292 @@ static void handler_execute(esp_event_loop_instance_t* loop, esp_event_handler_n
 #endif
 }
 
+static esp_err_t data_pool_init(esp_event_data_pool_t* pool, uint32_t block_count, size_t block_size)
+{
+    // Keep the blocks aligned for the free list link and the event data
+    block_size = (block_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    pool->blocks = malloc(block_count * block_size);
+    if (pool->blocks == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    pool->block_size = block_size;
+    pool->free_blocks = NULL;
+    for (uint32_t i = block_count; i > 0; i--) {
+        void** block = (void**)(pool->blocks + (i - 1) * block_size);
+        *block = pool->free_blocks;
+        pool->free_blocks = block;
+    }
+    portMUX_INITIALIZE(&pool->lock);
+
+    return ESP_OK;
+}
+
+static void* data_pool_alloc(esp_event_data_pool_t* pool, size_t size)
+{
+    if (size > pool->block_size) {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&pool->lock);
+    void** block = pool->free_blocks;
+    if (block != NULL) {
+        pool->free_blocks = *block;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+
+    return block;
+}
+
+static void data_pool_free(esp_event_data_pool_t* pool, void* block)
+{
+    portENTER_CRITICAL(&pool->lock);
+    *(void**)block = pool->free_blocks;
+    pool->free_blocks = block;
+    portEXIT_CRITICAL(&pool->lock);
+}
+
+static void* post_instance_data(esp_event_post_instance_t* post)
+{
+    switch (post->data_type) {
+    case ESP_EVENT_POST_DATA_INLINE:
+        return post->data.bytes;
+    case ESP_EVENT_POST_DATA_POOL:
+    case ESP_EVENT_POST_DATA_HEAP:
+        return post->data.ptr;
+    default:
+        return NULL;
+    }
+}
+
+static void post_instance_delete(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    if (post->data_type == ESP_EVENT_POST_DATA_POOL) {
+        data_pool_free(&loop->data_pool, post->data.ptr);
+    } else if (post->data_type == ESP_EVENT_POST_DATA_HEAP) {
+        free(post->data.ptr);
+    }
+    memset(post, 0, sizeof(*post));
+}
+
+static inline uint32_t dispatch_hash(esp_event_base_t base, int32_t id)
+{
+    uint32_t hash = (uint32_t)(uintptr_t) base ^ ((uint32_t) id * 0x9e3779b1);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+static esp_event_dispatch_entry_t* dispatch_table_slot(esp_event_dispatch_table_t* table, esp_event_base_t base, int32_t id)
+{
+    // The table is at most half full, so the probe always ends on a matching or an empty slot
+    uint32_t i = dispatch_hash(base, id) & table->mask;
+    while (table->slots[i].base != NULL && (table->slots[i].base != base || table->slots[i].id != id)) {
+        i = (i + 1) & table->mask;
+    }
+    return &table->slots[i];
+}
+
+static const esp_event_dispatch_entry_t* dispatch_table_find(esp_event_dispatch_table_t* table, esp_event_base_t base, int32_t id)
+{
+    esp_event_dispatch_entry_t* entry = dispatch_table_slot(table, base, id);
+
+    if (entry->base == NULL) {
+        // No id level handlers, run the base level handlers of the base, if any
+        entry = dispatch_table_slot(table, base, ESP_EVENT_ANY_ID);
+    }
+
+    return entry->base != NULL ? entry : &table->any;
+}
+
+// Collects the handlers the event should be dispatched to, in the order esp_event_loop_run used to visit them
+// when walking the lists. Returns the number of handlers, and stores them to handlers if it isn't NULL.
+static uint32_t dispatch_collect(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id, esp_event_handler_node_t** handlers)
+{
+    uint32_t count = 0;
+    esp_event_handler_node_t *handler;
+    esp_event_loop_node_t *loop_node;
+    esp_event_base_node_t *base_node;
+    esp_event_id_node_t *id_node;
+
+    SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
+        SLIST_FOREACH(handler, &(loop_node->handlers), next) {
+            if (handlers) {
+                handlers[count] = handler;
+            }
+            count++;
+        }
+
+        SLIST_FOREACH(base_node, &(loop_node->base_nodes), next) {
+            if (base_node->base != base) {
+                continue;
+            }
+
+            SLIST_FOREACH(handler, &(base_node->handlers), next) {
+                if (handlers) {
+                    handlers[count] = handler;
+                }
+                count++;
+            }
+
+            SLIST_FOREACH(id_node, &(base_node->id_nodes), next) {
+                if (id_node->id == id) {
+                    SLIST_FOREACH(handler, &(id_node->handlers), next) {
+                        if (handlers) {
+                            handlers[count] = handler;
+                        }
+                        count++;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+static void dispatch_table_free(esp_event_dispatch_table_t* table)
+{
+    if (table) {
+        free(table->handlers);
+        free(table);
+    }
+}
+
+static uint32_t dispatch_table_add(esp_event_loop_instance_t* loop, esp_event_dispatch_table_t* table, esp_event_base_t base, int32_t id)
+{
+    esp_event_dispatch_entry_t* entry = dispatch_table_slot(table, base, id);
+
+    if (entry->base != NULL) {
+        // Base registered in more than one base node
+        return 0;
+    }
+
+    entry->base = base;
+    entry->id = id;
+    entry->count = dispatch_collect(loop, base, id, NULL);
+
+    return entry->count;
+}
+
+static esp_err_t dispatch_table_rebuild(esp_event_loop_instance_t* loop)
+{
+    esp_event_loop_node_t *loop_node;
+    esp_event_base_node_t *base_node;
+    esp_event_id_node_t *id_node;
+    uint32_t keys = 0;
+
+    SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
+        SLIST_FOREACH(base_node, &(loop_node->base_nodes), next) {
+            keys++;
+            SLIST_FOREACH(id_node, &(base_node->id_nodes), next) {
+                keys++;
+            }
+        }
+    }
+
+    uint32_t slots = 2;
+    while (slots < keys * 2) {
+        slots *= 2;
+    }
+
+    esp_event_dispatch_table_t* table = calloc(1, sizeof(*table) + slots * sizeof(table->slots[0]));
+    if (table == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    table->mask = slots - 1;
+
+    // Insert all the keys and count their handlers first, so the handler arrays can be allocated at once
+    uint32_t total = table->any.count = dispatch_collect(loop, NULL, ESP_EVENT_ANY_ID, NULL);
+
+    SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
+        SLIST_FOREACH(base_node, &(loop_node->base_nodes), next) {
+            total += dispatch_table_add(loop, table, base_node->base, ESP_EVENT_ANY_ID);
+            SLIST_FOREACH(id_node, &(base_node->id_nodes), next) {
+                total += dispatch_table_add(loop, table, base_node->base, id_node->id);
+            }
+        }
+    }
+
+    if (total > 0) {
+        table->handlers = malloc(total * sizeof(table->handlers[0]));
+        if (table->handlers == NULL) {
+            free(table);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    uint32_t first = 0;
+    table->any.first = first;
+    first += dispatch_collect(loop, NULL, ESP_EVENT_ANY_ID, table->handlers + first);
+
+    for (uint32_t i = 0; i < slots; i++) {
+        esp_event_dispatch_entry_t* entry = &table->slots[i];
+        if (entry->base != NULL) {
+            entry->first = first;
+            first += dispatch_collect(loop, entry->base, entry->id, table->handlers + first);
+        }
+    }
+
+    dispatch_table_free(loop->dispatch);
+    loop->dispatch = table;
+    loop->dispatch_dirty = false;
+
+    return ESP_OK;
+}
+
+// Fallback used while the dispatch index can't be rebuilt
+static bool dispatch_walk(esp_event_loop_instance_t* loop, const esp_event_post_instance_t* post, void* data)
+{
+    bool exec = false;
+
+    esp_event_handler_node_t *handler, *temp_handler;
+    esp_event_loop_node_t *loop_node, *temp_node;
+    esp_event_base_node_t *base_node, *temp_base;
+    esp_event_id_node_t *id_node, *temp_id_node;
+
+    SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
+        // Execute loop level handlers
+        SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
+            if (!handler->unregistered) {
+                handler_execute(loop, handler, post, data);
+                exec |= true;
+            }
+        }
+
+        SLIST_FOREACH_SAFE(base_node, &(loop_node->base_nodes), next, temp_base) {
+            if (base_node->base == post->base) {
+                // Execute base level handlers
+                SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
+                    if (!handler->unregistered) {
+                        handler_execute(loop, handler, post, data);
+                        exec |= true;
+                    }
+                }
+
+                SLIST_FOREACH_SAFE(id_node, &(base_node->id_nodes), next, temp_id_node) {
+                    if (id_node->id == post->id) {
+                        // Execute id level handlers
+                        SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
+                            if (!handler->unregistered) {
+                                handler_execute(loop, handler, post, data);
+                                exec |= true;
+                            }
+                        }
+                        // Skip to next base node
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return exec;
+}
+
 static esp_err_t handler_instances_add(esp_event_handler_nodes_t* handlers, esp_event_handler_t event_handler, void* event_handler_arg, esp_event_handler_instance_context_t **handler_ctx, bool legacy)
 {
     esp_event_handler_node_t *handler_instance = calloc(1, sizeof(*handler_instance));
@@ -382,6 +659,7 @@ static esp_err_t loop_remove_handler(esp_event_remove_handler_context_t* ctx)
         esp_err_t res = loop_node_remove_handler(it, ctx->event_base, ctx->event_id, ctx->handler_ctx, ctx->legacy);
 
         if (res == ESP_OK) {
+            ctx->loop->dispatch_dirty = true;
             if (SLIST_EMPTY(&(it->base_nodes)) && SLIST_EMPTY(&(it->handlers))) {
                 SLIST_REMOVE(&(ctx->loop->loop_nodes), it, esp_event_loop_node, next);
                 free(it);
@@ -426,17 +704,6 @@ static void loop_node_remove_all_handler(esp_event_loop_node_t* loop_node)
     }
 }
 
-static void inline __attribute__((always_inline)) post_instance_delete(esp_event_post_instance_t* post)
-{
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    if (post->data_allocated)
-#endif
-    {
-        free(post->data.ptr);
-    }
-    memset(post, 0, sizeof(*post));
-}
-
 static esp_err_t find_and_unregister_handler(esp_event_remove_handler_context_t* ctx)
 {
     esp_event_handler_node_t *handler_to_unregister = NULL;
@@ -535,6 +802,105 @@ static esp_err_t find_and_unregister_handler(esp_event_remove_handler_context_t*
     return esp_event_post_to(ctx->loop, esp_event_handler_cleanup, 0, ctx, sizeof(esp_event_remove_handler_context_t), portMAX_DELAY);
 }
 
+// Queues the event to its lane. With several lanes, the pending semaphore is given for each queued event
+// so the loop can block on all the lanes at once; it can't overflow since its maximum count is the
+// capacity of all the lanes.
+static BaseType_t lane_send(esp_event_loop_instance_t* loop, const esp_event_post_instance_t* post, TickType_t ticks_to_wait)
+{
+    BaseType_t result = xQueueSendToBack(loop->queues[post->lane], post, ticks_to_wait);
+
+    if (result == pdTRUE && loop->pending != NULL) {
+        xSemaphoreGive(loop->pending);
+    }
+
+    return result;
+}
+
+// Receives the pending event of the highest priority lane
+static BaseType_t lane_receive(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post, TickType_t ticks_to_wait)
+{
+    if (loop->pending == NULL) {
+        return xQueueReceive(loop->queues[0], post, ticks_to_wait);
+    }
+
+    if (xSemaphoreTake(loop->pending, ticks_to_wait) != pdTRUE) {
+        return pdFALSE;
+    }
+
+    // The event counted by the semaphore is already queued
+    for (int lane = loop->lane_count - 1; lane >= 0; lane--) {
+        if (xQueueReceive(loop->queues[lane], post, 0) == pdTRUE) {
+            return pdTRUE;
+        }
+    }
+
+    return pdFALSE;
+}
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+static void lane_latency_record(esp_event_loop_instance_t* loop, const esp_event_post_instance_t* post)
+{
+    if (post->time == 0) {
+        return;
+    }
+
+    int64_t latency = esp_timer_get_time() - post->time;
+    int bucket = 0;
+
+    for (int64_t limit = 10; bucket < ESP_EVENT_LATENCY_BUCKETS - 1 && latency >= limit; limit *= 10) {
+        bucket++;
+    }
+
+    loop->latency[post->lane][bucket]++;
+}
+#endif
+
+static esp_err_t post_instance_send(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post, TickType_t ticks_to_wait)
+{
+    BaseType_t result = pdFALSE;
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+    post->time = esp_timer_get_time();
+#endif
+
+    // Find the task that currently executes the loop. It is safe to query loop->task since it is
+    // not mutated since loop creation. ENSURE THIS REMAINS TRUE.
+    if (loop->task == NULL) {
+        // The loop has no dedicated task. Find out what task is currently running it.
+        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+
+        if (result == pdTRUE) {
+            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = lane_send(loop, post, ticks_to_wait);
+            } else {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = lane_send(loop, post, 0);
+            }
+        }
+    } else {
+        // The loop has a dedicated task.
+        if (loop->task != xTaskGetCurrentTaskHandle()) {
+            result = lane_send(loop, post, ticks_to_wait);
+        } else {
+            result = lane_send(loop, post, 0);
+        }
+    }
+
+    if (result != pdTRUE) {
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+        atomic_fetch_add(&loop->events_dropped, 1);
+#endif
+        return ESP_ERR_TIMEOUT;
+    }
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+    atomic_fetch_add(&loop->events_received, 1);
+#endif
+
+    return ESP_OK;
+}
+
 /* ---------------------------- Public API --------------------------------- */
 
 esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, esp_event_loop_handle_t* event_loop)
@@ -558,11 +924,30 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
         return err;
     }
 
-    loop->queue = xQueueCreate(event_loop_args->queue_size, sizeof(esp_event_post_instance_t));
-    if (loop->queue == NULL) {
-        ESP_LOGE(TAG, "create event loop queue failed");
+    loop->lane_count = event_loop_args->priority_lanes > 0 ? event_loop_args->priority_lanes : 1;
+    if (loop->lane_count > ESP_EVENT_PRIORITY_LANES_MAX) {
+        ESP_LOGE(TAG, "priority_lanes was larger than %d", ESP_EVENT_PRIORITY_LANES_MAX);
+        err = ESP_ERR_INVALID_ARG;
         goto on_err;
     }
+    loop->batch_size = event_loop_args->dispatch_batch_size > 0 ? event_loop_args->dispatch_batch_size : 1;
+
+    for (int lane = 0; lane < loop->lane_count; lane++) {
+        loop->queues[lane] = xQueueCreate(event_loop_args->queue_size, sizeof(esp_event_post_instance_t));
+        if (loop->queues[lane] == NULL) {
+            ESP_LOGE(TAG, "create event loop queue failed");
+            goto on_err;
+        }
+    }
+
+    if (loop->lane_count > 1) {
+        UBaseType_t capacity = loop->lane_count * event_loop_args->queue_size;
+        loop->pending = xSemaphoreCreateCounting(capacity, 0);
+        if (loop->pending == NULL) {
+            ESP_LOGE(TAG, "create event loop semaphore failed");
+            goto on_err;
+        }
+    }
 
     loop->mutex = xSemaphoreCreateRecursiveMutex();
     if (loop->mutex == NULL) {
@@ -570,7 +955,22 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
         goto on_err;
     }
 
+    if (event_loop_args->data_pool_size > 0) {
+        if (event_loop_args->data_pool_block_size == 0) {
+            ESP_LOGE(TAG, "data pool block size was 0");
+            err = ESP_ERR_INVALID_ARG;
+            goto on_err;
+        }
+
+        err = data_pool_init(&loop->data_pool, event_loop_args->data_pool_size, event_loop_args->data_pool_block_size);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "alloc for event data pool failed");
+            goto on_err;
+        }
+    }
+
     SLIST_INIT(&(loop->loop_nodes));
+    loop->dispatch_dirty = true;
 
     // Create the loop task if requested
     if (event_loop_args->task_name != NULL) {
@@ -607,25 +1007,82 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
     return ESP_OK;
 
 on_err:
-    if (loop->queue != NULL) {
-        vQueueDelete(loop->queue);
+    for (int lane = 0; lane < ESP_EVENT_PRIORITY_LANES_MAX; lane++) {
+        if (loop->queues[lane] != NULL) {
+            vQueueDelete(loop->queues[lane]);
+        }
+    }
+
+    if (loop->pending != NULL) {
+        vSemaphoreDelete(loop->pending);
     }
 
     if (loop->mutex != NULL) {
         vSemaphoreDelete(loop->mutex);
     }
 
+    free(loop->data_pool.blocks);
     free(loop);
 
     return err;
 }
 
-// On event lookup performance: The library implements the event list as a linked list, which results to O(n)
-// lookup time. The test comparing this implementation to the O(lg n) performance of rbtrees
-// (https://github.com/freebsd/freebsd/blob/master/sys/sys/tree.h)
-// indicate that the difference is not that substantial, especially considering the additional
-// pointers per node of rbtrees. Code for the rbtree implementation of the event loop library is archived
-// in feature/esp_event_loop_library_rbtrees if needed.
+// On event lookup performance: The handlers are registered in linked lists, which would result in a lookup time
+// growing with the number of registered events. Instead, the loop dispatches from an index keyed by (base, id)
+// holding the precomputed array of handlers to execute. The index is rebuilt from the lists by the first
+// dispatch after handlers were registered or unregistered, so the cost of a burst of registrations is paid once.
+static bool loop_dispatch(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    void* data = post_instance_data(post);
+
+    // check if the event retrieve from the queue is the internal event that is
+    // triggered when a handler needs to be removed..
+    if (post->base == esp_event_handler_cleanup) {
+        assert(data != NULL);
+        esp_event_remove_handler_context_t* ctx = (esp_event_remove_handler_context_t*)data;
+        loop_remove_handler(ctx);
+
+        // if the handler unregistration request came from legacy code,
+        // we have to free handler_ctx pointer since it points to memory
+        // allocated by esp_event_handler_unregister_with_internal
+        if (ctx->legacy) {
+            free(ctx->handler_ctx);
+        }
+    }
+
+    bool exec = false;
+
+    // Handlers registered while the event is being dispatched only mark the index dirty, so the
+    // handler array below stays valid. Nested runs keep the index of the outer run.
+    if (loop->dispatch_dirty && loop->dispatch_depth == 0) {
+        if (dispatch_table_rebuild(loop) != ESP_OK) {
+            ESP_LOGW(TAG, "alloc for dispatch index of loop %p failed", loop);
+        }
+    }
+
+    loop->dispatch_depth++;
+
+    if (!loop->dispatch_dirty) {
+        const esp_event_dispatch_entry_t* entry = dispatch_table_find(loop->dispatch, post->base, post->id);
+        esp_event_handler_node_t** handlers = loop->dispatch->handlers + entry->first;
+
+        for (uint32_t i = 0; i < entry->count; i++) {
+            if (!handlers[i]->unregistered) {
+                handler_execute(loop, handlers[i], post, data);
+                exec = true;
+            }
+        }
+    } else {
+        exec = dispatch_walk(loop, post, data);
+    }
+
+    loop->dispatch_depth--;
+
+    return exec;
+}
+
+// On dispatch overhead: Up to batch_size pending events are dispatched while the loop mutex is held, so
+// a burst of events doesn't pay for the mutex and for the blocking queue receive of every event.
 esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t ticks_to_run)
 {
     assert(event_loop);
@@ -634,6 +1091,7 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
     esp_event_post_instance_t post;
     TickType_t marker = xTaskGetTickCount();
     TickType_t end = 0;
+    bool expired = false;
 
 #if (configUSE_16_BIT_TICKS == 1)
     int32_t remaining_ticks = ticks_to_run;
@@ -641,95 +1099,44 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
     int64_t remaining_ticks = ticks_to_run;
 #endif
 
-    while (xQueueReceive(loop->queue, &post, remaining_ticks) == pdTRUE) {
+    while (!expired && lane_receive(loop, &post, remaining_ticks) == pdTRUE) {
         // The event has already been unqueued, so ensure it gets executed.
         xSemaphoreTakeRecursive(loop->mutex, portMAX_DELAY);
 
-        // check if the event retrieve from the queue is the internal event that is
-        // triggered when a handler needs to be removed..
-        if (post.base == esp_event_handler_cleanup) {
-            assert(post.data.ptr != NULL);
-            esp_event_remove_handler_context_t* ctx = (esp_event_remove_handler_context_t*)post.data.ptr;
-            loop_remove_handler(ctx);
-
-            // if the handler unregistration request came from legacy code,
-            // we have to free handler_ctx pointer since it points to memory
-            // allocated by esp_event_handler_unregister_with_internal
-            if (ctx->legacy) {
-                free(ctx->handler_ctx);
-            }
-        }
-
         loop->running_task = xTaskGetCurrentTaskHandle();
 
-        bool exec = false;
+        uint32_t dispatched = 0;
 
-        esp_event_handler_node_t *handler, *temp_handler;
-        esp_event_loop_node_t *loop_node, *temp_node;
-        esp_event_base_node_t *base_node, *temp_base;
-        esp_event_id_node_t *id_node, *temp_id_node;
+        do {
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+            lane_latency_record(loop, &post);
+#endif
+            bool exec = loop_dispatch(loop, &post);
 
-        SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
-            // Execute loop level handlers
-            SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
-                if (!handler->unregistered) {
-                    handler_execute(loop, handler, post);
-                    exec |= true;
-                }
-            }
+            esp_event_base_t base = post.base;
+            int32_t id = post.id;
 
-            SLIST_FOREACH_SAFE(base_node, &(loop_node->base_nodes), next, temp_base) {
-                if (base_node->base == post.base) {
-                    // Execute base level handlers
-                    SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
-                        if (!handler->unregistered) {
-                            handler_execute(loop, handler, post);
-                            exec |= true;
-                        }
-                    }
+            post_instance_delete(loop, &post);
 
-                    SLIST_FOREACH_SAFE(id_node, &(base_node->id_nodes), next, temp_id_node) {
-                        if (id_node->id == post.id) {
-                            // Execute id level handlers
-                            SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
-                                if (!handler->unregistered) {
-                                    handler_execute(loop, handler, post);
-                                    exec |= true;
-                                }
-                            }
-                            // Skip to next base node
-                            break;
-                        }
-                    }
-                }
+            if (!exec) {
+                // No handlers were registered, not even loop/base level handlers
+                ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", base, id, event_loop);
             }
-        }
 
-        esp_event_base_t base = post.base;
-        int32_t id = post.id;
-
-        post_instance_delete(&post);
+            dispatched++;
+        } while (dispatched < loop->batch_size && lane_receive(loop, &post, 0) == pdTRUE);
 
         if (ticks_to_run != portMAX_DELAY) {
             end = xTaskGetTickCount();
             remaining_ticks -= end - marker;
+            marker = end;
             // If the ticks to run expired, return to the caller
-            if (remaining_ticks <= 0) {
-                xSemaphoreGiveRecursive(loop->mutex);
-                break;
-            } else {
-                marker = end;
-            }
+            expired = remaining_ticks <= 0;
         }
 
         loop->running_task = NULL;
 
         xSemaphoreGiveRecursive(loop->mutex);
-
-        if (!exec) {
-            // No handlers were registered, not even loop/base level handlers
-            ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", base, id, event_loop);
-        }
     }
 
     return ESP_OK;
@@ -763,15 +1170,24 @@ esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop)
         SLIST_REMOVE(&(loop->loop_nodes), it, esp_event_loop_node, next);
         free(it);
     }
+    dispatch_table_free(loop->dispatch);
 
-    // Drop existing posts on the queue
+    // Drop existing posts on the queues
     esp_event_post_instance_t post;
-    while (xQueueReceive(loop->queue, &post, 0) == pdTRUE) {
-        post_instance_delete(&post);
+    for (int lane = 0; lane < loop->lane_count; lane++) {
+        while (xQueueReceive(loop->queues[lane], &post, 0) == pdTRUE) {
+            post_instance_delete(loop, &post);
+        }
     }
 
     // Cleanup loop
-    vQueueDelete(loop->queue);
+    for (int lane = 0; lane < loop->lane_count; lane++) {
+        vQueueDelete(loop->queues[lane]);
+    }
+    if (loop->pending != NULL) {
+        vSemaphoreDelete(loop->pending);
+    }
+    free(loop->data_pool.blocks);
     free(loop);
     // Free loop mutex before deleting
     xSemaphoreGiveRecursive(loop_mutex);
@@ -838,6 +1254,10 @@ esp_err_t esp_event_handler_register_with_internal(esp_event_loop_handle_t event
         err = loop_node_add_handler(last_loop_node, event_base, event_id, event_handler, event_handler_arg, handler_ctx_arg, legacy);
     }
 
+    if (err == ESP_OK) {
+        loop->dispatch_dirty = true;
+    }
+
 on_err:
     xSemaphoreGiveRecursive(loop->mutex);
     return err;
@@ -911,6 +1331,14 @@ esp_err_t esp_event_handler_instance_unregister_with(esp_event_loop_handle_t eve
 
 esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
                             const void* event_data, size_t event_data_size, TickType_t ticks_to_wait)
+{
+    return esp_event_post_to_with_priority(event_loop, event_base, event_id, event_data, event_data_size,
+                                           ESP_EVENT_PRIORITY_DEFAULT, ticks_to_wait);
+}
+
+esp_err_t esp_event_post_to_with_priority(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
+                                          const void* event_data, size_t event_data_size, uint8_t priority,
+                                          TickType_t ticks_to_wait)
 {
     assert(event_loop);
 
@@ -924,68 +1352,76 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     memset((void*)(&post), 0, sizeof(post));
 
     if (event_data != NULL && event_data_size != 0) {
-        // Make persistent copy of event data on heap.
-        void* event_data_copy = calloc(1, event_data_size);
+        void* event_data_copy;
 
-        if (event_data_copy == NULL) {
-            return ESP_ERR_NO_MEM;
+        if (event_data_size <= sizeof(post.data.bytes)) {
+            event_data_copy = post.data.bytes;
+            post.data_type = ESP_EVENT_POST_DATA_INLINE;
+        } else {
+            event_data_copy = data_pool_alloc(&loop->data_pool, event_data_size);
+            post.data_type = ESP_EVENT_POST_DATA_POOL;
+
+            if (event_data_copy == NULL) {
+                // Make persistent copy of event data on heap.
+                event_data_copy = malloc(event_data_size);
+
+                if (event_data_copy == NULL) {
+                    return ESP_ERR_NO_MEM;
+                }
+                post.data_type = ESP_EVENT_POST_DATA_HEAP;
+            }
+            post.data.ptr = event_data_copy;
         }
 
         memcpy(event_data_copy, event_data, event_data_size);
-        post.data.ptr = event_data_copy;
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-        post.data_allocated = true;
-        post.data_set = true;
-#endif
     }
     post.base = event_base;
     post.id = event_id;
+    post.lane = priority < loop->lane_count ? priority : loop->lane_count - 1;
 
-    BaseType_t result = pdFALSE;
-
-    // Find the task that currently executes the loop. It is safe to query loop->task since it is
-    // not mutated since loop creation. ENSURE THIS REMAINS TRUE.
-    if (loop->task == NULL) {
-        // The loop has no dedicated task. Find out what task is currently running it.
-        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+    esp_err_t err = post_instance_send(loop, &post, ticks_to_wait);
 
-        if (result == pdTRUE) {
-            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-            } else {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, 0);
-            }
-        }
-    } else {
-        // The loop has a dedicated task.
-        if (loop->task != xTaskGetCurrentTaskHandle()) {
-            result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-        } else {
-            result = xQueueSendToBack(loop->queue, &post, 0);
-        }
+    if (err != ESP_OK) {
+        post_instance_delete(loop, &post);
     }
 
-    if (result != pdTRUE) {
-        post_instance_delete(&post);
+    return err;
+}
 
-#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-        atomic_fetch_add(&loop->events_dropped, 1);
-#endif
-        return ESP_ERR_TIMEOUT;
+esp_err_t esp_event_post_to_nocopy(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
+                                   void* event_data, TickType_t ticks_to_wait)
+{
+    assert(event_loop);
+
+    if (event_base == ESP_EVENT_ANY_BASE || event_id == ESP_EVENT_ANY_ID) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-    atomic_fetch_add(&loop->events_received, 1);
-#endif
+    esp_event_post_instance_t post;
+    memset((void*)(&post), 0, sizeof(post));
 
-    return ESP_OK;
+    if (event_data != NULL) {
+        post.data.ptr = event_data;
+        post.data_type = ESP_EVENT_POST_DATA_HEAP;
+    }
+    post.base = event_base;
+    post.id = event_id;
+
+    // On failure the caller keeps the ownership of event_data
+    return post_instance_send((esp_event_loop_instance_t*) event_loop, &post, ticks_to_wait);
 }
 
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
                                 const void* event_data, size_t event_data_size, BaseType_t* task_unblocked)
+{
+    return esp_event_isr_post_to_with_priority(event_loop, event_base, event_id, event_data, event_data_size,
+                                               ESP_EVENT_PRIORITY_DEFAULT, task_unblocked);
+}
+
+esp_err_t esp_event_isr_post_to_with_priority(esp_event_loop_handle_t event_loop, esp_event_base_t event_base,
+                                              int32_t event_id, const void* event_data, size_t event_data_size,
+                                              uint8_t priority, BaseType_t* task_unblocked)
 {
     assert(event_loop);
 
@@ -998,26 +1434,33 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
     esp_event_post_instance_t post;
     memset((void*)(&post), 0, sizeof(post));
 
-    if (event_data_size > sizeof(post.data.val)) {
+    if (event_data_size > sizeof(post.data.bytes)) {
         return ESP_ERR_INVALID_ARG;
     }
 
     if (event_data != NULL && event_data_size != 0) {
-        memcpy((void*)(&(post.data.val)), event_data, event_data_size);
-        post.data_allocated = false;
-        post.data_set = true;
+        memcpy((void*)(post.data.bytes), event_data, event_data_size);
+        post.data_type = ESP_EVENT_POST_DATA_INLINE;
     }
     post.base = event_base;
     post.id = event_id;
+    post.lane = priority < loop->lane_count ? priority : loop->lane_count - 1;
 
     BaseType_t result = pdFALSE;
 
     // Post the event from an ISR,
-    result = xQueueSendToBackFromISR(loop->queue, &post, task_unblocked);
+    result = xQueueSendToBackFromISR(loop->queues[post.lane], &post, task_unblocked);
 
-    if (result != pdTRUE) {
-        post_instance_delete(&post);
+    if (result == pdTRUE && loop->pending != NULL) {
+        BaseType_t pending_unblocked = pdFALSE;
+        xSemaphoreGiveFromISR(loop->pending, &pending_unblocked);
+        if (task_unblocked != NULL && pending_unblocked == pdTRUE) {
+            *task_unblocked = pdTRUE;
+        }
+    }
 
+    if (result != pdTRUE) {
+        // Data posted from ISR is always stored inline, there is nothing to free
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
         atomic_fetch_add(&loop->events_dropped, 1);
 #endif
@@ -1092,6 +1535,12 @@ esp_err_t esp_event_dump(FILE* file)
         if (sz == sz_bak) {
             PRINT_DUMP_INFO(dst, sz, "  NO HANDLERS REGISTERED\n");
         }
+
+        for (int lane = 0; lane < loop_it->lane_count; lane++) {
+            const uint32_t* latency = loop_it->latency[lane];
+            PRINT_DUMP_INFO(dst, sz, LANE_DUMP_FORMAT, lane, latency[0], latency[1], latency[2], latency[3],
+                            latency[4], latency[5], latency[6]);
+        }
     }
 
     portEXIT_CRITICAL(&s_event_loops_spinlock);
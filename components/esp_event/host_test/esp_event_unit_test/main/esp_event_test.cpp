@@ -8,6 +8,11 @@
 */
 
 #include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
 #include "esp_event.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -17,6 +22,37 @@
 extern "C" {
 #include "Mocktask.h"
 #include "Mockqueue.h"
+#include "Mockportmacro.h"
+}
+
+// Heap allocations of the code under test, see -Wl,--wrap in CMakeLists.txt
+static uint32_t s_heap_allocs;
+static uint32_t s_heap_frees;
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size)
+{
+    s_heap_allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    s_heap_allocs++;
+    return __real_calloc(nmemb, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    if (ptr) {
+        s_heap_frees++;
+    }
+    __real_free(ptr);
+}
 }
 
 namespace {
@@ -40,6 +76,154 @@ static esp_event_loop_args_t test_event_get_default_loop_args(void)
 
 void dummy_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data) { }
 
+ESP_EVENT_DEFINE_BASE(TEST_BASE_A);
+ESP_EVENT_DEFINE_BASE(TEST_BASE_B);
+ESP_EVENT_DEFINE_BASE(TEST_BASE_C);
+
+/**
+ * Event queues of a loop without dedicated task, backed by deques, so that events can be posted and dispatched
+ * through esp_event_loop_run. Each created queue gets the next deque, for the priority lanes of a loop.
+ */
+struct FifoQueue : public CMockFix {
+    FifoQueue() : sem(CreateAnd::IGNORE)
+    {
+        for (auto &lane : lanes) {
+            lane.clear();
+        }
+        created = 0;
+        mutex_takes = 0;
+        xQueueGenericCreate_Stub(create);
+        xQueueCreateCountingSemaphore_IgnoreAndReturn(reinterpret_cast<QueueHandle_t>(&created));
+        xQueueGenericSend_Stub(send);
+        xQueueReceive_Stub(receive);
+        xQueueTakeMutexRecursive_Stub(take_mutex);
+        xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+        xQueueSemaphoreTake_IgnoreAndReturn(pdTRUE);
+        xTaskGetTickCount_IgnoreAndReturn(0);
+        xTaskGetCurrentTaskHandle_IgnoreAndReturn(reinterpret_cast<TaskHandle_t>(1));
+        vPortEnterCritical_Ignore();
+        vPortExitCritical_Ignore();
+    }
+
+    ~FifoQueue()
+    {
+        xQueueGenericCreate_Stub(nullptr);
+        xQueueCreateCountingSemaphore_StopIgnore();
+        xQueueGenericSend_Stub(nullptr);
+        xQueueReceive_Stub(nullptr);
+        xQueueTakeMutexRecursive_Stub(nullptr);
+        xQueueGiveMutexRecursive_StopIgnore();
+        xQueueSemaphoreTake_StopIgnore();
+        xTaskGetTickCount_StopIgnore();
+        xTaskGetCurrentTaskHandle_StopIgnore();
+        vPortEnterCritical_StopIgnore();
+        vPortExitCritical_StopIgnore();
+    }
+
+    static QueueHandle_t create(const UBaseType_t length, const UBaseType_t size, const uint8_t type, int calls)
+    {
+        item_size = size;
+        return reinterpret_cast<QueueHandle_t>(&lanes[created++ % ESP_EVENT_PRIORITY_LANES_MAX]);
+    }
+
+    static std::deque<std::vector<uint8_t>> *lane(QueueHandle_t queue)
+    {
+        for (auto &lane : lanes) {
+            if (queue == reinterpret_cast<QueueHandle_t>(&lane)) {
+                return &lane;
+            }
+        }
+        return nullptr;
+    }
+
+    static BaseType_t send(QueueHandle_t queue, const void * const item, TickType_t ticks, const BaseType_t position, int calls)
+    {
+        // Giving the mutex or the pending events semaphore is a send to another queue
+        auto items = lane(queue);
+        if (items) {
+            const uint8_t *bytes = static_cast<const uint8_t *>(item);
+            items->emplace_back(bytes, bytes + item_size);
+        }
+        return pdTRUE;
+    }
+
+    static BaseType_t receive(QueueHandle_t queue, void * const item, TickType_t ticks, int calls)
+    {
+        auto items = lane(queue);
+        if (items->empty()) {
+            return pdFALSE;
+        }
+        memcpy(item, items->front().data(), item_size);
+        items->pop_front();
+        return pdTRUE;
+    }
+
+    static BaseType_t take_mutex(QueueHandle_t mutex, TickType_t ticks, int calls)
+    {
+        mutex_takes++;
+        return pdTRUE;
+    }
+
+    MockMutex sem;
+    static std::deque<std::vector<uint8_t>> lanes[ESP_EVENT_PRIORITY_LANES_MAX];
+    static UBaseType_t item_size;
+    static int created;
+    static uint32_t mutex_takes;
+};
+
+std::deque<std::vector<uint8_t>> FifoQueue::lanes[ESP_EVENT_PRIORITY_LANES_MAX];
+UBaseType_t FifoQueue::item_size;
+int FifoQueue::created;
+uint32_t FifoQueue::mutex_takes;
+
+void trace_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    std::string *trace = *static_cast<std::string **>(event_data);
+    *trace += *static_cast<const char *>(event_handler_arg);
+}
+
+void copy_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    // The tests use the size of the event data as event id
+    const uint8_t *data = static_cast<const uint8_t *>(event_data);
+    static_cast<std::vector<uint8_t> *>(event_handler_arg)->assign(data, data + event_id);
+}
+
+void count_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    (*static_cast<uint32_t *>(event_handler_arg))++;
+}
+
+std::string dispatch(esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id)
+{
+    std::string trace;
+    std::string *trace_ptr = &trace;
+    // The event data is copied, so post a pointer to the trace
+    CHECK(esp_event_post_to(loop, base, id, &trace_ptr, sizeof(trace_ptr), 0) == ESP_OK);
+    CHECK(esp_event_loop_run(loop, 0) == ESP_OK);
+    return trace;
+}
+
+std::vector<uint8_t> test_event_data(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(i + size);
+    }
+    return data;
+}
+
+double dispatch_ns_per_event(esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id, uint32_t events)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < events; i++) {
+        esp_event_post_to(loop, base, id, nullptr, 0, 0);
+        esp_event_loop_run(loop, 0);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / events;
+}
+
 }
 
 // TODO: IDF-2693, function definition just to satisfy linker, implement esp_common instead
@@ -149,3 +333,272 @@ TEST_CASE("registering with ANY_BASE but specific ID fails")
                                           dummy_handler,
                                           nullptr) == ESP_ERR_INVALID_ARG);
 }
+
+TEST_CASE("handlers are dispatched in loop, base and id level registration order")
+{
+    FifoQueue queue;
+    esp_event_loop_handle_t loop = nullptr;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+    REQUIRE(esp_event_loop_create(&loop_args, &loop) == ESP_OK);
+
+    static const char names[] = "1234567";
+    REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, 1, trace_handler, (void*) &names[0]) == ESP_OK);
+    REQUIRE(esp_event_handler_register_with(loop, ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, trace_handler, (void*) &names[1]) == ESP_OK);
+    REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, ESP_EVENT_ANY_ID, trace_handler, (void*) &names[2]) == ESP_OK);
+    REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_B, 2, trace_handler, (void*) &names[3]) == ESP_OK);
+    REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, 2, trace_handler, (void*) &names[4]) == ESP_OK);
+
+    CHECK(dispatch(loop, TEST_BASE_A, 1) == "123");
+    CHECK(dispatch(loop, TEST_BASE_A, 2) == "235");
+    CHECK(dispatch(loop, TEST_BASE_A, 3) == "23");
+    CHECK(dispatch(loop, TEST_BASE_B, 2) == "24");
+    CHECK(dispatch(loop, TEST_BASE_C, 2) == "2");
+
+    // Registering after a dispatch updates the dispatch index
+    REQUIRE(esp_event_handler_register_with(loop, ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, trace_handler, (void*) &names[5]) == ESP_OK);
+    REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, ESP_EVENT_ANY_ID, trace_handler, (void*) &names[6]) == ESP_OK);
+
+    CHECK(dispatch(loop, TEST_BASE_A, 1) == "12367");
+    CHECK(dispatch(loop, TEST_BASE_A, 2) == "23567");
+    CHECK(dispatch(loop, TEST_BASE_B, 3) == "26");
+    CHECK(dispatch(loop, TEST_BASE_C, 1) == "26");
+
+    REQUIRE(esp_event_handler_unregister_with(loop, TEST_BASE_A, ESP_EVENT_ANY_ID, trace_handler) == ESP_OK);
+    REQUIRE(esp_event_handler_unregister_with(loop, TEST_BASE_A, 2, trace_handler) == ESP_OK);
+
+    CHECK(dispatch(loop, TEST_BASE_A, 1) == "1267");
+    CHECK(dispatch(loop, TEST_BASE_A, 2) == "267");
+
+    CHECK(esp_event_loop_delete(loop) == ESP_OK);
+}
+
+TEST_CASE("dispatch time with few and many registered events")
+{
+    FifoQueue queue;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+    const uint32_t EVENTS = 20000;
+    const int BASES = 100;
+    const int IDS = 100;
+    uint32_t invoked = 0;
+
+    esp_event_loop_handle_t small_loop = nullptr;
+    REQUIRE(esp_event_loop_create(&loop_args, &small_loop) == ESP_OK);
+    REQUIRE(esp_event_handler_register_with(small_loop, TEST_BASE_A, IDS - 1, count_handler, &invoked) == ESP_OK);
+
+    // Events of the last registered base and id are the worst case for walking the handler lists
+    static char bases[BASES][8];
+    esp_event_loop_handle_t large_loop = nullptr;
+    REQUIRE(esp_event_loop_create(&loop_args, &large_loop) == ESP_OK);
+    for (int base = 0; base < BASES; base++) {
+        snprintf(bases[base], sizeof(bases[base]), "BASE%d", base);
+        for (int id = 0; id < IDS; id++) {
+            REQUIRE(esp_event_handler_register_with(large_loop, bases[base], id, count_handler, &invoked) == ESP_OK);
+        }
+    }
+
+    // Warm up, builds the dispatch indexes
+    dispatch_ns_per_event(small_loop, TEST_BASE_A, IDS - 1, 1);
+    dispatch_ns_per_event(large_loop, bases[BASES - 1], IDS - 1, 1);
+    invoked = 0;
+
+    double small_ns = dispatch_ns_per_event(small_loop, TEST_BASE_A, IDS - 1, EVENTS);
+    double large_ns = dispatch_ns_per_event(large_loop, bases[BASES - 1], IDS - 1, EVENTS);
+    printf("dispatch with 1 registered event: %.0f ns/event, with %d registered events: %.0f ns/event\n",
+           small_ns, BASES * IDS, large_ns);
+
+    // The host is not real-time, the timings are only printed
+    CHECK(invoked == 2 * EVENTS);
+
+    CHECK(esp_event_loop_delete(small_loop) == ESP_OK);
+    CHECK(esp_event_loop_delete(large_loop) == ESP_OK);
+}
+
+TEST_CASE("event data is passed to handlers from inline storage, data pool and heap")
+{
+    FifoQueue queue;
+    const size_t BLOCK_SIZE = 64;
+    esp_event_loop_handle_t loop = nullptr;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+    loop_args.data_pool_size = 2;
+    loop_args.data_pool_block_size = BLOCK_SIZE;
+    REQUIRE(esp_event_loop_create(&loop_args, &loop) == ESP_OK);
+
+    std::vector<uint8_t> received;
+    REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, ESP_EVENT_ANY_ID, copy_handler, &received) == ESP_OK);
+
+    for (size_t size : {size_t(1), size_t(CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE), BLOCK_SIZE, BLOCK_SIZE + 1}) {
+        std::vector<uint8_t> data = test_event_data(size);
+        uint32_t allocs = s_heap_allocs;
+        REQUIRE(esp_event_post_to(loop, TEST_BASE_A, size, data.data(), size, 0) == ESP_OK);
+        CHECK(s_heap_allocs - allocs == (size > BLOCK_SIZE ? 1 : 0));
+        REQUIRE(esp_event_loop_run(loop, 0) == ESP_OK);
+        CHECK(received == data);
+    }
+
+    // Falls back to heap once the pool is exhausted
+    std::vector<uint8_t> data = test_event_data(BLOCK_SIZE);
+    uint32_t allocs = s_heap_allocs;
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(esp_event_post_to(loop, TEST_BASE_A, BLOCK_SIZE, data.data(), BLOCK_SIZE, 0) == ESP_OK);
+    }
+    CHECK(s_heap_allocs - allocs == 1);
+    for (int i = 0; i < 3; i++) {
+        // Dispatches one event, as the time to run is zero
+        REQUIRE(esp_event_loop_run(loop, 0) == ESP_OK);
+        CHECK(received == data);
+    }
+
+    // The pool blocks were returned
+    allocs = s_heap_allocs;
+    for (int i = 0; i < 2; i++) {
+        REQUIRE(esp_event_post_to(loop, TEST_BASE_A, BLOCK_SIZE, data.data(), BLOCK_SIZE, 0) == ESP_OK);
+    }
+    CHECK(s_heap_allocs - allocs == 0);
+    for (int i = 0; i < 2; i++) {
+        REQUIRE(esp_event_loop_run(loop, 0) == ESP_OK);
+    }
+
+    // Zero-copy post hands the buffer over to the loop, which frees it after dispatch
+    uint8_t *owned = static_cast<uint8_t *>(malloc(BLOCK_SIZE));
+    REQUIRE(owned != nullptr);
+    memcpy(owned, data.data(), BLOCK_SIZE);
+    uint32_t frees = s_heap_frees;
+    REQUIRE(esp_event_post_to_nocopy(loop, TEST_BASE_A, BLOCK_SIZE, owned, 0) == ESP_OK);
+    REQUIRE(esp_event_loop_run(loop, 0) == ESP_OK);
+    CHECK(received == data);
+    CHECK(s_heap_frees - frees == 1);
+
+    CHECK(esp_event_loop_delete(loop) == ESP_OK);
+}
+
+TEST_CASE("posting event data allocates from heap only when it fits neither inline nor in the data pool")
+{
+    FifoQueue queue;
+    const uint32_t EVENTS = 20000;
+    const size_t LARGE_SIZE = 48;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+
+    esp_event_loop_handle_t heap_loop = nullptr;
+    REQUIRE(esp_event_loop_create(&loop_args, &heap_loop) == ESP_OK);
+
+    esp_event_loop_handle_t pool_loop = nullptr;
+    loop_args.data_pool_size = 4;
+    loop_args.data_pool_block_size = LARGE_SIZE;
+    REQUIRE(esp_event_loop_create(&loop_args, &pool_loop) == ESP_OK);
+
+    uint32_t invoked = 0;
+    REQUIRE(esp_event_handler_register_with(heap_loop, TEST_BASE_A, ESP_EVENT_ANY_ID, count_handler, &invoked) == ESP_OK);
+    REQUIRE(esp_event_handler_register_with(pool_loop, TEST_BASE_A, ESP_EVENT_ANY_ID, count_handler, &invoked) == ESP_OK);
+
+    struct {
+        const char *name;
+        esp_event_loop_handle_t loop;
+        size_t size;
+        bool allocates;
+    } cases[] = {
+        { "inline", heap_loop, CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE, false },
+        { "data pool", pool_loop, LARGE_SIZE, false },
+        { "heap", heap_loop, LARGE_SIZE, true },
+    };
+
+    std::vector<uint8_t> data = test_event_data(LARGE_SIZE);
+    for (auto &test : cases) {
+        // Warm up, builds the dispatch index
+        esp_event_post_to(test.loop, TEST_BASE_A, 1, data.data(), test.size, 0);
+        esp_event_loop_run(test.loop, 0);
+
+        uint32_t allocs = s_heap_allocs;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < EVENTS; i++) {
+            esp_event_post_to(test.loop, TEST_BASE_A, 1, data.data(), test.size, 0);
+            esp_event_loop_run(test.loop, 0);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        allocs = s_heap_allocs - allocs;
+
+        printf("post and dispatch %u bytes of event data (%s): %.0f ns/event, %.2f heap allocations/event\n",
+               (unsigned) test.size, test.name, elapsed.count() / EVENTS, (double) allocs / EVENTS);
+        CHECK(allocs == (test.allocates ? EVENTS : 0));
+    }
+    CHECK(invoked == 3 * (EVENTS + 1));
+
+    CHECK(esp_event_loop_delete(heap_loop) == ESP_OK);
+    CHECK(esp_event_loop_delete(pool_loop) == ESP_OK);
+}
+
+TEST_CASE("pending events of higher priority lanes are dispatched first")
+{
+    FifoQueue queue;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+    loop_args.priority_lanes = 3;
+
+    esp_event_loop_handle_t loop = nullptr;
+    REQUIRE(esp_event_loop_create(&loop_args, &loop) == ESP_OK);
+
+    std::vector<uint8_t> received;
+    REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, ESP_EVENT_ANY_ID, copy_handler, &received) == ESP_OK);
+
+    // The priority is the event data, priorities above the highest lane use the highest lane
+    const uint8_t priorities[] = { 0, 1, 0, 2, 9, 1, ESP_EVENT_PRIORITY_DEFAULT };
+    for (uint8_t priority : priorities) {
+        REQUIRE(esp_event_post_to_with_priority(loop, TEST_BASE_A, 1, &priority, 1, priority, 0) == ESP_OK);
+    }
+
+    std::string order;
+    for (size_t i = 0; i < sizeof(priorities); i++) {
+        REQUIRE(esp_event_loop_run(loop, 0) == ESP_OK);
+        order += std::to_string(received.at(0));
+    }
+    CHECK(order == "2911000");
+
+    CHECK(esp_event_loop_delete(loop) == ESP_OK);
+
+    loop_args.priority_lanes = ESP_EVENT_PRIORITY_LANES_MAX + 1;
+    CHECK(esp_event_loop_create(&loop_args, &loop) == ESP_ERR_INVALID_ARG);
+}
+
+TEST_CASE("pending events are dispatched in batches per mutex acquisition")
+{
+    FifoQueue queue;
+    const uint32_t EVENTS = 20000;
+    const uint32_t BATCH_SIZE = 16;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+
+    uint32_t invoked = 0;
+    double ns_per_event[2];
+    for (int batched = 0; batched < 2; batched++) {
+        loop_args.dispatch_batch_size = batched ? BATCH_SIZE : 0;
+        esp_event_loop_handle_t loop = nullptr;
+        REQUIRE(esp_event_loop_create(&loop_args, &loop) == ESP_OK);
+        REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, ESP_EVENT_ANY_ID, count_handler, &invoked) == ESP_OK);
+
+        uint32_t takes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < EVENTS; i += QUEUE_SIZE) {
+            for (uint32_t j = 0; j < QUEUE_SIZE; j++) {
+                esp_event_post_to(loop, TEST_BASE_A, 1, nullptr, 0, 0);
+            }
+            // Posting without dedicated task takes the mutex too
+            FifoQueue::mutex_takes = 0;
+            while (!FifoQueue::lanes[0].empty() || !FifoQueue::lanes[1].empty()) {
+                esp_event_loop_run(loop, 0);
+            }
+            takes += FifoQueue::mutex_takes;
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        ns_per_event[batched] = elapsed.count() / EVENTS;
+
+        printf("dispatch with batch size %u: %.0f ns/event, %.3f mutex acquisitions/event\n",
+               (unsigned) (batched ? BATCH_SIZE : 1), ns_per_event[batched], (double) takes / EVENTS);
+        CHECK(takes == (batched ? EVENTS / BATCH_SIZE : EVENTS));
+
+        CHECK(esp_event_loop_delete(loop) == ESP_OK);
+    }
+    CHECK(invoked == 2 * EVENTS);
+}
@@ -20,6 +20,9 @@
 extern "C" {
 #endif
 
+#define ESP_EVENT_PRIORITY_LANES_MAX    4       /*!< Maximum number of priority lanes of an event loop */
+#define ESP_EVENT_PRIORITY_DEFAULT      0       /*!< Priority of events posted without specifying a priority, the lowest one */
+
 /// Configuration for creating event loops
 typedef struct {
     int32_t queue_size;                         /**< size of the event loop queue */
@@ -29,6 +32,18 @@ typedef struct {
     uint32_t task_stack_size;                   /**< stack size of the event loop task, ignored if task name is NULL */
     BaseType_t task_core_id;                    /**< core to which the event loop task is pinned to,
                                                         ignored if task name is NULL */
+    uint32_t data_pool_size;                    /**< number of preallocated blocks for event data larger than
+                                                        CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE; if 0, such
+                                                        event data is allocated from heap */
+    size_t data_pool_block_size;                /**< size of a data pool block, larger event data is allocated
+                                                        from heap; ignored if data_pool_size is 0 */
+    uint8_t priority_lanes;                     /**< number of priority lanes, up to ESP_EVENT_PRIORITY_LANES_MAX,
+                                                        each with a queue of queue_size events; pending events
+                                                        of higher priority lanes are dispatched first; 0 is the
+                                                        same as 1 */
+    uint32_t dispatch_batch_size;               /**< maximum number of pending events dispatched while holding
+                                                        the loop mutex once, esp_event_loop_run checks
+                                                        ticks_to_run after each batch; 0 is the same as 1 */
 } esp_event_loop_args_t;
 
 /**
@@ -39,7 +54,8 @@ typedef struct {
  *
  * @return
  *  - ESP_OK: Success
- *  - ESP_ERR_INVALID_ARG: event_loop_args or event_loop was NULL
+ *  - ESP_ERR_INVALID_ARG: event_loop_args or event_loop was NULL, data_pool_block_size was 0 for a data pool,
+ *                         or priority_lanes was larger than ESP_EVENT_PRIORITY_LANES_MAX
  *  - ESP_ERR_NO_MEM: Cannot allocate memory for event loops list
  *  - ESP_FAIL: Failed to create task loop
  *  - Others: Fail
@@ -347,6 +363,9 @@ esp_err_t esp_event_handler_instance_unregister(esp_event_base_t event_base,
  * the copy's lifetime automatically (allocation + deletion); this ensures that the data the
  * handler receives is always valid.
  *
+ * Event data up to CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes is stored in the event queue, larger event data
+ * is copied to the data pool of the loop if it has a free block large enough, or to heap otherwise.
+ *
  * @param[in] event_base the event base that identifies the event
  * @param[in] event_id the event ID that identifies the event
  * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
@@ -395,6 +414,111 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop,
                             size_t event_data_size,
                             TickType_t ticks_to_wait);
 
+/**
+ * @brief Posts an event to a priority lane of the specified event loop.
+ *
+ * This function behaves in the same manner as esp_event_post_to, except that the event is queued to the lane
+ * of the given priority. Pending events of higher priority lanes are dispatched before the events of lower
+ * priority lanes, events of the same lane are dispatched in the order they were posted.
+ * esp_event_post_to posts to the ESP_EVENT_PRIORITY_DEFAULT lane.
+ *
+ * @param[in] event_loop the event loop to post to, must not be NULL
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] event_data_size the size of the event data
+ * @param[in] priority priority lane to post to; priorities above the highest lane of the loop use the highest lane
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_to_with_priority(esp_event_loop_handle_t event_loop,
+                                          esp_event_base_t event_base,
+                                          int32_t event_id,
+                                          const void *event_data,
+                                          size_t event_data_size,
+                                          uint8_t priority,
+                                          TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts an event to a priority lane of the system default event loop.
+ *
+ * @see esp_event_post_to_with_priority
+ *
+ * The number of lanes of the default event loop is set by CONFIG_ESP_EVENT_DEFAULT_LOOP_PRIORITY_LANES.
+ *
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] event_data_size the size of the event data
+ * @param[in] priority priority lane to post to; priorities above the highest lane of the loop use the highest lane
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ *  - ESP_ERR_INVALID_STATE: The default event loop has not been created
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_with_priority(esp_event_base_t event_base,
+                                       int32_t event_id,
+                                       const void *event_data,
+                                       size_t event_data_size,
+                                       uint8_t priority,
+                                       TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts an event to the system default event loop, handing over the ownership of event_data.
+ *
+ * @see esp_event_post_to_nocopy
+ *
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler;
+ *                       must be allocated from heap, can be NULL
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @return
+ *  - ESP_OK: Success, the event loop frees event_data
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired, the caller still owns event_data
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ *  - ESP_ERR_INVALID_STATE: The default event loop has not been created
+ */
+esp_err_t esp_event_post_nocopy(esp_event_base_t event_base,
+                                int32_t event_id,
+                                void *event_data,
+                                TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts an event to the specified event loop, handing over the ownership of event_data.
+ *
+ * Unlike esp_event_post_to, event_data is not copied. It must have been allocated with malloc() or one of
+ * the heap_caps_malloc() functions, and must not be accessed by the caller once the event is posted. The event loop
+ * frees it after the event has been dispatched, or when the event loop is deleted before dispatching the event.
+ *
+ * @param[in] event_loop the event loop to post to, must not be NULL
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler;
+ *                       must be allocated from heap, can be NULL
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @return
+ *  - ESP_OK: Success, the event loop frees event_data
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired, the caller still owns event_data
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID
+ */
+esp_err_t esp_event_post_to_nocopy(esp_event_loop_handle_t event_loop,
+                                   esp_event_base_t event_base,
+                                   int32_t event_id,
+                                   void *event_data,
+                                   TickType_t ticks_to_wait);
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 /**
  * @brief Special variant of esp_event_post for posting events from interrupt handlers.
@@ -402,7 +526,7 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop,
  * @param[in] event_base the event base that identifies the event
  * @param[in] event_id the event ID that identifies the event
  * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
- * @param[in] event_data_size the size of the event data; max is 4 bytes
+ * @param[in] event_data_size the size of the event data; max is CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
  * @param[out] task_unblocked an optional parameter (can be NULL) which indicates that an event task with
  *                            higher priority than currently running task has been unblocked by the posted event;
  *                            a context switch should be requested before the interrupt is existed.
@@ -415,7 +539,7 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop,
  *  - ESP_OK: Success
  *  - ESP_FAIL: Event queue for the default event loop full
  *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID,
- *                          data size of more than 4 bytes
+ *                          data size of more than CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
  *  - Others: Fail
  */
 esp_err_t esp_event_isr_post(esp_event_base_t event_base,
@@ -431,7 +555,7 @@ esp_err_t esp_event_isr_post(esp_event_base_t event_base,
  * @param[in] event_base the event base that identifies the event
  * @param[in] event_id the event ID that identifies the event
  * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
- * @param[in] event_data_size the size of the event data
+ * @param[in] event_data_size the size of the event data; max is CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
  * @param[out] task_unblocked an optional parameter (can be NULL) which indicates that an event task with
  *                            higher priority than currently running task has been unblocked by the posted event;
  *                            a context switch should be requested before the interrupt is existed.
@@ -444,7 +568,7 @@ esp_err_t esp_event_isr_post(esp_event_base_t event_base,
  *  - ESP_OK: Success
  *  - ESP_FAIL: Event queue for the loop full
  *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID,
- *                          data size of more than 4 bytes
+ *                          data size of more than CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
  *  - Others: Fail
  */
 esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop,
@@ -453,6 +577,69 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop,
                                 const void *event_data,
                                 size_t event_data_size,
                                 BaseType_t *task_unblocked);
+
+/**
+ * @brief Special variant of esp_event_isr_post for posting events to a priority lane of the default event loop
+ *
+ * @see esp_event_isr_post_to_with_priority
+ *
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] event_data_size the size of the event data; max is CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
+ * @param[in] priority priority lane to post to; priorities above the highest lane of the loop use the highest lane
+ * @param[out] task_unblocked an optional parameter (can be NULL) which indicates that an event task with
+ *                            higher priority than currently running task has been unblocked by the posted event;
+ *                            a context switch should be requested before the interrupt is existed.
+ *
+ * @note this function is only available when CONFIG_ESP_EVENT_POST_FROM_ISR is enabled
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_FAIL: Event queue of the lane full
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID,
+ *                          data size of more than CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
+ *  - ESP_ERR_INVALID_STATE: The default event loop has not been created
+ */
+esp_err_t esp_event_isr_post_with_priority(esp_event_base_t event_base,
+                                           int32_t event_id,
+                                           const void *event_data,
+                                           size_t event_data_size,
+                                           uint8_t priority,
+                                           BaseType_t *task_unblocked);
+
+/**
+ * @brief Special variant of esp_event_post_to_with_priority for posting events from interrupt handlers
+ *
+ * This function behaves in the same manner as esp_event_isr_post_to, except that the event is queued to the lane
+ * of the given priority. esp_event_isr_post_to posts to the ESP_EVENT_PRIORITY_DEFAULT lane.
+ *
+ * @param[in] event_loop the event loop to post to, must not be NULL
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event ID that identifies the event
+ * @param[in] event_data the data, specific to the event occurrence, that gets passed to the handler
+ * @param[in] event_data_size the size of the event data; max is CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
+ * @param[in] priority priority lane to post to; priorities above the highest lane of the loop use the highest lane
+ * @param[out] task_unblocked an optional parameter (can be NULL) which indicates that an event task with
+ *                            higher priority than currently running task has been unblocked by the posted event;
+ *                            a context switch should be requested before the interrupt is existed.
+ *
+ * @note this function is only available when CONFIG_ESP_EVENT_POST_FROM_ISR is enabled
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_FAIL: Event queue of the lane full
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID,
+ *                          data size of more than CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE bytes
+ *  - Others: Fail
+ */
+esp_err_t esp_event_isr_post_to_with_priority(esp_event_loop_handle_t event_loop,
+                                              esp_event_base_t event_base,
+                                              int32_t event_id,
+                                              const void *event_data,
+                                              size_t event_data_size,
+                                              uint8_t priority,
+                                              BaseType_t *task_unblocked);
 #endif
 
 /**
@@ -465,10 +652,14 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop,
            handler
            handler
            ...
+           lane
+           ...
        event loop
            handler
            handler
            ...
+           lane
+           ...
 
   where:
 
@@ -488,6 +679,13 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop,
            total_invoked - number of times this handler has been invoked
            total_runtime - total amount of time used for invoking this handler
 
+   lane
+       format: priority lat<10us:n <100us:n <1ms:n <10ms:n <100ms:n <1s:n >=1s:n
+       where:
+           priority - priority of the lane
+           n - number of events of the lane which waited in the queue for the given time before
+               being dispatched; events posted from ISRs are not included
+
  @endverbatim
  *
  * @param[in] file the file stream to output to
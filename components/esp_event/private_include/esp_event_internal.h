@@ -66,19 +66,59 @@ typedef struct esp_event_loop_node {
 
 typedef SLIST_HEAD(esp_event_loop_nodes, esp_event_loop_node) esp_event_loop_nodes_t;
 
+/// Handlers to be executed for an event base and id, in dispatch order
+typedef struct esp_event_dispatch_entry {
+    esp_event_base_t base;                                          /**< base of the event, NULL for an empty slot */
+    int32_t id;                                                     /**< id of the event, ESP_EVENT_ANY_ID for events of the base
+                                                                            which have no id level handlers */
+    uint32_t first;                                                 /**< index of the first handler in the handlers array */
+    uint32_t count;                                                 /**< number of handlers to be executed */
+} esp_event_dispatch_entry_t;
+
+/// Dispatch index of an event loop, built from the handler lists
+typedef struct esp_event_dispatch_table {
+    esp_event_handler_node_t** handlers;                            /**< handler arrays of all entries */
+    esp_event_dispatch_entry_t any;                                 /**< loop level handlers, for events with an unknown base */
+    uint32_t mask;                                                  /**< number of slots minus one */
+    esp_event_dispatch_entry_t slots[];                             /**< open addressing hash table of the entries */
+} esp_event_dispatch_table_t;
+
+/// Preallocated blocks for event data which doesn't fit in the post instance
+typedef struct esp_event_data_pool {
+    uint8_t* blocks;                                                /**< memory of all the blocks */
+    void* free_blocks;                                              /**< list of free blocks, linked through their first word */
+    size_t block_size;                                              /**< size of a block, 0 if the loop has no pool */
+    portMUX_TYPE lock;                                              /**< protects free_blocks */
+} esp_event_data_pool_t;
+
+#define ESP_EVENT_LATENCY_BUCKETS   7                                   /**< number of queue latency histogram buckets:
+                                                                            <10us, <100us, <1ms, <10ms, <100ms, <1s, >=1s */
+
 /// Event loop
 typedef struct esp_event_loop_instance {
     const char* name;                                               /**< name of this event loop */
-    QueueHandle_t queue;                                            /**< event queue */
+    QueueHandle_t queues[ESP_EVENT_PRIORITY_LANES_MAX];             /**< event queue of each priority lane */
+    SemaphoreHandle_t pending;                                      /**< counts events queued to all the lanes, NULL
+                                                                            for loops with a single lane */
+    uint8_t lane_count;                                             /**< number of priority lanes */
+    uint32_t batch_size;                                            /**< maximum number of events dispatched per
+                                                                            mutex acquisition */
     TaskHandle_t task;                                              /**< task that consumes the event queue */
     TaskHandle_t running_task;                                      /**< for loops with no dedicated task, the
                                                                             task that consumes the queue */
     SemaphoreHandle_t mutex;                                        /**< mutex for updating the events linked list */
+    esp_event_data_pool_t data_pool;                                /**< blocks for event data posted to the loop */
     esp_event_loop_nodes_t loop_nodes;                              /**< set of linked lists containing the
                                                                             registered handlers for the loop */
+    esp_event_dispatch_table_t* dispatch;                           /**< dispatch index built from loop_nodes */
+    bool dispatch_dirty;                                            /**< loop_nodes changed since the index was built */
+    uint32_t dispatch_depth;                                        /**< number of events being dispatched, the index
+                                                                            is not freed while it is non-zero */
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     atomic_uint_least32_t events_received;                          /**< number of events successfully posted to the loop */
     atomic_uint_least32_t events_dropped;                           /**< number of events dropped due to queue being full */
+    uint32_t latency[ESP_EVENT_PRIORITY_LANES_MAX][ESP_EVENT_LATENCY_BUCKETS];  /**< histogram of the time events of
+                                                                            each lane spent in the queue */
     SLIST_ENTRY(esp_event_loop_instance) next;                      /**< next event loop in the list */
 #endif
 } esp_event_loop_instance_t;
@@ -91,19 +131,29 @@ typedef struct esp_event_remove_handler_context_t {
     bool legacy;                                                    /**< Set to true when the handler unregistration request was made from legacy code */
 } esp_event_remove_handler_context_t;
 
+/// Storage of the data of a posted event
+typedef enum {
+    ESP_EVENT_POST_DATA_NONE = 0,                                   /**< the event has no data */
+    ESP_EVENT_POST_DATA_INLINE,                                     /**< data is stored in the post instance */
+    ESP_EVENT_POST_DATA_POOL,                                       /**< data is stored in a block of the loop data pool */
+    ESP_EVENT_POST_DATA_HEAP,                                       /**< data is allocated from heap */
+} esp_event_post_data_type_t;
+
 typedef union esp_event_post_data {
     uint32_t val;
     void *ptr;
+    uint8_t bytes[CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE];
 } esp_event_post_data_t;
 
 /// Event posted to the event queue
 typedef struct esp_event_post_instance {
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    bool data_allocated;                                             /**< indicates whether data is allocated from heap */
-    bool data_set;                                                   /**< indicates if data is null */
-#endif
     esp_event_base_t base;                                           /**< the event base */
     int32_t id;                                                      /**< the event id */
+    uint8_t data_type;                                               /**< storage of the data, esp_event_post_data_type_t */
+    uint8_t lane;                                                    /**< priority lane the event is posted to */
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+    int64_t time;                                                    /**< time the event was posted, 0 if posted from ISR */
+#endif
     esp_event_post_data_t data;                                      /**< data associated with the event */
 } esp_event_post_instance_t;
 
@@ -647,6 +647,144 @@ TEST_CASE("performance test - no dedicated task", "[event][qemu-ignore]")
     performance_test(false);
 }
 
+/* Counts the free blocks of the data pool of the loop */
+static uint32_t test_event_data_pool_free_blocks(esp_event_loop_instance_t* loop)
+{
+    uint32_t count = 0;
+    portENTER_CRITICAL(&loop->data_pool.lock);
+    for (void** block = loop->data_pool.free_blocks; block != NULL; block = *block) {
+        count++;
+    }
+    portEXIT_CRITICAL(&loop->data_pool.lock);
+    return count;
+}
+
+/* Checks where the data of the next event is stored, then dispatches the event, which releases its data */
+static void test_event_dispatch_next(esp_event_loop_handle_t loop, esp_event_post_data_type_t data_type)
+{
+    esp_event_post_instance_t post;
+    esp_event_loop_instance_t* loop_def = (esp_event_loop_instance_t*) loop;
+    UBaseType_t queued = uxQueueMessagesWaiting(loop_def->queues[0]);
+
+    TEST_ASSERT_EQUAL(pdTRUE, xQueuePeek(loop_def->queues[0], &post, 0));
+    TEST_ASSERT_EQUAL(data_type, post.data_type);
+    // With no ticks to run, a single event is dispatched
+    TEST_ESP_OK(esp_event_loop_run(loop, 0));
+    TEST_ASSERT_EQUAL(queued - 1, uxQueueMessagesWaiting(loop_def->queues[0]));
+}
+
+TEST_CASE("event data is stored inline, in the data pool or on heap", "[event]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+
+    loop_args.task_name = NULL;
+    loop_args.data_pool_size = 1;
+    loop_args.data_pool_block_size = 2 * CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    esp_event_loop_instance_t* loop_def = (esp_event_loop_instance_t*) loop;
+    uint8_t data[2 * CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE + 1] = { 0 };
+
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, data, CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE, portMAX_DELAY));
+    test_event_dispatch_next(loop, ESP_EVENT_POST_DATA_INLINE);
+
+    // The second large event doesn't get the only pool block
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, data, CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE + 1, portMAX_DELAY));
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, data, CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE + 1, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(0, test_event_data_pool_free_blocks(loop_def));
+    test_event_dispatch_next(loop, ESP_EVENT_POST_DATA_POOL);
+    test_event_dispatch_next(loop, ESP_EVENT_POST_DATA_HEAP);
+
+    // Dispatching the event gave the block back to the pool
+    TEST_ASSERT_EQUAL(1, test_event_data_pool_free_blocks(loop_def));
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, data, CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE + 1, portMAX_DELAY));
+    test_event_dispatch_next(loop, ESP_EVENT_POST_DATA_POOL);
+
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, data, sizeof(data), portMAX_DELAY));
+    test_event_dispatch_next(loop, ESP_EVENT_POST_DATA_HEAP);
+
+    // The loop frees the buffer it was handed over, the leak check of the test covers it
+    void* owned = malloc(sizeof(data));
+    TEST_ASSERT_NOT_NULL(owned);
+    TEST_ESP_OK(esp_event_post_to_nocopy(loop, s_test_base1, TEST_EVENT_BASE1_EV1, owned, portMAX_DELAY));
+    esp_event_post_instance_t post;
+    TEST_ASSERT_EQUAL(pdTRUE, xQueuePeek(loop_def->queues[0], &post, 0));
+    TEST_ASSERT_EQUAL_PTR(owned, post.data.ptr);
+    test_event_dispatch_next(loop, ESP_EVENT_POST_DATA_HEAP);
+
+    TEST_ASSERT_EQUAL(1, test_event_data_pool_free_blocks(loop_def));
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+
+    vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
+}
+
+static void test_handler_record_priority(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    uint8_t** order = (uint8_t**) event_handler_arg;
+    *(*order)++ = *(uint8_t*) event_data;
+}
+
+TEST_CASE("events of higher priority lanes are dispatched first", "[event]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+
+    loop_args.task_name = NULL;
+    loop_args.priority_lanes = 3;
+    loop_args.dispatch_batch_size = 4;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    uint8_t order[8] = { 0 };
+    uint8_t* next = order;
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_handler_record_priority, &next));
+
+    // Priorities above the highest lane are posted to the highest lane
+    const uint8_t priorities[] = { 0, 1, 0, 2, 7, 1 };
+    for (int i = 0; i < sizeof(priorities); i++) {
+        TEST_ESP_OK(esp_event_post_to_with_priority(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &priorities[i],
+                                                    sizeof(priorities[i]), priorities[i], portMAX_DELAY));
+    }
+
+    // Batches of 4, then 2 events
+    TEST_ESP_OK(esp_event_loop_run(loop, 0));
+    TEST_ASSERT_EQUAL(4, next - order);
+    TEST_ESP_OK(esp_event_loop_run(loop, 0));
+
+    const uint8_t expected[] = { 2, 7, 1, 1, 0, 0 };
+    TEST_ASSERT_EQUAL(sizeof(expected), next - order);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, order, sizeof(expected));
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+
+    vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
+}
+
+static void test_handler_give_sem(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    xSemaphoreGive(*(SemaphoreHandle_t*) event_handler_arg);
+}
+
+TEST_CASE("can post events with priority to the default loop", "[event]")
+{
+    TEST_ESP_OK(esp_event_loop_create_default());
+
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    TEST_ESP_OK(esp_event_handler_register(s_test_base1, TEST_EVENT_BASE1_EV1, test_handler_give_sem, &sem));
+
+    // Any priority is accepted, whatever the number of lanes of the default loop is
+    uint8_t priority = ESP_EVENT_PRIORITY_LANES_MAX;
+    TEST_ESP_OK(esp_event_post_with_priority(s_test_base1, TEST_EVENT_BASE1_EV1, &priority, sizeof(priority),
+                                             priority, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(sem, pdMS_TO_TICKS(1000)));
+
+    TEST_ESP_OK(esp_event_handler_unregister(s_test_base1, TEST_EVENT_BASE1_EV1, test_handler_give_sem));
+    TEST_ESP_OK(esp_event_loop_delete_default());
+    vSemaphoreDelete(sem);
+
+    vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
+}
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 TEST_CASE("data posted normally is correctly set internally", "[event][intr]")
 {
@@ -660,9 +798,8 @@ TEST_CASE("data posted normally is correctly set internally", "[event][intr]")
     esp_event_loop_instance_t* loop_def = (esp_event_loop_instance_t*) loop;
 
     TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
-    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
-    TEST_ASSERT_EQUAL(false, post.data_set);
-    TEST_ASSERT_EQUAL(false, post.data_allocated);
+    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queues[0], &post, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_NONE, post.data_type);
     TEST_ASSERT_EQUAL(NULL, post.data.ptr);
 
     TEST_ESP_OK(esp_event_loop_delete(loop));
@@ -682,9 +819,8 @@ TEST_CASE("data posted from ISR is correctly set internally", "[event][intr]")
     esp_event_loop_instance_t* loop_def = (esp_event_loop_instance_t*) loop;
     int sample = 0;
     TEST_ESP_OK(esp_event_isr_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &sample, sizeof(sample), NULL));
-    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
-    TEST_ASSERT_EQUAL(true, post.data_set);
-    TEST_ASSERT_EQUAL(false, post.data_allocated);
+    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queues[0], &post, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_INLINE, post.data_type);
     TEST_ASSERT_EQUAL(false, post.data.val);
 
     TEST_ESP_OK(esp_event_loop_delete(loop));
@@ -692,6 +828,40 @@ TEST_CASE("data posted from ISR is correctly set internally", "[event][intr]")
     vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
 }
 
+TEST_CASE("events posted from ISR go to the lane of their priority", "[event][intr]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+
+    loop_args.task_name = NULL;
+    loop_args.priority_lanes = 2;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    esp_event_post_instance_t post;
+    esp_event_loop_instance_t* loop_def = (esp_event_loop_instance_t*) loop;
+    int sample = 0;
+
+    TEST_ESP_OK(esp_event_isr_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &sample, sizeof(sample), NULL));
+    TEST_ASSERT_EQUAL(1, uxQueueMessagesWaiting(loop_def->queues[0]));
+    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queues[0], &post, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(0, post.lane);
+
+    // Priorities above the highest lane are posted to the highest lane
+    const uint8_t priorities[] = { 1, 5 };
+    for (int i = 0; i < sizeof(priorities); i++) {
+        TEST_ESP_OK(esp_event_isr_post_to_with_priority(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &sample,
+                                                        sizeof(sample), priorities[i], NULL));
+        TEST_ASSERT_EQUAL(0, uxQueueMessagesWaiting(loop_def->queues[0]));
+        TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queues[1], &post, portMAX_DELAY));
+        TEST_ASSERT_EQUAL(1, post.lane);
+        TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_INLINE, post.data_type);
+    }
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+
+    vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
+}
+
 static void test_handler_post_from_isr(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
 {
     SemaphoreHandle_t *sem = (SemaphoreHandle_t*) event_handler_arg;
@@ -13,11 +13,14 @@
 #include <stdbool.h>
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_heap_caps_pool.h"
 #include "http_header.h"
 #include "http_utils.h"
 
 static const char *TAG = "HTTP_HEADER";
 #define HEADER_BUFFER (1024)
+// Items are allocated from a pool, a request usually has less than 8 headers
+#define HEADER_ITEM_POOL_COUNT (8)
 
 /**
  * dictionary item struct, with key-value pair
@@ -28,20 +31,31 @@ typedef struct http_header_item {
     STAILQ_ENTRY(http_header_item) next;   /*!< Point to next entry */
 } http_header_item_t;
 
-STAILQ_HEAD(http_header, http_header_item);
+struct http_header {
+    STAILQ_HEAD(, http_header_item) items;  /*!< List of the header items */
+    heap_caps_pool_handle_t item_pool;      /*!< Pool of the header items */
+};
 
 
 http_header_handle_t http_header_init(void)
 {
     http_header_handle_t header = calloc(1, sizeof(struct http_header));
     ESP_RETURN_ON_FALSE(header, NULL, TAG, "Memory exhausted");
-    STAILQ_INIT(header);
+    header->item_pool = heap_caps_pool_create_growable(sizeof(http_header_item_t), MALLOC_CAP_DEFAULT,
+                                                       HEADER_ITEM_POOL_COUNT, HEADER_ITEM_POOL_COUNT);
+    if (header->item_pool == NULL) {
+        free(header);
+        ESP_LOGE(TAG, "Memory exhausted");
+        return NULL;
+    }
+    STAILQ_INIT(&header->items);
     return header;
 }
 
 esp_err_t http_header_destroy(http_header_handle_t header)
 {
     esp_err_t err = http_header_clean(header);
+    heap_caps_pool_delete(header->item_pool);
     free(header);
     return err;
 }
@@ -52,7 +66,7 @@ http_header_item_handle_t http_header_get_item(http_header_handle_t header, cons
     if (header == NULL || key == NULL) {
         return NULL;
     }
-    STAILQ_FOREACH(item, header, next) {
+    STAILQ_FOREACH(item, &header->items, next) {
         if (strcasecmp(item->key, key) == 0) {
             return item;
         }
@@ -79,20 +93,21 @@ static esp_err_t http_header_new_item(http_header_handle_t header, const char *k
     esp_err_t ret = ESP_OK;
     http_header_item_handle_t item;
 
-    item = calloc(1, sizeof(http_header_item_t));
+    item = heap_caps_pool_alloc(header->item_pool);
     ESP_RETURN_ON_FALSE(item, ESP_ERR_NO_MEM, TAG, "Memory exhausted");
+    memset(item, 0, sizeof(http_header_item_t));
     http_utils_assign_string(&item->key, key, -1);
     ESP_GOTO_ON_FALSE(item->key, ESP_ERR_NO_MEM, _header_new_item_exit, TAG, "Memory exhausted");
     http_utils_trim_whitespace(&item->key);
     http_utils_assign_string(&item->value, value, -1);
     ESP_GOTO_ON_FALSE(item->value, ESP_ERR_NO_MEM, _header_new_item_exit, TAG, "Memory exhausted");
     http_utils_trim_whitespace(&item->value);
-    STAILQ_INSERT_TAIL(header, item, next);
+    STAILQ_INSERT_TAIL(&header->items, item, next);
     return ret;
 _header_new_item_exit:
     free(item->key);
     free(item->value);
-    free(item);
+    heap_caps_pool_free(header->item_pool, item);
     return ret;
 }
 
@@ -139,10 +154,10 @@ esp_err_t http_header_delete(http_header_handle_t header, const char *key)
 {
     http_header_item_handle_t item = http_header_get_item(header, key);
     if (item) {
-        STAILQ_REMOVE(header, item, http_header_item, next);
+        STAILQ_REMOVE(&header->items, item, http_header_item, next);
         free(item->key);
         free(item->value);
-        free(item);
+        heap_caps_pool_free(header->item_pool, item);
     } else {
         return ESP_ERR_NOT_FOUND;
     }
@@ -173,7 +188,7 @@ int http_header_generate_string(http_header_handle_t header, int index, char *bu
     bool is_end = false;
 
     // iterate over the header entries to calculate buffer size and determine last item
-    STAILQ_FOREACH(item, header, next) {
+    STAILQ_FOREACH(item, &header->items, next) {
         if (item->value && idx >= index) {
             siz += strlen(item->key);
             siz += strlen(item->value);
@@ -201,7 +216,7 @@ int http_header_generate_string(http_header_handle_t header, int index, char *bu
     // iterate again over the header entries to write only the fitting indeces
     int str_len = 0;
     idx = 0;
-    STAILQ_FOREACH(item, header, next) {
+    STAILQ_FOREACH(item, &header->items, next) {
         if (item->value && idx >= index && idx < ret_idx) {
             str_len += snprintf(buffer + str_len, *buffer_len - str_len, "%s: %s\r\n", item->key, item->value);
         }
@@ -217,15 +232,15 @@ int http_header_generate_string(http_header_handle_t header, int index, char *bu
 
 esp_err_t http_header_clean(http_header_handle_t header)
 {
-    http_header_item_handle_t item = STAILQ_FIRST(header), tmp;
+    http_header_item_handle_t item = STAILQ_FIRST(&header->items), tmp;
     while (item != NULL) {
         tmp = STAILQ_NEXT(item, next);
         free(item->key);
         free(item->value);
-        free(item);
+        heap_caps_pool_free(header->item_pool, item);
         item = tmp;
     }
-    STAILQ_INIT(header);
+    STAILQ_INIT(&header->items);
     return ESP_OK;
 }
 
@@ -233,7 +248,7 @@ int http_header_count(http_header_handle_t header)
 {
     http_header_item_handle_t item;
     int count = 0;
-    STAILQ_FOREACH(item, header, next) {
+    STAILQ_FOREACH(item, &header->items, next) {
         count ++;
     }
     return count;
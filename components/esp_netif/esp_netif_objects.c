@@ -1,74 +1,188 @@
 /*
- * SPDX-FileCopyrightText: 2015-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #include "esp_netif.h"
-#include "sys/queue.h"
 #include "esp_log.h"
 #include "esp_netif_private.h"
+#include "freertos/FreeRTOS.h"
+#include <stdatomic.h>
 #include <string.h>
 
 //
 // Purpose of this module is to provide list of esp-netif structures
 //  - this module has no dependency on a specific network stack (lwip)
 //
+// The list is an immutable table, replaced on every addition and removal (read-copy-update):
+//  - readers don't lock, they count themselves in the reader counter while using the table
+//  - writers (serialized by the caller, see esp_netif_add_to_list_unsafe()) publish a new table and retire
+//    the old one, which is freed once no reader is counted, by the writer or by the last reader leaving.
+//    Writers never wait for the readers: they run in the TCP/IP task, which the readers may call into.
+//  - a removal without memory for the new table clears the slot of the netif in place instead
+//
 
 static const char *TAG = "esp_netif_objects";
 
-typedef struct slist_netifs_s slist_netifs_t;
-struct slist_netifs_s {
-    esp_netif_t *netif;
-    SLIST_ENTRY(slist_netifs_s) next;
-};
-
-SLIST_HEAD(slisthead, slist_netifs_s) s_head = { .slh_first = NULL, };
+typedef struct esp_netif_table {
+    struct esp_netif_table *retired_next;   // link in the list of the retired tables
+    size_t count;
+    _Atomic(esp_netif_t *) netifs[];        // the most recently added first, NULL for a removed netif
+} esp_netif_table_t;
 
-static size_t s_esp_netif_counter = 0;
+static _Atomic(esp_netif_table_t *) s_table = NULL;
+static _Atomic(esp_netif_table_t *) s_retired = NULL;
+static atomic_uint s_readers = 0;
 
 ESP_EVENT_DEFINE_BASE(IP_EVENT);
 
+//
+// Table access
+//
+
+/**
+ * @brief Frees the retired tables, unless a reader, which could have loaded one of them, is counted
+ */
+static void table_reclaim(void)
+{
+    while (atomic_load(&s_readers) == 0) {
+        esp_netif_table_t *retired = atomic_exchange(&s_retired, NULL);
+        if (retired == NULL) {
+            return;
+        }
+        if (atomic_load(&s_readers) == 0) {
+            // the tables were retired before, the readers which loaded them are gone
+            while (retired) {
+                esp_netif_table_t *next = retired->retired_next;
+                free(retired);
+                retired = next;
+            }
+            continue;
+        }
+        // puts them back, the last reader leaving (or this loop, if it already left) frees them
+        esp_netif_table_t *last = retired;
+        while (last->retired_next) {
+            last = last->retired_next;
+        }
+        last->retired_next = atomic_load(&s_retired);
+        while (!atomic_compare_exchange_weak(&s_retired, &last->retired_next, retired)) {
+        }
+    }
+}
+
+static const esp_netif_table_t *table_read_begin(void)
+{
+    atomic_fetch_add(&s_readers, 1);
+    // loaded after the reader is counted, so it can't be freed before table_read_end()
+    return atomic_load(&s_table);
+}
+
+static void table_read_end(void)
+{
+    if (atomic_fetch_sub(&s_readers, 1) == 1 && atomic_load(&s_retired) != NULL) {
+        table_reclaim();
+    }
+}
+
+/**
+ * @brief Publishes the new table and retires the old one
+ */
+static void table_replace(esp_netif_table_t *table)
+{
+    esp_netif_table_t *old = atomic_exchange(&s_table, table);
+    if (old) {
+        old->retired_next = atomic_load(&s_retired);
+        while (!atomic_compare_exchange_weak(&s_retired, &old->retired_next, old)) {
+        }
+    }
+    table_reclaim();
+}
+
+static int table_find(const esp_netif_table_t *table, esp_netif_t *netif)
+{
+    for (size_t i = 0; netif && table && i < table->count; i++) {
+        if (atomic_load(&table->netifs[i]) == netif) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Allocates a table of the netifs of the current table, except the removed ones and the one to skip
+ */
+static esp_netif_table_t *table_copy(const esp_netif_table_t *table, esp_netif_t *add, esp_netif_t *skip)
+{
+    size_t count = add ? 1 : 0;
+    for (size_t i = 0; table && i < table->count; i++) {
+        esp_netif_t *netif = atomic_load(&table->netifs[i]);
+        count += netif && netif != skip;
+    }
+    if (count == 0) {
+        return NULL;
+    }
+    esp_netif_table_t *new_table = malloc(sizeof(esp_netif_table_t) + count * sizeof(esp_netif_t *));
+    if (new_table == NULL) {
+        return NULL;
+    }
+    new_table->retired_next = NULL;
+    new_table->count = 0;
+    if (add) {
+        atomic_init(&new_table->netifs[new_table->count++], add);
+    }
+    for (size_t i = 0; table && i < table->count; i++) {
+        esp_netif_t *netif = atomic_load(&table->netifs[i]);
+        if (netif && netif != skip) {
+            atomic_init(&new_table->netifs[new_table->count++], netif);
+        }
+    }
+    return new_table;
+}
+
 //
 // List manipulation functions
 //
 esp_err_t esp_netif_add_to_list_unsafe(esp_netif_t *netif)
 {
-    struct slist_netifs_s *item = calloc(1, sizeof(struct slist_netifs_s));
     ESP_LOGV(TAG, "%s %p", __func__, netif);
-    if (item == NULL) {
+    esp_netif_table_t *new_table = table_copy(atomic_load(&s_table), netif, NULL);
+    if (new_table == NULL) {
         return ESP_ERR_NO_MEM;
     }
-    item->netif = netif;
-
-    SLIST_INSERT_HEAD(&s_head, item, next);
-    ++s_esp_netif_counter;
-    ESP_LOGD(TAG, "%s netif added successfully (total netifs: %" PRIu32 ")", __func__, (uint32_t)s_esp_netif_counter);
+    table_replace(new_table);
+    ESP_LOGD(TAG, "%s netif added successfully (total netifs: %" PRIu32 ")", __func__, (uint32_t)new_table->count);
     return ESP_OK;
 }
 
-
 esp_err_t esp_netif_remove_from_list_unsafe(esp_netif_t *netif)
 {
-    struct slist_netifs_s *item;
     ESP_LOGV(TAG, "%s %p", __func__, netif);
-
-    SLIST_FOREACH(item, &s_head, next) {
-        if (item->netif == netif) {
-            SLIST_REMOVE(&s_head, item, slist_netifs_s, next);
-            assert(s_esp_netif_counter > 0);
-            --s_esp_netif_counter;
-            ESP_LOGD(TAG, "%s netif successfully removed (total netifs: %" PRIu32 ")", __func__, (uint32_t)s_esp_netif_counter);
-            free(item);
-            return ESP_OK;
-        }
+    esp_netif_table_t *table = atomic_load(&s_table);
+    int index = table_find(table, netif);
+    if (index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_netif_table_t *new_table = table_copy(table, NULL, netif);
+    if (new_table == NULL && table->count > 1) {
+        // no memory for the copy, the next addition drops the cleared slot
+        atomic_store(&table->netifs[index], NULL);
+    } else {
+        table_replace(new_table);
     }
-    return ESP_ERR_NOT_FOUND;
+    ESP_LOGD(TAG, "%s netif successfully removed", __func__);
+    return ESP_OK;
 }
 
 size_t esp_netif_get_nr_of_ifs(void)
 {
-    return s_esp_netif_counter;
+    const esp_netif_table_t *table = table_read_begin();
+    size_t count = 0;
+    for (size_t i = 0; table && i < table->count; i++) {
+        count += atomic_load(&table->netifs[i]) != NULL;
+    }
+    table_read_end();
+    return count;
 }
 
 // This API is inherently unsafe
@@ -81,42 +195,54 @@ esp_netif_t* esp_netif_next(esp_netif_t* netif)
 esp_netif_t* esp_netif_next_unsafe(esp_netif_t* netif)
 {
     ESP_LOGV(TAG, "%s %p", __func__, netif);
-    struct slist_netifs_s *item;
-    // Getting the first netif if argument is NULL
-    if (netif == NULL) {
-        item = SLIST_FIRST(&s_head);
-        return (item == NULL) ? NULL : item->netif;
-    }
-    // otherwise the next one (after the supplied netif)
-    SLIST_FOREACH(item, &s_head, next) {
-        if (item->netif == netif) {
-            item = SLIST_NEXT(item, next);
-            return (item == NULL) ? NULL : item->netif;
+    const esp_netif_table_t *table = table_read_begin();
+    esp_netif_t *next = NULL;
+    // Getting the first netif if argument is NULL, otherwise the next one (after the supplied netif)
+    int index = netif == NULL ? -1 : table_find(table, netif);
+    if (netif == NULL || index >= 0) {
+        for (size_t i = index + 1; table && i < table->count && next == NULL; i++) {
+            next = atomic_load(&table->netifs[i]);
         }
     }
-    return NULL;
+    table_read_end();
+    return next;
 }
 
 bool esp_netif_is_netif_listed(esp_netif_t *esp_netif)
 {
-    struct slist_netifs_s *item;
-    SLIST_FOREACH(item, &s_head, next) {
-        if (item->netif == esp_netif) {
-            return true;
+    const esp_netif_table_t *table = table_read_begin();
+    bool listed = table_find(table, esp_netif) >= 0;
+    table_read_end();
+    return listed;
+}
+
+esp_netif_t *esp_netif_find_if(esp_netif_find_predicate_t fn, void *ctx)
+{
+    const esp_netif_table_t *table = table_read_begin();
+    esp_netif_t *found = NULL;
+    for (size_t i = 0; table && i < table->count; i++) {
+        esp_netif_t *netif = atomic_load(&table->netifs[i]);
+        if (netif && fn(netif, ctx)) {
+            found = netif;
+            break;
         }
     }
-    return false;
+    table_read_end();
+    return found;
+}
+
+static bool if_key_matches(esp_netif_t *esp_netif, void *ctx)
+{
+    const char *if_key = esp_netif_get_ifkey(esp_netif);
+    return if_key && strcmp(ctx, if_key) == 0;
 }
 
 esp_netif_t *esp_netif_get_handle_from_ifkey_unsafe(const char *if_key)
 {
-    struct slist_netifs_s *item;
+    return esp_netif_find_if(if_key_matches, (void *)if_key);
+}
 
-    SLIST_FOREACH(item, &s_head, next) {
-        esp_netif_t *esp_netif = item->netif;
-        if (strcmp(if_key, esp_netif_get_ifkey(esp_netif)) == 0) {
-            return esp_netif;
-        }
-    }
-    return NULL;
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
+{
+    return esp_netif_find_if(if_key_matches, (void *)if_key);
 }
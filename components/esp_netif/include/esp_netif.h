@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2019-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2019-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -64,6 +64,10 @@ esp_netif_t *esp_netif_new(const esp_netif_config_t *esp_netif_config);
 /**
  * @brief   Destroys the esp_netif object
  *
+ * @note With CONFIG_ESP_NETIF_RX_WORKERS, it waits for the input task of the interface to stop,
+ *       which needs the TCP/IP core lock. Called from the TCP/IP context (e.g. from esp_netif_tcpip_exec()),
+ *       it logs an error and leaves the interface as it is.
+ *
  * @param[in]  esp_netif pointer to the object to be deleted
  */
 void esp_netif_destroy(esp_netif_t *esp_netif);
@@ -138,6 +142,53 @@ esp_err_t esp_netif_attach(esp_netif_t *esp_netif, esp_netif_iodriver_handle dri
  */
 esp_err_t esp_netif_receive(esp_netif_t *esp_netif, void *buffer, size_t len, void *eb);
 
+/**
+ * @brief  Passes several raw packets from communication media to the TCP/IP stack at once
+ *
+ * Same as calling esp_netif_receive() for each frame, but the TCP/IP stack gets all the frames
+ * with a single acquisition of the TCP/IP core lock (if LWIP_TCPIP_CORE_LOCKING_INPUT is enabled),
+ * or with a single message to the TCP/IP task. Drivers which receive frames in bursts, like
+ * from a DMA ring, call this function once per burst.
+ *
+ * @param[in]  esp_netif Handle to esp-netif instance
+ * @param[in]  frames Received frames
+ * @param[in]  count Number of frames
+ *
+ * @return
+ *         - ESP_OK
+ *         - ESP_ERR_ESP_NETIF_INVALID_PARAMS
+ *         - ESP_ERR_NO_MEM if some frames could not be queued to the TCP/IP task, these frames are dropped
+ */
+esp_err_t esp_netif_receive_batch(esp_netif_t *esp_netif, const esp_netif_rx_frame_t *frames, size_t count);
+
+/**
+ * @brief  Gets the traffic statistics of the interface
+ *
+ * The counters are updated without locking and can be read from any task at any time, so the values
+ * of a snapshot may be off by the frames in flight. The queue latency is measured on one frame at a time.
+ *
+ * @param[in]  esp_netif Handle to esp-netif instance
+ * @param[out] stats Statistics of the interface since its creation or the last esp_netif_reset_stats()
+ *
+ * @return
+ *         - ESP_OK
+ *         - ESP_ERR_ESP_NETIF_INVALID_PARAMS
+ *         - ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_NETIF_STATS is disabled
+ */
+esp_err_t esp_netif_get_stats(esp_netif_t *esp_netif, esp_netif_stats_t *stats);
+
+/**
+ * @brief  Resets the traffic statistics of the interface to zero
+ *
+ * @param[in]  esp_netif Handle to esp-netif instance
+ *
+ * @return
+ *         - ESP_OK
+ *         - ESP_ERR_ESP_NETIF_INVALID_PARAMS
+ *         - ESP_ERR_NOT_SUPPORTED if CONFIG_ESP_NETIF_STATS is disabled
+ */
+esp_err_t esp_netif_reset_stats(esp_netif_t *esp_netif);
+
 /**
  * @brief Enables transmit/receive event reporting for a network interface.
  *
@@ -1017,6 +1068,8 @@ esp_netif_iodriver_handle esp_netif_get_io_driver(esp_netif_t *esp_netif);
 /**
  * @brief Searches over a list of created objects to find an instance with supplied if key
  *
+ * @note The search doesn't lock the list nor the TCPIP context, so it can be called per packet or per event
+ *
  * @param if_key Textual description of network interface
  *
  * @return Handle to esp-netif instance
@@ -1125,6 +1178,10 @@ typedef bool (*esp_netif_find_predicate_t)(esp_netif_t *netif, void *ctx);
  * @brief Return a netif pointer for the first interface that meets criteria defined
  * by the callback
  *
+ * @note The search doesn't lock the list nor the TCPIP context, it runs the predicate in the context
+ * of the caller over a snapshot of the list. The predicate may call the other esp_netif APIs, including the ones
+ * executed in the TCPIP context, but must not destroy the interfaces it is passed.
+ *
  * @param fn Predicate function returning true for the desired interface
  * @param ctx Context pointer passed to the predicate, typically a descriptor to compare with
  * @return valid netif pointer if found, NULL if not
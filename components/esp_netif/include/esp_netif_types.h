@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -181,6 +181,14 @@ typedef enum esp_netif_flags {
     ESP_NETIF_FLAG_IPV6_AUTOCONFIG_ENABLED = 1 << 8,
 } esp_netif_flags_t;
 
+/**
+ * @brief  Protocol processing done by the IO driver (or its hardware) in place of the TCP/IP stack
+ */
+typedef enum esp_netif_offload {
+    ESP_NETIF_OFFLOAD_TX_CHECKSUM = 1 << 0, /*!< Inserts the IPv4 header, TCP, UDP and ICMP checksums of transmitted frames, except in IP-fragmented datagrams */
+    ESP_NETIF_OFFLOAD_RX_CHECKSUM = 1 << 1, /*!< Checks the IPv4 header, TCP, UDP and ICMP checksums of received frames and drops the wrong ones */
+} esp_netif_offload_t;
+
 typedef enum esp_netif_ip_event_type {
     ESP_NETIF_IP_EVENT_GOT_IP = 1,
     ESP_NETIF_IP_EVENT_LOST_IP = 2,
@@ -244,10 +252,35 @@ struct esp_netif_driver_ifconfig {
     esp_err_t (*transmit)(void *h, void *buffer, size_t len); /*!< transmit function pointer */
     esp_err_t (*transmit_wrap)(void *h, void *buffer, size_t len, void *netstack_buffer); /*!< transmit wrap function pointer */
     void (*driver_free_rx_buffer)(void *h, void* buffer); /*!< free rx buffer function pointer */
+    size_t rx_buffer_num; /*!< number of rx buffers the driver may pass to the TCP/IP stack at the same time, sizes the pool of network stack buffers referencing them (0 if unknown) */
+    uint32_t offload;     /*!< checksums computed by the driver, combination of esp_netif_offload_t flags (0 if none) */
 };
 
 typedef struct esp_netif_driver_ifconfig esp_netif_driver_ifconfig_t;
 
+/**
+ * @brief  Received frame passed to esp_netif_receive_batch()
+ */
+typedef struct esp_netif_rx_frame {
+    void *buffer;       /*!< Received data */
+    size_t len;         /*!< Length of the data frame */
+    void *eb;           /*!< Pointer to internal buffer (used in Wi-Fi driver) */
+} esp_netif_rx_frame_t;
+
+/**
+ * @brief  Traffic statistics of an esp-netif instance, see esp_netif_get_stats()
+ */
+typedef struct esp_netif_stats {
+    uint64_t rx_packets;        /*!< Frames received from the driver */
+    uint64_t rx_bytes;          /*!< Bytes of the frames received from the driver */
+    uint64_t rx_dropped;        /*!< Received frames dropped before the TCP/IP stack processed them (interface down, out of memory, input queue full) */
+    uint64_t tx_packets;        /*!< Frames passed to the driver */
+    uint64_t tx_bytes;          /*!< Bytes of the frames passed to the driver */
+    uint64_t tx_dropped;        /*!< Frames the driver failed to transmit */
+    uint32_t rx_queue_latency_avg_us;   /*!< Average time of the received frames in the input queue of the TCP/IP stack, in microseconds (sampled, moving average) */
+    uint32_t rx_queue_latency_max_us;   /*!< Maximum sampled time of the received frames in the input queue of the TCP/IP stack, in microseconds */
+} esp_netif_stats_t;
+
 /**
  * @brief  Specific L3 network stack configuration
  */
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -24,6 +24,26 @@ extern "C" {
  */
 struct pbuf* esp_pbuf_allocate(esp_netif_t *esp_netif, void *buffer, size_t len, void *l2_buff);
 
+/**
+ * @brief Adds the custom pbufs for the RX buffers of a driver to the pool
+ *
+ * The pool grows to the sum of the current reservations, custom pbufs beyond its capacity
+ * are allocated from the heap.
+ *
+ * @note Called from the TCP/IP context, which serializes the reservations
+ *
+ * @param count Number of RX buffers the driver may pass to the stack at the same time
+ * @return ESP_OK on success; ESP_ERR_NO_MEM if the pool couldn't grow (the custom pbufs are then allocated from the heap)
+ */
+esp_err_t esp_pbuf_pool_reserve(size_t count);
+
+/**
+ * @brief Returns a reservation made with esp_pbuf_pool_reserve()
+ *
+ * @note Called from the TCP/IP context
+ */
+void esp_pbuf_pool_release(size_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -187,8 +187,6 @@ esp_netif_t *esp_netif_new(const esp_netif_config_t *esp_netif_config)
     }
     esp_netif->ip_info_old = ip_info;
 
-    esp_netif_add_to_list_unsafe(esp_netif);
-
     // Configure the created object with provided configuration
     esp_err_t ret =  esp_netif_init_configuration(esp_netif, esp_netif_config);
     if (ret != ESP_OK) {
@@ -196,6 +194,7 @@ esp_netif_t *esp_netif_new(const esp_netif_config_t *esp_netif_config)
         esp_netif_destroy(esp_netif);
         return NULL;
     }
+    esp_netif_add_to_list_unsafe(esp_netif);
 
     return esp_netif;
 }
@@ -284,6 +283,27 @@ esp_err_t esp_netif_receive(esp_netif_t *esp_netif, void *buffer, size_t len, vo
     return ESP_OK;
 }
 
+esp_err_t esp_netif_receive_batch(esp_netif_t *esp_netif, const esp_netif_rx_frame_t *frames, size_t count)
+{
+    if (esp_netif == NULL || (frames == NULL && count > 0)) {
+        return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+    }
+    for (size_t i = 0; i < count; i++) {
+        esp_netif_receive(esp_netif, frames[i].buffer, frames[i].len, frames[i].eb);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_get_stats(esp_netif_t *esp_netif, esp_netif_stats_t *stats)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_netif_reset_stats(esp_netif_t *esp_netif)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
 esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif)
 {
     return ESP_ERR_NOT_SUPPORTED;
@@ -479,9 +499,4 @@ esp_err_t esp_netif_tcpip_exec(esp_netif_callback_fn fn, void*ctx)
 {
     return fn(ctx);
 }
-
-esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
-{
-    return esp_netif_get_handle_from_ifkey_unsafe(if_key);
-}
 #endif /* CONFIG_ESP_NETIF_LOOPBACK */
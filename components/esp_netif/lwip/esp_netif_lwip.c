@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2019-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2019-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -13,6 +13,7 @@
 #include "esp_check.h"
 #include "esp_netif_lwip_internal.h"
 #include "lwip/esp_netif_net_stack.h"
+#include "lwip/esp_pbuf_ref.h"
 
 
 #include "esp_netif.h"
@@ -31,6 +32,7 @@
 #include "lwip/priv/tcpip_priv.h"
 #include "lwip/netif.h"
 #include "lwip/etharp.h"
+#include "netif/ethernet.h"
 #if CONFIG_ESP_NETIF_BRIDGE_EN
 #include "netif/bridgeif.h"
 #endif // CONFIG_ESP_NETIF_BRIDGE_EN
@@ -50,6 +52,14 @@
 #include "netif/dhcp_state.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#if CONFIG_ESP_NETIF_STATS
+#include "esp_timer.h"
+#endif
+#if CONFIG_ESP_NETIF_RX_WORKERS
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#endif
 #if IP_NAPT
 #include "lwip/lwip_napt.h"
 #endif
@@ -60,9 +70,33 @@
 //
 
 #define ESP_NETIF_HOSTNAME_MAX_SIZE    32
+#define ESP_NETIF_RX_BATCH_MAX         16
 
 #define DHCP_CB_CHANGE (LWIP_NSC_IPV4_SETTINGS_CHANGED | LWIP_NSC_IPV4_ADDRESS_CHANGED | LWIP_NSC_IPV4_GATEWAY_CHANGED | LWIP_NSC_IPV4_NETMASK_CHANGED)
 
+/**
+ * @brief Packets of the frames passed to esp_netif_receive_batch(), collected by the input function
+ * of the netif when called from the task running the batch
+ */
+struct esp_netif_rx_batch {
+    TaskHandle_t owner;
+    struct netif *netif;
+    size_t count;
+    struct pbuf *p[ESP_NETIF_RX_BATCH_MAX];
+};
+
+#if CONFIG_ESP_NETIF_RX_WORKERS
+/**
+ * @brief Input queue of the netif, serviced by a task which inputs the packets under the core lock
+ */
+struct esp_netif_rx_worker {
+    esp_netif_t *esp_netif;
+    QueueHandle_t queue;        // of struct pbuf *, NULL stops the task
+    TaskHandle_t task;
+    TaskHandle_t stopper;       // notified when the task stops
+};
+#endif
+
 /**
  * @brief lwip thread safe tcpip function utility macros
  */
@@ -136,6 +170,10 @@ static void netif_unset_mldv6_flag(esp_netif_t *netif);
 #endif /* LWIP_IPV6 */
 
 static esp_err_t esp_netif_destroy_api(esp_netif_api_msg_t *msg);
+#if CONFIG_ESP_NETIF_RX_WORKERS
+static esp_err_t esp_netif_rx_worker_start(esp_netif_t *esp_netif);
+static void esp_netif_rx_worker_stop(esp_netif_t *esp_netif);
+#endif
 
 static void netif_callback_fn(struct netif* netif, netif_nsc_reason_t reason, const netif_ext_callback_args_t* args)
 {
@@ -605,6 +643,53 @@ esp_err_t esp_netif_deinit(void)
     return ESP_ERR_INVALID_STATE;
 }
 
+/**
+ * @brief Sizes the reservation of the netif in the pool of custom pbufs to the rx buffers of its driver
+ *
+ * @note Runs in the lwip context
+ */
+static void esp_netif_reserve_rx_pbufs(esp_netif_t *esp_netif, size_t rx_buffer_num)
+{
+    if (rx_buffer_num == esp_netif->rx_pbufs_reserved) {
+        return;
+    }
+    esp_pbuf_pool_release(esp_netif->rx_pbufs_reserved);
+    esp_netif->rx_pbufs_reserved = rx_buffer_num;
+    if (esp_pbuf_pool_reserve(rx_buffer_num) != ESP_OK) {
+        ESP_LOGW(TAG, "No memory to pool the pbufs of %u rx buffers, allocating them per frame", (unsigned)rx_buffer_num);
+    }
+}
+
+/**
+ * @brief Skips the checksums computed by the driver in the lwip netif
+ *
+ * @note Runs in the lwip context, after netif_add() which enables all the checksums
+ */
+static void esp_netif_apply_offload(esp_netif_t *esp_netif)
+{
+    if (esp_netif->lwip_netif == NULL) {
+        return;
+    }
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+    u16_t chksum_flags = NETIF_CHECKSUM_ENABLE_ALL;
+    if (esp_netif->offload & ESP_NETIF_OFFLOAD_TX_CHECKSUM) {
+        // ICMP and ICMPv6 checksums stay in software: the hardware does not fill them in for fragmented
+        // datagrams (echo replies to large pings). lwip udp.c computes the checksum of fragmented UDP datagrams
+        chksum_flags &= ~(NETIF_CHECKSUM_GEN_IP | NETIF_CHECKSUM_GEN_UDP | NETIF_CHECKSUM_GEN_TCP);
+    }
+    if (esp_netif->offload & ESP_NETIF_OFFLOAD_RX_CHECKSUM) {
+        chksum_flags &= ~(NETIF_CHECKSUM_CHECK_IP | NETIF_CHECKSUM_CHECK_UDP | NETIF_CHECKSUM_CHECK_TCP |
+                          NETIF_CHECKSUM_CHECK_ICMP | NETIF_CHECKSUM_CHECK_ICMP6);
+    }
+    NETIF_SET_CHECKSUM_CTRL(esp_netif->lwip_netif, chksum_flags);
+#else
+    if (esp_netif->offload) {
+        ESP_LOGD(TAG, "%s: checksums offloaded by the driver are computed also in software (CONFIG_LWIP_CHECKSUM_CTRL_PER_NETIF disabled)",
+                 esp_netif->if_key);
+    }
+#endif
+}
+
 static esp_err_t esp_netif_init_configuration(esp_netif_t *esp_netif, const esp_netif_config_t *cfg)
 {
     // Basic esp_netif and lwip is a mandatory configuration and cannot be updated after esp_netif_new()
@@ -694,6 +779,8 @@ static esp_err_t esp_netif_init_configuration(esp_netif_t *esp_netif, const esp_
         if (esp_netif_driver_config->driver_free_rx_buffer) {
             esp_netif->driver_free_rx_buffer = esp_netif_driver_config->driver_free_rx_buffer;
         }
+        esp_netif_reserve_rx_pbufs(esp_netif, esp_netif_driver_config->rx_buffer_num);
+        esp_netif->offload = esp_netif_driver_config->offload;
     }
     return ESP_OK;
 }
@@ -772,8 +859,6 @@ static esp_err_t esp_netif_new_api(esp_netif_api_msg_t *msg)
 
     esp_netif->lwip_netif = lwip_netif;
 
-    esp_netif_add_to_list_unsafe(esp_netif);
-
 #if ESP_DHCPS
     // Create DHCP server structure
     if (esp_netif_config->base->flags & ESP_NETIF_DHCP_SERVER) {
@@ -795,6 +880,8 @@ static esp_err_t esp_netif_new_api(esp_netif_api_msg_t *msg)
         esp_netif_destroy_api(&to_destroy);
         return ESP_FAIL;
     }
+    // listed once configured, the list is read outside of the lwip context
+    esp_netif_add_to_list_unsafe(esp_netif);
     lwip_set_esp_netif(lwip_netif, esp_netif);
 
     if (netif_callback.callback_fn == NULL ) {
@@ -809,48 +896,15 @@ esp_netif_t *esp_netif_new(const esp_netif_config_t *config)
 {
     esp_netif_t *netif = NULL;
     esp_netif_lwip_ipc_call_get_netif(esp_netif_new_api, &netif, (void *)config);
-    return netif;
-}
-
-static esp_err_t get_handle_from_ifkey_api(esp_netif_api_msg_t *msg)
-{
-    *msg->p_esp_netif = esp_netif_get_handle_from_ifkey_unsafe(msg->data);
-    return ESP_OK;
-}
-
-esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
-{
-    esp_netif_t *netif = NULL;
-    esp_netif_lwip_ipc_call_get_netif(get_handle_from_ifkey_api, &netif, (void*)if_key);
-    return netif;
-}
-
-typedef struct find_if_api {
-    esp_netif_find_predicate_t fn;
-    void *ctx;
-} find_if_api_t;
-
-static esp_err_t esp_netif_find_if_api(esp_netif_api_msg_t *msg)
-{
-    find_if_api_t *find_if_api = msg->data;
-    esp_netif_t *esp_netif = NULL;
-    while ((esp_netif = esp_netif_next_unsafe(esp_netif)) != NULL) {
-        if (find_if_api->fn(esp_netif, find_if_api->ctx)) {
-            *msg->p_esp_netif = esp_netif;
-            return ESP_OK;
-        }
+#if CONFIG_ESP_NETIF_RX_WORKERS
+    // the input task takes the core lock, so it's started and stopped outside of the lwip context
+    if (netif && esp_netif_rx_worker_start(netif) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start the input task of netif %s", netif->if_key);
+        esp_netif_destroy(netif);
+        return NULL;
     }
-    return ESP_FAIL;
-}
-
-esp_netif_t *esp_netif_find_if(esp_netif_find_predicate_t fn, void *ctx)
-{
-    esp_netif_t *netif = NULL;
-    find_if_api_t find_if_api = { .fn = fn, .ctx = ctx };
-    if (esp_netif_lwip_ipc_call_get_netif(esp_netif_find_if_api, &netif, &find_if_api) == ESP_OK) {
-        return netif;
-    }
-    return NULL;
+#endif
+    return netif;
 }
 
 static void esp_netif_lwip_remove(esp_netif_t *esp_netif)
@@ -879,6 +933,289 @@ static void esp_netif_lwip_remove(esp_netif_t *esp_netif)
     }
 }
 
+/**
+ * @brief Input function of the lwip core for the packets of the netif, as chosen by tcpip_input()
+ */
+static inline netif_input_fn esp_netif_lwip_stack_input(struct netif *inp)
+{
+#if LWIP_ETHERNET
+    if (inp->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET)) {
+        return ethernet_input;
+    }
+#endif
+    return ip_input;
+}
+
+#if CONFIG_ESP_NETIF_STATS
+/**
+ * @brief Starts a queue latency sample on the packet, unless a sample is running
+ *
+ * @note The received packets of a netif are queued by a single driver task
+ */
+static inline void esp_netif_stats_rx_queued(esp_netif_t *esp_netif, struct pbuf *p)
+{
+    esp_netif_stats_counters_t *stats = &esp_netif->stats;
+    if (atomic_load_explicit(&stats->rx_probe, memory_order_relaxed) == NULL) {
+        stats->rx_probe_time = esp_timer_get_time();
+        atomic_store_explicit(&stats->rx_probe, p, memory_order_release);
+    }
+}
+
+/**
+ * @brief Stops the latency sample of the packet, if it is the probe
+ *
+ * @param processed false if the packet didn't make it to the queue, it isn't sampled
+ */
+static inline void esp_netif_stats_rx_dequeued(esp_netif_t *esp_netif, struct pbuf *p, bool processed)
+{
+    esp_netif_stats_counters_t *stats = &esp_netif->stats;
+    if (atomic_load_explicit(&stats->rx_probe, memory_order_acquire) != p) {
+        return;
+    }
+    if (processed) {
+        uint32_t latency = (uint32_t)(esp_timer_get_time() - stats->rx_probe_time);
+        uint32_t avg = atomic_load_explicit(&stats->rx_latency_avg_us, memory_order_relaxed);
+        // moving average with the weight of 1/8 for the new sample
+        avg = avg ? avg - avg / 8 + latency / 8 : latency;
+        atomic_store_explicit(&stats->rx_latency_avg_us, avg, memory_order_relaxed);
+        if (latency > atomic_load_explicit(&stats->rx_latency_max_us, memory_order_relaxed)) {
+            atomic_store_explicit(&stats->rx_latency_max_us, latency, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&stats->rx_probe, NULL, memory_order_release);
+}
+
+#define ESP_NETIF_STATS_FOLD (1UL << 31)
+
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void esp_netif_stats_fold(esp_netif_stats_counter_t *counter)
+{
+    portENTER_CRITICAL_SAFE(&s_stats_lock);
+    atomic_fetch_sub_explicit(&counter->count, ESP_NETIF_STATS_FOLD, memory_order_relaxed);
+    counter->base += ESP_NETIF_STATS_FOLD;
+    portEXIT_CRITICAL_SAFE(&s_stats_lock);
+}
+
+static inline void esp_netif_stats_add(esp_netif_stats_counter_t *counter, uint32_t n)
+{
+    uint32_t old = atomic_fetch_add_explicit(&counter->count, n, memory_order_relaxed);
+    // only the update crossing 2^31 folds, the others keep adding on top of it meanwhile
+    if (unlikely(old < ESP_NETIF_STATS_FOLD && old + n >= ESP_NETIF_STATS_FOLD)) {
+        esp_netif_stats_fold(counter);
+    }
+}
+
+/**
+ * @brief Reads the full 64-bit value of a counter, called with the stats lock held
+ */
+static inline uint64_t esp_netif_stats_read(const esp_netif_stats_counter_t *counter)
+{
+    return counter->base + atomic_load_explicit(&counter->count, memory_order_relaxed);
+}
+
+/**
+ * @brief Restarts a counter from zero, called with the stats lock held
+ *
+ * The count is not cleared, as an update that crossed 2^31 may be about to fold it
+ */
+static inline void esp_netif_stats_clear(esp_netif_stats_counter_t *counter)
+{
+    counter->base = -(uint64_t)atomic_load_explicit(&counter->count, memory_order_relaxed);
+}
+
+void esp_netif_stats_rx_dropped(esp_netif_t *esp_netif)
+{
+    if (esp_netif) {
+        esp_netif_stats_add(&esp_netif->stats.rx_dropped, 1);
+    }
+}
+
+static inline void esp_netif_stats_count(esp_netif_stats_counter_t *packets, esp_netif_stats_counter_t *bytes, size_t len)
+{
+    esp_netif_stats_add(packets, 1);
+    esp_netif_stats_add(bytes, len);
+}
+
+/**
+ * @brief Input of the packets queued to the tcpip thread by esp_netif_lwip_input(), the same as tcpip_input()
+ * with the latency sample
+ */
+static err_t esp_netif_lwip_input_dequeued(struct pbuf *p, struct netif *inp)
+{
+    esp_netif_t *esp_netif = lwip_get_esp_netif(inp);
+    if (esp_netif) {
+        esp_netif_stats_rx_dequeued(esp_netif, p, true);
+    }
+    return esp_netif_lwip_stack_input(inp)(p, inp);
+}
+#endif // CONFIG_ESP_NETIF_STATS
+
+#if CONFIG_ESP_NETIF_RX_WORKERS
+static void esp_netif_rx_worker_input(esp_netif_t *esp_netif, struct pbuf *p)
+{
+    struct netif *inp = esp_netif->lwip_netif;
+#if CONFIG_ESP_NETIF_STATS
+    esp_netif_stats_rx_dequeued(esp_netif, p, true);
+#endif
+    // the packets queued before the netif went down are dropped, as the input functions do
+    if (unlikely(!netif_is_up(inp))) {
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
+        pbuf_free(p);
+    } else if (esp_netif_lwip_stack_input(inp)(p, inp) != ERR_OK) {
+        pbuf_free(p);
+    }
+}
+
+/**
+ * @brief Input task of the netif, inputs the queued packets in bursts, one acquisition of the core lock per burst
+ */
+static void esp_netif_rx_worker_task(void *arg)
+{
+    struct esp_netif_rx_worker *worker = arg;
+    esp_netif_t *esp_netif = worker->esp_netif;
+    struct pbuf *p;
+    bool running = true;
+    while (running) {
+        xQueueReceive(worker->queue, &p, portMAX_DELAY);
+        LOCK_TCPIP_CORE();
+        for (size_t n = 1; ; n++) {
+            if (p == NULL) {
+                running = false;
+                break;
+            }
+            esp_netif_rx_worker_input(esp_netif, p);
+            if (n == ESP_NETIF_RX_BATCH_MAX || xQueueReceive(worker->queue, &p, 0) != pdTRUE) {
+                break;
+            }
+        }
+        UNLOCK_TCPIP_CORE();
+    }
+    // deleted by the stopper, which frees the task right away, unlike deleting itself
+    xTaskNotifyGive(worker->stopper);
+    vTaskSuspend(NULL);
+}
+
+static void esp_netif_rx_worker_free(struct esp_netif_rx_worker *worker)
+{
+    if (worker->task) {
+        struct pbuf *stop = NULL;
+        worker->stopper = xTaskGetCurrentTaskHandle();
+        xQueueSend(worker->queue, &stop, portMAX_DELAY);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        vTaskDelete(worker->task);
+    }
+    if (worker->queue) {
+        struct pbuf *p;
+        // the packets queued after the stop request are dropped
+        while (xQueueReceive(worker->queue, &p, 0) == pdTRUE) {
+#if CONFIG_ESP_NETIF_STATS
+            esp_netif_stats_rx_dequeued(worker->esp_netif, p, false);
+#endif
+            ESP_NETIF_STATS_RX_DROPPED(worker->esp_netif);
+            pbuf_free(p);
+        }
+        vQueueDelete(worker->queue);
+    }
+    free(worker);
+}
+
+static void esp_netif_rx_worker_stop(esp_netif_t *esp_netif)
+{
+    struct esp_netif_rx_worker *worker = atomic_exchange(&esp_netif->rx_worker, NULL);
+    if (worker == NULL) {
+        return;
+    }
+    // the inputs which saw the worker before it was unpublished only queue a packet without blocking
+    while (atomic_load(&esp_netif->rx_worker_senders) != 0) {
+        vTaskDelay(1);
+    }
+    esp_netif_rx_worker_free(worker);
+}
+
+static esp_err_t esp_netif_rx_worker_start(esp_netif_t *esp_netif)
+{
+    if (esp_netif->flags & (ESP_NETIF_FLAG_IS_PPP | ESP_NETIF_FLAG_IS_BRIDGE)) {
+        // these netifs don't use esp_netif_lwip_input()
+        return ESP_OK;
+    }
+#if CONFIG_ESP_NETIF_RX_WORKER_AFFINITY_SPREAD
+    static unsigned s_next_core;
+    BaseType_t core = s_next_core++ % portNUM_PROCESSORS;
+#elif CONFIG_ESP_NETIF_RX_WORKER_AFFINITY_CPU0
+    BaseType_t core = 0;
+#elif CONFIG_ESP_NETIF_RX_WORKER_AFFINITY_CPU1
+    BaseType_t core = 1;
+#else
+    BaseType_t core = tskNO_AFFINITY;
+#endif
+    struct esp_netif_rx_worker *worker = calloc(1, sizeof(struct esp_netif_rx_worker));
+    if (worker == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    worker->esp_netif = esp_netif;
+    worker->queue = xQueueCreate(CONFIG_ESP_NETIF_RX_WORKER_QUEUE_SIZE, sizeof(struct pbuf *));
+    if (worker->queue == NULL ||
+        xTaskCreatePinnedToCore(esp_netif_rx_worker_task, "netif_rx", CONFIG_ESP_NETIF_RX_WORKER_STACK_SIZE,
+                                worker, CONFIG_ESP_NETIF_RX_WORKER_PRIO, &worker->task, core) != pdPASS) {
+        worker->task = NULL;
+        esp_netif_rx_worker_free(worker);
+        return ESP_ERR_NO_MEM;
+    }
+    atomic_store(&esp_netif->rx_worker, worker);
+    return ESP_OK;
+}
+#endif // CONFIG_ESP_NETIF_RX_WORKERS
+
+/**
+ * @brief Input function of the lwip netifs, collects the packets of esp_netif_receive_batch()
+ * called from this task or passes the packets to the tcpip thread
+ */
+static err_t esp_netif_lwip_input(struct pbuf *p, struct netif *inp)
+{
+    esp_netif_t *esp_netif = lwip_get_esp_netif(inp);
+    struct esp_netif_rx_batch *batch = esp_netif ? esp_netif->rx_batch : NULL;
+    if (unlikely(batch != NULL) && batch->owner == xTaskGetCurrentTaskHandle() && batch->count < ESP_NETIF_RX_BATCH_MAX) {
+        batch->p[batch->count++] = p;
+        return ERR_OK;
+    }
+#if CONFIG_ESP_NETIF_RX_WORKERS
+    if (esp_netif != NULL) {
+        // seq_cst, so that esp_netif_rx_worker_stop() either waits for this input or this input sees no worker
+        atomic_fetch_add(&esp_netif->rx_worker_senders, 1);
+        struct esp_netif_rx_worker *worker = atomic_load(&esp_netif->rx_worker);
+        if (worker != NULL) {
+#if CONFIG_ESP_NETIF_STATS
+            esp_netif_stats_rx_queued(esp_netif, p);
+#endif
+            err_t err = ERR_OK;
+            if (unlikely(xQueueSend(worker->queue, &p, 0) != pdTRUE)) {
+#if CONFIG_ESP_NETIF_STATS
+                esp_netif_stats_rx_dequeued(esp_netif, p, false);
+#endif
+                err = ERR_MEM;
+            }
+            atomic_fetch_sub_explicit(&esp_netif->rx_worker_senders, 1, memory_order_release);
+            return err;
+        }
+        atomic_fetch_sub_explicit(&esp_netif->rx_worker_senders, 1, memory_order_release);
+    }
+#endif
+#if CONFIG_ESP_NETIF_STATS
+    if (esp_netif == NULL) {
+        return tcpip_input(p, inp);
+    }
+    esp_netif_stats_rx_queued(esp_netif, p);
+    err_t err = tcpip_inpkt(p, inp, esp_netif_lwip_input_dequeued);
+    if (err != ERR_OK) {
+        esp_netif_stats_rx_dequeued(esp_netif, p, false);
+    }
+    return err;
+#else
+    return tcpip_input(p, inp);
+#endif
+}
+
 static esp_err_t esp_netif_lwip_add(esp_netif_t *esp_netif)
 {
     ESP_COMPILER_DIAGNOSTIC_PUSH_IGNORE("-Wanalyzer-malloc-leak"); // False-positive detection. TODO GCC-366
@@ -924,7 +1261,7 @@ static esp_err_t esp_netif_lwip_add(esp_netif_t *esp_netif)
                             (struct ip4_addr*)&esp_netif->ip_info->netmask,
                             (struct ip4_addr*)&esp_netif->ip_info->gw,
 #endif
-                            esp_netif, esp_netif->lwip_init_fn, tcpip_input)) {
+                            esp_netif, esp_netif->lwip_init_fn, esp_netif_lwip_input)) {
             esp_netif_lwip_remove(esp_netif);
             return ESP_ERR_ESP_NETIF_IF_NOT_READY;
         }
@@ -932,6 +1269,7 @@ static esp_err_t esp_netif_lwip_add(esp_netif_t *esp_netif)
     }
 #endif // CONFIG_ESP_NETIF_BRIDGE_EN
     lwip_set_esp_netif(esp_netif->lwip_netif, esp_netif);
+    esp_netif_apply_offload(esp_netif);
     return ESP_OK;
 }
 
@@ -958,6 +1296,7 @@ static esp_err_t esp_netif_destroy_api(esp_netif_api_msg_t *msg)
     free(esp_netif->if_desc);
     esp_netif_lwip_remove(esp_netif);
     esp_netif_destroy_related(esp_netif);
+    esp_pbuf_pool_release(esp_netif->rx_pbufs_reserved);
     free(esp_netif->lwip_netif);
     free(esp_netif->hostname);
     esp_netif_update_default_netif(esp_netif, ESP_NETIF_STOPPED);
@@ -973,6 +1312,14 @@ void esp_netif_destroy(esp_netif_t *esp_netif)
     if (esp_netif == NULL) {
         return;
     }
+#if CONFIG_ESP_NETIF_RX_WORKERS
+    if (atomic_load(&esp_netif->rx_worker) != NULL && sys_thread_tcpip(LWIP_CORE_LOCK_QUERY_HOLDER)) {
+        // the input task needs the core lock to stop
+        ESP_LOGE(TAG, "Cannot destroy netif %s from the TCP/IP context, it has an input task", esp_netif->if_key);
+        return;
+    }
+    esp_netif_rx_worker_stop(esp_netif);
+#endif
     esp_netif_lwip_ipc_call(esp_netif_destroy_api, esp_netif, NULL);
 }
 
@@ -991,6 +1338,15 @@ esp_err_t esp_netif_attach(esp_netif_t *esp_netif, esp_netif_iodriver_handle dri
     return ESP_OK;
 }
 
+static esp_err_t esp_netif_set_driver_config_api(esp_netif_api_msg_t *msg)
+{
+    const esp_netif_driver_ifconfig_t *driver_config = msg->data;
+    esp_netif_reserve_rx_pbufs(msg->esp_netif, driver_config->rx_buffer_num);
+    msg->esp_netif->offload = driver_config->offload;
+    esp_netif_apply_offload(msg->esp_netif);
+    return ESP_OK;
+}
+
 esp_err_t esp_netif_set_driver_config(esp_netif_t *esp_netif,
                                       const esp_netif_driver_ifconfig_t *driver_config)
 {
@@ -1001,7 +1357,7 @@ esp_err_t esp_netif_set_driver_config(esp_netif_t *esp_netif,
     esp_netif->driver_transmit = driver_config->transmit;
     esp_netif->driver_transmit_wrap = driver_config->transmit_wrap;
     esp_netif->driver_free_rx_buffer = driver_config->driver_free_rx_buffer;
-    return ESP_OK;
+    return esp_netif_lwip_ipc_call(esp_netif_set_driver_config_api, esp_netif, (void *)driver_config);
 }
 
 #if CONFIG_LWIP_IPV4
@@ -1299,7 +1655,17 @@ esp_err_t esp_netif_transmit(esp_netif_t *esp_netif, void* data, size_t len)
         esp_event_post(IP_EVENT, IP_EVENT_TX_RX, &evt, sizeof(evt), 0);
     }
 #endif
+#if CONFIG_ESP_NETIF_STATS
+    esp_err_t ret = (esp_netif->driver_transmit)(esp_netif->driver_handle, data, len);
+    if (likely(ret == ESP_OK)) {
+        esp_netif_stats_count(&esp_netif->stats.tx_packets, &esp_netif->stats.tx_bytes, len);
+    } else {
+        esp_netif_stats_add(&esp_netif->stats.tx_dropped, 1);
+    }
+    return ret;
+#else
     return (esp_netif->driver_transmit)(esp_netif->driver_handle, data, len);
+#endif
 }
 
 esp_err_t esp_netif_transmit_wrap(esp_netif_t *esp_netif, void *data, size_t len, void *pbuf)
@@ -1314,7 +1680,17 @@ esp_err_t esp_netif_transmit_wrap(esp_netif_t *esp_netif, void *data, size_t len
         esp_event_post(IP_EVENT, IP_EVENT_TX_RX, &evt, sizeof(evt), 0);
     }
 #endif
+#if CONFIG_ESP_NETIF_STATS
+    esp_err_t ret = (esp_netif->driver_transmit_wrap)(esp_netif->driver_handle, data, len, pbuf);
+    if (likely(ret == ESP_OK)) {
+        esp_netif_stats_count(&esp_netif->stats.tx_packets, &esp_netif->stats.tx_bytes, len);
+    } else {
+        esp_netif_stats_add(&esp_netif->stats.tx_dropped, 1);
+    }
+    return ret;
+#else
     return (esp_netif->driver_transmit_wrap)(esp_netif->driver_handle, data, len, pbuf);
+#endif
 }
 
 esp_err_t esp_netif_receive(esp_netif_t *esp_netif, void *buffer, size_t len, void *eb)
@@ -1329,6 +1705,9 @@ esp_err_t esp_netif_receive(esp_netif_t *esp_netif, void *buffer, size_t len, vo
         esp_event_post(IP_EVENT, IP_EVENT_TX_RX, &evt, sizeof(evt), 0);
     }
 #endif
+#if CONFIG_ESP_NETIF_STATS
+    esp_netif_stats_count(&esp_netif->stats.rx_packets, &esp_netif->stats.rx_bytes, len);
+#endif
 #ifdef CONFIG_ESP_NETIF_RECEIVE_REPORT_ERRORS
     return esp_netif->lwip_input_fn(esp_netif->netif_handle, buffer, len, eb);
 #else
@@ -1337,6 +1716,149 @@ esp_err_t esp_netif_receive(esp_netif_t *esp_netif, void *buffer, size_t len, vo
 #endif
 }
 
+/**
+ * @brief Inputs the collected packets to the stack, the same way as tcpip_input() for each packet
+ *
+ * @note Runs in the lwip context
+ */
+static void esp_netif_input_batch_lwip(struct esp_netif_rx_batch *batch)
+{
+    struct netif *inp = batch->netif;
+    netif_input_fn input_fn = esp_netif_lwip_stack_input(inp);
+#if CONFIG_ESP_NETIF_STATS
+    esp_netif_t *esp_netif = lwip_get_esp_netif(inp);
+    if (esp_netif) {
+        esp_netif_stats_rx_dequeued(esp_netif, batch->p[0], true);
+    }
+#endif
+    for (size_t i = 0; i < batch->count; i++) {
+        if (input_fn(batch->p[i], inp) != ERR_OK) {
+            pbuf_free(batch->p[i]);
+        }
+    }
+}
+
+#if !LWIP_TCPIP_CORE_LOCKING_INPUT
+static void esp_netif_input_batch_cb(void *ctx)
+{
+    struct esp_netif_rx_batch *batch = ctx;
+    esp_netif_input_batch_lwip(batch);
+    mem_free(batch);
+}
+#endif
+
+static esp_err_t esp_netif_input_batch(esp_netif_t *esp_netif, struct esp_netif_rx_batch *batch)
+{
+    if (batch->count == 0) {
+        return ESP_OK;
+    }
+#if CONFIG_ESP_NETIF_STATS
+    // the first packet samples the latency of the whole batch
+    esp_netif_stats_rx_queued(esp_netif, batch->p[0]);
+#endif
+#if LWIP_TCPIP_CORE_LOCKING_INPUT
+    LOCK_TCPIP_CORE();
+    esp_netif_input_batch_lwip(batch);
+    UNLOCK_TCPIP_CORE();
+    return ESP_OK;
+#else
+    // the batch on the stack of the caller is gone when the tcpip thread processes it
+    size_t size = offsetof(struct esp_netif_rx_batch, p) + batch->count * sizeof(struct pbuf *);
+    struct esp_netif_rx_batch *msg = mem_malloc(size);
+    if (msg != NULL) {
+        memcpy(msg, batch, size);
+        if (tcpip_try_callback(esp_netif_input_batch_cb, msg) == ERR_OK) {
+            return ESP_OK;
+        }
+        mem_free(msg);
+    }
+#if CONFIG_ESP_NETIF_STATS
+    esp_netif_stats_rx_dequeued(esp_netif, batch->p[0], false);
+    esp_netif_stats_add(&esp_netif->stats.rx_dropped, batch->count);
+#endif
+    for (size_t i = 0; i < batch->count; i++) {
+        pbuf_free(batch->p[i]);
+    }
+    return ESP_ERR_NO_MEM;
+#endif
+}
+
+esp_err_t esp_netif_receive_batch(esp_netif_t *esp_netif, const esp_netif_rx_frame_t *frames, size_t count)
+{
+    if (esp_netif == NULL || (frames == NULL && count > 0)) {
+        return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+    }
+    esp_err_t ret = ESP_OK;
+    struct esp_netif_rx_batch batch = {
+        .owner = xTaskGetCurrentTaskHandle(),
+        .netif = esp_netif->lwip_netif,
+    };
+    while (count > 0) {
+        size_t n = count < ESP_NETIF_RX_BATCH_MAX ? count : ESP_NETIF_RX_BATCH_MAX;
+        batch.count = 0;
+        // the input functions of the netif pass their packets to the batch instead of the tcpip thread
+        esp_netif->rx_batch = &batch;
+        for (size_t i = 0; i < n; i++) {
+            esp_netif_receive(esp_netif, frames[i].buffer, frames[i].len, frames[i].eb);
+        }
+        esp_netif->rx_batch = NULL;
+        if (esp_netif_input_batch(esp_netif, &batch) != ESP_OK) {
+            ret = ESP_ERR_NO_MEM;
+        }
+        frames += n;
+        count -= n;
+    }
+    return ret;
+}
+
+esp_err_t esp_netif_get_stats(esp_netif_t *esp_netif, esp_netif_stats_t *stats)
+{
+    if (esp_netif == NULL || stats == NULL) {
+        return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+    }
+#if CONFIG_ESP_NETIF_STATS
+    const esp_netif_stats_counters_t *counters = &esp_netif->stats;
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = (esp_netif_stats_t) {
+        .rx_packets = esp_netif_stats_read(&counters->rx_packets),
+        .rx_bytes = esp_netif_stats_read(&counters->rx_bytes),
+        .rx_dropped = esp_netif_stats_read(&counters->rx_dropped),
+        .tx_packets = esp_netif_stats_read(&counters->tx_packets),
+        .tx_bytes = esp_netif_stats_read(&counters->tx_bytes),
+        .tx_dropped = esp_netif_stats_read(&counters->tx_dropped),
+        .rx_queue_latency_avg_us = atomic_load_explicit(&counters->rx_latency_avg_us, memory_order_relaxed),
+        .rx_queue_latency_max_us = atomic_load_explicit(&counters->rx_latency_max_us, memory_order_relaxed),
+    };
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_netif_reset_stats(esp_netif_t *esp_netif)
+{
+    if (esp_netif == NULL) {
+        return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+    }
+#if CONFIG_ESP_NETIF_STATS
+    esp_netif_stats_counters_t *counters = &esp_netif->stats;
+    portENTER_CRITICAL(&s_stats_lock);
+    esp_netif_stats_clear(&counters->rx_packets);
+    esp_netif_stats_clear(&counters->rx_bytes);
+    esp_netif_stats_clear(&counters->rx_dropped);
+    esp_netif_stats_clear(&counters->tx_packets);
+    esp_netif_stats_clear(&counters->tx_bytes);
+    esp_netif_stats_clear(&counters->tx_dropped);
+    portEXIT_CRITICAL(&s_stats_lock);
+    atomic_store_explicit(&counters->rx_latency_avg_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->rx_latency_max_us, 0, memory_order_relaxed);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 #if CONFIG_LWIP_IPV4
 static esp_err_t esp_netif_start_ip_lost_timer(esp_netif_t *esp_netif);
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -10,6 +10,9 @@
 #include "esp_netif_ppp.h"
 #include "lwip/netif.h"
 #include "lwip/esp_netif_net_stack.h"
+#if CONFIG_ESP_NETIF_STATS
+#include <stdatomic.h>
+#endif
 #ifdef CONFIG_LWIP_DHCPS
 #include "dhcpserver/dhcpserver.h"
 #endif
@@ -66,6 +69,40 @@ typedef struct netif_related_data {
     enum netif_types netif_type;
 } netif_related_data_t;
 
+#if CONFIG_ESP_NETIF_STATS
+/**
+ * @brief Traffic counters of the netif, see esp_netif_stats_t
+ *
+ * Updated with relaxed atomics from the driver tasks and from the lwip context
+ */
+typedef struct esp_netif_stats_counter {
+    atomic_uint_least32_t count;    // 32-bit atomics do not take a lock, unlike the 64-bit ones
+    uint64_t base;                  // count folds into it when it reaches 2^31, under the stats lock
+} esp_netif_stats_counter_t;
+
+typedef struct esp_netif_stats_counters {
+    esp_netif_stats_counter_t rx_packets;
+    esp_netif_stats_counter_t rx_bytes;
+    esp_netif_stats_counter_t rx_dropped;
+    esp_netif_stats_counter_t tx_packets;
+    esp_netif_stats_counter_t tx_bytes;
+    esp_netif_stats_counter_t tx_dropped;
+    // the input queue latency is sampled on one received packet at a time, the probe
+    _Atomic(struct pbuf *) rx_probe;
+    int64_t rx_probe_time;      // when the probe was queued, written before the probe is published
+    atomic_uint_least32_t rx_latency_avg_us;
+    atomic_uint_least32_t rx_latency_max_us;
+} esp_netif_stats_counters_t;
+
+/**
+ * @brief Counts a received frame dropped before the lwip input, called from the netif input functions
+ */
+void esp_netif_stats_rx_dropped(esp_netif_t *esp_netif);
+#define ESP_NETIF_STATS_RX_DROPPED(esp_netif) esp_netif_stats_rx_dropped(esp_netif)
+#else
+#define ESP_NETIF_STATS_RX_DROPPED(esp_netif)
+#endif // CONFIG_ESP_NETIF_STATS
+
 /**
  * @brief Main esp-netif container with interface related information
  */
@@ -89,6 +126,16 @@ struct esp_netif_obj {
     esp_err_t (*driver_transmit)(void *h, void *buffer, size_t len);
     esp_err_t (*driver_transmit_wrap)(void *h, void *buffer, size_t len, void *pbuf);
     void (*driver_free_rx_buffer)(void *h, void* buffer);
+    size_t rx_pbufs_reserved;   // custom pbufs of the pool reserved for the driver's rx buffers
+    uint32_t offload;           // esp_netif_offload_t flags of the checksums computed by the driver
+    struct esp_netif_rx_batch *rx_batch;    // frames collected by esp_netif_receive_batch()
+#if CONFIG_ESP_NETIF_RX_WORKERS
+    _Atomic(struct esp_netif_rx_worker *) rx_worker;   // input queue and task of the netif
+    atomic_uint rx_worker_senders;  // inputs using the worker, which is freed once they are done
+#endif
+#if CONFIG_ESP_NETIF_STATS
+    esp_netif_stats_counters_t stats;
+#endif
 
     // dhcp related
     esp_netif_dhcp_status_t dhcpc_status;
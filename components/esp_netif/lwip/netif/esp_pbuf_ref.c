@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -9,10 +9,17 @@
  * and the L2 free function esp_netif_free_rx_buffer()
  */
 
+#include <stdatomic.h>
 #include "lwip/mem.h"
 #include "lwip/esp_pbuf_ref.h"
 #include "esp_netif_net_stack.h"
 
+/* Index of the custom pbufs allocated from the heap, also terminates the free list of the pool */
+#define ESP_PBUF_NOT_POOLED         UINT16_MAX
+#define ESP_PBUF_POOL_SEGMENTS      8
+#define ESP_PBUF_POOL_SEGMENT_BITS  12
+#define ESP_PBUF_POOL_SEGMENT_MAX   (1 << ESP_PBUF_POOL_SEGMENT_BITS)
+
 /**
  * @brief Specific pbuf structure for pbufs allocated by ESP netif
  * of PBUF_REF type
@@ -22,8 +29,116 @@ typedef struct esp_custom_pbuf
     struct pbuf_custom p;
     esp_netif_t *esp_netif;
     void* l2_buf;
+    uint16_t index;                 // position in the pool, ESP_PBUF_NOT_POOLED if allocated from heap
+    _Atomic uint16_t next_free;     // next object of the free list while in the pool
 } esp_custom_pbuf_t;
 
+#if CONFIG_ESP_NETIF_RX_PBUF_POOL
+/**
+ * The pool is made of segments, added when the reservations of the drivers exceed its capacity and
+ * never freed, so a stale pointer to a pooled object stays valid.
+ * The free objects form a stack whose head packs the index of the top object (segment and position)
+ * in the low half and a tag in the high half. The tag changes with every push and pop, so a pop
+ * racing with another pop and push of the same object fails the compare-and-swap (no ABA problem),
+ * and the pool needs no lock on the 32-bit atomics of all targets.
+ */
+static _Atomic uint32_t s_free_head = ESP_PBUF_NOT_POOLED;
+static esp_custom_pbuf_t *s_segments[ESP_PBUF_POOL_SEGMENTS];
+static size_t s_segment_count;
+static size_t s_capacity;
+static size_t s_reserved;
+
+static inline esp_custom_pbuf_t *esp_pbuf_pool_object(uint16_t index)
+{
+    return &s_segments[index >> ESP_PBUF_POOL_SEGMENT_BITS][index & (ESP_PBUF_POOL_SEGMENT_MAX - 1)];
+}
+
+static inline uint32_t esp_pbuf_pool_head(uint32_t old_head, uint16_t index)
+{
+    return ((old_head + (1 << 16)) & 0xffff0000) | index;
+}
+
+static esp_custom_pbuf_t *esp_pbuf_pool_get(void)
+{
+    uint32_t head = atomic_load_explicit(&s_free_head, memory_order_acquire);
+    esp_custom_pbuf_t *esp_pbuf;
+    uint32_t new_head;
+    do {
+        uint16_t index = head & 0xffff;
+        if (index == ESP_PBUF_NOT_POOLED) {
+            return NULL;
+        }
+        esp_pbuf = esp_pbuf_pool_object(index);
+        new_head = esp_pbuf_pool_head(head, atomic_load_explicit(&esp_pbuf->next_free, memory_order_relaxed));
+    } while (!atomic_compare_exchange_weak_explicit(&s_free_head, &head, new_head,
+                                                    memory_order_acquire, memory_order_acquire));
+    return esp_pbuf;
+}
+
+static void esp_pbuf_pool_put(esp_custom_pbuf_t *esp_pbuf)
+{
+    uint32_t head = atomic_load_explicit(&s_free_head, memory_order_relaxed);
+    uint32_t new_head;
+    do {
+        atomic_store_explicit(&esp_pbuf->next_free, head & 0xffff, memory_order_relaxed);
+        new_head = esp_pbuf_pool_head(head, esp_pbuf->index);
+    } while (!atomic_compare_exchange_weak_explicit(&s_free_head, &head, new_head,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+esp_err_t esp_pbuf_pool_reserve(size_t count)
+{
+    LWIP_ASSERT_CORE_LOCKED();
+    s_reserved += count;
+    if (s_reserved <= s_capacity) {
+        return ESP_OK;
+    }
+    size_t missing = s_reserved - s_capacity;
+    if (s_segment_count == ESP_PBUF_POOL_SEGMENTS || missing > ESP_PBUF_POOL_SEGMENT_MAX) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_custom_pbuf_t *segment = mem_calloc(missing, sizeof(esp_custom_pbuf_t));
+    if (segment == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    uint16_t first = s_segment_count << ESP_PBUF_POOL_SEGMENT_BITS;
+    s_segments[s_segment_count++] = segment;
+    s_capacity += missing;
+    for (size_t i = 0; i < missing; i++) {
+        segment[i].index = first + i;
+        esp_pbuf_pool_put(&segment[i]);
+    }
+    return ESP_OK;
+}
+
+void esp_pbuf_pool_release(size_t count)
+{
+    LWIP_ASSERT_CORE_LOCKED();
+    // the objects stay in the pool for the next reservations
+    s_reserved -= count;
+}
+
+#else
+
+static inline esp_custom_pbuf_t *esp_pbuf_pool_get(void)
+{
+    return NULL;
+}
+
+static inline void esp_pbuf_pool_put(esp_custom_pbuf_t *esp_pbuf)
+{
+}
+
+esp_err_t esp_pbuf_pool_reserve(size_t count)
+{
+    return ESP_OK;
+}
+
+void esp_pbuf_pool_release(size_t count)
+{
+}
+#endif // CONFIG_ESP_NETIF_RX_PBUF_POOL
+
 /**
  * @brief Free custom pbuf containing the L2 layer buffer allocated in the driver
  *
@@ -34,7 +149,11 @@ static void esp_pbuf_free(struct pbuf *pbuf)
 {
     esp_custom_pbuf_t* esp_pbuf = (esp_custom_pbuf_t*)pbuf;
     esp_netif_free_rx_buffer(esp_pbuf->esp_netif, esp_pbuf->l2_buf);
-    mem_free(pbuf);
+    if (esp_pbuf->index != ESP_PBUF_NOT_POOLED) {
+        esp_pbuf_pool_put(esp_pbuf);
+    } else {
+        mem_free(pbuf);
+    }
 }
 
 /**
@@ -49,16 +168,25 @@ struct pbuf* esp_pbuf_allocate(esp_netif_t *esp_netif, void *buffer, size_t len,
 {
     struct pbuf *p;
 
-    esp_custom_pbuf_t* esp_pbuf  = mem_malloc(sizeof(esp_custom_pbuf_t));
+    esp_custom_pbuf_t* esp_pbuf = esp_pbuf_pool_get();
     if (esp_pbuf == NULL) {
-        return NULL;
+        // more frames in flight than reserved, or no pool
+        esp_pbuf = mem_malloc(sizeof(esp_custom_pbuf_t));
+        if (esp_pbuf == NULL) {
+            return NULL;
+        }
+        esp_pbuf->index = ESP_PBUF_NOT_POOLED;
     }
     esp_pbuf->p.custom_free_function = esp_pbuf_free;
     esp_pbuf->esp_netif = esp_netif;
     esp_pbuf->l2_buf = l2_buff;
     p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &esp_pbuf->p, buffer, len);
     if (p == NULL) {
-        mem_free(esp_pbuf);
+        if (esp_pbuf->index != ESP_PBUF_NOT_POOLED) {
+            esp_pbuf_pool_put(esp_pbuf);
+        } else {
+            mem_free(esp_pbuf);
+        }
         return NULL;
     }
     return p;
@@ -23,6 +23,7 @@
 #include "esp_netif_net_stack.h"
 #include "lwip/esp_netif_net_stack.h"
 #include "lwip/esp_pbuf_ref.h"
+#include "esp_netif_lwip_internal.h"
 
 /* Define those to better describe your network interface. */
 #define IFNAME0 'e'
@@ -126,6 +127,7 @@ esp_netif_recv_ret_t ethernetif_input(void *h, void *buffer, size_t len, void *l
         if (buffer) {
             esp_netif_free_rx_buffer(esp_netif, buffer);
         }
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
         return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_FAIL);
     }
 
@@ -133,12 +135,14 @@ esp_netif_recv_ret_t ethernetif_input(void *h, void *buffer, size_t len, void *l
     p = esp_pbuf_allocate(esp_netif, buffer, len, buffer);
     if (p == NULL) {
         esp_netif_free_rx_buffer(esp_netif, buffer);
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
         return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_ERR_NO_MEM);
     }
     /* full packet send to tcpip_thread to process */
     if (unlikely(netif->input(p, netif) != ERR_OK)) {
         LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
         pbuf_free(p);
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
         return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_FAIL);
     }
     /* the pbuf will be free in upper layer, eg: ethernet_input */
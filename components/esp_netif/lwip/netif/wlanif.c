@@ -25,6 +25,7 @@
 #include "esp_compiler.h"
 #include "lwip/esp_pbuf_ref.h"
 #include "esp_netif_types.h"
+#include "esp_netif_lwip_internal.h"
 
 /**
  * In this function, the hardware should be initialized.
@@ -153,6 +154,7 @@ esp_netif_recv_ret_t wlanif_input(void *h, void *buffer, size_t len, void* l2_bu
         if (l2_buff) {
             esp_netif_free_rx_buffer(esp_netif, l2_buff);
         }
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
         return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_FAIL);
     }
 
@@ -160,6 +162,7 @@ esp_netif_recv_ret_t wlanif_input(void *h, void *buffer, size_t len, void* l2_bu
     p = pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
     if (p == NULL) {
         esp_netif_free_rx_buffer(esp_netif, l2_buff);
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
         return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_ERR_NO_MEM);
     }
     memcpy(p->payload, buffer, len);
@@ -168,6 +171,7 @@ esp_netif_recv_ret_t wlanif_input(void *h, void *buffer, size_t len, void* l2_bu
     p = esp_pbuf_allocate(esp_netif, buffer, len, l2_buff);
     if (p == NULL) {
         esp_netif_free_rx_buffer(esp_netif, l2_buff);
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
         return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_ERR_NO_MEM);
     }
 
@@ -177,6 +181,7 @@ esp_netif_recv_ret_t wlanif_input(void *h, void *buffer, size_t len, void* l2_bu
     if (unlikely(netif->input(p, netif) != ERR_OK)) {
         LWIP_DEBUGF(NETIF_DEBUG, ("wlanif_input: IP input error\n"));
         pbuf_free(p);
+        ESP_NETIF_STATS_RX_DROPPED(esp_netif);
         return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_FAIL);
     }
     return ESP_NETIF_OPTIONAL_RETURN_CODE(ESP_OK);
@@ -83,8 +83,9 @@ bool esp_netif_is_valid_static_ip(esp_netif_ip_info_t *ip_info);
 
 /**
  * @brief Adds created interface to the list of netifs.
- * This function doesn't lock the list, so you need to call esp_netif_list_lock/unlock
- * manually before and after the call.
+ * The additions and removals must be serialized by the caller (the lwip implementation runs them
+ * in the lwip context). The readers of the list don't lock, this function waits until none of them
+ * uses the previous version of the list, so it must not be called while searching the list.
  *
  * @param[in]  esp_netif Handle to esp-netif instance
  *
@@ -96,8 +97,9 @@ esp_err_t esp_netif_add_to_list_unsafe(esp_netif_t* netif);
 
 /**
  * @brief Removes interface to be destroyed from the list of netifs
- * This function doesn't lock the list, so you need to call esp_netif_list_lock/unlock
- * manually before and after the call.
+ * The additions and removals must be serialized by the caller (the lwip implementation runs them
+ * in the lwip context). The readers of the list don't lock, this function waits until none of them
+ * uses the previous version of the list, so it must not be called while searching the list.
  *
  * @param[in]  esp_netif Handle to esp-netif instance
  *
@@ -118,7 +120,7 @@ bool esp_netif_is_netif_listed(esp_netif_t *esp_netif);
 
 /**
  * @brief Get esp_netif handle based on the if_key
- * This doesn't lock the list nor TCPIP context
+ * This doesn't lock the list nor TCPIP context (the same as esp_netif_get_handle_from_ifkey())
  *
  * @param if_key
  * @return esp_netif handle if found, NULL otherwise
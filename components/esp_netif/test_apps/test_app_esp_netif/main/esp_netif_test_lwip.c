@@ -1,9 +1,10 @@
 /*
- * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Unlicense OR CC0-1.0
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "unity.h"
 #include "unity_fixture.h"
@@ -17,6 +18,8 @@
 #include "test_utils.h"
 #include "memory_checks.h"
 #include "lwip/netif.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_netif_test.h"
 
 TEST_GROUP(esp_netif);
@@ -147,6 +150,61 @@ TEST(esp_netif, find_netifs)
     }
 }
 
+static volatile bool s_lookup_running;
+
+/* Calls into the TCP/IP task, as the predicate of the tcp_client example does */
+static bool impl_name_and_desc_match(esp_netif_t *netif, void *ctx)
+{
+    char name[NETIF_NAMESIZE];
+    return esp_netif_get_netif_impl_name(netif, name) == ESP_OK && strcmp(ctx, esp_netif_get_desc(netif)) == 0;
+}
+
+static void lookup_task(void *arg)
+{
+    int *lookups = arg;
+    while (s_lookup_running) {
+        esp_netif_t *netif = (*lookups & 1) ? esp_netif_find_if(impl_name_and_desc_match, "if_static")
+                                            : esp_netif_get_handle_from_ifkey("if_static");
+        if (netif == NULL || strcmp(esp_netif_get_desc(netif), "if_static") != 0) {
+            *lookups = -1;
+            break;
+        }
+        ++*lookups;
+    }
+    s_lookup_running = false;
+    vTaskDelete(NULL);
+}
+
+/*
+ * This test looks up a netif from another task, while other netifs are created and destroyed,
+ * checks that the lookups don't block and always find the netif. Every other lookup runs a predicate
+ * which calls into the TCP/IP task, where the netifs are added to and removed from the list.
+ */
+TEST(esp_netif, find_netifs_concurrently)
+{
+    esp_netif_inherent_config_t base_netif_config = { .if_key = "if_static", .if_desc = "if_static" };
+    esp_netif_config_t cfg = { .base = &base_netif_config, .stack = ESP_NETIF_NETSTACK_DEFAULT_WIFI_STA };
+    esp_netif_t *static_netif = esp_netif_new(&cfg);
+    TEST_ASSERT_NOT_NULL(static_netif);
+
+    int lookups = 0;
+    s_lookup_running = true;
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(lookup_task, "lookup", 4096, &lookups, uxTaskPriorityGet(NULL), NULL));
+    for (int i = 0; i < 20 && s_lookup_running; ++i) {
+        base_netif_config = (esp_netif_inherent_config_t) { .if_key = "if_temp", .if_desc = "if_temp" };
+        esp_netif_t *netif = esp_netif_new(&cfg);
+        TEST_ASSERT_NOT_NULL(netif);
+        vTaskDelay(1);
+        esp_netif_destroy(netif);
+    }
+    bool failed = !s_lookup_running;
+    s_lookup_running = false;
+    vTaskDelay(pdMS_TO_TICKS(20));     // let the task finish
+    TEST_ASSERT_FALSE(failed);
+    TEST_ASSERT_GREATER_THAN(0, lookups);
+    esp_netif_destroy(static_netif);
+}
+
 #ifdef CONFIG_ESP_WIFI_ENABLED
 /*
  * This test creates a default WiFi station and checks all possible transitions
@@ -580,6 +638,121 @@ TEST(esp_netif, set_get_dnsserver)
     }
 }
 
+static int s_rx_buffers_freed;
+
+static void count_free_rx_buffer(void *h, void* buffer)
+{
+    free(buffer);
+    s_rx_buffers_freed++;
+}
+
+/*
+ * This test passes a batch of frames, longer than the batches delivered to lwIP at once and than the rx buffers
+ * of the driver, so the custom pbufs come both from the pool and from the heap.
+ * The frames carry an unknown ethertype and lwIP drops them, which returns each rx buffer to the driver.
+ */
+TEST(esp_netif, receive_batch)
+{
+    test_case_uses_tcpip();
+    // the pool of custom pbufs is kept for the next interfaces
+    TEST_ESP_OK(test_utils_set_leak_level(1024, ESP_LEAK_TYPE_CRITICAL, ESP_COMP_LEAK_GENERAL));
+    esp_netif_driver_ifconfig_t driver_config = { .handle =  (void*)1, .transmit = dummy_transmit,
+                                                  .driver_free_rx_buffer = count_free_rx_buffer, .rx_buffer_num = 4 };
+    esp_netif_inherent_config_t base_netif_config = ESP_NETIF_INHERENT_DEFAULT_ETH();
+    esp_netif_config_t cfg = { .base = &base_netif_config, .stack = ESP_NETIF_NETSTACK_DEFAULT_ETH,
+                               .driver = &driver_config };
+    esp_netif_t *esp_netif = esp_netif_new(&cfg);
+    TEST_ASSERT_NOT_NULL(esp_netif);
+    esp_netif_action_start(esp_netif, 0, 0, 0);
+
+    const int nr_of_frames = 40;
+    const size_t frame_len = 60;
+    esp_netif_rx_frame_t frames[nr_of_frames];
+    for (int i = 0; i < nr_of_frames; ++i) {
+        uint8_t *frame = calloc(1, frame_len);
+        TEST_ASSERT_NOT_NULL(frame);
+        memset(frame, 0xff, 6);     // broadcast destination
+        frame[12] = 0x88;           // local experimental ethertype
+        frame[13] = 0xb5;
+        frames[i] = (esp_netif_rx_frame_t) { .buffer = frame, .len = frame_len, .eb = frame };
+    }
+    s_rx_buffers_freed = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_ESP_NETIF_INVALID_PARAMS, esp_netif_receive_batch(esp_netif, NULL, 1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_netif_receive_batch(esp_netif, frames, nr_of_frames));
+    // without core locking of the input, the batches are processed later by the TCP/IP task
+    for (int i = 0; i < 100 && s_rx_buffers_freed < nr_of_frames; ++i) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    TEST_ASSERT_EQUAL(nr_of_frames, s_rx_buffers_freed);
+
+    esp_netif_action_stop(esp_netif, 0, 0, 0);
+    esp_netif_destroy(esp_netif);
+}
+
+#if CONFIG_ESP_NETIF_STATS
+/*
+ * This test checks the traffic counters: frames received while the interface is down are dropped,
+ * the others are counted as received and dropped by lwIP later (unknown ethertype), frames transmitted
+ * by the stack are counted as transmitted.
+ */
+TEST(esp_netif, traffic_stats)
+{
+    test_case_uses_tcpip();
+    TEST_ESP_OK(test_utils_set_leak_level(1024, ESP_LEAK_TYPE_CRITICAL, ESP_COMP_LEAK_GENERAL));
+    esp_netif_driver_ifconfig_t driver_config = { .handle =  (void*)1, .transmit = dummy_transmit,
+                                                  .driver_free_rx_buffer = count_free_rx_buffer };
+    esp_netif_inherent_config_t base_netif_config = ESP_NETIF_INHERENT_DEFAULT_ETH();
+    esp_netif_config_t cfg = { .base = &base_netif_config, .stack = ESP_NETIF_NETSTACK_DEFAULT_ETH,
+                               .driver = &driver_config };
+    esp_netif_t *esp_netif = esp_netif_new(&cfg);
+    TEST_ASSERT_NOT_NULL(esp_netif);
+
+    esp_netif_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_ERR_ESP_NETIF_INVALID_PARAMS, esp_netif_get_stats(esp_netif, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_ESP_NETIF_INVALID_PARAMS, esp_netif_reset_stats(NULL));
+    TEST_ESP_OK(esp_netif_get_stats(esp_netif, &stats));
+    TEST_ASSERT_EQUAL(0, stats.rx_packets + stats.tx_packets + stats.rx_dropped + stats.tx_dropped);
+
+    const int nr_of_frames = 5;
+    const size_t frame_len = 60;
+    s_rx_buffers_freed = 0;
+    for (int i = 0; i < nr_of_frames + 1; ++i) {
+        uint8_t *frame = calloc(1, frame_len);
+        TEST_ASSERT_NOT_NULL(frame);
+        memset(frame, 0xff, 6);     // broadcast destination
+        frame[12] = 0x88;           // local experimental ethertype
+        frame[13] = 0xb5;
+        esp_netif_receive(esp_netif, frame, frame_len, frame);
+        if (i == 0) {
+            // the first frame was dropped, as the interface is down
+            esp_netif_action_start(esp_netif, 0, 0, 0);
+        }
+    }
+    for (int i = 0; i < 100 && s_rx_buffers_freed < nr_of_frames + 1; ++i) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    TEST_ASSERT_EQUAL(nr_of_frames + 1, s_rx_buffers_freed);
+
+    uint8_t frame[frame_len];
+    TEST_ESP_OK(esp_netif_transmit(esp_netif, frame, frame_len));
+    TEST_ESP_OK(esp_netif_get_stats(esp_netif, &stats));
+    TEST_ASSERT_EQUAL(nr_of_frames + 1, stats.rx_packets);
+    TEST_ASSERT_EQUAL((nr_of_frames + 1) * frame_len, stats.rx_bytes);
+    TEST_ASSERT_EQUAL(1, stats.rx_dropped);
+    TEST_ASSERT_EQUAL(1, stats.tx_packets);
+    TEST_ASSERT_EQUAL(frame_len, stats.tx_bytes);
+    TEST_ASSERT_EQUAL(0, stats.tx_dropped);
+    TEST_ASSERT_GREATER_OR_EQUAL(stats.rx_queue_latency_avg_us, stats.rx_queue_latency_max_us);
+
+    TEST_ESP_OK(esp_netif_reset_stats(esp_netif));
+    TEST_ESP_OK(esp_netif_get_stats(esp_netif, &stats));
+    TEST_ASSERT_EQUAL(0, stats.rx_packets + stats.rx_bytes + stats.tx_packets + stats.tx_bytes + stats.rx_dropped);
+
+    esp_netif_action_stop(esp_netif, 0, 0, 0);
+    esp_netif_destroy(esp_netif);
+}
+#endif // CONFIG_ESP_NETIF_STATS
+
 TEST_GROUP_RUNNER(esp_netif)
 {
     /**
@@ -592,6 +765,7 @@ TEST_GROUP_RUNNER(esp_netif)
     RUN_TEST_CASE(esp_netif, get_from_if_key)
     RUN_TEST_CASE(esp_netif, create_delete_multiple_netifs)
     RUN_TEST_CASE(esp_netif, find_netifs)
+    RUN_TEST_CASE(esp_netif, find_netifs_concurrently)
 #ifdef CONFIG_ESP_WIFI_ENABLED
     RUN_TEST_CASE(esp_netif, wifi_netif_api_null_deref)
     RUN_TEST_CASE(esp_netif, create_custom_wifi_interfaces)
@@ -610,6 +784,10 @@ TEST_GROUP_RUNNER(esp_netif)
 #endif
     RUN_TEST_CASE(esp_netif, route_priority)
     RUN_TEST_CASE(esp_netif, set_get_dnsserver)
+    RUN_TEST_CASE(esp_netif, receive_batch)
+#if CONFIG_ESP_NETIF_STATS
+    RUN_TEST_CASE(esp_netif, traffic_stats)
+#endif
 }
 
 void app_main(void)
@@ -11,6 +11,7 @@ from pytest_embedded import Dut
     'global_dns',
     'dns_per_netif',
     'loopback',             # test config without LWIP
+    'rx_workers',           # input tasks of the interfaces
 ], indirect=True)
 def test_esp_netif(dut: Dut) -> None:
     dut.expect_unity_test_output()
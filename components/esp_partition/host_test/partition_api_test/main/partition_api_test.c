@@ -8,6 +8,7 @@
 
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include "esp_err.h"
 #include "esp_partition.h"
@@ -30,12 +31,19 @@ static void partition_test_get_unique_filename(char *filename, size_t len)
 
 TEST_GROUP(partition_api);
 
+static int64_t s_setup_time_at_start;
+
 TEST_SETUP(partition_api)
 {
+    s_setup_time_at_start = esp_partition_file_get_setup_time();
 }
 
 TEST_TEAR_DOWN(partition_api)
 {
+    int64_t setup_time = esp_partition_file_get_setup_time() - s_setup_time_at_start;
+    if (setup_time > 0) {
+        ESP_LOGI(TAG, "flash emulation set up in %lld us", (long long) setup_time);
+    }
 }
 
 TEST(partition_api, test_partition_find_basic)
@@ -764,6 +772,306 @@ TEST(partition_api, test_partition_register_external)
     TEST_ESP_OK(esp_partition_deregister_external(ota1_part));
 }
 
+/* Size of the file system blocks allocated for the emulated flash file */
+static size_t partition_test_allocated_size(void)
+{
+    struct stat st;
+    TEST_ASSERT_EQUAL(0, stat(esp_partition_get_file_mmap_ctrl_act()->flash_file_name, &st));
+    return (size_t) st.st_blocks * 512;
+}
+
+static void partition_test_check_erased(const esp_partition_t *part, size_t offset, size_t size)
+{
+    uint8_t buf[256];
+    for (size_t pos = 0; pos < size; pos += sizeof(buf)) {
+        TEST_ESP_OK(esp_partition_read(part, offset + pos, buf, sizeof(buf)));
+        for (size_t i = 0; i < sizeof(buf); i++) {
+            TEST_ASSERT_EQUAL_HEX8(0xFF, buf[i]);
+        }
+    }
+}
+
+TEST(partition_api, test_partition_sparse_flash_file)
+{
+    // Scenario: 16MB temporary flash file. Only the written sectors should be allocated on the disk,
+    // erased sectors read back as 0xFF and are released again by erase.
+    esp_partition_file_munmap();
+
+    esp_partition_file_mmap_ctrl_t *p_file_mmap_ctrl_input = esp_partition_get_file_mmap_ctrl_input();
+    memset(p_file_mmap_ctrl_input, 0, sizeof(*p_file_mmap_ctrl_input));
+    p_file_mmap_ctrl_input->flash_file_size = 0x1000000;   // 16MB
+    strlcpy(p_file_mmap_ctrl_input->partition_file_name, BUILD_DIR "/partition_table/partition-table_8M.bin", sizeof(p_file_mmap_ctrl_input->partition_file_name));
+
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+
+    const size_t flash_size = esp_partition_get_file_mmap_ctrl_act()->flash_file_size;
+    const size_t allocated_at_setup = partition_test_allocated_size();
+    ESP_LOGI(TAG, "16MB flash set up in %lld us, %u B allocated", (long long) esp_partition_get_file_mmap_ctrl_act()->setup_time_us, (unsigned) allocated_at_setup);
+    TEST_ASSERT_LESS_THAN(flash_size / 16, allocated_at_setup);
+
+    partition_test_check_erased(partition_data, 0, 2 * ESP_PARTITION_EMULATED_SECTOR_SIZE);
+    partition_test_check_erased(partition_data, partition_data->size - ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_EMULATED_SECTOR_SIZE);
+
+    // partial write keeps the rest of the sector erased
+    const uint8_t data[] = {0x12, 0x34, 0x56, 0x78};
+    TEST_ESP_OK(esp_partition_write(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE + 16, data, sizeof(data)));
+    uint8_t verify[sizeof(data) + 2];
+    TEST_ESP_OK(esp_partition_read(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE + 15, verify, sizeof(verify)));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, verify[0]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, verify + 1, sizeof(data));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, verify[sizeof(verify) - 1]);
+    partition_test_check_erased(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE);
+
+    // erase returns the sector to the erased state
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    partition_test_check_erased(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_EMULATED_SECTOR_SIZE);
+
+    // directly mapped memory has to hold the erased contents
+    const uint8_t *mapped = NULL;
+    esp_partition_mmap_handle_t handle;
+    TEST_ESP_OK(esp_partition_mmap(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_MMAP_DATA, (const void **) &mapped, &handle));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, mapped[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, mapped[ESP_PARTITION_EMULATED_SECTOR_SIZE - 1]);
+    TEST_ESP_OK(esp_partition_write(partition_data, 0, data, sizeof(data)));
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, mapped[0]);
+    esp_partition_munmap(handle);
+
+    // overwriting an erased sector bypasses the NOR flash rules and keeps the rest of the sector erased
+    const size_t overwrite_offset = 2 * ESP_PARTITION_EMULATED_SECTOR_SIZE + 16;
+    TEST_ESP_OK(esp_partition_file_overwrite(partition_data->address + overwrite_offset, data, sizeof(data)));
+    TEST_ESP_OK(esp_partition_read(partition_data, overwrite_offset - 1, verify, sizeof(verify)));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, verify[0]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, verify + 1, sizeof(data));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, verify[sizeof(verify) - 1]);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_partition_file_overwrite(flash_size - 1, data, sizeof(data)));
+
+    // the kept temporary dump stays sparse, its holes read as erased when it is opened by name
+    char flash_file_name[PATH_MAX];
+    strlcpy(flash_file_name, esp_partition_get_file_mmap_ctrl_act()->flash_file_name, sizeof(flash_file_name));
+    TEST_ESP_OK(esp_partition_file_munmap());
+    memset(p_file_mmap_ctrl_input, 0, sizeof(*p_file_mmap_ctrl_input));
+    strlcpy(p_file_mmap_ctrl_input->flash_file_name, flash_file_name, sizeof(p_file_mmap_ctrl_input->flash_file_name));
+
+    partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+    TEST_ASSERT_LESS_THAN(flash_size / 16, partition_test_allocated_size());
+    TEST_ESP_OK(esp_partition_read(partition_data, overwrite_offset, verify, sizeof(data)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, verify, sizeof(data));
+    partition_test_check_erased(partition_data, 0, 2 * ESP_PARTITION_EMULATED_SECTOR_SIZE);
+    partition_test_check_erased(partition_data, partition_data->size - ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_EMULATED_SECTOR_SIZE);
+
+    // a flash file opened by name is kept as a complete flash image, erased sectors included
+    TEST_ESP_OK(esp_partition_file_munmap());
+    struct stat st;
+    TEST_ASSERT_EQUAL(0, stat(flash_file_name, &st));
+    TEST_ASSERT_GREATER_OR_EQUAL(flash_size, (size_t) st.st_blocks * 512);
+    memset(p_file_mmap_ctrl_input, 0, sizeof(*p_file_mmap_ctrl_input));
+    strlcpy(p_file_mmap_ctrl_input->flash_file_name, flash_file_name, sizeof(p_file_mmap_ctrl_input->flash_file_name));
+
+    partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+    TEST_ESP_OK(esp_partition_read(partition_data, overwrite_offset, verify, sizeof(data)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, verify, sizeof(data));
+    partition_test_check_erased(partition_data, partition_data->size - ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_EMULATED_SECTOR_SIZE);
+
+    p_file_mmap_ctrl_input->remove_dump = true;
+    TEST_ESP_OK(esp_partition_file_munmap());
+    memset(p_file_mmap_ctrl_input, 0, sizeof(*p_file_mmap_ctrl_input));
+}
+
+TEST(partition_api, test_partition_snapshot_restore)
+{
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+
+    const char *original = "state captured by the snapshot";
+    const char *modified = "state written after the snapshot";
+    const size_t len = strlen(modified) + 1;
+    char buf[64];
+
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, 2 * ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ESP_OK(esp_partition_write(partition_data, 0, original, strlen(original) + 1));
+
+    const char *mapped = NULL;
+    esp_partition_mmap_handle_t handle;
+    TEST_ESP_OK(esp_partition_mmap(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_MMAP_DATA, (const void **) &mapped, &handle));
+
+    esp_partition_file_snapshot_handle_t snapshot;
+    TEST_ESP_OK(esp_partition_file_snapshot_create(&snapshot));
+
+    for (int round = 0; round < 2; round++) {
+        TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+        TEST_ESP_OK(esp_partition_write(partition_data, 0, modified, len));
+        TEST_ESP_OK(esp_partition_write(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE, modified, len));
+        TEST_ASSERT_EQUAL_STRING(modified, mapped);
+
+        struct timeval start, end;
+        gettimeofday(&start, NULL);
+        TEST_ESP_OK(esp_partition_file_snapshot_restore(snapshot));
+        gettimeofday(&end, NULL);
+        ESP_LOGI(TAG, "snapshot restored in %ld us", (long) ((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec)));
+
+        TEST_ESP_OK(esp_partition_read(partition_data, 0, buf, sizeof(buf)));
+        TEST_ASSERT_EQUAL_STRING(original, buf);
+        // pointers obtained before the restore see the restored contents
+        TEST_ASSERT_EQUAL_STRING(original, mapped);
+        partition_test_check_erased(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_EMULATED_SECTOR_SIZE);
+    }
+
+    esp_partition_munmap(handle);
+    esp_partition_file_snapshot_delete(snapshot);
+
+    // the restored contents stay valid after the snapshot is deleted
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING(original, buf);
+
+    // wrong size
+    esp_partition_file_mmap_ctrl_t *p_file_mmap_ctrl_input = esp_partition_get_file_mmap_ctrl_input();
+    TEST_ESP_OK(esp_partition_file_snapshot_create(&snapshot));
+    esp_partition_file_munmap();
+    memset(p_file_mmap_ctrl_input, 0, sizeof(*p_file_mmap_ctrl_input));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_partition_file_snapshot_restore(snapshot));
+    p_file_mmap_ctrl_input->flash_file_size = 0x800000;
+    strlcpy(p_file_mmap_ctrl_input->partition_file_name, BUILD_DIR "/partition_table/partition-table_8M.bin", sizeof(p_file_mmap_ctrl_input->partition_file_name));
+    TEST_ASSERT_NOT_NULL(esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage"));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_partition_file_snapshot_restore(snapshot));
+    esp_partition_file_snapshot_delete(snapshot);
+
+    p_file_mmap_ctrl_input->remove_dump = true;
+    esp_partition_file_munmap();
+    memset(p_file_mmap_ctrl_input, 0, sizeof(*p_file_mmap_ctrl_input));
+}
+
+TEST(partition_api, test_partition_readv_writev)
+{
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, 2 * ESP_PARTITION_EMULATED_SECTOR_SIZE));
+
+    // segments in arbitrary order, one of them crossing the sector boundary
+    const uint8_t seg_a[16] = "0123456789abcde";
+    const uint8_t seg_b[8] = "ABCDEFG";
+    const uint8_t seg_c[32] = "sector boundary crossing data..";
+    const esp_partition_write_vec_t wvec[] = {
+        { .offset = 512, .src = seg_a, .size = sizeof(seg_a) },
+        { .offset = 64, .src = seg_b, .size = sizeof(seg_b) },
+        { .offset = ESP_PARTITION_EMULATED_SECTOR_SIZE - 16, .src = seg_c, .size = sizeof(seg_c) },
+    };
+    const size_t wcount = sizeof(wvec) / sizeof(wvec[0]);
+
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_writev(partition_data, wvec, wcount));
+    TEST_ASSERT_EQUAL(1, esp_partition_get_write_ops());
+    TEST_ASSERT_EQUAL(sizeof(seg_a) + sizeof(seg_b) + sizeof(seg_c), esp_partition_get_write_bytes());
+
+    uint8_t out_a[sizeof(seg_a)], out_b[sizeof(seg_b)], out_c[sizeof(seg_c)];
+    const esp_partition_read_vec_t rvec[] = {
+        { .offset = 64, .dst = out_b, .size = sizeof(out_b) },
+        { .offset = ESP_PARTITION_EMULATED_SECTOR_SIZE - 16, .dst = out_c, .size = sizeof(out_c) },
+        { .offset = 512, .dst = out_a, .size = sizeof(out_a) },
+    };
+    const size_t rcount = sizeof(rvec) / sizeof(rvec[0]);
+    TEST_ESP_OK(esp_partition_readv(partition_data, rvec, rcount));
+    TEST_ASSERT_EQUAL(1, esp_partition_get_read_ops());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(seg_a, out_a, sizeof(seg_a));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(seg_b, out_b, sizeof(seg_b));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(seg_c, out_c, sizeof(seg_c));
+
+    // empty batch
+    TEST_ESP_OK(esp_partition_readv(partition_data, NULL, 0));
+    TEST_ESP_OK(esp_partition_writev(partition_data, NULL, 0));
+
+    // an invalid segment rejects the whole batch, nothing is written
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    const esp_partition_write_vec_t bad_size[] = {
+        { .offset = 0, .src = seg_a, .size = sizeof(seg_a) },
+        { .offset = partition_data->size - 4, .src = seg_b, .size = sizeof(seg_b) },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_partition_writev(partition_data, bad_size, 2));
+    const esp_partition_write_vec_t bad_offset[] = {
+        { .offset = 0, .src = seg_a, .size = sizeof(seg_a) },
+        { .offset = partition_data->size + 1, .src = seg_b, .size = 0 },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_partition_writev(partition_data, bad_offset, 2));
+    const esp_partition_read_vec_t bad_read[] = {
+        { .offset = 0, .dst = out_a, .size = sizeof(out_a) },
+        { .offset = partition_data->size - 4, .dst = out_b, .size = sizeof(out_b) },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_partition_readv(partition_data, bad_read, 2));
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, out_a, sizeof(out_a)));
+    for (size_t i = 0; i < sizeof(out_a); i++) {
+        TEST_ASSERT_EQUAL_HEX8(0xFF, out_a[i]);
+    }
+
+    // power-off during a batch: segments are programmed in order, only the tail is lost
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    esp_partition_fail_after(sizeof(seg_a) / 4 + 1, ESP_PARTITION_FAIL_AFTER_MODE_WRITE);
+    const esp_partition_write_vec_t ordered[] = {
+        { .offset = 256, .src = seg_a, .size = sizeof(seg_a) },
+        { .offset = 0, .src = seg_b, .size = sizeof(seg_b) },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_FLASH_OP_FAIL, esp_partition_writev(partition_data, ordered, 2));
+    esp_partition_fail_after(SIZE_MAX, 0);
+    TEST_ESP_OK(esp_partition_read(partition_data, 256, out_a, sizeof(out_a)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(seg_a, out_a, sizeof(seg_a));
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, out_b, sizeof(out_b)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(seg_b, out_b, 4);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, out_b[4]);
+}
+
+TEST(partition_api, test_partition_readv_ops_benchmark)
+{
+    // Scenario: read and write 64 records of 32 bytes scattered over a sector, one call per record
+    // compared to one batched call. The emulator counts each call as one flash operation.
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+
+    enum { RECORDS = 64, RECORD_SIZE = 32 };
+    static uint8_t records[RECORDS][RECORD_SIZE];
+    esp_partition_write_vec_t wvec[RECORDS];
+    esp_partition_read_vec_t rvec[RECORDS];
+    for (size_t i = 0; i < RECORDS; i++) {
+        memset(records[i], (int) i, RECORD_SIZE);
+        // every other record slot, in reverse order
+        const size_t offset = (RECORDS - 1 - i) * 2 * RECORD_SIZE;
+        wvec[i] = (esp_partition_write_vec_t) { .offset = offset, .src = records[i], .size = RECORD_SIZE };
+        rvec[i] = (esp_partition_read_vec_t) { .offset = offset, .dst = records[i], .size = RECORD_SIZE };
+    }
+
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    esp_partition_clear_stats();
+    for (size_t i = 0; i < RECORDS; i++) {
+        TEST_ESP_OK(esp_partition_write(partition_data, wvec[i].offset, wvec[i].src, wvec[i].size));
+    }
+    for (size_t i = 0; i < RECORDS; i++) {
+        TEST_ESP_OK(esp_partition_read(partition_data, rvec[i].offset, rvec[i].dst, rvec[i].size));
+    }
+    const size_t single_write_ops = esp_partition_get_write_ops();
+    const size_t single_read_ops = esp_partition_get_read_ops();
+    const size_t single_time = esp_partition_get_total_time();
+
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_writev(partition_data, wvec, RECORDS));
+    TEST_ESP_OK(esp_partition_readv(partition_data, rvec, RECORDS));
+    const size_t batch_write_ops = esp_partition_get_write_ops();
+    const size_t batch_read_ops = esp_partition_get_read_ops();
+    const size_t batch_time = esp_partition_get_total_time();
+
+    ESP_LOGI(TAG, "%d records: single calls %u W / %u R ops (%u us), batched %u W / %u R ops (%u us)", RECORDS,
+             (unsigned) single_write_ops, (unsigned) single_read_ops, (unsigned) single_time,
+             (unsigned) batch_write_ops, (unsigned) batch_read_ops, (unsigned) batch_time);
+    TEST_ASSERT_EQUAL(RECORDS, single_write_ops);
+    TEST_ASSERT_EQUAL(RECORDS, single_read_ops);
+    TEST_ASSERT_EQUAL(1, batch_write_ops);
+    TEST_ASSERT_EQUAL(1, batch_read_ops);
+    for (size_t i = 0; i < RECORDS; i++) {
+        TEST_ASSERT_EACH_EQUAL_HEX8((uint8_t) i, records[i], RECORD_SIZE);
+    }
+}
+
 TEST_GROUP_RUNNER(partition_api)
 {
     RUN_TEST_CASE(partition_api, test_partition_find_basic);
@@ -785,6 +1093,10 @@ TEST_GROUP_RUNNER(partition_api)
     RUN_TEST_CASE(partition_api, test_partition_power_off_emulation);
     RUN_TEST_CASE(partition_api, test_partition_copy);
     RUN_TEST_CASE(partition_api, test_partition_register_external);
+    RUN_TEST_CASE(partition_api, test_partition_sparse_flash_file);
+    RUN_TEST_CASE(partition_api, test_partition_snapshot_restore);
+    RUN_TEST_CASE(partition_api, test_partition_readv_writev);
+    RUN_TEST_CASE(partition_api, test_partition_readv_ops_benchmark);
 }
 
 static void run_all_tests(void)
@@ -143,6 +143,24 @@ typedef struct {
     bool readonly;                      /*!< flag is set to true if partition is read-only */
 } esp_partition_t;
 
+/**
+ * @brief Segment of a batched read, see esp_partition_readv
+ */
+typedef struct {
+    size_t offset;                      /*!< address of the data to be read, relative to the beginning of the partition */
+    void* dst;                          /*!< buffer where the data should be stored, at least 'size' bytes long */
+    size_t size;                        /*!< size of the data to be read, in bytes */
+} esp_partition_read_vec_t;
+
+/**
+ * @brief Segment of a batched write, see esp_partition_writev
+ */
+typedef struct {
+    size_t offset;                      /*!< address where the data should be written, relative to the beginning of the partition */
+    const void* src;                    /*!< source buffer, at least 'size' bytes long */
+    size_t size;                        /*!< size of the data to be written, in bytes */
+} esp_partition_write_vec_t;
+
 /**
  * @brief Find partition based on one or more parameters
  *
@@ -338,6 +356,60 @@ esp_err_t esp_partition_read_raw(const esp_partition_t* partition,
 esp_err_t esp_partition_write_raw(const esp_partition_t* partition,
                                   size_t dst_offset, const void* src, size_t size);
 
+/**
+ * @brief Read several segments of data from the partition in one batch
+ *
+ * Equivalent to calling esp_partition_read for each segment in the array order, but all
+ * segments are validated before any data is read. Segments which are adjacent both in the
+ * partition and in memory are merged, and the flash driver is called once per merged segment
+ * (one esp_flash_read call on the target).
+ *
+ * Reading stops at the first failing segment, the contents of the buffers of that and all
+ * following segments are undefined.
+ *
+ * @param partition Pointer to partition structure obtained using
+ *                  esp_partition_find_first or esp_partition_get.
+ *                  Must be non-NULL.
+ * @param vec Array of segments to be read. Can be NULL if count is 0.
+ * @param count Number of segments in the array.
+ *
+ * @return ESP_OK, if all segments were read successfully;
+ *         ESP_ERR_INVALID_ARG, if offset of any segment exceeds partition size;
+ *         ESP_ERR_INVALID_SIZE, if any segment would go out of bounds of the partition;
+ *         or one of error codes from lower-level flash driver.
+ */
+esp_err_t esp_partition_readv(const esp_partition_t* partition,
+                              const esp_partition_read_vec_t* vec, size_t count);
+
+/**
+ * @brief Write several segments of data to the partition in one batch
+ *
+ * Equivalent to calling esp_partition_write for each segment in the array order, but all
+ * segments are validated before anything is written. Segments which are adjacent both in the
+ * partition and in memory are merged, and the flash driver is called once per merged segment
+ * (one esp_flash_write call on the target).
+ *
+ * Segments are written in the array order, so a later segment is never programmed before
+ * an earlier one. Writing stops at the first failing segment.
+ *
+ * @param partition Pointer to partition structure obtained using
+ *                  esp_partition_find_first or esp_partition_get.
+ *                  Must be non-NULL.
+ * @param vec Array of segments to be written. Can be NULL if count is 0.
+ * @param count Number of segments in the array.
+ *
+ * @note Prior to writing to flash memory, make sure it has been erased with
+ *       esp_partition_erase_range call.
+ *
+ * @return ESP_OK, if all segments were written successfully;
+ *         ESP_ERR_INVALID_ARG, if offset of any segment exceeds partition size;
+ *         ESP_ERR_INVALID_SIZE, if any segment would go out of bounds of the partition;
+ *         ESP_ERR_NOT_ALLOWED, if partition is read-only;
+ *         or one of error codes from lower-level flash driver.
+ */
+esp_err_t esp_partition_writev(const esp_partition_t* partition,
+                               const esp_partition_write_vec_t* vec, size_t count);
+
 /**
  * @brief Erase part of the partition
  *
@@ -58,17 +58,25 @@ const char *esp_partition_subtype_to_str(const uint32_t type, const uint32_t sub
  * to allow relevant Partition APIs run in host-emulated environment without any code change.
  *
  * The emulation buffer is actually a disk file mapped to the host memory, current version implements the following:
- * 1. create temporary file /tmp/idf-partition-XXXXXX (fixed size 4MB)
- * 2. mmap() whole file to the memory and set its contents to all 1s (SPI NOR flash default)
+ * 1. create sparse temporary file /tmp/idf-partition-XXXXXX (fixed size 4MB)
+ * 2. mmap() whole file to the memory and mark all sectors as erased. Erased sectors are holes in the file which read
+ *    as all 1s (SPI NOR flash default) and are filled with 1s on the first write. Erasing a sector turns it into
+ *    a hole again, so only written flash consumes disk space.
  * 3. upload build/partition_table/partition-table.bin (hard-wired path for now) to ESP_PARTITION_TABLE_OFFSET
  *    (from the beginning of the memory buffer, ie to the same offset as in real SPI FLASH)
  * 4. [optional: iterate through the partitions uploaded and print esp_partition_info_t details for each]
  * 5. set part_desc_addr_start[out] parameter to the memory buffer starting address
  *
  * The pointer returned in part_desc_addr_start is then used as it was regular SPI FLASH address.
+ * Only the partition table sector is guaranteed to hold its flash contents at the pointer. Erased sectors are
+ * not filled in the memory, use esp_partition_read() to read them and esp_partition_file_overwrite() to write
+ * arbitrary contents (e.g. corrupted data in tests) instead of writing through the pointer.
  *
  * NOTES:
- * 1. the temporary file generated is not deleted automatically - the cleanup happens during the next host system reset
+ * 1. the temporary file generated is not deleted automatically - the cleanup happens during the next host system reset.
+ *    A kept temporary file (remove_dump not set) stays sparse, its erased sectors are holes. When a flash file
+ *    is opened by name, the sectors lying entirely in holes of the file read as erased. A file opened by name is
+ *    kept as a complete flash image: esp_partition_file_munmap() writes its erased sectors to the file as 0xFF.
  * 2. the mmapped() section remains active until esp_partition_file_unmmap() is called
  * 3. mmap() is called with MAP_SHARED so the emulated SPI FLASH can be shared among processes
  *
@@ -96,10 +104,40 @@ esp_err_t esp_partition_file_mmap(const uint8_t **part_desc_addr_start);
  *      - ESP_OK: Operation successful
  *      - ESP_ERR_NO_MEM: The memory buffer was not allocated
  *      - ESP_ERR_INVALID_SIZE: The buffer size was 0
- *      - ESP_ERR_INVALID_RESPONSE: Failed to munmap() the emulation file from memory
+ *      - ESP_ERR_INVALID_RESPONSE: Failed to write the kept flash file or to munmap() the emulation file from memory
  */
 esp_err_t esp_partition_file_munmap(void);
 
+/**
+ * @brief Returns the time spent in esp_partition_file_mmap (Linux host)
+ *
+ * The total is not reset by esp_partition_clear_stats(), take the difference of two calls to measure a test case.
+ *
+ * @return
+ *      - time spent in all calls to esp_partition_file_mmap since the start of the process, in microseconds
+ */
+int64_t esp_partition_file_get_setup_time(void);
+
+/**
+ * @brief Overwrites the emulated SPI FLASH contents (Linux host)
+ *
+ * The data is copied as is, without the NOR flash programming rules applied by esp_partition_write()
+ * (bits can only be cleared) and without the erase check. Intended for tests which prepare the flash contents
+ * directly, e.g. to emulate corrupted or randomized flash. Erased sectors touched by the range are materialized,
+ * the rest of such sectors keeps reading as 0xFF.
+ *
+ * @param[in] flash_offset Offset from the beginning of the emulated flash
+ * @param[in] src Data to be written
+ * @param[in] size Size of the data in bytes
+ *
+ * @return
+ *      - ESP_OK: Operation successful
+ *      - ESP_ERR_INVALID_ARG: src is NULL
+ *      - ESP_ERR_INVALID_STATE: The emulated flash is not mapped
+ *      - ESP_ERR_INVALID_SIZE: The range exceeds the emulated flash
+ */
+esp_err_t esp_partition_file_overwrite(size_t flash_offset, const void *src, size_t size);
+
 /**
  * Functions for host tests
 */
@@ -113,20 +151,22 @@ void esp_partition_clear_stats(void);
 /**
  * @brief Returns number of read operations called
  *
- * Function returns number of calls to the function esp_partition_read
+ * Function returns number of calls to the function esp_partition_read. A batch passed to
+ * esp_partition_readv is counted as one operation.
  *
  * @return
- *      - number of calls to esp_partition_read since recent esp_partition_clear_stats
+ *      - number of calls to esp_partition_read and esp_partition_readv since recent esp_partition_clear_stats
  */
 size_t esp_partition_get_read_ops(void);
 
 /**
  * @brief Returns number of write operations called
  *
- * Function returns number of calls to the function esp_partition_write
+ * Function returns number of calls to the function esp_partition_write. A batch passed to
+ * esp_partition_writev is counted as one operation.
  *
  * @return
- *      - number of calls to esp_partition_write since recent esp_partition_clear_stats
+ *      - number of calls to esp_partition_write and esp_partition_writev since recent esp_partition_clear_stats
  */
 size_t esp_partition_get_write_ops(void);
 
@@ -205,6 +245,7 @@ typedef struct {
     size_t flash_file_size;              /*!< size of flash dump file in bytes */
     char partition_file_name[PATH_MAX];  /*!< name of file containing binary representation of partition table, zero-terminated ASCII string */
     bool remove_dump;                    /*!< flag is set to true if dump file has to be removed after esp_partition_file_munmap */
+    int64_t setup_time_us;               /*!< time spent in esp_partition_file_mmap, only reported in the actual control structure */
 } esp_partition_file_mmap_ctrl_t;
 
 /**
@@ -236,6 +277,62 @@ esp_partition_file_mmap_ctrl_t* esp_partition_get_file_mmap_ctrl_input(void);
 */
 esp_partition_file_mmap_ctrl_t* esp_partition_get_file_mmap_ctrl_act(void);
 
+/**
+ * @brief Handle of a snapshot of the emulated flash
+ */
+typedef struct esp_partition_file_snapshot *esp_partition_file_snapshot_handle_t;
+
+/**
+ * @brief Takes a snapshot of the emulated SPI FLASH contents (Linux host)
+ *
+ * The snapshot is an unlinked temporary file. If the host file system supports reflinks (FICLONE), the snapshot shares
+ * data blocks with the flash file and is created in constant time. Otherwise only the non-erased sectors are copied
+ * into a sparse file.
+ *
+ * Typical use is to take a snapshot after a common test setup (e.g. formatting a file system) and to restore it
+ * before each test case.
+ *
+ * @param[out] ret_snapshot output snapshot handle
+ *
+ * @return
+ *      - ESP_OK: Snapshot created
+ *      - ESP_ERR_INVALID_ARG: ret_snapshot is NULL
+ *      - ESP_ERR_INVALID_STATE: The emulated flash is not mapped
+ *      - ESP_ERR_NO_MEM: Out of memory
+ *      - ESP_ERR_NOT_FINISHED, ESP_ERR_INVALID_SIZE, ESP_ERR_INVALID_RESPONSE: Failed to create the snapshot file
+ */
+esp_err_t esp_partition_file_snapshot_create(esp_partition_file_snapshot_handle_t *ret_snapshot);
+
+/**
+ * @brief Restores the emulated SPI FLASH contents from a snapshot (Linux host)
+ *
+ * The emulated flash is replaced by a MAP_PRIVATE (copy-on-write) mapping of the snapshot at the same address,
+ * so restoring takes constant time and pointers returned by esp_partition_mmap() stay valid. Subsequent writes
+ * don't modify the snapshot, which can be restored any number of times. Erase counters gathered by statistics
+ * are not affected.
+ *
+ * The partition table of the snapshot has to match the loaded one.
+ *
+ * @param[in] snapshot snapshot handle
+ *
+ * @return
+ *      - ESP_OK: Flash contents restored
+ *      - ESP_ERR_INVALID_ARG: snapshot is NULL
+ *      - ESP_ERR_INVALID_STATE: The emulated flash is not mapped
+ *      - ESP_ERR_INVALID_SIZE: The snapshot was taken from a flash of different size
+ *      - ESP_ERR_NO_MEM: Failed to mmap() the snapshot
+ */
+esp_err_t esp_partition_file_snapshot_restore(esp_partition_file_snapshot_handle_t snapshot);
+
+/**
+ * @brief Deletes a snapshot of the emulated SPI FLASH
+ *
+ * The snapshot may be deleted while restored, the restored flash contents stay valid.
+ *
+ * @param[in] snapshot snapshot handle, NULL is ignored
+ */
+void esp_partition_file_snapshot_delete(esp_partition_file_snapshot_handle_t snapshot);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,12 +4,17 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // fallocate()
+#endif
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <inttypes.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/ioctl.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <limits.h>
@@ -21,12 +26,44 @@
 #include "esp_log.h"
 #include "spi_flash_mmap.h"
 
+#if __has_include(<linux/fs.h>)
+#include <linux/fs.h>   // FICLONE
+#endif
+
 static const char *TAG = "linux_spiflash";
 
 static void *s_spiflash_mem_file_buf = NULL;
 static int s_spiflash_mem_file_fd = -1;
 static const esp_partition_mmap_handle_t s_default_partition_mmap_handle = 0;
 
+/*
+ * Erased-state tracking of the emulated flash
+ *
+ * Freshly created flash files are sparse: instead of filling the whole file with 0xFF, every emulated sector
+ * in erased state is marked in s_spiflash_erased_map and reads of it return 0xFF without touching the file.
+ * Such sectors are holes in the file (erase punches the hole again where the host supports it), so neither time
+ * nor disk space is spent on flash which is never written. A sector is materialized (filled with 0xFF in
+ * the file) on its first write.
+ *
+ * Sectors exposed by direct pointers (esp_partition_mmap, partition table) are recorded in s_spiflash_pinned_map
+ * and always stay materialized, as the pointer holders read the memory directly.
+ */
+static uint32_t *s_spiflash_erased_map = NULL;
+static uint32_t *s_spiflash_pinned_map = NULL;
+static size_t s_spiflash_sector_count = 0;
+// true if the emulated flash is a MAP_PRIVATE view of a snapshot, see esp_partition_file_snapshot_restore
+static bool s_spiflash_mem_private = false;
+// true if the flash file was opened by name, false for a temporary flash file
+static bool s_spiflash_mem_file_named = false;
+// time spent in all esp_partition_file_mmap calls, see esp_partition_file_get_setup_time
+static int64_t s_esp_partition_file_setup_time_us = 0;
+
+struct esp_partition_file_snapshot {
+    int fd;                         // unlinked file holding the flash contents
+    size_t flash_size;
+    uint32_t *erased_map;
+};
+
 // input control structure, always contains what was specified by caller
 static esp_partition_file_mmap_ctrl_t s_esp_partition_file_mmap_ctrl_input = {0};
 // actual control structure, contains what is actually used by the esp_partition
@@ -109,8 +146,236 @@ const char *esp_partition_subtype_to_str(const uint32_t type, const uint32_t sub
     }
 }
 
+#define SECTOR_MAP_WORDS(sectors) (((sectors) + 31) / 32)
+
+static inline bool sector_map_get(const uint32_t *map, size_t sector)
+{
+    return (map[sector / 32] >> (sector % 32)) & 1;
+}
+
+static inline void sector_map_set(uint32_t *map, size_t sector)
+{
+    map[sector / 32] |= 1UL << (sector % 32);
+}
+
+static inline void sector_map_clear(uint32_t *map, size_t sector)
+{
+    map[sector / 32] &= ~(1UL << (sector % 32));
+}
+
+static size_t emulated_sector_len(size_t sector)
+{
+    size_t start = sector * ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    size_t len = s_esp_partition_file_mmap_ctrl_act.flash_file_size - start;
+    return len < ESP_PARTITION_EMULATED_SECTOR_SIZE ? len : ESP_PARTITION_EMULATED_SECTOR_SIZE;
+}
+
+static void emulated_sector_maps_free(void)
+{
+    free(s_spiflash_erased_map);
+    free(s_spiflash_pinned_map);
+    s_spiflash_erased_map = NULL;
+    s_spiflash_pinned_map = NULL;
+    s_spiflash_sector_count = 0;
+}
+
+static esp_err_t emulated_sector_maps_alloc(size_t flash_size, bool all_erased)
+{
+    s_spiflash_sector_count = (flash_size + ESP_PARTITION_EMULATED_SECTOR_SIZE - 1) / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    s_spiflash_erased_map = calloc(SECTOR_MAP_WORDS(s_spiflash_sector_count), sizeof(uint32_t));
+    s_spiflash_pinned_map = calloc(SECTOR_MAP_WORDS(s_spiflash_sector_count), sizeof(uint32_t));
+    if (s_spiflash_erased_map == NULL || s_spiflash_pinned_map == NULL) {
+        emulated_sector_maps_free();
+        return ESP_ERR_NO_MEM;
+    }
+    if (all_erased) {
+        for (size_t sector = 0; sector < s_spiflash_sector_count; sector++) {
+            sector_map_set(s_spiflash_erased_map, sector);
+        }
+    }
+    return ESP_OK;
+}
+
+// Fills erased sectors of the given flash range with 0xFF, so that they can be accessed in the file directly
+static void emulated_flash_materialize(size_t flash_addr, size_t size, bool pin)
+{
+    if (size == 0) {
+        return;
+    }
+    size_t first = flash_addr / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    size_t last = (flash_addr + size - 1) / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    for (size_t sector = first; sector <= last; sector++) {
+        if (sector_map_get(s_spiflash_erased_map, sector)) {
+            memset(s_spiflash_mem_file_buf + sector * ESP_PARTITION_EMULATED_SECTOR_SIZE, 0xFF, emulated_sector_len(sector));
+            sector_map_clear(s_spiflash_erased_map, sector);
+        }
+        if (pin) {
+            sector_map_set(s_spiflash_pinned_map, sector);
+        }
+    }
+}
+
+static void emulated_flash_read(size_t flash_addr, void *dst, size_t size)
+{
+    uint8_t *out = dst;
+    while (size > 0) {
+        size_t sector = flash_addr / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        size_t chunk = ESP_PARTITION_EMULATED_SECTOR_SIZE - flash_addr % ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        chunk = chunk < size ? chunk : size;
+        if (sector_map_get(s_spiflash_erased_map, sector)) {
+            memset(out, 0xFF, chunk);
+        } else {
+            memcpy(out, s_spiflash_mem_file_buf + flash_addr, chunk);
+        }
+        out += chunk;
+        flash_addr += chunk;
+        size -= chunk;
+    }
+}
+
+// Releases disk space of the given sector range, the sectors have to be marked as erased
+static void emulated_flash_punch_hole(size_t first_sector, size_t count)
+{
+#if defined(FALLOC_FL_PUNCH_HOLE)
+    // the flash file isn't mapped while the emulated flash is a private view of a snapshot
+    if (count == 0 || s_spiflash_mem_private) {
+        return;
+    }
+    off_t start = (off_t) first_sector * ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    off_t len = (off_t) count * ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    if (fallocate(s_spiflash_mem_file_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, start, len) != 0) {
+        // not fatal, the sector map is authoritative; the space is just not released
+        ESP_LOGV(TAG, "fallocate(PUNCH_HOLE) failed: %s", strerror(errno));
+    }
+#else
+    (void) first_sector;
+    (void) count;
+#endif
+}
+
+// Punches holes for all erased sectors, in runs of consecutive sectors
+static void emulated_flash_punch_erased(void)
+{
+    size_t hole_start = 0;
+    for (size_t sector = 0; sector <= s_spiflash_sector_count; sector++) {
+        if (sector < s_spiflash_sector_count && sector_map_get(s_spiflash_erased_map, sector)) {
+            continue;
+        }
+        emulated_flash_punch_hole(hole_start, sector - hole_start);
+        hole_start = sector + 1;
+    }
+}
+
+// Marks the sectors which lie entirely in holes of the flash file as erased, as left by kept temporary flash files
+static void emulated_flash_find_holes(void)
+{
+#if defined(SEEK_HOLE) && defined(SEEK_DATA)
+    const off_t size = s_esp_partition_file_mmap_ctrl_act.flash_file_size;
+    off_t pos = 0;
+    while (pos < size) {
+        off_t hole = lseek(s_spiflash_mem_file_fd, pos, SEEK_HOLE);
+        if (hole < 0 || hole >= size) {
+            // no more holes, or the file system doesn't report them
+            break;
+        }
+        off_t data = lseek(s_spiflash_mem_file_fd, hole, SEEK_DATA);
+        if (data < 0 || data > size) {
+            data = size;
+        }
+        size_t first = (hole + ESP_PARTITION_EMULATED_SECTOR_SIZE - 1) / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        size_t end = data == size ? s_spiflash_sector_count : data / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        for (size_t sector = first; sector < end; sector++) {
+            sector_map_set(s_spiflash_erased_map, sector);
+        }
+        pos = data;
+    }
+#endif
+}
+
+static void emulated_flash_erase(size_t flash_addr, size_t size)
+{
+    size_t offset = 0;
+    size_t hole_start = 0;
+    size_t hole_count = 0;
+
+    while (offset < size) {
+        size_t addr = flash_addr + offset;
+        size_t sector = addr / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        size_t chunk = ESP_PARTITION_EMULATED_SECTOR_SIZE - addr % ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        chunk = chunk < size - offset ? chunk : size - offset;
+
+        if (chunk == emulated_sector_len(sector) && !sector_map_get(s_spiflash_pinned_map, sector)) {
+            sector_map_set(s_spiflash_erased_map, sector);
+            if (hole_count > 0 && hole_start + hole_count == sector) {
+                hole_count++;
+            } else {
+                emulated_flash_punch_hole(hole_start, hole_count);
+                hole_start = sector;
+                hole_count = 1;
+            }
+        } else if (!sector_map_get(s_spiflash_erased_map, sector)) {
+            //set all bits to 1 (NOR FLASH default)
+            memset(s_spiflash_mem_file_buf + addr, 0xFF, chunk);
+        }
+        offset += chunk;
+    }
+    emulated_flash_punch_hole(hole_start, hole_count);
+}
+
+// Returns true if the file range reads as a hole, false if it holds data or the file system doesn't report holes
+static bool emulated_file_is_hole(int fd, off_t pos, size_t len)
+{
+#if defined(SEEK_DATA)
+    off_t data = lseek(fd, pos, SEEK_DATA);
+    return (data < 0 && errno == ENXIO) || data >= pos + (off_t) len;
+#else
+    (void) fd;
+    (void) pos;
+    (void) len;
+    return false;
+#endif
+}
+
+// Writes sectors of the emulated flash to the file at their flash offsets: the materialized sectors from the memory
+// if write_materialized is set and the erased sectors as 0xFF if write_erased is set, except those which are holes
+// in the file if keep_holes is set
+static esp_err_t emulated_flash_write_file(int fd, bool write_materialized, bool write_erased, bool keep_holes)
+{
+    uint8_t erased_sector[ESP_PARTITION_EMULATED_SECTOR_SIZE];
+    if (write_erased) {
+        memset(erased_sector, 0xFF, sizeof(erased_sector));
+    }
+
+    for (size_t sector = 0; sector < s_spiflash_sector_count; sector++) {
+        const bool erased = sector_map_get(s_spiflash_erased_map, sector);
+        if (erased ? !write_erased : !write_materialized) {
+            continue;
+        }
+        off_t pos = (off_t) sector * ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        const uint8_t *src = erased ? erased_sector : (const uint8_t *) s_spiflash_mem_file_buf + pos;
+        size_t remaining = emulated_sector_len(sector);
+        if (erased && keep_holes && emulated_file_is_hole(fd, pos, remaining)) {
+            continue;
+        }
+        while (remaining > 0) {
+            ssize_t written = pwrite(fd, src, remaining, pos);
+            if (written <= 0) {
+                ESP_LOGE(TAG, "Failed to write SPI FLASH memory emulation file: %s", strerror(errno));
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            src += written;
+            pos += written;
+            remaining -= written;
+        }
+    }
+    return ESP_OK;
+}
+
 esp_err_t esp_partition_file_mmap(const uint8_t **part_desc_addr_start)
 {
+    struct timeval setup_start;
+    gettimeofday(&setup_start, NULL);
+
     // temporary file is used only if control structure doesn't specify file name.
     bool open_existing_file = false;
 
@@ -204,6 +469,13 @@ esp_err_t esp_partition_file_mmap(const uint8_t **part_desc_addr_start)
                 ret = ESP_ERR_NOT_FINISHED;
                 break;
             }
+
+            // flash images written by esp_partition_file_munmap() for named files are complete, the kept temporary
+            // files have their erased sectors as holes
+            ret = emulated_sector_maps_alloc(s_esp_partition_file_mmap_ctrl_act.flash_file_size, false);
+            if (ret == ESP_OK) {
+                emulated_flash_find_holes();
+            }
         } while (false);
     } else {
         //create temporary file to hold complete SPIFLASH size
@@ -231,8 +503,11 @@ esp_err_t esp_partition_file_mmap(const uint8_t **part_desc_addr_start)
                 break;
             }
 
-            // initialize whole range with bit-1 (NOR FLASH default)
-            memset(s_spiflash_mem_file_buf, 0xFF, s_esp_partition_file_mmap_ctrl_act.flash_file_size);
+            // The file is sparse after ftruncate(), all sectors start in erased state without being written
+            ret = emulated_sector_maps_alloc(s_esp_partition_file_mmap_ctrl_act.flash_file_size, true);
+            if (ret != ESP_OK) {
+                break;
+            }
 
             // upload partition table to the mmap file at real offset as in SPIFLASH
             FILE *f_partition_table = fopen(s_esp_partition_file_mmap_ctrl_act.partition_file_name, "r+");
@@ -271,6 +546,8 @@ esp_err_t esp_partition_file_mmap(const uint8_t **part_desc_addr_start)
                 break;
             }
 
+            // the partition table is accessed directly through the returned pointer, see partition.c
+            emulated_flash_materialize(ESP_PARTITION_TABLE_OFFSET, ESP_PARTITION_EMULATED_SECTOR_SIZE, true);
             uint8_t *part_table_in_spiflash = s_spiflash_mem_file_buf + ESP_PARTITION_TABLE_OFFSET;
 
             size_t res = fread(part_table_in_spiflash, 1, partition_table_file_size, f_partition_table);
@@ -284,6 +561,11 @@ esp_err_t esp_partition_file_mmap(const uint8_t **part_desc_addr_start)
     }
 
     if (ret != ESP_OK) {
+        emulated_sector_maps_free();
+        if (s_spiflash_mem_file_buf != NULL && s_spiflash_mem_file_buf != MAP_FAILED) {
+            munmap(s_spiflash_mem_file_buf, s_esp_partition_file_mmap_ctrl_act.flash_file_size);
+        }
+        s_spiflash_mem_file_buf = NULL;
         if (close(s_spiflash_mem_file_fd)) {
             ESP_LOGE(TAG, "Failed to close() SPIFLASH memory emulation file: %s", strerror(errno));
         }
@@ -326,6 +608,15 @@ esp_err_t esp_partition_file_mmap(const uint8_t **part_desc_addr_start)
     //return mmapped file starting address
     *part_desc_addr_start = s_spiflash_mem_file_buf;
 
+    struct timeval setup_end;
+    gettimeofday(&setup_end, NULL);
+    s_esp_partition_file_mmap_ctrl_act.setup_time_us = (setup_end.tv_sec - setup_start.tv_sec) * 1000000LL + (setup_end.tv_usec - setup_start.tv_usec);
+    s_esp_partition_file_setup_time_us += s_esp_partition_file_mmap_ctrl_act.setup_time_us;
+    s_spiflash_mem_file_named = open_existing_file;
+    ESP_LOGD(TAG, "SPI FLASH emulation file %s (size: %" PRIu32 " B) set up in %" PRId64 " us",
+             s_esp_partition_file_mmap_ctrl_act.flash_file_name, (uint32_t) s_esp_partition_file_mmap_ctrl_act.flash_file_size,
+             s_esp_partition_file_mmap_ctrl_act.setup_time_us);
+
     // clear input control structure
     memset(&s_esp_partition_file_mmap_ctrl_input, 0, sizeof(s_esp_partition_file_mmap_ctrl_input));
 
@@ -351,6 +642,24 @@ esp_err_t esp_partition_file_munmap(void)
     s_esp_partition_stat_sector_erase_count = NULL;
 #endif
 
+    esp_err_t ret = ESP_OK;
+    if (!s_esp_partition_file_mmap_ctrl_input.remove_dump) {
+        // A private copy of a snapshot is not backed by the flash file, so its materialized sectors are written back.
+        // A named flash file is kept as a complete flash image: its erased sectors are written as 0xFF directly,
+        // without faulting in their pages of the mapping. A temporary one stays sparse, the erased sectors are holes
+        // which read as erased when the file is opened by name. Only the erased sectors which couldn't be punched
+        // are written.
+        bool write_materialized = s_spiflash_mem_private;
+        s_spiflash_mem_private = false;
+        if (write_materialized && !s_spiflash_mem_file_named) {
+            emulated_flash_punch_erased();
+        }
+        ret = emulated_flash_write_file(s_spiflash_mem_file_fd, write_materialized, true, !s_spiflash_mem_file_named);
+    }
+    emulated_sector_maps_free();
+    s_spiflash_mem_private = false;
+    s_spiflash_mem_file_named = false;
+
     // unmap the flash emulation memory file
     if (munmap(s_spiflash_mem_file_buf, s_esp_partition_file_mmap_ctrl_act.flash_file_size) != 0) {
         ESP_LOGE(TAG, "Failed to munmap() SPIFLASH memory emulation file %s: %s", s_esp_partition_file_mmap_ctrl_act.flash_file_name, strerror(errno));
@@ -376,6 +685,30 @@ esp_err_t esp_partition_file_munmap(void)
     s_spiflash_mem_file_buf = NULL;
     s_spiflash_mem_file_fd = -1;
 
+    return ret;
+}
+
+int64_t esp_partition_file_get_setup_time(void)
+{
+    return s_esp_partition_file_setup_time_us;
+}
+
+// Programs emulated flash memory, bits can only be cleared (to emulate real NOR FLASH behavior)
+static esp_err_t emulated_flash_program(void *dst_addr, const void *src, size_t size)
+{
+    for (size_t x = 0; x < size; x++) {
+
+#ifdef CONFIG_ESP_PARTITION_ERASE_CHECK
+        // Check if address to be written was erased first
+        if((~((uint8_t *)dst_addr)[x] & ((const uint8_t *)src)[x]) != 0) {
+            ESP_LOGW(TAG, "invalid flash operation detected");
+            return ESP_ERR_FLASH_OP_FAIL;
+        }
+#endif // CONFIG_ESP_PARTITION_ERASE_CHECK
+
+        // AND with destination byte (to emulate real NOR FLASH behavior)
+        ((uint8_t *)dst_addr)[x] &= ((const uint8_t *)src)[x];
+    }
     return ESP_OK;
 }
 
@@ -404,6 +737,9 @@ esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offse
 
     esp_err_t ret = ESP_OK;
 
+    // the written sectors have to hold their erased contents in the file
+    emulated_flash_materialize(partition->address + dst_offset, size, false);
+
     // hook gathers statistics and can emulate power-off
     // in case of power - off it decreases new_size to the number of bytes written
     // before power event occurred
@@ -411,19 +747,9 @@ esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offse
         ret =  ESP_ERR_FLASH_OP_FAIL;
     }
 
-    for (size_t x = 0; x < new_size; x++) {
-
-#ifdef CONFIG_ESP_PARTITION_ERASE_CHECK
-        // Check if address to be written was erased first
-        if((~((uint8_t *)dst_addr)[x] & ((uint8_t *)src)[x]) != 0) {
-            ESP_LOGW(TAG, "invalid flash operation detected");
-            ret = ESP_ERR_FLASH_OP_FAIL;
-            break;
-        }
-#endif // CONFIG_ESP_PARTITION_ERASE_CHECK
-
-        // AND with destination byte (to emulate real NOR FLASH behavior)
-        ((uint8_t *)dst_addr)[x] &= ((uint8_t *)src)[x];
+    esp_err_t program_ret = emulated_flash_program(dst_addr, src, new_size);
+    if (program_ret != ESP_OK) {
+        ret = program_ret;
     }
 
     return ret;
@@ -446,13 +772,104 @@ esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset
     void *src_addr = s_spiflash_mem_file_buf + partition->address + src_offset;
     ESP_LOGV(TAG, "esp_partition_read(): partition=%s src_offset=%" PRIu32 " dst=%p size=%" PRIu32 " (real src address: %p)", partition->label, (uint32_t) src_offset, dst, (uint32_t) size, src_addr);
 
-    memcpy(dst, src_addr, size);
+    emulated_flash_read(partition->address + src_offset, dst, size);
 
     ESP_PARTITION_HOOK_READ(src_addr, size); // statistics
 
     return ESP_OK;
 }
 
+esp_err_t esp_partition_readv(const esp_partition_t *partition, const esp_partition_read_vec_t *vec, size_t count)
+{
+    assert(partition != NULL && s_spiflash_mem_file_buf != NULL);
+    assert(vec != NULL || count == 0);
+
+    if (partition->encrypted) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    // validate the whole batch before any flash access
+    size_t total_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (vec[i].offset > partition->size) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (vec[i].offset + vec[i].size > partition->size) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        total_size += vec[i].size;
+    }
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    ESP_LOGV(TAG, "esp_partition_readv(): partition=%s count=%" PRIu32 " total size=%" PRIu32, partition->label, (uint32_t) count, (uint32_t) total_size);
+
+    for (size_t i = 0; i < count; i++) {
+        emulated_flash_read(partition->address + vec[i].offset, vec[i].dst, vec[i].size);
+    }
+
+    // the whole batch is accounted as one flash operation
+    ESP_PARTITION_HOOK_READ(s_spiflash_mem_file_buf + partition->address + vec[0].offset, total_size); // statistics
+
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_writev(const esp_partition_t *partition, const esp_partition_write_vec_t *vec, size_t count)
+{
+    assert(partition != NULL && s_spiflash_mem_file_buf != NULL);
+    assert(vec != NULL || count == 0);
+
+    if (partition->readonly) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    if (partition->encrypted) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    // validate the whole batch before any flash access
+    size_t total_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (vec[i].offset > partition->size) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (vec[i].offset + vec[i].size > partition->size) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        total_size += vec[i].size;
+    }
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    ESP_LOGV(TAG, "esp_partition_writev(): partition=%s count=%" PRIu32 " total size=%" PRIu32, partition->label, (uint32_t) count, (uint32_t) total_size);
+
+    // local size, can be modified by the write hook in case of simulated power-off
+    size_t new_size = total_size;
+
+    esp_err_t ret = ESP_OK;
+
+    // the whole batch is accounted as one flash operation, in case of power-off new_size
+    // is decreased to the number of bytes written before the power event occurred
+    if (!ESP_PARTITION_HOOK_WRITE(s_spiflash_mem_file_buf + partition->address + vec[0].offset, &new_size)) {
+        ret = ESP_ERR_FLASH_OP_FAIL;
+    }
+
+    // segments are programmed in order, so a power-off only affects the tail of the batch
+    for (size_t i = 0; i < count && new_size > 0; i++) {
+        const size_t size = (vec[i].size < new_size) ? vec[i].size : new_size;
+
+        // the written sectors have to hold their erased contents in the file
+        emulated_flash_materialize(partition->address + vec[i].offset, size, false);
+
+        esp_err_t program_ret = emulated_flash_program(s_spiflash_mem_file_buf + partition->address + vec[i].offset, vec[i].src, size);
+        if (program_ret != ESP_OK) {
+            return program_ret;
+        }
+        new_size -= size;
+    }
+
+    return ret;
+}
+
 esp_err_t esp_partition_read_raw(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
 {
     ESP_LOGV(TAG, "esp_partition_read_raw(): calling esp_partition_read()");
@@ -492,8 +909,8 @@ esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t off
         ret =  ESP_ERR_FLASH_OP_FAIL;
     }
 
-    //set all bits to 1 (NOR FLASH default)
-    memset(target_addr, 0xFF, new_size);
+    // set all bits to 1 (NOR FLASH default), whole sectors are turned into holes
+    emulated_flash_erase(partition->address + offset, new_size);
 
     return ret;
 }
@@ -537,6 +954,8 @@ esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, si
 
     // adjust memory mapped pointer to the required offset
     if (rc == ESP_OK) {
+        // the caller reads the memory directly, keep the range materialized
+        emulated_flash_materialize(req_flash_addr, size, true);
         *out_ptr = (void *) (s_spiflash_mem_file_buf + req_flash_addr);
         *out_handle = s_default_partition_mmap_handle;
     } else {
@@ -566,6 +985,131 @@ uint32_t esp_partition_get_main_flash_sector_size(void)
     return ESP_PARTITION_EMULATED_SECTOR_SIZE;
 }
 
+esp_err_t esp_partition_file_overwrite(size_t flash_offset, const void *src, size_t size)
+{
+    if (src == NULL && size > 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_spiflash_mem_file_buf == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (flash_offset > s_esp_partition_file_mmap_ctrl_act.flash_file_size ||
+            size > s_esp_partition_file_mmap_ctrl_act.flash_file_size - flash_offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // the bytes around the written range keep their (possibly erased) contents
+    emulated_flash_materialize(flash_offset, size, false);
+    memcpy(s_spiflash_mem_file_buf + flash_offset, src, size);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_file_snapshot_create(esp_partition_file_snapshot_handle_t *ret_snapshot)
+{
+    if (ret_snapshot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_spiflash_mem_file_buf == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const size_t map_size = SECTOR_MAP_WORDS(s_spiflash_sector_count) * sizeof(uint32_t);
+    struct esp_partition_file_snapshot *snapshot = calloc(1, sizeof(struct esp_partition_file_snapshot));
+    uint32_t *erased_map = malloc(map_size);
+    if (snapshot == NULL || erased_map == NULL) {
+        free(snapshot);
+        free(erased_map);
+        return ESP_ERR_NO_MEM;
+    }
+
+    char snapshot_file_name[] = "/tmp/idf-partition-snapshot-XXXXXX";
+    int fd = mkstemp(snapshot_file_name);
+    if (fd == -1) {
+        ESP_LOGE(TAG, "Failed to create SPI FLASH snapshot file %s: %s", snapshot_file_name, strerror(errno));
+        free(snapshot);
+        free(erased_map);
+        return ESP_ERR_NOT_FINISHED;
+    }
+    // the file lives as long as the descriptor or a mapping of it exists
+    unlink(snapshot_file_name);
+
+    esp_err_t ret = ESP_OK;
+    bool cloned = false;
+#ifdef FICLONE
+    // reflink shares the data blocks with the flash file, copy-on-write is done by the file system
+    if (!s_spiflash_mem_private) {
+        cloned = (ioctl(fd, FICLONE, s_spiflash_mem_file_fd) == 0);
+    }
+#endif
+    if (!cloned) {
+        if (ftruncate(fd, s_esp_partition_file_mmap_ctrl_act.flash_file_size) != 0) {
+            ESP_LOGE(TAG, "Failed to set size of SPI FLASH snapshot file: %s", strerror(errno));
+            ret = ESP_ERR_INVALID_SIZE;
+        } else {
+            // sparse copy, the erased sectors stay holes
+            ret = emulated_flash_write_file(fd, true, false, false);
+        }
+    }
+
+    if (ret != ESP_OK) {
+        close(fd);
+        free(snapshot);
+        free(erased_map);
+        return ret;
+    }
+
+    memcpy(erased_map, s_spiflash_erased_map, map_size);
+    snapshot->fd = fd;
+    snapshot->flash_size = s_esp_partition_file_mmap_ctrl_act.flash_file_size;
+    snapshot->erased_map = erased_map;
+
+    ESP_LOGV(TAG, "SPI FLASH snapshot created (%s)", cloned ? "reflink" : "sparse copy");
+    *ret_snapshot = snapshot;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_file_snapshot_restore(esp_partition_file_snapshot_handle_t snapshot)
+{
+    if (snapshot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_spiflash_mem_file_buf == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (snapshot->flash_size != s_esp_partition_file_mmap_ctrl_act.flash_file_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Replace the emulated flash by a copy-on-write view of the snapshot at the same address, so that pointers
+    // obtained from esp_partition_mmap() stay valid. Writes after the restore don't modify the snapshot.
+    void *addr = mmap(s_spiflash_mem_file_buf, snapshot->flash_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, snapshot->fd, 0);
+    if (addr == MAP_FAILED) {
+        ESP_LOGE(TAG, "Failed to mmap() SPI FLASH snapshot: %s", strerror(errno));
+        return ESP_ERR_NO_MEM;
+    }
+    s_spiflash_mem_private = true;
+
+    memcpy(s_spiflash_erased_map, snapshot->erased_map, SECTOR_MAP_WORDS(s_spiflash_sector_count) * sizeof(uint32_t));
+    for (size_t sector = 0; sector < s_spiflash_sector_count; sector++) {
+        if (sector_map_get(s_spiflash_pinned_map, sector)) {
+            emulated_flash_materialize(sector * ESP_PARTITION_EMULATED_SECTOR_SIZE, 1, false);
+        }
+    }
+
+    return ESP_OK;
+}
+
+void esp_partition_file_snapshot_delete(esp_partition_file_snapshot_handle_t snapshot)
+{
+    if (snapshot == NULL) {
+        return;
+    }
+    close(snapshot->fd);
+    free(snapshot->erased_map);
+    free(snapshot);
+}
+
 #ifdef CONFIG_ESP_PARTITION_ENABLE_STATS
 // timing data for ESP8266, 160MHz CPU frequency, 80MHz flash frequency
 // all values in microseconds
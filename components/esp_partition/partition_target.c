@@ -120,6 +120,71 @@ esp_err_t esp_partition_write_raw(const esp_partition_t *partition,
     return esp_flash_write(partition->flash_chip, src, dst_offset, size);
 }
 
+esp_err_t esp_partition_readv(const esp_partition_t *partition,
+                              const esp_partition_read_vec_t *vec, size_t count)
+{
+    assert(partition != NULL);
+    assert(vec != NULL || count == 0);
+    // validate the whole batch before any flash access
+    for (size_t i = 0; i < count; i++) {
+        if (vec[i].offset > partition->size) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (vec[i].size > partition->size - vec[i].offset) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    for (size_t i = 0; i < count;) {
+        // merge segments which are adjacent both in flash and in memory
+        const size_t offset = vec[i].offset;
+        uint8_t *dst = vec[i].dst;
+        size_t size = vec[i].size;
+        for (i++; i < count && vec[i].offset == offset + size && vec[i].dst == dst + size; i++) {
+            size += vec[i].size;
+        }
+        esp_err_t err = esp_partition_read(partition, offset, dst, size);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_writev(const esp_partition_t *partition,
+                               const esp_partition_write_vec_t *vec, size_t count)
+{
+    assert(partition != NULL);
+    assert(vec != NULL || count == 0);
+    if (partition->readonly) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    // validate the whole batch before any flash access
+    for (size_t i = 0; i < count; i++) {
+        if (vec[i].offset > partition->size) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (vec[i].size > partition->size - vec[i].offset) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+
+    for (size_t i = 0; i < count;) {
+        // merge segments which are adjacent both in flash and in memory
+        const size_t offset = vec[i].offset;
+        const uint8_t *src = vec[i].src;
+        size_t size = vec[i].size;
+        for (i++; i < count && vec[i].offset == offset + size && vec[i].src == src + size; i++) {
+            size += vec[i].size;
+        }
+        esp_err_t err = esp_partition_write(partition, offset, src, size);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
 esp_err_t esp_partition_erase_range(const esp_partition_t *partition,
                                     size_t offset, size_t size)
 {
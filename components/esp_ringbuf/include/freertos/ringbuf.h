@@ -62,6 +62,7 @@ typedef struct xSTATIC_RINGBUFFER {
     StaticList_t xDummy5[2];
     void * pvDummy6;
     portMUX_TYPE muxDummy;
+    size_t xDummy7[7];
     /** @endcond */
 } StaticRingbuffer_t;
 
@@ -110,6 +111,47 @@ RingbufHandle_t xRingbufferCreateStatic(size_t xBufferSize,
                                         uint8_t *pucRingbufferStorage,
                                         StaticRingbuffer_t *pxStaticRingbuffer);
 
+/**
+ * @brief       Create a single-producer/single-consumer ring buffer
+ *
+ * This API is similar to xRingbufferCreate(), but the created ring buffer is
+ * lock-free: sending, receiving and returning items only update atomic counters
+ * and never enter a critical section, unless a task is blocked on the ring buffer.
+ *
+ * @param[in]   xBufferSize Size of the buffer in bytes. Note that items require
+ *              space for a header in no-split/allow-split buffers
+ * @param[in]   xBufferType Type of ring buffer, see documentation.
+ *
+ * @note    At any given time, only one task or ISR may send items to the ring buffer
+ *          (including xRingbufferSendAcquire(), xRingbufferSendComplete() and
+ *          xRingbufferGetCurFreeSize()), and only one task or ISR may receive and return
+ *          items. Use xRingbufferCreate() if there are multiple senders or receivers.
+ * @note    xBufferSize of no-split/allow-split buffers will be rounded up to the nearest 32-bit aligned size.
+ *
+ * @return  A handle to the created ring buffer, or NULL in case of error.
+ */
+RingbufHandle_t xRingbufferCreateSPSC(size_t xBufferSize, RingbufferType_t xBufferType);
+
+/**
+ * @brief       Create a single-producer/single-consumer ring buffer but manually provide the required memory
+ *
+ * @param[in]   xBufferSize Size of the buffer in bytes.
+ * @param[in]   xBufferType Type of ring buffer, see documentation
+ * @param[in]   pucRingbufferStorage Pointer to the ring buffer's storage area.
+ *              Storage area must have the same size as specified by xBufferSize
+ * @param[in]   pxStaticRingbuffer Pointed to a struct of type StaticRingbuffer_t
+ *              which will be used to hold the ring buffer's data structure
+ *
+ * @note    The same restrictions as for xRingbufferCreateSPSC() apply.
+ * @note    xBufferSize of no-split/allow-split buffers MUST be 32-bit aligned.
+ *
+ * @return  A handle to the created ring buffer
+ */
+RingbufHandle_t xRingbufferCreateStaticSPSC(size_t xBufferSize,
+                                            RingbufferType_t xBufferType,
+                                            uint8_t *pucRingbufferStorage,
+                                            StaticRingbuffer_t *pxStaticRingbuffer);
+
 /**
  * @brief       Insert an item into the ring buffer
  *
@@ -386,6 +428,110 @@ void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem);
  */
 void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, BaseType_t *pxHigherPriorityTaskWoken);
 
+/**
+ * @brief   Insert multiple items into the ring buffer
+ *
+ * Equivalent to calling xRingbufferSend() for each item, but all items that
+ * currently fit are inserted under a single lock and a waiting receiver is
+ * unblocked only once. This function will block until all items are inserted
+ * or until it times out.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to insert the items into
+ * @param[in]   ppvItems        Array of pointers to the data of each item. NULL is allowed for items of size 0.
+ * @param[in]   pxItemSizes     Array of the size of each item
+ * @param[in]   xItemNum        Number of items to insert
+ * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
+ *
+ * @note    Items are inserted in order. If an item is larger than the maximum item
+ *          size, only the items preceding it are inserted.
+ *
+ * @return  Number of items inserted. Those are always the first items of ppvItems.
+ */
+size_t xRingbufferSendMultiple(RingbufHandle_t xRingbuffer,
+                               const void *const *ppvItems,
+                               const size_t *pxItemSizes,
+                               size_t xItemNum,
+                               TickType_t xTicksToWait);
+
+/**
+ * @brief   Acquire memory for multiple items from the ring buffer
+ *
+ * Equivalent to calling xRingbufferSendAcquire() for each item, but under a single
+ * lock. This function will block until memory for all items is acquired or until
+ * it times out. Every acquired item must be sent with xRingbufferSendComplete() or
+ * xRingbufferSendCompleteMultiple().
+ *
+ * @param[in]   xRingbuffer     Ring buffer to allocate the memory
+ * @param[out]  ppvItems        Array filled with the memory acquired for each item (NULL if no memory was acquired)
+ * @param[in]   pxItemSizes     Array of the size of each item
+ * @param[in]   xItemNum        Number of items to acquire
+ * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
+ *
+ * @note    Only applicable for no-split ring buffers.
+ *
+ * @return  Number of items acquired. Those are always the first items of ppvItems.
+ */
+size_t xRingbufferSendAcquireMultiple(RingbufHandle_t xRingbuffer,
+                                      void **ppvItems,
+                                      const size_t *pxItemSizes,
+                                      size_t xItemNum,
+                                      TickType_t xTicksToWait);
+
+/**
+ * @brief   Actually send multiple items acquired using xRingbufferSendAcquire() or
+ *          xRingbufferSendAcquireMultiple()
+ *
+ * Equivalent to calling xRingbufferSendComplete() for each item, but under a single lock.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to insert the items into
+ * @param[in]   ppvItems        Array of the items acquired earlier
+ * @param[in]   xItemNum        Number of items
+ *
+ * @note    Only applicable for no-split ring buffers.
+ *
+ * @return  pdTRUE if succeeded
+ */
+BaseType_t xRingbufferSendCompleteMultiple(RingbufHandle_t xRingbuffer, void *const *ppvItems, size_t xItemNum);
+
+/**
+ * @brief   Retrieve multiple items from the ring buffer
+ *
+ * Retrieves all items which are available, up to xMaxItems, under a single lock.
+ * This function will block until at least one item is available or until it times out.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to retrieve the items from
+ * @param[out]  ppvItems        Array filled with pointers to the retrieved items
+ * @param[out]  pxItemSizes     Array filled with the size of each retrieved item
+ * @param[in]   xMaxItems       Maximum number of items to retrieve
+ * @param[in]   xTicksToWait    Ticks to wait for items in the ring buffer.
+ *
+ * @note    Every retrieved item must be returned with vRingbufferReturnItem() or
+ *          vRingbufferReturnItemMultiple().
+ * @note    Only applicable for no-split ring buffers. Byte buffers and allow-split buffers
+ *          are not supported, the function returns 0 for them without blocking. Use
+ *          xRingbufferReceiveUpTo() to retrieve multiple bytes from byte buffers, and
+ *          xRingbufferReceiveSplit() for allow-split buffers.
+ *
+ * @return  Number of items retrieved, 0 on time-out or if the ring buffer is not a no-split buffer.
+ */
+size_t xRingbufferReceiveMultiple(RingbufHandle_t xRingbuffer,
+                                  void **ppvItems,
+                                  size_t *pxItemSizes,
+                                  size_t xMaxItems,
+                                  TickType_t xTicksToWait);
+
+/**
+ * @brief   Return multiple previously-retrieved items to the ring buffer
+ *
+ * Equivalent to calling vRingbufferReturnItem() for each item, but under a single
+ * lock, and a waiting sender is unblocked only once.
+ *
+ * @param[in]   xRingbuffer     Ring buffer the items were retrieved from
+ * @param[in]   ppvItems        Array of the items received earlier
+ * @param[in]   xItemNum        Number of items
+ */
+void vRingbufferReturnItemMultiple(RingbufHandle_t xRingbuffer, void *const *ppvItems, size_t xItemNum);
+
 /**
  * @brief   Delete a ring buffer
  *
@@ -7,6 +7,7 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/list.h"
 #include "freertos/task.h"
@@ -27,6 +28,11 @@
 #define rbBUFFER_FULL_FLAG          ( ( UBaseType_t ) 4 )   //The ring buffer is currently full (write pointer == free pointer)
 #define rbBUFFER_STATIC_FLAG        ( ( UBaseType_t ) 8 )   //The ring buffer is statically allocated
 #define rbUSING_QUEUE_SET           ( ( UBaseType_t ) 16 )  //The ring buffer has been added to a queue set
+#define rbSPSC_FLAG                 ( ( UBaseType_t ) 32 )  //The ring buffer is a single-producer/single-consumer buffer
+
+//Blocked tasks of single-producer/single-consumer ring buffers
+#define rbSPSC_RECEIVER_WAITING     ( ( size_t ) 1 )        //A task is blocked waiting to receive
+#define rbSPSC_SENDER_WAITING       ( ( size_t ) 2 )        //A task is blocked waiting to send/acquire
 
 //Item flags
 #define rbITEM_FREE_FLAG            ( ( UBaseType_t ) 1 )   //Item has been retrieved and returned by application, free to overwrite
@@ -73,6 +79,19 @@ typedef struct RingbufferDefinition {
     QueueSetHandle_t xQueueSet;                 //Ring buffer's read queue set handle.
 
     portMUX_TYPE mux;                           //Spinlock required for SMP
+
+    /*
+     * Single-producer/single-consumer buffers only. The pointers above are only accessed by the side
+     * that owns them (pucAcquire/pucWrite by the producer, pucRead/pucFree by the consumer), the sides
+     * synchronize through the following monotonic byte counts, which include the bytes skipped at wrap around.
+     */
+    atomic_size_t xSPSCAcquired;                //Bytes acquired by the producer
+    atomic_size_t xSPSCWritten;                 //Bytes sent by the producer, available to the consumer
+    atomic_size_t xSPSCRead;                    //Bytes retrieved by the consumer
+    atomic_size_t xSPSCFreed;                   //Bytes returned by the consumer, available to the producer
+    atomic_size_t xSPSCItemsSent;               //Number of items/item parts sent
+    atomic_size_t xSPSCItemsReceived;           //Number of items/item parts retrieved
+    atomic_size_t xSPSCWaiting;                 //rbSPSC_RECEIVER_WAITING/rbSPSC_SENDER_WAITING, set by blocked tasks
 } Ringbuffer_t;
 
 _Static_assert(sizeof(StaticRingbuffer_t) == sizeof(Ringbuffer_t), "StaticRingbuffer_t != Ringbuffer_t");
@@ -202,6 +221,95 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
                                            size_t *xItemSize2,
                                            size_t xMaxSize);
 
+/*
+Generic function used to send or acquire multiple items in a single critical section.
+If ppvAcquired is not NULL, items are acquired instead of copied from ppvItems.
+Blocks until all items were sent/acquired or until timeout. Returns the number of
+items sent/acquired, which are always the first items of the list.
+*/
+static size_t prvSendAcquireMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                            const void *const *ppvItems,
+                                            void **ppvAcquired,
+                                            const size_t *pxItemSizes,
+                                            size_t xItemNum,
+                                            TickType_t xTicksToWait);
+
+/*
+Generic function used to retrieve multiple items from no-split ring buffers in a single
+critical section. Blocks until at least one item is available or until timeout.
+Returns the number of items retrieved.
+*/
+static size_t prvReceiveMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                        void **ppvItems,
+                                        size_t *pxItemSizes,
+                                        size_t xMaxItems,
+                                        TickType_t xTicksToWait);
+
+/*
+ * The following functions implement single-producer/single-consumer ring buffers. They don't need a
+ * critical section, but each of them may only be called by the side (producer or consumer) it belongs to.
+ */
+
+//Producer: acquire space for an item in a no-split buffer. Returns NULL if the item doesn't currently fit
+static uint8_t *prvSPSCAcquireItemNoSplit(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
+
+//Producer: mark an acquired item of a no-split buffer as written and make written items available to the consumer
+static void prvSPSCSendItemDoneNoSplit(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
+//Producer: copy an item into the buffer and make it available to the consumer. Returns pdFALSE if the item doesn't currently fit
+static BaseType_t prvSPSCCopyItem(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+
+//Consumer: check if an item/data is currently available for retrieval
+static BaseType_t prvSPSCCheckItemAvail(Ringbuffer_t *pxRingbuffer);
+
+//Consumer: retrieve an item/data, same semantics as prvReceiveGenericFromISR()
+static BaseType_t prvSPSCGetItem(Ringbuffer_t *pxRingbuffer,
+                                 void **pvItem1,
+                                 void **pvItem2,
+                                 size_t *xItemSize1,
+                                 size_t *xItemSize2,
+                                 size_t xMaxSize);
+
+//Consumer: return an item/data and make the freed space available to the producer
+static void prvSPSCReturnItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
+//Unblock the task waiting for the given event, if any. Only enters the critical section if a task is blocked
+static void prvSPSCWakeWaiting(Ringbuffer_t *pxRingbuffer, size_t xWaiter, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken);
+
+//Block until prvSPSCCopyItem() or prvSPSCAcquireItemNoSplit() succeeds, same semantics as prvSendAcquireGeneric()
+static BaseType_t prvSPSCSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
+                                            const void *pvItem,
+                                            void **ppvItem,
+                                            size_t xItemSize,
+                                            TickType_t xTicksToWait);
+
+//Block until prvSPSCGetItem() succeeds, same semantics as prvReceiveGeneric()
+static BaseType_t prvSPSCReceiveGeneric(Ringbuffer_t *pxRingbuffer,
+                                        void **pvItem1,
+                                        void **pvItem2,
+                                        size_t *xItemSize1,
+                                        size_t *xItemSize2,
+                                        size_t xMaxSize,
+                                        TickType_t xTicksToWait);
+
+//Get the maximum size an item that can currently have if sent to a single-producer/single-consumer buffer
+static size_t prvSPSCGetCurMaxSize(Ringbuffer_t *pxRingbuffer);
+
+//Single-producer/single-consumer version of prvSendAcquireMultipleGeneric()
+static size_t prvSPSCSendAcquireMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                                const void *const *ppvItems,
+                                                void **ppvAcquired,
+                                                const size_t *pxItemSizes,
+                                                size_t xItemNum,
+                                                TickType_t xTicksToWait);
+
+//Single-producer/single-consumer version of prvReceiveMultipleGeneric()
+static size_t prvSPSCReceiveMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                            void **ppvItems,
+                                            size_t *pxItemSizes,
+                                            size_t xMaxItems,
+                                            TickType_t xTicksToWait);
+
 // ------------------------------------------------ Static Functions ---------------------------------------------------
 
 static void prvInitializeNewRingbuffer(size_t xBufferSize,
@@ -257,6 +365,14 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
     pxNewRingbuffer->xQueueSet = NULL;
 
     portMUX_INITIALIZE(&pxNewRingbuffer->mux);
+
+    atomic_init(&pxNewRingbuffer->xSPSCAcquired, 0);
+    atomic_init(&pxNewRingbuffer->xSPSCWritten, 0);
+    atomic_init(&pxNewRingbuffer->xSPSCRead, 0);
+    atomic_init(&pxNewRingbuffer->xSPSCFreed, 0);
+    atomic_init(&pxNewRingbuffer->xSPSCItemsSent, 0);
+    atomic_init(&pxNewRingbuffer->xSPSCItemsReceived, 0);
+    atomic_init(&pxNewRingbuffer->xSPSCWaiting, 0);
 }
 
 static size_t prvGetFreeSize(Ringbuffer_t *pxRingbuffer)
@@ -837,6 +953,10 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
 
     ESP_STATIC_ANALYZER_CHECK(!pvItem1 || !xItemSize1, pdFALSE);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSPSCReceiveGeneric(pxRingbuffer, pvItem1, pvItem2, xItemSize1, xItemSize2, xMaxSize, xTicksToWait);
+    }
+
     while (xExitLoop == pdFALSE) {
         portENTER_CRITICAL(&pxRingbuffer->mux);
         if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
@@ -899,6 +1019,10 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
 
     ESP_STATIC_ANALYZER_CHECK(!pvItem1 || !xItemSize1, pdFALSE);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSPSCGetItem(pxRingbuffer, pvItem1, pvItem2, xItemSize1, xItemSize2, xMaxSize);
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
         BaseType_t xIsSplit = pdFALSE;
@@ -929,6 +1053,699 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
     return xReturn;
 }
 
+static size_t prvSendAcquireMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                            const void *const *ppvItems,
+                                            void **ppvAcquired,
+                                            const size_t *pxItemSizes,
+                                            size_t xItemNum,
+                                            TickType_t xTicksToWait)
+{
+    size_t xSent = 0;
+    size_t xNotifyQueueSet = 0;
+    BaseType_t xExitLoop = pdFALSE;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (xExitLoop == pdFALSE) {
+        size_t xSentBefore = xSent;
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        //Send/acquire as many items as currently fit
+        while (xSent < xItemNum && pxRingbuffer->xCheckItemFits(pxRingbuffer, pxItemSizes[xSent]) == pdTRUE) {
+            if (ppvAcquired) {
+                ppvAcquired[xSent] = prvAcquireItemNoSplit(pxRingbuffer, pxItemSizes[xSent]);
+            } else if (!(pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) || pxItemSizes[xSent] > 0) {
+                pxRingbuffer->vCopyItem(pxRingbuffer, ppvItems[xSent], pxItemSizes[xSent]);
+            }
+            xSent++;
+        }
+        if (ppvAcquired == NULL && xSent > xSentBefore) {
+            if (pxRingbuffer->xQueueSet) {
+                //If ring buffer was added to a queue set, notify the queue set once per item
+                xNotifyQueueSet += xSent - xSentBefore;
+            } else {
+                //If a task was waiting for data to arrive on the ring buffer, unblock it immediately.
+                if (listLIST_IS_EMPTY(&pxRingbuffer->xTasksWaitingToReceive) == pdFALSE) {
+                    if (xTaskRemoveFromEventList(&pxRingbuffer->xTasksWaitingToReceive) == pdTRUE) {
+                        //The unblocked task will preempt us. Trigger a yield here.
+                        portYIELD_WITHIN_API();
+                    }
+                }
+            }
+        }
+        if (xSent == xItemNum || xTicksToWait == (TickType_t) 0) {
+            //All items sent, or no block time. Return immediately.
+            xExitLoop = pdTRUE;
+            goto loop_end;
+        } else if (xSent > xSentBefore) {
+            //Let the receiver (or the queue set) see the sent items before blocking, then retry
+            goto loop_end;
+        } else if (xEntryTimeSet == pdFALSE) {
+            //This is our first block. Set entry time
+            vTaskInternalSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+
+        if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE) {
+            //Not timed out yet. Block the current task
+            vTaskPlaceOnEventList(&pxRingbuffer->xTasksWaitingToSend, xTicksToWait);
+            portYIELD_WITHIN_API();
+        } else {
+            //We have timed out
+            xExitLoop = pdTRUE;
+        }
+loop_end:
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+        //Notify the queue set outside of the critical section.
+        for (; xNotifyQueueSet > 0; xNotifyQueueSet--) {
+            xQueueSend((QueueHandle_t)pxRingbuffer->xQueueSet, (QueueSetMemberHandle_t *)&pxRingbuffer, 0);
+        }
+    }
+
+    return xSent;
+}
+
+static size_t prvReceiveMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                        void **ppvItems,
+                                        size_t *pxItemSizes,
+                                        size_t xMaxItems,
+                                        TickType_t xTicksToWait)
+{
+    size_t xReceived = 0;
+    BaseType_t xExitLoop = pdFALSE;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (xExitLoop == pdFALSE) {
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        //Retrieve as many items as are currently available
+        while (xReceived < xMaxItems && prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+            BaseType_t xIsSplit = pdFALSE;
+            ppvItems[xReceived] = pxRingbuffer->pvGetItem(pxRingbuffer, &xIsSplit, 0, &pxItemSizes[xReceived]);
+            xReceived++;
+        }
+        if (xReceived > 0 || xTicksToWait == (TickType_t) 0) {
+            xExitLoop = pdTRUE;
+            goto loop_end;
+        } else if (xEntryTimeSet == pdFALSE) {
+            //This is our first block. Set entry time
+            vTaskInternalSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+
+        if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE) {
+            //Not timed out yet. Block the current task
+            vTaskPlaceOnEventList(&pxRingbuffer->xTasksWaitingToReceive, xTicksToWait);
+            portYIELD_WITHIN_API();
+        } else {
+            //We have timed out.
+            xExitLoop = pdTRUE;
+        }
+loop_end:
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+
+    return xReceived;
+}
+
+// -------------------------------------- Single-Producer/Single-Consumer Functions ------------------------------------
+
+/*
+ * Items are laid out exactly as in the other ring buffers (same headers, dummy items and split items), but
+ * instead of the buffer full flag and the item counts, which would have to be updated by both sides under the
+ * spinlock, the producer and the consumer publish monotonic byte counts. The producer only reads xSPSCFreed and
+ * the consumer only reads xSPSCWritten, so every operation is lock-free. The spinlock is only taken to block a
+ * task, or to unblock a task if one is actually blocked.
+ */
+
+static inline size_t prvSPSCFreeSize(Ringbuffer_t *pxRingbuffer)
+{
+    //Acquire pairs with the release in prvSPSCReturnItem(), the freed space may be overwritten afterwards
+    return pxRingbuffer->xSize - (atomic_load_explicit(&pxRingbuffer->xSPSCAcquired, memory_order_relaxed) -
+                                  atomic_load_explicit(&pxRingbuffer->xSPSCFreed, memory_order_acquire));
+}
+
+static inline void prvSPSCAdvanceAcquire(Ringbuffer_t *pxRingbuffer, size_t xLen)
+{
+    atomic_store_explicit(&pxRingbuffer->xSPSCAcquired,
+                          atomic_load_explicit(&pxRingbuffer->xSPSCAcquired, memory_order_relaxed) + xLen,
+                          memory_order_relaxed);
+}
+
+static inline void prvSPSCPublishWritten(Ringbuffer_t *pxRingbuffer, size_t xWritten, size_t xItems)
+{
+    atomic_store_explicit(&pxRingbuffer->xSPSCItemsSent,
+                          atomic_load_explicit(&pxRingbuffer->xSPSCItemsSent, memory_order_relaxed) + xItems,
+                          memory_order_relaxed);
+    //Release pairs with the acquire in prvSPSCCheckItemAvail(), the item contents must be visible first
+    atomic_store_explicit(&pxRingbuffer->xSPSCWritten, xWritten, memory_order_release);
+}
+
+static uint8_t *prvSPSCAcquireItemNoSplit(Ringbuffer_t *pxRingbuffer, size_t xItemSize)
+{
+    size_t xTotalItemSize = rbALIGN_SIZE(xItemSize) + rbHEADER_SIZE;      //Rounded up aligned item size with header
+    size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;    //Length from pucAcquire until end of buffer
+    configASSERT(rbCHECK_ALIGNED(pxRingbuffer->pucAcquire));
+    configASSERT(xRemLen >= rbHEADER_SIZE);                             //Remaining length must be able to at least fit an item header
+
+    //If the item doesn't fit in the remaining length, the remaining length is skipped
+    size_t xSkipLen = (xRemLen < xTotalItemSize) ? xRemLen : 0;
+    if (xSkipLen + xTotalItemSize > prvSPSCFreeSize(pxRingbuffer)) {
+        return NULL;
+    }
+    if (xSkipLen > 0) {
+        ItemHeader_t *pxDummy = (ItemHeader_t *)pxRingbuffer->pucAcquire;
+        pxDummy->uxItemFlags = rbITEM_DUMMY_DATA_FLAG;
+        pxDummy->xItemLen = 0;
+        pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;
+    }
+
+    ItemHeader_t *pxHeader = (ItemHeader_t *)pxRingbuffer->pucAcquire;
+    pxHeader->xItemLen = xItemSize;
+    pxHeader->uxItemFlags = 0;
+    uint8_t *pucItem = pxRingbuffer->pucAcquire + rbHEADER_SIZE;
+    pxRingbuffer->pucAcquire += xTotalItemSize;
+
+    //Padding which can't fit a header is skipped as well
+    size_t xPadLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;
+    if (xPadLen < rbHEADER_SIZE) {
+        pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;
+    } else {
+        xPadLen = 0;
+    }
+    prvSPSCAdvanceAcquire(pxRingbuffer, xSkipLen + xTotalItemSize + xPadLen);
+    return pucItem;
+}
+
+static void prvSPSCSendItemDoneNoSplit(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    configASSERT(rbCHECK_ALIGNED(pucItem));
+    configASSERT(pucItem >= pxRingbuffer->pucHead && pucItem <= pxRingbuffer->pucTail);
+
+    ItemHeader_t *pxCurHeader = (ItemHeader_t *)(pucItem - rbHEADER_SIZE);
+    configASSERT((pxCurHeader->uxItemFlags & (rbITEM_DUMMY_DATA_FLAG | rbITEM_WRITTEN_FLAG)) == 0);
+    pxCurHeader->uxItemFlags |= rbITEM_WRITTEN_FLAG;
+
+    //Items might not be written in the order they were acquired. Publish the written items preceding the first unwritten one
+    size_t xAcquired = atomic_load_explicit(&pxRingbuffer->xSPSCAcquired, memory_order_relaxed);
+    size_t xWritten = atomic_load_explicit(&pxRingbuffer->xSPSCWritten, memory_order_relaxed);
+    size_t xItems = 0;
+    while (xWritten != xAcquired) {
+        pxCurHeader = (ItemHeader_t *)pxRingbuffer->pucWrite;
+        if (pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) {
+            xWritten += pxRingbuffer->pucTail - pxRingbuffer->pucWrite;
+            pxRingbuffer->pucWrite = pxRingbuffer->pucHead;
+            continue;
+        }
+        if ((pxCurHeader->uxItemFlags & rbITEM_WRITTEN_FLAG) == 0) {
+            break;
+        }
+        size_t xLen = rbHEADER_SIZE + rbALIGN_SIZE(pxCurHeader->xItemLen);
+        pxRingbuffer->pucWrite += xLen;
+        xWritten += xLen;
+        if ((size_t)(pxRingbuffer->pucTail - pxRingbuffer->pucWrite) < rbHEADER_SIZE) {
+            xWritten += pxRingbuffer->pucTail - pxRingbuffer->pucWrite;
+            pxRingbuffer->pucWrite = pxRingbuffer->pucHead;
+        }
+        xItems++;
+    }
+    prvSPSCPublishWritten(pxRingbuffer, xWritten, xItems);
+}
+
+static BaseType_t prvSPSCCopyItem(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+{
+    size_t xFreeSize = prvSPSCFreeSize(pxRingbuffer);
+    size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;
+    size_t xUsedLen;
+    size_t xItems = 1;
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        if (xItemSize > xFreeSize) {
+            return pdFALSE;
+        }
+        if (xRemLen <= xItemSize) {
+            //Copy as much as possible into the remaining length, and the rest from the start of the buffer
+            memcpy(pxRingbuffer->pucAcquire, pucItem, xRemLen);
+            memcpy(pxRingbuffer->pucHead, pucItem + xRemLen, xItemSize - xRemLen);
+            pxRingbuffer->pucAcquire = pxRingbuffer->pucHead + (xItemSize - xRemLen);
+        } else {
+            memcpy(pxRingbuffer->pucAcquire, pucItem, xItemSize);
+            pxRingbuffer->pucAcquire += xItemSize;
+        }
+        xUsedLen = xItemSize;
+        xItems = xItemSize;
+    } else if (pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG) {
+        size_t xAlignedItemSize = rbALIGN_SIZE(xItemSize);
+        configASSERT(rbCHECK_ALIGNED(pxRingbuffer->pucAcquire));
+        configASSERT(xRemLen >= rbHEADER_SIZE);
+        //Splitting the item incurs an extra header
+        BaseType_t xSplit = (xRemLen < xAlignedItemSize + rbHEADER_SIZE) ? pdTRUE : pdFALSE;
+        if (xAlignedItemSize + rbHEADER_SIZE * (xSplit ? 2 : 1) > xFreeSize) {
+            return pdFALSE;
+        }
+        xUsedLen = 0;
+        if (xSplit) {
+            //Write first part of the item, or a dummy header if only a header fits
+            ItemHeader_t *pxFirstHeader = (ItemHeader_t *)pxRingbuffer->pucAcquire;
+            size_t xFirstLen = xRemLen - rbHEADER_SIZE;
+            pxFirstHeader->xItemLen = xFirstLen;
+            if (xFirstLen > 0) {
+                memcpy(pxRingbuffer->pucAcquire + rbHEADER_SIZE, pucItem, xFirstLen);
+                pxFirstHeader->uxItemFlags = rbITEM_SPLIT_FLAG;
+                pucItem += xFirstLen;
+                xItemSize -= xFirstLen;
+                xAlignedItemSize -= xFirstLen;
+                xItems++;
+            } else {
+                pxFirstHeader->uxItemFlags = rbITEM_DUMMY_DATA_FLAG;
+            }
+            pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;
+            xUsedLen = xRemLen;
+        }
+        ItemHeader_t *pxSecondHeader = (ItemHeader_t *)pxRingbuffer->pucAcquire;
+        pxSecondHeader->xItemLen = xItemSize;
+        pxSecondHeader->uxItemFlags = 0;
+        memcpy(pxRingbuffer->pucAcquire + rbHEADER_SIZE, pucItem, xItemSize);
+        pxRingbuffer->pucAcquire += rbHEADER_SIZE + xAlignedItemSize;
+        xUsedLen += rbHEADER_SIZE + xAlignedItemSize;
+        //Padding which can't fit a header is skipped
+        xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;
+        if (xRemLen < rbHEADER_SIZE) {
+            xUsedLen += xRemLen;
+            pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;
+        }
+    } else {
+        uint8_t *pucDest = prvSPSCAcquireItemNoSplit(pxRingbuffer, xItemSize);
+        if (pucDest == NULL) {
+            return pdFALSE;
+        }
+        memcpy(pucDest, pucItem, xItemSize);
+        prvSPSCSendItemDoneNoSplit(pxRingbuffer, pucDest);
+        return pdTRUE;
+    }
+
+    if (pxRingbuffer->pucAcquire == pxRingbuffer->pucTail) {
+        pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;
+    }
+    //Items are copied in order, so everything acquired is written
+    pxRingbuffer->pucWrite = pxRingbuffer->pucAcquire;
+    prvSPSCAdvanceAcquire(pxRingbuffer, xUsedLen);
+    prvSPSCPublishWritten(pxRingbuffer, atomic_load_explicit(&pxRingbuffer->xSPSCAcquired, memory_order_relaxed), xItems);
+    return pdTRUE;
+}
+
+static BaseType_t prvSPSCCheckItemAvail(Ringbuffer_t *pxRingbuffer)
+{
+    size_t xRead = atomic_load_explicit(&pxRingbuffer->xSPSCRead, memory_order_relaxed);
+    if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) &&
+            xRead != atomic_load_explicit(&pxRingbuffer->xSPSCFreed, memory_order_relaxed)) {
+        return pdFALSE;     //Byte buffers do not allow multiple retrievals before return
+    }
+    return (atomic_load_explicit(&pxRingbuffer->xSPSCWritten, memory_order_acquire) != xRead) ? pdTRUE : pdFALSE;
+}
+
+static BaseType_t prvSPSCGetItem(Ringbuffer_t *pxRingbuffer,
+                                 void **pvItem1,
+                                 void **pvItem2,
+                                 size_t *xItemSize1,
+                                 size_t *xItemSize2,
+                                 size_t xMaxSize)
+{
+    ESP_STATIC_ANALYZER_CHECK(!pvItem1 || !xItemSize1, pdFALSE);
+
+    if (prvSPSCCheckItemAvail(pxRingbuffer) == pdFALSE) {
+        return pdFALSE;
+    }
+    size_t xWritten = atomic_load_explicit(&pxRingbuffer->xSPSCWritten, memory_order_acquire);
+    size_t xRead = atomic_load_explicit(&pxRingbuffer->xSPSCRead, memory_order_relaxed);
+    size_t xItems = 1;
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        //Return contiguous data from the read pointer, up to xMaxSize
+        size_t xLen = xWritten - xRead;
+        if (xLen > (size_t)(pxRingbuffer->pucTail - pxRingbuffer->pucRead)) {
+            xLen = pxRingbuffer->pucTail - pxRingbuffer->pucRead;
+        }
+        if (xMaxSize != 0 && xLen > xMaxSize) {
+            xLen = xMaxSize;
+        }
+        *pvItem1 = pxRingbuffer->pucRead;
+        *xItemSize1 = xLen;
+        pxRingbuffer->pucRead += xLen;
+        if (pxRingbuffer->pucRead == pxRingbuffer->pucTail) {
+            pxRingbuffer->pucRead = pxRingbuffer->pucHead;
+        }
+        xRead += xLen;
+        xItems = xLen;
+    } else {
+        BaseType_t xIsSplit = pdFALSE;
+        for (int i = 0; i < 2; i++) {
+            ItemHeader_t *pxHeader = (ItemHeader_t *)pxRingbuffer->pucRead;
+            //Skip dummy data, it may be published before the item following it
+            if (pxHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) {
+                xRead += pxRingbuffer->pucTail - pxRingbuffer->pucRead;
+                pxRingbuffer->pucRead = pxRingbuffer->pucHead;
+                if (xRead == xWritten) {
+                    atomic_store_explicit(&pxRingbuffer->xSPSCRead, xRead, memory_order_relaxed);
+                    return pdFALSE;
+                }
+                pxHeader = (ItemHeader_t *)pxRingbuffer->pucRead;
+            }
+            configASSERT(pxHeader->xItemLen <= pxRingbuffer->xMaxItemSize);
+            if (i == 0) {
+                *pvItem1 = pxRingbuffer->pucRead + rbHEADER_SIZE;
+                *xItemSize1 = pxHeader->xItemLen;
+            } else {
+                *pvItem2 = pxRingbuffer->pucRead + rbHEADER_SIZE;
+                *xItemSize2 = pxHeader->xItemLen;
+                xItems++;
+            }
+            xIsSplit = (pxHeader->uxItemFlags & rbITEM_SPLIT_FLAG) ? pdTRUE : pdFALSE;
+            size_t xLen = rbHEADER_SIZE + rbALIGN_SIZE(pxHeader->xItemLen);
+            pxRingbuffer->pucRead += xLen;
+            xRead += xLen;
+            if ((size_t)(pxRingbuffer->pucTail - pxRingbuffer->pucRead) < rbHEADER_SIZE) {
+                xRead += pxRingbuffer->pucTail - pxRingbuffer->pucRead;
+                pxRingbuffer->pucRead = pxRingbuffer->pucHead;
+            }
+            //Both parts of a split item are published together
+            if (xIsSplit == pdFALSE) {
+                break;
+            }
+            configASSERT(xRead != xWritten);
+        }
+        if (pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG) {
+            ESP_STATIC_ANALYZER_CHECK(!pvItem2 || !xItemSize2, pdFALSE);
+            if (xItems == 1) {
+                *pvItem2 = NULL;
+            }
+        }
+    }
+
+    atomic_store_explicit(&pxRingbuffer->xSPSCItemsReceived,
+                          atomic_load_explicit(&pxRingbuffer->xSPSCItemsReceived, memory_order_relaxed) + xItems,
+                          memory_order_relaxed);
+    atomic_store_explicit(&pxRingbuffer->xSPSCRead, xRead, memory_order_relaxed);
+    return pdTRUE;
+}
+
+static void prvSPSCReturnItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    configASSERT(pucItem >= pxRingbuffer->pucHead && pucItem <= pxRingbuffer->pucTail);
+    size_t xRead = atomic_load_explicit(&pxRingbuffer->xSPSCRead, memory_order_relaxed);
+    size_t xFreed;
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        //Byte buffers do not allow multiple outstanding reads
+        pxRingbuffer->pucFree = pxRingbuffer->pucRead;
+        xFreed = xRead;
+    } else {
+        configASSERT(rbCHECK_ALIGNED(pucItem));
+        ItemHeader_t *pxCurHeader = (ItemHeader_t *)(pucItem - rbHEADER_SIZE);
+        configASSERT((pxCurHeader->uxItemFlags & (rbITEM_DUMMY_DATA_FLAG | rbITEM_FREE_FLAG)) == 0);
+        pxCurHeader->uxItemFlags |= rbITEM_FREE_FLAG;
+
+        //Items might not be returned in the order they were retrieved. Free the returned items preceding the first outstanding one
+        xFreed = atomic_load_explicit(&pxRingbuffer->xSPSCFreed, memory_order_relaxed);
+        while (xFreed != xRead) {
+            pxCurHeader = (ItemHeader_t *)pxRingbuffer->pucFree;
+            if (pxCurHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) {
+                xFreed += pxRingbuffer->pucTail - pxRingbuffer->pucFree;
+                pxRingbuffer->pucFree = pxRingbuffer->pucHead;
+                continue;
+            }
+            if ((pxCurHeader->uxItemFlags & rbITEM_FREE_FLAG) == 0) {
+                break;
+            }
+            size_t xLen = rbHEADER_SIZE + rbALIGN_SIZE(pxCurHeader->xItemLen);
+            pxRingbuffer->pucFree += xLen;
+            xFreed += xLen;
+            if ((size_t)(pxRingbuffer->pucTail - pxRingbuffer->pucFree) < rbHEADER_SIZE) {
+                xFreed += pxRingbuffer->pucTail - pxRingbuffer->pucFree;
+                pxRingbuffer->pucFree = pxRingbuffer->pucHead;
+            }
+        }
+    }
+    //Release pairs with the acquire in prvSPSCFreeSize(), the returned items must not be accessed afterwards
+    atomic_store_explicit(&pxRingbuffer->xSPSCFreed, xFreed, memory_order_release);
+}
+
+static void prvSPSCWakeWaiting(Ringbuffer_t *pxRingbuffer, size_t xWaiter, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    //Pairs with the fence in prvSPSCBlock(): either the blocking task sees the new state, or we see its flag
+    atomic_thread_fence(memory_order_seq_cst);
+    if ((atomic_load_explicit(&pxRingbuffer->xSPSCWaiting, memory_order_relaxed) & xWaiter) == 0) {
+        return;
+    }
+
+    List_t *pxList = (xWaiter == rbSPSC_RECEIVER_WAITING) ? &pxRingbuffer->xTasksWaitingToReceive : &pxRingbuffer->xTasksWaitingToSend;
+    if (xFromISR) {
+        portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+    }
+    atomic_fetch_and(&pxRingbuffer->xSPSCWaiting, ~xWaiter);
+    if (listLIST_IS_EMPTY(pxList) == pdFALSE) {
+        if (xTaskRemoveFromEventList(pxList) == pdTRUE) {
+            //The unblocked task will preempt us
+            if (!xFromISR) {
+                portYIELD_WITHIN_API();
+            } else if (pxHigherPriorityTaskWoken != NULL) {
+                *pxHigherPriorityTaskWoken = pdTRUE;
+            }
+        }
+    }
+    if (xFromISR) {
+        portEXIT_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+}
+
+//Notify the consumer about xItems sent items. The queue set is notified outside of any critical section
+static void prvSPSCNotifySent(Ringbuffer_t *pxRingbuffer, size_t xItems, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxRingbuffer->xQueueSet) {
+        for (size_t i = 0; i < xItems; i++) {
+            if (xFromISR) {
+                xQueueSendFromISR((QueueHandle_t)pxRingbuffer->xQueueSet, (QueueSetMemberHandle_t *)&pxRingbuffer, pxHigherPriorityTaskWoken);
+            } else {
+                xQueueSend((QueueHandle_t)pxRingbuffer->xQueueSet, (QueueSetMemberHandle_t *)&pxRingbuffer, 0);
+            }
+        }
+    } else {
+        prvSPSCWakeWaiting(pxRingbuffer, rbSPSC_RECEIVER_WAITING, xFromISR, pxHigherPriorityTaskWoken);
+    }
+}
+
+/*
+Block the calling task until the other side signals xWaiter, or until the timeout.
+Entry:
+    - xCanProceed(pxRingbuffer, xArg) returned pdFALSE
+Exit:
+    - pdTRUE if the operation should be retried, pdFALSE on timeout
+*/
+typedef BaseType_t (*SPSCConditionFunction_t)(Ringbuffer_t *pxRingbuffer, size_t xArg);
+
+static BaseType_t prvSPSCBlock(Ringbuffer_t *pxRingbuffer, size_t xWaiter, SPSCConditionFunction_t xCanProceed, size_t xArg,
+                               TimeOut_t *pxTimeOut, TickType_t *pxTicksToWait)
+{
+    BaseType_t xRetry = pdTRUE;
+    List_t *pxList = (xWaiter == rbSPSC_RECEIVER_WAITING) ? &pxRingbuffer->xTasksWaitingToReceive : &pxRingbuffer->xTasksWaitingToSend;
+
+    portENTER_CRITICAL(&pxRingbuffer->mux);
+    atomic_fetch_or(&pxRingbuffer->xSPSCWaiting, xWaiter);
+    //Pairs with the fence in prvSPSCWakeWaiting(). Check again after announcing that we are about to block
+    atomic_thread_fence(memory_order_seq_cst);
+    if (xCanProceed(pxRingbuffer, xArg) == pdFALSE) {
+        if (xTaskCheckForTimeOut(pxTimeOut, pxTicksToWait) == pdFALSE) {
+            vTaskPlaceOnEventList(pxList, *pxTicksToWait);
+            portYIELD_WITHIN_API();
+        } else {
+            xRetry = pdFALSE;
+        }
+    }
+    portEXIT_CRITICAL(&pxRingbuffer->mux);
+    return xRetry;
+}
+
+static BaseType_t prvSPSCCheckItemFits(Ringbuffer_t *pxRingbuffer, size_t xItemSize)
+{
+    //Conservative check, the worst case of an item wrapping around is assumed
+    size_t xFreeSize = prvSPSCFreeSize(pxRingbuffer);
+    size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        return (xItemSize <= xFreeSize) ? pdTRUE : pdFALSE;
+    }
+    size_t xTotalItemSize = rbALIGN_SIZE(xItemSize) + rbHEADER_SIZE;
+    if (xTotalItemSize <= xRemLen) {
+        return (xTotalItemSize <= xFreeSize) ? pdTRUE : pdFALSE;
+    }
+    if (pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG) {
+        return (xTotalItemSize + rbHEADER_SIZE <= xFreeSize) ? pdTRUE : pdFALSE;
+    }
+    return (xRemLen + xTotalItemSize <= xFreeSize) ? pdTRUE : pdFALSE;
+}
+
+static BaseType_t prvSPSCCheckItemAvailCondition(Ringbuffer_t *pxRingbuffer, size_t xUnusedArg)
+{
+    return prvSPSCCheckItemAvail(pxRingbuffer);
+}
+
+static BaseType_t prvSPSCSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
+                                            const void *pvItem,
+                                            void **ppvItem,
+                                            size_t xItemSize,
+                                            TickType_t xTicksToWait)
+{
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (1) {
+        if (ppvItem) {
+            *ppvItem = prvSPSCAcquireItemNoSplit(pxRingbuffer, xItemSize);
+            if (*ppvItem != NULL) {
+                return pdTRUE;
+            }
+        } else if (prvSPSCCopyItem(pxRingbuffer, pvItem, xItemSize) == pdTRUE) {
+            prvSPSCNotifySent(pxRingbuffer, 1, pdFALSE, NULL);
+            return pdTRUE;
+        }
+        if (xTicksToWait == (TickType_t) 0) {
+            return pdFALSE;
+        }
+        if (xEntryTimeSet == pdFALSE) {
+            vTaskSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+        if (prvSPSCBlock(pxRingbuffer, rbSPSC_SENDER_WAITING, prvSPSCCheckItemFits, xItemSize, &xTimeOut, &xTicksToWait) == pdFALSE) {
+            return pdFALSE;
+        }
+    }
+}
+
+static BaseType_t prvSPSCReceiveGeneric(Ringbuffer_t *pxRingbuffer,
+                                        void **pvItem1,
+                                        void **pvItem2,
+                                        size_t *xItemSize1,
+                                        size_t *xItemSize2,
+                                        size_t xMaxSize,
+                                        TickType_t xTicksToWait)
+{
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (1) {
+        if (prvSPSCGetItem(pxRingbuffer, pvItem1, pvItem2, xItemSize1, xItemSize2, xMaxSize) == pdTRUE) {
+            return pdTRUE;
+        }
+        if (xTicksToWait == (TickType_t) 0) {
+            return pdFALSE;
+        }
+        if (xEntryTimeSet == pdFALSE) {
+            vTaskSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+        if (prvSPSCBlock(pxRingbuffer, rbSPSC_RECEIVER_WAITING, prvSPSCCheckItemAvailCondition, 0, &xTimeOut, &xTicksToWait) == pdFALSE) {
+            return pdFALSE;
+        }
+    }
+}
+
+static size_t prvSPSCGetCurMaxSize(Ringbuffer_t *pxRingbuffer)
+{
+    BaseType_t xFreeSize = prvSPSCFreeSize(pxRingbuffer);
+    BaseType_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;
+
+    if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
+        return xFreeSize;
+    }
+    if (xFreeSize > xRemLen) {
+        if (pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG) {
+            //Free space wraps around, requires two headers
+            xFreeSize -= rbHEADER_SIZE;
+        } else {
+            //Largest contiguous free space
+            xFreeSize = (xRemLen > xFreeSize - xRemLen) ? xRemLen : xFreeSize - xRemLen;
+        }
+    }
+    xFreeSize -= rbHEADER_SIZE;
+
+    if (xFreeSize < 0) {
+        xFreeSize = 0;
+    } else if (xFreeSize > pxRingbuffer->xMaxItemSize) {
+        xFreeSize = pxRingbuffer->xMaxItemSize;
+    }
+    return xFreeSize;
+}
+
+static size_t prvSPSCSendAcquireMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                                const void *const *ppvItems,
+                                                void **ppvAcquired,
+                                                const size_t *pxItemSizes,
+                                                size_t xItemNum,
+                                                TickType_t xTicksToWait)
+{
+    size_t xSent = 0;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (1) {
+        size_t xSentBefore = xSent;
+        while (xSent < xItemNum) {
+            if (ppvAcquired) {
+                ppvAcquired[xSent] = prvSPSCAcquireItemNoSplit(pxRingbuffer, pxItemSizes[xSent]);
+                if (ppvAcquired[xSent] == NULL) {
+                    break;
+                }
+            } else if (!(pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) || pxItemSizes[xSent] > 0) {
+                if (prvSPSCCopyItem(pxRingbuffer, ppvItems[xSent], pxItemSizes[xSent]) == pdFALSE) {
+                    break;
+                }
+            }
+            xSent++;
+        }
+        if (ppvAcquired == NULL && xSent > xSentBefore) {
+            prvSPSCNotifySent(pxRingbuffer, xSent - xSentBefore, pdFALSE, NULL);
+        }
+        if (xSent == xItemNum || xTicksToWait == (TickType_t) 0) {
+            return xSent;
+        }
+        if (xEntryTimeSet == pdFALSE) {
+            vTaskSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+        if (prvSPSCBlock(pxRingbuffer, rbSPSC_SENDER_WAITING, prvSPSCCheckItemFits, pxItemSizes[xSent], &xTimeOut, &xTicksToWait) == pdFALSE) {
+            return xSent;
+        }
+    }
+}
+
+static size_t prvSPSCReceiveMultipleGeneric(Ringbuffer_t *pxRingbuffer,
+                                            void **ppvItems,
+                                            size_t *pxItemSizes,
+                                            size_t xMaxItems,
+                                            TickType_t xTicksToWait)
+{
+    size_t xReceived = 0;
+    if (prvSPSCReceiveGeneric(pxRingbuffer, &ppvItems[0], NULL, &pxItemSizes[0], NULL, 0, xTicksToWait) == pdTRUE) {
+        xReceived++;
+        while (xReceived < xMaxItems &&
+                prvSPSCGetItem(pxRingbuffer, &ppvItems[xReceived], NULL, &pxItemSizes[xReceived], NULL, 0) == pdTRUE) {
+            xReceived++;
+        }
+    }
+    return xReceived;
+}
+
+//Check if the ring buffer holds data that was not retrieved yet, regardless of its mode
+static BaseType_t prvRingbufferHasData(Ringbuffer_t *pxRingbuffer)
+{
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return (atomic_load(&pxRingbuffer->xSPSCWritten) != atomic_load(&pxRingbuffer->xSPSCRead)) ? pdTRUE : pdFALSE;
+    }
+    return prvCheckItemAvail(pxRingbuffer);
+}
+
 // ------------------------------------------------ Public Functions ---------------------------------------------------
 
 RingbufHandle_t xRingbufferCreate(size_t xBufferSize, RingbufferType_t xBufferType)
@@ -981,6 +1798,25 @@ RingbufHandle_t xRingbufferCreateStatic(size_t xBufferSize,
     return (RingbufHandle_t)pxNewRingbuffer;
 }
 
+RingbufHandle_t xRingbufferCreateSPSC(size_t xBufferSize, RingbufferType_t xBufferType)
+{
+    Ringbuffer_t *pxNewRingbuffer = (Ringbuffer_t *)xRingbufferCreate(xBufferSize, xBufferType);
+    if (pxNewRingbuffer != NULL) {
+        pxNewRingbuffer->uxRingbufferFlags |= rbSPSC_FLAG;
+    }
+    return (RingbufHandle_t)pxNewRingbuffer;
+}
+
+RingbufHandle_t xRingbufferCreateStaticSPSC(size_t xBufferSize,
+                                            RingbufferType_t xBufferType,
+                                            uint8_t *pucRingbufferStorage,
+                                            StaticRingbuffer_t *pxStaticRingbuffer)
+{
+    Ringbuffer_t *pxNewRingbuffer = (Ringbuffer_t *)xRingbufferCreateStatic(xBufferSize, xBufferType, pucRingbufferStorage, pxStaticRingbuffer);
+    pxNewRingbuffer->uxRingbufferFlags |= rbSPSC_FLAG;
+    return (RingbufHandle_t)pxNewRingbuffer;
+}
+
 BaseType_t xRingbufferSendAcquire(RingbufHandle_t xRingbuffer, void **ppvItem, size_t xItemSize, TickType_t xTicksToWait)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
@@ -995,6 +1831,9 @@ BaseType_t xRingbufferSendAcquire(RingbufHandle_t xRingbuffer, void **ppvItem, s
         return pdFALSE;     //Data will never ever fit in the queue.
     }
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSPSCSendAcquireGeneric(pxRingbuffer, NULL, ppvItem, xItemSize, xTicksToWait);
+    }
     return prvSendAcquireGeneric(pxRingbuffer, NULL, ppvItem, xItemSize, xTicksToWait);
 }
 
@@ -1008,6 +1847,12 @@ BaseType_t xRingbufferSendComplete(RingbufHandle_t xRingbuffer, void *pvItem)
     configASSERT(pvItem != NULL);
     configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvSPSCSendItemDoneNoSplit(pxRingbuffer, pvItem);
+        prvSPSCNotifySent(pxRingbuffer, 1, pdFALSE, NULL);
+        return pdTRUE;
+    }
+
     portENTER_CRITICAL(&pxRingbuffer->mux);
     prvSendItemDoneNoSplit(pxRingbuffer, pvItem);
     if (pxRingbuffer->xQueueSet) {
@@ -1047,6 +1892,9 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSPSCSendAcquireGeneric(pxRingbuffer, pvItem, NULL, xItemSize, xTicksToWait);
+    }
     return prvSendAcquireGeneric(pxRingbuffer, pvItem, NULL, xItemSize, xTicksToWait);
 }
 
@@ -1069,6 +1917,14 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        xReturn = prvSPSCCopyItem(pxRingbuffer, pvItem, xItemSize);
+        if (xReturn == pdTRUE) {
+            prvSPSCNotifySent(pxRingbuffer, 1, pdTRUE, pxHigherPriorityTaskWoken);
+        }
+        return xReturn;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     if (pxRingbuffer->xCheckItemFits(xRingbuffer, xItemSize) == pdTRUE) {
         pxRingbuffer->vCopyItem(xRingbuffer, pvItem, xItemSize);
@@ -1212,6 +2068,12 @@ void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem)
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvSPSCReturnItem(pxRingbuffer, (uint8_t *)pvItem);
+        prvSPSCWakeWaiting(pxRingbuffer, rbSPSC_SENDER_WAITING, pdFALSE, NULL);
+        return;
+    }
+
     portENTER_CRITICAL(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1230,6 +2092,12 @@ void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, Bas
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvSPSCReturnItem(pxRingbuffer, (uint8_t *)pvItem);
+        prvSPSCWakeWaiting(pxRingbuffer, rbSPSC_SENDER_WAITING, pdTRUE, pxHigherPriorityTaskWoken);
+        return;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1244,6 +2112,165 @@ void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, Bas
     portEXIT_CRITICAL_ISR(&pxRingbuffer->mux);
 }
 
+size_t xRingbufferSendMultiple(RingbufHandle_t xRingbuffer,
+                               const void *const *ppvItems,
+                               const size_t *pxItemSizes,
+                               size_t xItemNum,
+                               TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+
+    //Check arguments
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL && pxItemSizes != NULL);
+    for (size_t i = 0; i < xItemNum; i++) {
+        configASSERT(ppvItems[i] != NULL || pxItemSizes[i] == 0);
+        if (pxItemSizes[i] > pxRingbuffer->xMaxItemSize) {
+            xItemNum = i;   //Data will never ever fit in the queue. Send the items before it.
+            break;
+        }
+    }
+    if (xItemNum == 0) {
+        return 0;
+    }
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSPSCSendAcquireMultipleGeneric(pxRingbuffer, ppvItems, NULL, pxItemSizes, xItemNum, xTicksToWait);
+    }
+    return prvSendAcquireMultipleGeneric(pxRingbuffer, ppvItems, NULL, pxItemSizes, xItemNum, xTicksToWait);
+}
+
+size_t xRingbufferSendAcquireMultiple(RingbufHandle_t xRingbuffer,
+                                      void **ppvItems,
+                                      const size_t *pxItemSizes,
+                                      size_t xItemNum,
+                                      TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+
+    //Check arguments
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL && pxItemSizes != NULL);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0); //Send acquire currently only supported in NoSplit buffers
+
+    for (size_t i = 0; i < xItemNum; i++) {
+        ppvItems[i] = NULL;
+        if (pxItemSizes[i] > pxRingbuffer->xMaxItemSize) {
+            xItemNum = i;   //Data will never ever fit in the queue. Acquire the items before it.
+            break;
+        }
+    }
+    if (xItemNum == 0) {
+        return 0;
+    }
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSPSCSendAcquireMultipleGeneric(pxRingbuffer, NULL, ppvItems, pxItemSizes, xItemNum, xTicksToWait);
+    }
+    return prvSendAcquireMultipleGeneric(pxRingbuffer, NULL, ppvItems, pxItemSizes, xItemNum, xTicksToWait);
+}
+
+BaseType_t xRingbufferSendCompleteMultiple(RingbufHandle_t xRingbuffer, void *const *ppvItems, size_t xItemNum)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+
+    //Check arguments
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0);
+    if (xItemNum == 0) {
+        return pdTRUE;
+    }
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        for (size_t i = 0; i < xItemNum; i++) {
+            configASSERT(ppvItems[i] != NULL);
+            prvSPSCSendItemDoneNoSplit(pxRingbuffer, ppvItems[i]);
+        }
+        prvSPSCNotifySent(pxRingbuffer, xItemNum, pdFALSE, NULL);
+        return pdTRUE;
+    }
+
+    portENTER_CRITICAL(&pxRingbuffer->mux);
+    for (size_t i = 0; i < xItemNum; i++) {
+        configASSERT(ppvItems[i] != NULL);
+        prvSendItemDoneNoSplit(pxRingbuffer, ppvItems[i]);
+    }
+    if (pxRingbuffer->xQueueSet == NULL) {
+        //If a task was waiting for data to arrive on the ring buffer, unblock it immediately.
+        if (listLIST_IS_EMPTY(&pxRingbuffer->xTasksWaitingToReceive) == pdFALSE) {
+            if (xTaskRemoveFromEventList(&pxRingbuffer->xTasksWaitingToReceive) == pdTRUE) {
+                //The unblocked task will preempt us. Trigger a yield here.
+                portYIELD_WITHIN_API();
+            }
+        }
+    }
+    portEXIT_CRITICAL(&pxRingbuffer->mux);
+
+    //If ring buffer was added to a queue set, notify the queue set once per item
+    if (pxRingbuffer->xQueueSet) {
+        for (size_t i = 0; i < xItemNum; i++) {
+            xQueueSend((QueueHandle_t)pxRingbuffer->xQueueSet, (QueueSetMemberHandle_t *)&pxRingbuffer, 0);
+        }
+    }
+    return pdTRUE;
+}
+
+size_t xRingbufferReceiveMultiple(RingbufHandle_t xRingbuffer,
+                                  void **ppvItems,
+                                  size_t *pxItemSizes,
+                                  size_t xMaxItems,
+                                  TickType_t xTicksToWait)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+
+    //Check arguments
+    configASSERT(pxRingbuffer && ppvItems && pxItemSizes);
+
+    //Only no-split buffers are supported. A byte buffer has a single span retrieved at a time, and the parts of a
+    //split item would not be told apart from whole items.
+    if ((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) != 0 || xMaxItems == 0) {
+        return 0;
+    }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSPSCReceiveMultipleGeneric(pxRingbuffer, ppvItems, pxItemSizes, xMaxItems, xTicksToWait);
+    }
+    return prvReceiveMultipleGeneric(pxRingbuffer, ppvItems, pxItemSizes, xMaxItems, xTicksToWait);
+}
+
+void vRingbufferReturnItemMultiple(RingbufHandle_t xRingbuffer, void *const *ppvItems, size_t xItemNum)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL);
+    if (xItemNum == 0) {
+        return;
+    }
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        for (size_t i = 0; i < xItemNum; i++) {
+            configASSERT(ppvItems[i] != NULL);
+            prvSPSCReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+        }
+        prvSPSCWakeWaiting(pxRingbuffer, rbSPSC_SENDER_WAITING, pdFALSE, NULL);
+        return;
+    }
+
+    portENTER_CRITICAL(&pxRingbuffer->mux);
+    for (size_t i = 0; i < xItemNum; i++) {
+        configASSERT(ppvItems[i] != NULL);
+        pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+    }
+    //If a task was waiting for space to send, unblock it immediately.
+    if (listLIST_IS_EMPTY(&pxRingbuffer->xTasksWaitingToSend) == pdFALSE) {
+        if (xTaskRemoveFromEventList(&pxRingbuffer->xTasksWaitingToSend) == pdTRUE) {
+            //The unblocked task will preempt us. Trigger a yield here.
+            portYIELD_WITHIN_API();
+        }
+    }
+    portEXIT_CRITICAL(&pxRingbuffer->mux);
+}
+
 void vRingbufferDelete(RingbufHandle_t xRingbuffer)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
@@ -1269,6 +2296,10 @@ size_t xRingbufferGetCurFreeSize(RingbufHandle_t xRingbuffer)
     configASSERT(pxRingbuffer);
 
     size_t xFreeSize;
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        //Must be called by the producer
+        return prvSPSCGetCurMaxSize(pxRingbuffer);
+    }
     portENTER_CRITICAL(&pxRingbuffer->mux);
     xFreeSize = pxRingbuffer->xGetCurMaxSize(pxRingbuffer);
     portEXIT_CRITICAL(&pxRingbuffer->mux);
@@ -1283,7 +2314,7 @@ BaseType_t xRingbufferAddToQueueSetRead(RingbufHandle_t xRingbuffer, QueueSetHan
     configASSERT(pxRingbuffer && xQueueSet);
 
     portENTER_CRITICAL(&pxRingbuffer->mux);
-    if (pxRingbuffer->xQueueSet != NULL || prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+    if (pxRingbuffer->xQueueSet != NULL || prvRingbufferHasData(pxRingbuffer) == pdTRUE) {
         /*
         - Cannot add ring buffer to more than one queue set
         - It is dangerous to add a ring buffer to a queue set if the ring buffer currently has data to be read.
@@ -1307,7 +2338,7 @@ BaseType_t xRingbufferRemoveFromQueueSetRead(RingbufHandle_t xRingbuffer, QueueS
     configASSERT(pxRingbuffer && xQueueSet);
 
     portENTER_CRITICAL(&pxRingbuffer->mux);
-    if (pxRingbuffer->xQueueSet != xQueueSet || prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+    if (pxRingbuffer->xQueueSet != xQueueSet || prvRingbufferHasData(pxRingbuffer) == pdTRUE) {
         /*
         - Ring buffer was never added to this queue set
         - It is dangerous to remove a ring buffer from a queue set if the ring buffer currently has data to be read.
@@ -1347,7 +2378,11 @@ void vRingbufferGetInfo(RingbufHandle_t xRingbuffer,
         *uxAcquire = (UBaseType_t)(pxRingbuffer->pucAcquire - pxRingbuffer->pucHead);
     }
     if (uxItemsWaiting != NULL) {
-        *uxItemsWaiting = (UBaseType_t)(pxRingbuffer->xItemsWaiting);
+        if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+            *uxItemsWaiting = (UBaseType_t)(atomic_load(&pxRingbuffer->xSPSCItemsSent) - atomic_load(&pxRingbuffer->xSPSCItemsReceived));
+        } else {
+            *uxItemsWaiting = (UBaseType_t)(pxRingbuffer->xItemsWaiting);
+        }
     }
     portEXIT_CRITICAL(&pxRingbuffer->mux);
 }
@@ -1357,7 +2392,8 @@ void xRingbufferPrintInfo(RingbufHandle_t xRingbuffer)
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
     printf("Rb size:%" PRId32 "\tfree: %" PRId32 "\trptr: %" PRId32 "\tfreeptr: %" PRId32 "\twptr: %" PRId32 ", aptr: %" PRId32 "\n",
-           (int32_t)pxRingbuffer->xSize, (int32_t)prvGetFreeSize(pxRingbuffer),
+           (int32_t)pxRingbuffer->xSize,
+           (int32_t)((pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) ? prvSPSCFreeSize(pxRingbuffer) : prvGetFreeSize(pxRingbuffer)),
            (int32_t)(pxRingbuffer->pucRead - pxRingbuffer->pucHead),
            (int32_t)(pxRingbuffer->pucFree - pxRingbuffer->pucHead),
            (int32_t)(pxRingbuffer->pucWrite - pxRingbuffer->pucHead),
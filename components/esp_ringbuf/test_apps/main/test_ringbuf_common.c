@@ -12,6 +12,8 @@
 #include "sdkconfig.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -1124,3 +1126,482 @@ TEST_CASE("Test no-split buffers can receive items if the acquire pointer wraps
     // Cleanup
     vRingbufferDelete(buffer_handle);
 }
+
+/* ------------------------ Test single-producer/single-consumer ring buffers ---------------------------
+ * The following test cases test the lock-free single-producer/single-consumer ring buffers. They must behave
+ * exactly like the other ring buffers as long as there is only one sender and one receiver at a time.
+ */
+
+static void receive_check_and_return_item(RingbufHandle_t handle, RingbufferType_t type, const uint8_t *expected_data, size_t expected_size, TickType_t ticks_to_wait, bool in_isr)
+{
+    if (type == RINGBUF_TYPE_NOSPLIT) {
+        receive_check_and_return_item_no_split(handle, expected_data, expected_size, ticks_to_wait, in_isr);
+    } else if (type == RINGBUF_TYPE_ALLOWSPLIT) {
+        receive_check_and_return_item_allow_split(handle, expected_data, expected_size, ticks_to_wait, in_isr);
+    } else {
+        receive_check_and_return_item_byte_buffer(handle, expected_data, expected_size, ticks_to_wait, in_isr);
+    }
+}
+
+TEST_CASE("Test SPSC ring buffers wrap around and detect full buffers", "[esp_ringbuf][linux]")
+{
+    for (RingbufferType_t type = RINGBUF_TYPE_NOSPLIT; type < RINGBUF_TYPE_MAX; type++) {
+        RingbufHandle_t buffer_handle = xRingbufferCreateSPSC(BUFFER_SIZE, type);
+        RingbufHandle_t reference_handle = xRingbufferCreate(BUFFER_SIZE, type);
+        TEST_ASSERT_MESSAGE(buffer_handle != NULL && reference_handle != NULL, "Failed to create ring buffers");
+        TEST_ASSERT_EQUAL(xRingbufferGetMaxItemSize(reference_handle), xRingbufferGetMaxItemSize(buffer_handle));
+        TEST_ASSERT_EQUAL(xRingbufferGetCurFreeSize(reference_handle), xRingbufferGetCurFreeSize(buffer_handle));
+
+        //Fill the buffer with items of varying size, so that items wrap around at varying positions
+        uint8_t item[LARGE_ITEM_SIZE + 1];
+        for (int round = 0; round < 100; round++) {
+            size_t item_size = (round * 5) % sizeof(item) + 1;
+            bool in_isr = (round % 2) != 0;
+            for (int i = 0; i < item_size; i++) {
+                item[i] = round + i;
+            }
+
+            int no_of_items = 0;
+            while (1) {
+                BaseType_t ret = in_isr ? xRingbufferSendFromISR(buffer_handle, item, item_size, NULL) : xRingbufferSend(buffer_handle, item, item_size, 0);
+                if (ret == pdFALSE) {
+                    break;
+                }
+                no_of_items++;
+            }
+            TEST_ASSERT_GREATER_THAN(0, no_of_items);
+            TEST_ASSERT_LESS_THAN(item_size, xRingbufferGetCurFreeSize(buffer_handle));
+
+            for (int i = 0; i < no_of_items; i++) {
+                receive_check_and_return_item(buffer_handle, type, item, item_size, 0, in_isr);
+            }
+            UBaseType_t items_waiting;
+            vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+            TEST_ASSERT_EQUAL(0, items_waiting);
+        }
+
+        vRingbufferDelete(buffer_handle);
+        vRingbufferDelete(reference_handle);
+    }
+}
+
+TEST_CASE("Test SPSC no-split buffers always receive items in order", "[esp_ringbuf][linux]")
+{
+    static StaticRingbuffer_t buffer_struct;
+    static uint8_t buffer_storage[BUFFER_SIZE];
+    RingbufHandle_t buffer_handle = xRingbufferCreateStaticSPSC(BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT, buffer_storage, &buffer_struct);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+
+    // Make sure the items acquired below wrap around
+    void *item;
+    size_t item_size;
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquire(buffer_handle, &item, LARGE_ITEM_SIZE, TIMEOUT_TICKS));
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendComplete(buffer_handle, item));
+    item = xRingbufferReceive(buffer_handle, &item_size, TIMEOUT_TICKS);
+    TEST_ASSERT_NOT_NULL(item);
+    vRingbufferReturnItem(buffer_handle, item);
+
+    void *items[MAX_LARGE_ITEMS];
+    for (int i = 0; i < MAX_LARGE_ITEMS; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquire(buffer_handle, &items[i], LARGE_ITEM_SIZE, TIMEOUT_TICKS));
+        *(uint32_t *)items[i] = (0x100 + i);
+    }
+    TEST_ASSERT_EQUAL(0U, xRingbufferGetCurFreeSize(buffer_handle));
+    TEST_ASSERT_EQUAL(pdFALSE, xRingbufferSendAcquire(buffer_handle, &item, LARGE_ITEM_SIZE, 0));
+
+    // Items completed out-of-order are not received until the first item is completed
+    for (int i = MAX_LARGE_ITEMS - 1; i > 0; i--) {
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendComplete(buffer_handle, items[i]));
+        TEST_ASSERT_NULL(xRingbufferReceive(buffer_handle, &item_size, 0));
+    }
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendComplete(buffer_handle, items[0]));
+
+    // Items returned out-of-order only free space once the first item is returned
+    for (int i = 0; i < MAX_LARGE_ITEMS; i++) {
+        items[i] = xRingbufferReceive(buffer_handle, &item_size, TIMEOUT_TICKS);
+        TEST_ASSERT_NOT_NULL(items[i]);
+        TEST_ASSERT_EQUAL(LARGE_ITEM_SIZE, item_size);
+        TEST_ASSERT_EQUAL(0x100 + i, *(uint32_t *)items[i]);
+    }
+    for (int i = MAX_LARGE_ITEMS - 1; i > 0; i--) {
+        vRingbufferReturnItem(buffer_handle, items[i]);
+        TEST_ASSERT_EQUAL(0U, xRingbufferGetCurFreeSize(buffer_handle));
+    }
+    vRingbufferReturnItem(buffer_handle, items[0]);
+    TEST_ASSERT_EQUAL(xRingbufferGetMaxItemSize(buffer_handle), xRingbufferGetCurFreeSize(buffer_handle));
+
+    vRingbufferDelete(buffer_handle);
+}
+
+TEST_CASE("Test SPSC ring buffer with queue sets", "[esp_ringbuf][linux]")
+{
+    RingbufHandle_t buffer_handle = xRingbufferCreateSPSC(BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT);
+    QueueSetHandle_t queue_set = xQueueCreateSet(BUFFER_SIZE / (ITEM_HDR_SIZE + SMALL_ITEM_SIZE));
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL && queue_set != NULL, "Failed to create ring buffer or queue set");
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferAddToQueueSetRead(buffer_handle, queue_set));
+
+    for (int i = 0; i < 3; i++) {
+        send_item_and_check(buffer_handle, small_item, SMALL_ITEM_SIZE, 0, (i % 2) != 0);
+    }
+    TEST_ASSERT_EQUAL(pdFALSE, xRingbufferRemoveFromQueueSetRead(buffer_handle, queue_set));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_PTR(buffer_handle, xQueueSelectFromSet(queue_set, TIMEOUT_TICKS));
+        receive_check_and_return_item_no_split(buffer_handle, small_item, SMALL_ITEM_SIZE, 0, false);
+    }
+    TEST_ASSERT_NULL(xQueueSelectFromSet(queue_set, 0));
+
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferRemoveFromQueueSetRead(buffer_handle, queue_set));
+    vQueueDelete(queue_set);
+    vRingbufferDelete(buffer_handle);
+}
+
+#define SPSC_TEST_ITEMS             2000
+
+typedef struct {
+    RingbufHandle_t buffer;
+    RingbufferType_t type;
+    SemaphoreHandle_t done;
+} spsc_test_args_t;
+
+static void spsc_producer_task(void *arg)
+{
+    spsc_test_args_t *args = (spsc_test_args_t *)arg;
+    uint8_t item[LARGE_ITEM_SIZE + 1];
+    uint8_t seq = 0;
+    for (int i = 0; i < SPSC_TEST_ITEMS; i++) {
+        size_t item_size = i % sizeof(item) + 1;
+        for (int j = 0; j < item_size; j++) {
+            item[j] = seq++;
+        }
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSend(args->buffer, item, item_size, pdMS_TO_TICKS(1000)));
+    }
+    xSemaphoreGive(args->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test SPSC ring buffer between tasks", "[esp_ringbuf][linux]")
+{
+    spsc_test_args_t args = {
+        .done = xSemaphoreCreateBinary(),
+    };
+    TEST_ASSERT_NOT_NULL(args.done);
+
+    //Run the producer at a higher and at a lower priority, so that both the producer and the consumer block
+    for (int i = 0; i < 2 * RINGBUF_TYPE_MAX; i++) {
+        args.type = i / 2;
+        args.buffer = xRingbufferCreateSPSC(BUFFER_SIZE, args.type);
+        TEST_ASSERT_NOT_NULL(args.buffer);
+        UBaseType_t priority = uxTaskPriorityGet(NULL) + ((i % 2) ? 1 : -1);
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(spsc_producer_task, "spsc_producer", 4096, &args, priority, NULL));
+
+        //Every byte sent carries the next sequence number, whatever the item boundaries are
+        uint8_t seq = 0;
+        size_t expected_bytes = 0;
+        for (int j = 0; j < SPSC_TEST_ITEMS; j++) {
+            expected_bytes += j % (LARGE_ITEM_SIZE + 1) + 1;
+        }
+        while (expected_bytes > 0) {
+            uint8_t *items[2] = { NULL, NULL };
+            size_t sizes[2] = { 0, 0 };
+            if (args.type == RINGBUF_TYPE_NOSPLIT) {
+                items[0] = xRingbufferReceive(args.buffer, &sizes[0], pdMS_TO_TICKS(1000));
+            } else if (args.type == RINGBUF_TYPE_ALLOWSPLIT) {
+                TEST_ASSERT_EQUAL(pdTRUE, xRingbufferReceiveSplit(args.buffer, (void **)&items[0], (void **)&items[1], &sizes[0], &sizes[1], pdMS_TO_TICKS(1000)));
+            } else {
+                items[0] = xRingbufferReceiveUpTo(args.buffer, &sizes[0], pdMS_TO_TICKS(1000), SMALL_ITEM_SIZE);
+            }
+            TEST_ASSERT_NOT_NULL(items[0]);
+            for (int j = 0; j < 2 && items[j] != NULL; j++) {
+                for (int k = 0; k < sizes[j]; k++) {
+                    TEST_ASSERT_EQUAL(seq++, items[j][k]);
+                }
+                expected_bytes -= sizes[j];
+                vRingbufferReturnItem(args.buffer, items[j]);
+            }
+        }
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(args.done, pdMS_TO_TICKS(1000)));
+        vRingbufferDelete(args.buffer);
+    }
+    vSemaphoreDelete(args.done);
+}
+
+/* ------------------------ Ring buffer throughput ---------------------------
+ * Compare the throughput of the default ring buffers with the single-producer/single-consumer ring buffers.
+ * Items are sent and received in bursts from a single task, so that only the ring buffer operations are measured.
+ */
+
+#define THROUGHPUT_ITEM_SIZE        16
+#define THROUGHPUT_BURST            16
+#define THROUGHPUT_ITEMS            200000
+
+static uint32_t ringbuf_throughput(RingbufHandle_t buffer_handle, RingbufferType_t type)
+{
+    uint8_t item[THROUGHPUT_ITEM_SIZE] = { 0 };
+    TickType_t start = xTaskGetTickCount();
+    for (int i = 0; i < THROUGHPUT_ITEMS; i += THROUGHPUT_BURST) {
+        for (int j = 0; j < THROUGHPUT_BURST; j++) {
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSend(buffer_handle, item, sizeof(item), 0));
+        }
+        while (1) {
+            void *items[2] = { NULL, NULL };
+            size_t sizes[2];
+            if (type == RINGBUF_TYPE_NOSPLIT) {
+                items[0] = xRingbufferReceive(buffer_handle, &sizes[0], 0);
+            } else if (type == RINGBUF_TYPE_ALLOWSPLIT) {
+                xRingbufferReceiveSplit(buffer_handle, &items[0], &items[1], &sizes[0], &sizes[1], 0);
+            } else {
+                items[0] = xRingbufferReceiveUpTo(buffer_handle, &sizes[0], 0, sizeof(item));
+            }
+            if (items[0] == NULL) {
+                break;
+            }
+            vRingbufferReturnItem(buffer_handle, items[0]);
+            if (items[1] != NULL) {
+                vRingbufferReturnItem(buffer_handle, items[1]);
+            }
+        }
+    }
+    TickType_t ticks = xTaskGetTickCount() - start;
+    //Items per second
+    return (uint32_t)((uint64_t)THROUGHPUT_ITEMS * configTICK_RATE_HZ / (ticks ? ticks : 1));
+}
+
+TEST_CASE("Test ring buffer throughput", "[esp_ringbuf][linux]")
+{
+    const char *type_names[RINGBUF_TYPE_MAX] = { "no-split", "allow-split", "byte buffer" };
+    const size_t buffer_size = 2 * THROUGHPUT_BURST * (ITEM_HDR_SIZE + THROUGHPUT_ITEM_SIZE);
+    for (RingbufferType_t type = RINGBUF_TYPE_NOSPLIT; type < RINGBUF_TYPE_MAX; type++) {
+        RingbufHandle_t default_handle = xRingbufferCreate(buffer_size, type);
+        RingbufHandle_t spsc_handle = xRingbufferCreateSPSC(buffer_size, type);
+        TEST_ASSERT_MESSAGE(default_handle != NULL && spsc_handle != NULL, "Failed to create ring buffers");
+
+        uint32_t default_rate = ringbuf_throughput(default_handle, type);
+        uint32_t spsc_rate = ringbuf_throughput(spsc_handle, type);
+        printf("%s, %d byte items: default %" PRIu32 " items/s, SPSC %" PRIu32 " items/s\n",
+               type_names[type], THROUGHPUT_ITEM_SIZE, default_rate, spsc_rate);
+
+        vRingbufferDelete(default_handle);
+        vRingbufferDelete(spsc_handle);
+    }
+}
+
+/* ------------------------ Test multi-item batch API ---------------------------
+ * The following test cases test sending, acquiring, receiving and returning multiple items at once,
+ * with both the default and the single-producer/single-consumer ring buffers.
+ */
+
+#define BATCH_MAX_ITEMS             (BUFFER_SIZE / ITEM_HDR_SIZE)
+
+static RingbufHandle_t create_ringbuf(bool spsc, RingbufferType_t type)
+{
+    return spsc ? xRingbufferCreateSPSC(BUFFER_SIZE, type) : xRingbufferCreate(BUFFER_SIZE, type);
+}
+
+TEST_CASE("Test no-split buffers batch send and receive", "[esp_ringbuf][linux]")
+{
+    for (int spsc = 0; spsc < 2; spsc++) {
+        RingbufHandle_t buffer_handle = create_ringbuf(spsc, RINGBUF_TYPE_NOSPLIT);
+        TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+        const size_t max_size = xRingbufferGetCurFreeSize(buffer_handle);
+
+        uint32_t values[BATCH_MAX_ITEMS];
+        const void *send_items[BATCH_MAX_ITEMS];
+        size_t sizes[BATCH_MAX_ITEMS];
+        void *items[BATCH_MAX_ITEMS];
+        size_t received_sizes[BATCH_MAX_ITEMS];
+        for (int round = 0; round < 8; round++) {
+            //Send more items than fit, only as many as fit are sent
+            for (int i = 0; i < BATCH_MAX_ITEMS; i++) {
+                values[i] = round * 0x100 + i;
+                send_items[i] = &values[i];
+                sizes[i] = sizeof(values[i]);
+            }
+            size_t sent = xRingbufferSendMultiple(buffer_handle, send_items, sizes, BATCH_MAX_ITEMS, 0);
+            TEST_ASSERT_GREATER_THAN(0, sent);
+            TEST_ASSERT_LESS_THAN(BATCH_MAX_ITEMS, sent);
+            TEST_ASSERT_EQUAL(0, xRingbufferSendMultiple(buffer_handle, &send_items[sent], &sizes[sent], 1, 0));
+
+            //Receive them in two batches
+            size_t received = xRingbufferReceiveMultiple(buffer_handle, items, received_sizes, 2, 0);
+            TEST_ASSERT_EQUAL(2, received);
+            received += xRingbufferReceiveMultiple(buffer_handle, &items[2], &received_sizes[2], BATCH_MAX_ITEMS - 2, 0);
+            TEST_ASSERT_EQUAL(sent, received);
+            for (int i = 0; i < received; i++) {
+                TEST_ASSERT_EQUAL(sizeof(uint32_t), received_sizes[i]);
+                TEST_ASSERT_EQUAL(values[i], *(uint32_t *)items[i]);
+            }
+            TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(buffer_handle, items, received_sizes, BATCH_MAX_ITEMS, 0));
+            vRingbufferReturnItemMultiple(buffer_handle, items, received);
+            TEST_ASSERT_EQUAL(max_size, xRingbufferGetCurFreeSize(buffer_handle));
+
+            //Acquire as many items as fit, and complete them in reverse order
+            for (int i = 0; i < BATCH_MAX_ITEMS; i++) {
+                sizes[i] = LARGE_ITEM_SIZE;
+            }
+            size_t acquired = xRingbufferSendAcquireMultiple(buffer_handle, items, sizes, BATCH_MAX_ITEMS, 0);
+            TEST_ASSERT_GREATER_THAN(1, acquired);
+            TEST_ASSERT_NULL(items[acquired]);
+            void *reversed[BATCH_MAX_ITEMS];
+            for (int i = 0; i < acquired; i++) {
+                *(uint32_t *)items[i] = round * 0x100 + i;
+                reversed[acquired - 1 - i] = items[i];
+            }
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendCompleteMultiple(buffer_handle, reversed, acquired - 1));
+            TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(buffer_handle, items, received_sizes, BATCH_MAX_ITEMS, 0));
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendCompleteMultiple(buffer_handle, &reversed[acquired - 1], 1));
+            TEST_ASSERT_EQUAL(acquired, xRingbufferReceiveMultiple(buffer_handle, items, received_sizes, BATCH_MAX_ITEMS, TIMEOUT_TICKS));
+            for (int i = 0; i < acquired; i++) {
+                TEST_ASSERT_EQUAL(LARGE_ITEM_SIZE, received_sizes[i]);
+                TEST_ASSERT_EQUAL(round * 0x100 + i, *(uint32_t *)items[i]);
+            }
+            vRingbufferReturnItemMultiple(buffer_handle, items, acquired);
+            TEST_ASSERT_EQUAL(max_size, xRingbufferGetCurFreeSize(buffer_handle));
+        }
+
+        vRingbufferDelete(buffer_handle);
+    }
+}
+
+TEST_CASE("Test allow-split and byte buffers batch send and receive", "[esp_ringbuf][linux]")
+{
+    for (int spsc = 0; spsc < 2; spsc++) {
+        RingbufHandle_t allow_split_rb = create_ringbuf(spsc, RINGBUF_TYPE_ALLOWSPLIT);
+        RingbufHandle_t byte_rb = create_ringbuf(spsc, RINGBUF_TYPE_BYTEBUF);
+        TEST_ASSERT_MESSAGE(allow_split_rb && byte_rb, "Failed to create ring buffers");
+
+        const void *send_items[] = { small_item, large_item, NULL, small_item };
+        const size_t sizes[] = { SMALL_ITEM_SIZE, LARGE_ITEM_SIZE, 0, SMALL_ITEM_SIZE };
+        void *items[4];
+        size_t received_sizes[4];
+        for (int round = 0; round < 8; round++) {
+            TEST_ASSERT_EQUAL(4, xRingbufferSendMultiple(allow_split_rb, send_items, sizes, 4, TIMEOUT_TICKS));
+            //Batch receive is only supported by no-split buffers
+            TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(allow_split_rb, items, received_sizes, 4, TIMEOUT_TICKS));
+            receive_check_and_return_item_allow_split(allow_split_rb, small_item, SMALL_ITEM_SIZE, 0, false);
+            receive_check_and_return_item_allow_split(allow_split_rb, large_item, LARGE_ITEM_SIZE, 0, false);
+            receive_check_and_return_item_allow_split(allow_split_rb, NULL, 0, 0, false);
+            receive_check_and_return_item_allow_split(allow_split_rb, small_item, SMALL_ITEM_SIZE, 0, false);
+
+            //Byte buffers receive the concatenation of all items
+            TEST_ASSERT_EQUAL(4, xRingbufferSendMultiple(byte_rb, send_items, sizes, 4, TIMEOUT_TICKS));
+            TEST_ASSERT_EQUAL(0, xRingbufferReceiveMultiple(byte_rb, items, received_sizes, 4, TIMEOUT_TICKS));
+            receive_check_and_return_item_byte_buffer(byte_rb, small_item, SMALL_ITEM_SIZE, 0, false);
+            receive_check_and_return_item_byte_buffer(byte_rb, large_item, LARGE_ITEM_SIZE, 0, false);
+            receive_check_and_return_item_byte_buffer(byte_rb, small_item, SMALL_ITEM_SIZE, 0, false);
+        }
+
+        vRingbufferDelete(allow_split_rb);
+        vRingbufferDelete(byte_rb);
+    }
+}
+
+#define BATCH_TEST_ITEMS            1000
+#define BATCH_TEST_BURST            8
+
+static void batch_producer_task(void *arg)
+{
+    spsc_test_args_t *args = (spsc_test_args_t *)arg;
+    uint32_t values[BATCH_TEST_BURST];
+    const void *items[BATCH_TEST_BURST];
+    size_t sizes[BATCH_TEST_BURST];
+    for (int i = 0; i < BATCH_TEST_ITEMS; i += BATCH_TEST_BURST) {
+        for (int j = 0; j < BATCH_TEST_BURST; j++) {
+            values[j] = i + j;
+            items[j] = &values[j];
+            sizes[j] = sizeof(values[j]);
+        }
+        TEST_ASSERT_EQUAL(BATCH_TEST_BURST, xRingbufferSendMultiple(args->buffer, items, sizes, BATCH_TEST_BURST, pdMS_TO_TICKS(1000)));
+    }
+    xSemaphoreGive(args->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test no-split buffers batch send and receive between tasks", "[esp_ringbuf][linux]")
+{
+    spsc_test_args_t args = {
+        .type = RINGBUF_TYPE_NOSPLIT,
+        .done = xSemaphoreCreateBinary(),
+    };
+    TEST_ASSERT_NOT_NULL(args.done);
+
+    //Run the producer at a higher and at a lower priority, so that both the producer and the consumer block
+    for (int i = 0; i < 4; i++) {
+        args.buffer = create_ringbuf(i / 2, RINGBUF_TYPE_NOSPLIT);
+        TEST_ASSERT_NOT_NULL(args.buffer);
+        UBaseType_t priority = uxTaskPriorityGet(NULL) + ((i % 2) ? 1 : -1);
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(batch_producer_task, "batch_producer", 4096, &args, priority, NULL));
+
+        uint32_t expected = 0;
+        while (expected < BATCH_TEST_ITEMS) {
+            void *items[BATCH_TEST_BURST];
+            size_t sizes[BATCH_TEST_BURST];
+            size_t received = xRingbufferReceiveMultiple(args.buffer, items, sizes, BATCH_TEST_BURST, pdMS_TO_TICKS(1000));
+            TEST_ASSERT_GREATER_THAN(0, received);
+            for (int j = 0; j < received; j++) {
+                TEST_ASSERT_EQUAL(expected++, *(uint32_t *)items[j]);
+            }
+            vRingbufferReturnItemMultiple(args.buffer, items, received);
+        }
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(args.done, pdMS_TO_TICKS(1000)));
+        vRingbufferDelete(args.buffer);
+    }
+    vSemaphoreDelete(args.done);
+}
+
+/* ------------------------ Batch throughput ---------------------------
+ * Compare the throughput of sending and receiving items one by one with the batch API, for items of 16 to 256 bytes.
+ * Items are written in place (acquire/complete) and received in bursts from a single task.
+ */
+
+#define BATCH_THROUGHPUT_ITEMS      100000
+
+static uint32_t ringbuf_batch_throughput(RingbufHandle_t buffer_handle, size_t item_size, bool batch)
+{
+    void *items[THROUGHPUT_BURST];
+    size_t sizes[THROUGHPUT_BURST];
+    for (int i = 0; i < THROUGHPUT_BURST; i++) {
+        sizes[i] = item_size;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    for (int i = 0; i < BATCH_THROUGHPUT_ITEMS; i += THROUGHPUT_BURST) {
+        if (batch) {
+            TEST_ASSERT_EQUAL(THROUGHPUT_BURST, xRingbufferSendAcquireMultiple(buffer_handle, items, sizes, THROUGHPUT_BURST, 0));
+            for (int j = 0; j < THROUGHPUT_BURST; j++) {
+                memset(items[j], j, item_size);
+            }
+            xRingbufferSendCompleteMultiple(buffer_handle, items, THROUGHPUT_BURST);
+            TEST_ASSERT_EQUAL(THROUGHPUT_BURST, xRingbufferReceiveMultiple(buffer_handle, items, sizes, THROUGHPUT_BURST, 0));
+            vRingbufferReturnItemMultiple(buffer_handle, items, THROUGHPUT_BURST);
+        } else {
+            for (int j = 0; j < THROUGHPUT_BURST; j++) {
+                TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquire(buffer_handle, &items[j], item_size, 0));
+                memset(items[j], j, item_size);
+                xRingbufferSendComplete(buffer_handle, items[j]);
+            }
+            for (int j = 0; j < THROUGHPUT_BURST; j++) {
+                items[j] = xRingbufferReceive(buffer_handle, &sizes[j], 0);
+                TEST_ASSERT_NOT_NULL(items[j]);
+                vRingbufferReturnItem(buffer_handle, items[j]);
+            }
+        }
+    }
+    TickType_t ticks = xTaskGetTickCount() - start;
+    //Items per second
+    return (uint32_t)((uint64_t)BATCH_THROUGHPUT_ITEMS * configTICK_RATE_HZ / (ticks ? ticks : 1));
+}
+
+TEST_CASE("Test no-split buffers batch throughput", "[esp_ringbuf][linux]")
+{
+    for (size_t item_size = 16; item_size <= 256; item_size *= 2) {
+        RingbufHandle_t buffer_handle = xRingbufferCreate(2 * THROUGHPUT_BURST * (ITEM_HDR_SIZE + item_size), RINGBUF_TYPE_NOSPLIT);
+        TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+
+        uint32_t single_rate = ringbuf_batch_throughput(buffer_handle, item_size, false);
+        uint32_t batch_rate = ringbuf_batch_throughput(buffer_handle, item_size, true);
+        printf("%u byte items: one by one %" PRIu32 " items/s, batches of %d %" PRIu32 " items/s\n",
+               (unsigned)item_size, single_rate, THROUGHPUT_BURST, batch_rate);
+
+        vRingbufferDelete(buffer_handle);
+    }
+}
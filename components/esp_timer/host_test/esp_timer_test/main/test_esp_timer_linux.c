@@ -0,0 +1,286 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "esp_timer.h"
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+/* The host is not a real-time system, the latencies are only checked against generous bounds */
+#define MAX_LATENCY_US      100000
+
+/* Deleted timers are freed by the esp_timer task, and count as armed until then */
+#define WAIT_FOR_DELETE()   vTaskDelay(2)
+
+static void dummy_cb(void* arg)
+{
+}
+
+TEST_CASE("esp_timer_get_time is monotonic", "[esp_timer]")
+{
+    int64_t prev = esp_timer_get_time();
+    TEST_ASSERT_GREATER_OR_EQUAL(0, prev);
+    for (int i = 0; i < 100000; ++i) {
+        int64_t now = esp_timer_get_time();
+        TEST_ASSERT_GREATER_OR_EQUAL(prev, now);
+        prev = now;
+    }
+    int64_t start = esp_timer_get_time();
+    vTaskDelay(pdMS_TO_TICKS(100));
+    int64_t elapsed = esp_timer_get_time() - start;
+    TEST_ASSERT_GREATER_OR_EQUAL(100000 - 1000, elapsed);
+    TEST_ASSERT_LESS_THAN(100000 + MAX_LATENCY_US, elapsed);
+}
+
+typedef struct {
+    SemaphoreHandle_t done;
+    int64_t fired_at;
+} one_shot_state_t;
+
+static void one_shot_cb(void* arg)
+{
+    one_shot_state_t* state = (one_shot_state_t*) arg;
+    state->fired_at = esp_timer_get_time();
+    xSemaphoreGive(state->done);
+}
+
+TEST_CASE("one-shot timer fires after its timeout", "[esp_timer]")
+{
+    one_shot_state_t state = {
+        .done = xSemaphoreCreateBinary(),
+    };
+    TEST_ASSERT_NOT_NULL(state.done);
+    esp_timer_create_args_t args = {
+        .callback = &one_shot_cb,
+        .arg = &state,
+        .name = "one_shot"
+    };
+    esp_timer_handle_t timer;
+    TEST_ESP_OK(esp_timer_create(&args, &timer));
+
+    for (int timeout_us = 100; timeout_us <= 100000; timeout_us *= 10) {
+        int64_t start = esp_timer_get_time();
+        TEST_ESP_OK(esp_timer_start_once(timer, timeout_us));
+        TEST_ASSERT_TRUE(esp_timer_is_active(timer));
+        TEST_ASSERT_TRUE(xSemaphoreTake(state.done, pdMS_TO_TICKS(1000)));
+        int64_t latency = state.fired_at - start - timeout_us;
+        printf("timeout %6d us, latency %5" PRId64 " us\n", timeout_us, latency);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, latency);
+        TEST_ASSERT_LESS_THAN(MAX_LATENCY_US, latency);
+        TEST_ASSERT_FALSE(esp_timer_is_active(timer));
+    }
+
+    // A stopped timer does not fire
+    TEST_ESP_OK(esp_timer_start_once(timer, 10000));
+    TEST_ESP_OK(esp_timer_stop(timer));
+    TEST_ASSERT_FALSE(xSemaphoreTake(state.done, pdMS_TO_TICKS(50)));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_timer_stop(timer));
+
+    TEST_ESP_OK(esp_timer_delete(timer));
+    vSemaphoreDelete(state.done);
+    WAIT_FOR_DELETE();
+}
+
+static void periodic_cb(void* arg)
+{
+    volatile int* count = (volatile int*) arg;
+    (*count)++;
+}
+
+TEST_CASE("periodic timer fires once per period", "[esp_timer]")
+{
+    volatile int count = 0;
+    esp_timer_create_args_t args = {
+        .callback = &periodic_cb,
+        .arg = (void*) &count,
+        .name = "periodic"
+    };
+    esp_timer_handle_t timer;
+    TEST_ESP_OK(esp_timer_create(&args, &timer));
+    uint64_t period;
+
+    /* The simulated tick is not accurate, the count is compared with the time measured with esp_timer */
+    int64_t start = esp_timer_get_time();
+    TEST_ESP_OK(esp_timer_start_periodic(timer, 10000));
+    TEST_ESP_OK(esp_timer_get_period(timer, &period));
+    TEST_ASSERT_EQUAL_UINT64(10000, period);
+    vTaskDelay(pdMS_TO_TICKS(200));
+    TEST_ESP_OK(esp_timer_stop(timer));
+    int64_t elapsed = esp_timer_get_time() - start;
+    printf("fired %d times in %" PRId64 " us\n", count, elapsed);
+    // The periodic alarms are computed from the previous alarm, late callbacks catch up instead of dropping periods
+    TEST_ASSERT_LESS_OR_EQUAL(elapsed / 10000 + 1, count);
+    TEST_ASSERT_GREATER_OR_EQUAL((elapsed - MAX_LATENCY_US) / 10000, count);
+
+    // Restarting changes the period
+    count = 0;
+    start = esp_timer_get_time();
+    TEST_ESP_OK(esp_timer_start_periodic(timer, 50000));
+    TEST_ESP_OK(esp_timer_restart(timer, 20000));
+    TEST_ESP_OK(esp_timer_get_period(timer, &period));
+    TEST_ASSERT_EQUAL_UINT64(20000, period);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ESP_OK(esp_timer_stop(timer));
+    elapsed = esp_timer_get_time() - start;
+    TEST_ASSERT_LESS_OR_EQUAL(elapsed / 20000 + 1, count);
+    TEST_ASSERT_GREATER_OR_EQUAL((elapsed - MAX_LATENCY_US) / 20000, count);
+
+    TEST_ESP_OK(esp_timer_delete(timer));
+    WAIT_FOR_DELETE();
+}
+
+#define ORDER_TIMERS_COUNT  300
+
+typedef struct {
+    uint64_t alarm[ORDER_TIMERS_COUNT];
+    uint64_t last_alarm;
+    int fired;
+    int out_of_order;
+} order_state_t;
+
+static order_state_t s_order;
+
+static void order_cb(void* arg)
+{
+    int i = (int)(intptr_t) arg;
+    if (s_order.alarm[i] < s_order.last_alarm) {
+        s_order.out_of_order++;
+    }
+    s_order.last_alarm = s_order.alarm[i];
+    s_order.fired++;
+}
+
+TEST_CASE("timers started and stopped in random order fire in alarm order", "[esp_timer]")
+{
+    esp_timer_handle_t* timers = calloc(ORDER_TIMERS_COUNT, sizeof(esp_timer_handle_t));
+    bool* armed = calloc(ORDER_TIMERS_COUNT, sizeof(bool));
+    TEST_ASSERT_NOT_NULL(timers);
+    TEST_ASSERT_NOT_NULL(armed);
+    s_order = (order_state_t) { 0 };
+    for (int i = 0; i < ORDER_TIMERS_COUNT; ++i) {
+        esp_timer_create_args_t args = {
+            .callback = &order_cb,
+            .arg = (void*)(intptr_t) i,
+            .name = "order"
+        };
+        TEST_ESP_OK(esp_timer_create(&args, &timers[i]));
+    }
+
+    /* Arm and disarm the timers in a random order, with alarms in a 200 ms window, many of them equal.
+     * The window starts late enough for the timers not to fire before the end of the loop. */
+    srand(1);
+    int64_t base = esp_timer_get_time() + 500000;
+    for (int k = 0; k < 5000; ++k) {
+        int i = rand() % ORDER_TIMERS_COUNT;
+        if (armed[i]) {
+            TEST_ESP_OK(esp_timer_stop(timers[i]));
+        } else {
+            int64_t alarm = base + (rand() % 200) * 1000;
+            TEST_ESP_OK(esp_timer_start_once(timers[i], alarm - esp_timer_get_time()));
+            TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &s_order.alarm[i]));
+        }
+        armed[i] = !armed[i];
+    }
+
+    int armed_count = 0;
+    int64_t next_alarm = INT64_MAX;
+    for (int i = 0; i < ORDER_TIMERS_COUNT; ++i) {
+        if (armed[i]) {
+            armed_count++;
+            next_alarm = MIN(next_alarm, (int64_t) s_order.alarm[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT64(next_alarm, esp_timer_get_next_alarm());
+    TEST_ASSERT_EQUAL_INT64(next_alarm, esp_timer_get_next_alarm_for_wake_up());
+
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    printf("%d timers armed, %d fired, %d out of order\n", armed_count, s_order.fired, s_order.out_of_order);
+    TEST_ASSERT_EQUAL(armed_count, s_order.fired);
+    TEST_ASSERT_EQUAL(0, s_order.out_of_order);
+
+    for (int i = 0; i < ORDER_TIMERS_COUNT; ++i) {
+        TEST_ESP_OK(esp_timer_delete(timers[i]));
+    }
+    free(armed);
+    free(timers);
+    WAIT_FOR_DELETE();
+}
+
+TEST_CASE("next alarm for wake up skips the timers which skip unhandled events", "[esp_timer]")
+{
+    esp_timer_create_args_t skip_args = {
+        .callback = &dummy_cb,
+        .name = "skip",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create_args_t wake_args = {
+        .callback = &dummy_cb,
+        .name = "wake",
+    };
+    esp_timer_handle_t skip1, skip2, wake;
+    TEST_ESP_OK(esp_timer_create(&skip_args, &skip1));
+    TEST_ESP_OK(esp_timer_create(&skip_args, &skip2));
+    TEST_ESP_OK(esp_timer_create(&wake_args, &wake));
+    TEST_ESP_OK(esp_timer_start_periodic(skip1, 100000));
+    TEST_ESP_OK(esp_timer_start_periodic(skip2, 200000));
+    TEST_ESP_OK(esp_timer_start_once(wake, 300000));
+
+    uint64_t wake_alarm;
+    TEST_ESP_OK(esp_timer_get_expiry_time(wake, &wake_alarm));
+    TEST_ASSERT_EQUAL_INT64(wake_alarm, esp_timer_get_next_alarm_for_wake_up());
+    TEST_ASSERT_LESS_THAN(wake_alarm, esp_timer_get_next_alarm());
+
+    TEST_ESP_OK(esp_timer_stop(skip1));
+    TEST_ESP_OK(esp_timer_stop(skip2));
+    TEST_ESP_OK(esp_timer_stop(wake));
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, esp_timer_get_next_alarm_for_wake_up());
+    TEST_ESP_OK(esp_timer_delete(skip1));
+    TEST_ESP_OK(esp_timer_delete(skip2));
+    TEST_ESP_OK(esp_timer_delete(wake));
+    WAIT_FOR_DELETE();
+}
+
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+static void isr_dispatch_cb(void* arg)
+{
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t) arg, &need_yield);
+    if (need_yield) {
+        esp_timer_isr_dispatch_need_yield();
+    }
+}
+
+TEST_CASE("ISR dispatch method runs the callbacks from the alarm signal", "[esp_timer]")
+{
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(sem);
+    esp_timer_create_args_t args = {
+        .callback = &isr_dispatch_cb,
+        .arg = sem,
+        .dispatch_method = ESP_TIMER_ISR,
+        .name = "isr"
+    };
+    esp_timer_handle_t timer;
+    TEST_ESP_OK(esp_timer_create(&args, &timer));
+    TEST_ESP_OK(esp_timer_start_periodic(timer, 5000));
+    for (int i = 0; i < 20; ++i) {
+        TEST_ASSERT_TRUE(xSemaphoreTake(sem, pdMS_TO_TICKS(100)));
+    }
+    TEST_ESP_OK(esp_timer_stop(timer));
+    TEST_ESP_OK(esp_timer_delete(timer));
+    vSemaphoreDelete(sem);
+    WAIT_FOR_DELETE();
+}
+#endif // CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+
+void app_main(void)
+{
+    unity_run_menu();
+}
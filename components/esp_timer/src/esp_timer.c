@@ -5,6 +5,8 @@
  */
 
 #include <sys/param.h>
+#include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 #include "soc/soc.h"
 #include "esp_types.h"
@@ -18,7 +20,9 @@
 #include "esp_timer.h"
 #include "esp_timer_impl.h"
 #include "esp_compiler.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "esp_private/startup_internal.h"
+#endif
 #include "esp_private/esp_timer_private.h"
 #include "esp_private/system_internal.h"
 #include "sdkconfig.h"
@@ -49,14 +53,18 @@ struct esp_timer {
         uint32_t event_id;
     };
     void* arg;
+    uint32_t seq;                       //!< Order in which the timer was armed, breaks ties between equal alarms
+    struct esp_timer* heap_child;       //!< First child in the heap of armed timers
+    struct esp_timer* heap_next;        //!< Next sibling in the heap of armed timers
+    struct esp_timer* heap_prev;        //!< Previous sibling, or the parent if this is the first child
 #if WITH_PROFILING
     const char* name;
     size_t times_triggered;
     size_t times_armed;
     size_t times_skipped;
     uint64_t total_callback_run_time;
-#endif // WITH_PROFILING
     LIST_ENTRY(esp_timer) list_entry;
+#endif // WITH_PROFILING
 };
 
 static inline bool is_initialized(void);
@@ -65,6 +73,9 @@ static esp_err_t timer_remove(esp_timer_handle_t timer);
 static bool timer_armed(esp_timer_handle_t timer);
 static void timer_list_lock(esp_timer_dispatch_t timer_type);
 static void timer_list_unlock(esp_timer_dispatch_t timer_type);
+#if CONFIG_IDF_TARGET_LINUX
+static esp_err_t esp_timer_init_on_first_use(void);
+#endif
 
 #if WITH_PROFILING
 static void timer_insert_inactive(esp_timer_handle_t timer);
@@ -73,10 +84,11 @@ static void timer_remove_inactive(esp_timer_handle_t timer);
 
 __attribute__((unused)) static const char* TAG = "esp_timer";
 
-// lists of currently armed timers for two dispatch methods: ISR and TASK
-static LIST_HEAD(esp_timer_list, esp_timer) s_timers[ESP_TIMER_MAX] = {
-    [0 ...(ESP_TIMER_MAX - 1)] = LIST_HEAD_INITIALIZER(s_timers)
-};
+// heaps of currently armed timers for two dispatch methods: ISR and TASK.
+// Each entry points to the root of a pairing heap, i.e. the timer with the earliest alarm.
+static esp_timer_handle_t s_timers[ESP_TIMER_MAX];
+// sequence numbers given to the timers as they are armed, to keep timers with equal alarms in arming order
+static uint32_t s_timer_seq[ESP_TIMER_MAX];
 #if WITH_PROFILING
 // lists of unarmed timers for two dispatch methods: ISR and TASK,
 // used only to be able to dump statistics about all the timers
@@ -100,6 +112,12 @@ static volatile BaseType_t s_isr_dispatch_need_yield = pdFALSE;
 esp_err_t esp_timer_create(const esp_timer_create_args_t* args,
                            esp_timer_handle_t* out_handle)
 {
+#if CONFIG_IDF_TARGET_LINUX
+    esp_err_t err = esp_timer_init_on_first_use();
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
     if (!is_initialized()) {
         return ESP_ERR_INVALID_STATE;
     }
@@ -278,8 +296,8 @@ esp_err_t esp_timer_delete(esp_timer_handle_t timer)
         err = ESP_ERR_INVALID_STATE;
     } else {
         // A case for the timer with ESP_TIMER_ISR:
-        // This ISR timer was removed from the ISR list in esp_timer_stop() or in timer_process_alarm() -> LIST_REMOVE(it, list_entry)
-        // and here this timer will be added to another the TASK list, see below.
+        // This ISR timer was removed from the ISR heap in esp_timer_stop() or in timer_process_alarm() -> timer_heap_remove(it)
+        // and here this timer will be added to the TASK heap, see below.
         // We do this because we want to free memory of the timer in a task context instead of an isr context.
         timer->flags &= ~FL_ISR_DISPATCH_METHOD;
         timer->event_id = EVENT_ID_DELETE_TIMER;
@@ -291,29 +309,142 @@ esp_err_t esp_timer_delete(esp_timer_handle_t timer)
     return err;
 }
 
-static IRAM_ATTR esp_err_t timer_insert(esp_timer_handle_t timer, bool without_update_alarm)
+/*
+ * Armed timers are kept in a pairing heap, one per dispatch method. The heap is intrusive
+ * (the links live in struct esp_timer), so arming and disarming never allocate memory and
+ * can be done from a critical section or an ISR. Inserting a timer is O(1), removing the
+ * earliest timer or an arbitrary one is O(log n) amortized, compared to O(n) insertion into
+ * a sorted list.
+ */
+
+static IRAM_ATTR bool timer_heap_before(esp_timer_handle_t a, esp_timer_handle_t b)
+{
+    if (a->alarm != b->alarm) {
+        return a->alarm < b->alarm;
+    }
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+/* Merges two detached heaps, returns the new root */
+static IRAM_ATTR esp_timer_handle_t timer_heap_meld(esp_timer_handle_t a, esp_timer_handle_t b)
+{
+    if (timer_heap_before(b, a)) {
+        esp_timer_handle_t tmp = a;
+        a = b;
+        b = tmp;
+    }
+    b->heap_prev = a;
+    b->heap_next = a->heap_child;
+    if (a->heap_child) {
+        a->heap_child->heap_prev = b;
+    }
+    a->heap_child = b;
+    return a;
+}
+
+/* Merges a list of sibling heaps into one heap (standard two-pass pairing), returns the new root */
+static IRAM_ATTR esp_timer_handle_t timer_heap_merge_pairs(esp_timer_handle_t first)
+{
+    // first pass: meld the siblings pairwise from left to right, collecting the results in reverse order
+    esp_timer_handle_t pairs = NULL;
+    while (first) {
+        esp_timer_handle_t a = first;
+        esp_timer_handle_t b = a->heap_next;
+        a->heap_prev = NULL;
+        a->heap_next = NULL;
+        if (b == NULL) {
+            a->heap_next = pairs;
+            pairs = a;
+            break;
+        }
+        first = b->heap_next;
+        b->heap_prev = NULL;
+        b->heap_next = NULL;
+        a = timer_heap_meld(a, b);
+        a->heap_next = pairs;
+        pairs = a;
+    }
+    // second pass: meld the results from right to left
+    esp_timer_handle_t root = NULL;
+    while (pairs) {
+        esp_timer_handle_t next = pairs->heap_next;
+        pairs->heap_next = NULL;
+        root = (root == NULL) ? pairs : timer_heap_meld(root, pairs);
+        pairs = next;
+    }
+    return root;
+}
+
+static IRAM_ATTR void timer_heap_insert(esp_timer_handle_t timer)
 {
-#if WITH_PROFILING
-    timer_remove_inactive(timer);
-#endif
-    esp_timer_handle_t it, last = NULL;
     esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
-    if (LIST_FIRST(&s_timers[dispatch_method]) == NULL) {
-        LIST_INSERT_HEAD(&s_timers[dispatch_method], timer, list_entry);
+    timer->seq = s_timer_seq[dispatch_method]++;
+    timer->heap_child = NULL;
+    timer->heap_next = NULL;
+    timer->heap_prev = NULL;
+    if (s_timers[dispatch_method] == NULL) {
+        s_timers[dispatch_method] = timer;
     } else {
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            if (timer->alarm < it->alarm) {
-                LIST_INSERT_BEFORE(it, timer, list_entry);
-                break;
-            }
-            last = it;
+        s_timers[dispatch_method] = timer_heap_meld(s_timers[dispatch_method], timer);
+    }
+}
+
+static IRAM_ATTR void timer_heap_remove(esp_timer_handle_t timer)
+{
+    esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
+    esp_timer_handle_t subheap = timer_heap_merge_pairs(timer->heap_child);
+    if (timer == s_timers[dispatch_method]) {
+        s_timers[dispatch_method] = subheap;
+    } else {
+        // unlink the timer from its siblings, then meld its children back into the heap
+        if (timer->heap_prev->heap_child == timer) {
+            timer->heap_prev->heap_child = timer->heap_next;
+        } else {
+            timer->heap_prev->heap_next = timer->heap_next;
         }
-        if (it == NULL) {
-            assert(last);
-            LIST_INSERT_AFTER(last, timer, list_entry);
+        if (timer->heap_next) {
+            timer->heap_next->heap_prev = timer->heap_prev;
+        }
+        if (subheap) {
+            s_timers[dispatch_method] = timer_heap_meld(s_timers[dispatch_method], subheap);
         }
     }
-    if (without_update_alarm == false && timer == LIST_FIRST(&s_timers[dispatch_method])) {
+    timer->heap_child = NULL;
+    timer->heap_next = NULL;
+    timer->heap_prev = NULL;
+}
+
+/*
+ * Returns the timer following 'timer' in a pre-order walk of the heap, or NULL at the end.
+ * If 'descend' is false, the children of 'timer' are skipped. Since a timer never expires
+ * earlier than its parent, this allows to prune the walk when looking for the earliest alarm.
+ */
+static IRAM_ATTR esp_timer_handle_t timer_heap_walk_next(esp_timer_handle_t timer, bool descend)
+{
+    if (descend && timer->heap_child) {
+        return timer->heap_child;
+    }
+    while (timer) {
+        if (timer->heap_next) {
+            return timer->heap_next;
+        }
+        // go back to the first sibling, whose 'heap_prev' is the parent (or NULL for the root)
+        while (timer->heap_prev && timer->heap_prev->heap_child != timer) {
+            timer = timer->heap_prev;
+        }
+        timer = timer->heap_prev;
+    }
+    return NULL;
+}
+
+static IRAM_ATTR esp_err_t timer_insert(esp_timer_handle_t timer, bool without_update_alarm)
+{
+#if WITH_PROFILING
+    timer_remove_inactive(timer);
+#endif
+    esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
+    timer_heap_insert(timer);
+    if (without_update_alarm == false && timer == s_timers[dispatch_method]) {
         esp_timer_impl_set_alarm_id(timer->alarm, dispatch_method);
     }
     return ESP_OK;
@@ -323,14 +454,14 @@ static IRAM_ATTR esp_err_t timer_remove(esp_timer_handle_t timer)
 {
     esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
     timer_list_lock(dispatch_method);
-    esp_timer_handle_t first_timer = LIST_FIRST(&s_timers[dispatch_method]);
-    LIST_REMOVE(timer, list_entry);
+    esp_timer_handle_t first_timer = s_timers[dispatch_method];
+    timer_heap_remove(timer);
     timer->alarm = 0;
     timer->period = 0;
-    if (timer == first_timer) { // if this timer was the first in the list.
+    if (timer == first_timer) { // if this timer was the first in the heap.
         uint64_t next_timestamp = UINT64_MAX;
-        first_timer = LIST_FIRST(&s_timers[dispatch_method]);
-        if (first_timer) { // if after removing the timer from the list, this list is not empty.
+        first_timer = s_timers[dispatch_method];
+        if (first_timer) { // if after removing the timer from the heap, this heap is not empty.
             next_timestamp = first_timer->alarm;
         }
         esp_timer_impl_set_alarm_id(next_timestamp, dispatch_method);
@@ -393,7 +524,7 @@ static bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
     bool processed = false;
     esp_timer_handle_t it;
     while (1) {
-        it = LIST_FIRST(&s_timers[dispatch_method]);
+        it = s_timers[dispatch_method];
         int64_t now = esp_timer_impl_get_time();
         ESP_COMPILER_DIAGNOSTIC_PUSH_IGNORE("-Wanalyzer-use-after-free") // False-positive detection. TODO GCC-366
         if (it == NULL || it->alarm > now) {
@@ -401,10 +532,10 @@ static bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
         }
         ESP_COMPILER_DIAGNOSTIC_POP("-Wanalyzer-use-after-free")
         processed = true;
-        LIST_REMOVE(it, list_entry);
+        timer_heap_remove(it);
         if (it->event_id == EVENT_ID_DELETE_TIMER) {
             // It is handled only by ESP_TIMER_TASK (see esp_timer_delete()).
-            // All the ESP_TIMER_ISR timers which should be deleted are moved by esp_timer_delete() to the ESP_TIMER_TASK list.
+            // All the ESP_TIMER_ISR timers which should be deleted are moved by esp_timer_delete() to the ESP_TIMER_TASK heap.
             // We want to free memory of the timer in a task context instead of an isr context.
             free(it);
             it = NULL;
@@ -419,7 +550,7 @@ static bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
                 } else {
                     it->alarm += it->period;
                 }
-                timer_insert(it, true);
+                timer_heap_insert(it);
             } else {
                 it->alarm = 0;
 #if WITH_PROFILING
@@ -465,7 +596,10 @@ static void timer_task(void* arg)
 #ifdef CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
 IRAM_ATTR void esp_timer_isr_dispatch_need_yield(void)
 {
+#if !CONFIG_IDF_TARGET_LINUX
+    // the Linux port does not track the context of the simulated interrupts
     assert(xPortInIsrContext());
+#endif
     s_isr_dispatch_need_yield = pdTRUE;
 }
 #endif
@@ -486,9 +620,7 @@ static void IRAM_ATTR timer_alarm_handler(void* arg)
     if (isr_timers_processed == false) {
         vTaskNotifyGiveFromISR(s_timer_task, &xHigherPriorityTaskWoken);
     }
-    if (xHigherPriorityTaskWoken == pdTRUE) {
-        portYIELD_FROM_ISR();
-    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 static IRAM_ATTR inline bool is_initialized(void)
@@ -547,6 +679,7 @@ esp_err_t esp_timer_init(void)
     return err;
 }
 
+#if !CONFIG_IDF_TARGET_LINUX
 #if CONFIG_ESP_TIMER_ISR_AFFINITY_CPU0
 #define ESP_TIMER_INIT_MASK BIT(0)
 #elif CONFIG_ESP_TIMER_ISR_AFFINITY_CPU1
@@ -566,6 +699,23 @@ ESP_SYSTEM_INIT_FN(esp_timer_init_os, SECONDARY, ESP_TIMER_INIT_MASK, 100)
 {
     return esp_timer_init();
 }
+#else
+/*
+ * There is no startup code running the system init functions on Linux,
+ * the task and the dispatch thread are created when the first timer is created.
+ * The scheduler is suspended so that two tasks can not both initialize esp_timer.
+ */
+static esp_err_t esp_timer_init_on_first_use(void)
+{
+    esp_err_t err = ESP_OK;
+    vTaskSuspendAll();
+    if (!is_initialized()) {
+        err = esp_timer_init();
+    }
+    xTaskResumeAll();
+    return err;
+}
+#endif // !CONFIG_IDF_TARGET_LINUX
 
 esp_err_t esp_timer_deinit(void)
 {
@@ -575,7 +725,7 @@ esp_err_t esp_timer_deinit(void)
 
     /* Check if there are any active timers */
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
-        if (!LIST_EMPTY(&s_timers[dispatch_method])) {
+        if (s_timers[dispatch_method] != NULL) {
             return ESP_ERR_INVALID_STATE;
         }
     }
@@ -606,19 +756,29 @@ static void print_timer_info(esp_timer_handle_t t, char** dst, size_t* dst_size)
     } else {
         cb = snprintf(*dst, *dst_size, "timer@%-10p  ", t);
     }
-    cb += snprintf(*dst + cb, *dst_size + cb, "%-10lld  %-12lld  %-12d  %-12d  %-12d  %-12lld\n",
+    cb += snprintf(*dst + cb, *dst_size + cb, "%-10" PRIu64 "  %-12" PRIu64 "  %-12zu  %-12zu  %-12zu  %-12" PRIu64 "\n",
                    (uint64_t)t->period, t->alarm, t->times_armed,
                    t->times_triggered, t->times_skipped, t->total_callback_run_time);
     /* keep this in sync with the format string, used in esp_timer_dump */
 #define TIMER_INFO_LINE_LEN 90
 #else
-    size_t cb = snprintf(*dst, *dst_size, "timer@%-14p  %-10lld  %-12lld\n", t, (uint64_t)t->period, t->alarm);
+    size_t cb = snprintf(*dst, *dst_size, "timer@%-14p  %-10" PRIu64 "  %-12" PRIu64 "\n", t, (uint64_t)t->period, t->alarm);
 #define TIMER_INFO_LINE_LEN 46
 #endif
     *dst += cb;
     *dst_size -= cb;
 }
 
+static int compare_timer_alarms(const void* a, const void* b)
+{
+    esp_timer_handle_t timer_a = *(const esp_timer_handle_t*) a;
+    esp_timer_handle_t timer_b = *(const esp_timer_handle_t*) b;
+    if (timer_heap_before(timer_a, timer_b)) {
+        return -1;
+    }
+    return timer_heap_before(timer_b, timer_a) ? 1 : 0;
+}
+
 esp_err_t esp_timer_dump(FILE* stream)
 {
     /* Since timer lock is a critical section, we don't want to print directly
@@ -633,7 +793,7 @@ esp_err_t esp_timer_dump(FILE* stream)
     size_t timer_count = 0;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
+        for (it = s_timers[dispatch_method]; it != NULL; it = timer_heap_walk_next(it, true)) {
             ++timer_count;
         }
 #if WITH_PROFILING
@@ -651,7 +811,14 @@ esp_err_t esp_timer_dump(FILE* stream)
      */
     size_t buf_size = TIMER_INFO_LINE_LEN * (timer_count + 3);
     char* print_buf = calloc(1, buf_size + 1);
-    if (print_buf == NULL) {
+    /* The heap of armed timers is not sorted, collect the armed timers
+     * into an array and sort them by alarm before printing.
+     */
+    size_t sorted_size = timer_count + 3;
+    esp_timer_handle_t* sorted = calloc(sorted_size, sizeof(esp_timer_handle_t));
+    if (print_buf == NULL || sorted == NULL) {
+        free(print_buf);
+        free(sorted);
         return ESP_ERR_NO_MEM;
     }
 
@@ -659,8 +826,13 @@ esp_err_t esp_timer_dump(FILE* stream)
     char* pos = print_buf;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            print_timer_info(it, &pos, &buf_size);
+        size_t sorted_count = 0;
+        for (it = s_timers[dispatch_method]; it != NULL && sorted_count < sorted_size; it = timer_heap_walk_next(it, true)) {
+            sorted[sorted_count++] = it;
+        }
+        qsort(sorted, sorted_count, sizeof(esp_timer_handle_t), compare_timer_alarms);
+        for (size_t i = 0; i < sorted_count; ++i) {
+            print_timer_info(sorted[i], &pos, &buf_size);
         }
 #if WITH_PROFILING
         LIST_FOREACH(it, &s_inactive_timers[dispatch_method], list_entry) {
@@ -684,6 +856,7 @@ esp_err_t esp_timer_dump(FILE* stream)
     }
 
     free(print_buf);
+    free(sorted);
     return ESP_OK;
 }
 
@@ -692,7 +865,7 @@ int64_t IRAM_ATTR esp_timer_get_next_alarm(void)
     int64_t next_alarm = INT64_MAX;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        esp_timer_handle_t it = LIST_FIRST(&s_timers[dispatch_method]);
+        esp_timer_handle_t it = s_timers[dispatch_method];
         if (it) {
             if (next_alarm > it->alarm) {
                 next_alarm = it->alarm;
@@ -708,15 +881,19 @@ int64_t IRAM_ATTR esp_timer_get_next_alarm_for_wake_up(void)
     int64_t next_alarm = INT64_MAX;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        esp_timer_handle_t it = NULL;
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            // timers with the SKIP_UNHANDLED_EVENTS flag do not want to wake up CPU from a sleep mode.
-            if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
-                if (next_alarm > it->alarm) {
+        esp_timer_handle_t it = s_timers[dispatch_method];
+        while (it) {
+            bool descend = false;
+            if (it->alarm < next_alarm) {
+                // timers with the SKIP_UNHANDLED_EVENTS flag do not want to wake up CPU from a sleep mode.
+                if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
+                    // children of this timer can not expire earlier, no need to look at them
                     next_alarm = it->alarm;
+                } else {
+                    descend = true;
                 }
-                break;
             }
+            it = timer_heap_walk_next(it, descend);
         }
         timer_list_unlock(dispatch_method);
     }
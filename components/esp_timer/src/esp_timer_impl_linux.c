@@ -0,0 +1,235 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <sys/timerfd.h>
+#include "sdkconfig.h"
+#include "esp_timer_impl.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @file esp_timer_impl_linux.c
+ * @brief Implementation of esp_timer for the Linux target.
+ *
+ * The counter is CLOCK_MONOTONIC, counted from the moment the application was loaded.
+ * The alarm is a timerfd armed with an absolute expiry time.
+ *
+ * A dispatch thread, which is not a FreeRTOS task, waits for the timerfd to expire and
+ * raises ESP_TIMER_ALARM_SIGNAL. The FreeRTOS simulator keeps signals blocked in all of
+ * its threads except in the task which is currently running (and only while it is outside
+ * of a critical section), so the signal is handled by that task, the same way the tick
+ * interrupt (SIGALRM) is. The upper layer handler thus runs in an interrupt-like context
+ * and can use the FromISR FreeRTOS APIs, as on the chip targets.
+ */
+
+static const char *TAG = "esp_timer_linux";
+
+#define ESP_TIMER_ALARM_SIGNAL  (SIGRTMIN)
+
+/* Function from the upper layer to be called when the alarm expires.
+ * Registered in esp_timer_impl_init.
+ */
+static intr_handler_t s_alarm_handler = NULL;
+
+/* Spinlock used to protect access to the alarm and to the time base. */
+extern portMUX_TYPE s_time_update_lock;
+
+/* Alarm values to generate interrupt on match */
+extern uint64_t timestamp_id[2];
+
+/* CLOCK_MONOTONIC time, in microseconds, at which esp_timer time was 0 */
+static int64_t s_time_base_us;
+
+/* Alarm which is currently set, in esp_timer time */
+static uint64_t s_alarm = UINT64_MAX;
+
+static int s_timer_fd = -1;
+static pthread_t s_dispatch_thread;
+
+/* Set by the dispatch thread when it raises the signal, cleared by the signal handler.
+ * Avoids queueing more than one signal if the handler is delayed by a critical section.
+ */
+static atomic_bool s_alarm_pending;
+
+static int64_t get_monotonic_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t esp_timer_impl_get_counter_reg(void)
+{
+    return get_monotonic_time_us();
+}
+
+int64_t esp_timer_impl_get_time(void)
+{
+    return get_monotonic_time_us() - s_time_base_us;
+}
+
+int64_t esp_timer_get_time(void) __attribute__((alias("esp_timer_impl_get_time")));
+
+/* Must be called with s_time_update_lock held */
+static void set_alarm_target(uint64_t timestamp)
+{
+    s_alarm = timestamp;
+    if (s_timer_fd < 0) {
+        return;
+    }
+    struct itimerspec spec = { 0 };
+    if (timestamp != UINT64_MAX) {
+        /* An expiry time in the past makes the timerfd expire right away, like the hardware
+         * alarm does. A zero expiry time would disarm it instead, hence the MAX.
+         */
+        uint64_t target_us = MIN(timestamp, (uint64_t) INT64_MAX - s_time_base_us) + s_time_base_us;
+        target_us = MAX(target_us, 1);
+        spec.it_value.tv_sec = target_us / 1000000;
+        spec.it_value.tv_nsec = (target_us % 1000000) * 1000;
+    }
+    timerfd_settime(s_timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+void esp_timer_impl_set_alarm_id(uint64_t timestamp, unsigned alarm_id)
+{
+    assert(alarm_id < sizeof(timestamp_id) / sizeof(timestamp_id[0]));
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    timestamp_id[alarm_id] = timestamp;
+    set_alarm_target(MIN(timestamp_id[0], timestamp_id[1]));
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+}
+
+static void timer_alarm_signal_handler(int sig)
+{
+    /* All signals are blocked while the handler runs. Enter a critical section, as the tick
+     * handler does, so that the critical sections taken by the upper layer handler do not
+     * unblock them when they are exited.
+     */
+    vPortEnterCritical();
+    atomic_store(&s_alarm_pending, false);
+    if (s_alarm_handler != NULL) {
+        (*s_alarm_handler)(NULL);
+    }
+    vPortExitCritical();
+}
+
+static void *timer_dispatch_thread(void *arg)
+{
+    while (true) {
+        uint64_t expirations;
+        ssize_t len = read(s_timer_fd, &expirations, sizeof(expirations));
+        if (len != sizeof(expirations)) {
+            // nothing has expired, wait for the next alarm
+            continue;
+        }
+        if (!atomic_exchange(&s_alarm_pending, true)) {
+            kill(getpid(), ESP_TIMER_ALARM_SIGNAL);
+        }
+    }
+    return NULL;
+}
+
+void esp_timer_impl_set(uint64_t new_us)
+{
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    s_time_base_us = get_monotonic_time_us() - new_us;
+    set_alarm_target(s_alarm);
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+}
+
+void esp_timer_impl_advance(int64_t time_diff_us)
+{
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    s_time_base_us -= time_diff_us;
+    set_alarm_target(s_alarm);
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+}
+
+esp_err_t esp_timer_impl_early_init(void)
+{
+    s_time_base_us = get_monotonic_time_us();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_impl_init(intr_handler_t alarm_handler)
+{
+    if (s_timer_fd >= 0) {
+        ESP_EARLY_LOGE(TAG, "timer dispatch thread is already initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        ESP_EARLY_LOGE(TAG, "timerfd_create failed (%d)", errno);
+        return ESP_FAIL;
+    }
+
+    s_alarm_handler = alarm_handler;
+    atomic_store(&s_alarm_pending, false);
+    struct sigaction action = {
+        .sa_handler = timer_alarm_signal_handler,
+        .sa_flags = SA_RESTART,
+    };
+    sigfillset(&action.sa_mask);
+    sigaction(ESP_TIMER_ALARM_SIGNAL, &action, NULL);
+
+    /* The dispatch thread must never handle any signal, create it with all signals blocked */
+    sigset_t all_signals, prev_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &prev_signals);
+    s_timer_fd = timer_fd;
+    int ret = pthread_create(&s_dispatch_thread, NULL, timer_dispatch_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &prev_signals, NULL);
+    if (ret != 0) {
+        ESP_EARLY_LOGE(TAG, "pthread_create failed (%d)", ret);
+        s_timer_fd = -1;
+        close(timer_fd);
+        s_alarm_handler = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* An alarm may have been set before the timerfd existed */
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    set_alarm_target(s_alarm);
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+    return ESP_OK;
+}
+
+void esp_timer_impl_deinit(void)
+{
+    if (s_timer_fd < 0) {
+        return;
+    }
+    pthread_cancel(s_dispatch_thread);
+    pthread_join(s_dispatch_thread, NULL);
+    close(s_timer_fd);
+    s_timer_fd = -1;
+    /* Ignoring the signal also discards one which may still be pending */
+    signal(ESP_TIMER_ALARM_SIGNAL, SIG_IGN);
+    s_alarm_handler = NULL;
+}
+
+uint64_t esp_timer_impl_get_alarm_reg(void)
+{
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    uint64_t val = s_alarm;
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+    return val;
+}
+
+void esp_timer_private_set(uint64_t new_us) __attribute__((alias("esp_timer_impl_set")));
+void esp_timer_private_advance(int64_t time_diff_us) __attribute__((alias("esp_timer_impl_advance")));
@@ -4,9 +4,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "esp_private/startup_internal.h"
+#endif
 #include "esp_timer_impl.h"
-#include "sdkconfig.h"
 
 esp_err_t esp_timer_early_init(void)
 {
@@ -24,10 +26,18 @@ esp_err_t esp_timer_early_init(void)
  * Another initialization function, esp_timer_init_nonos (which initializes ISR and task),
  * is called only if other code calls the esp_timer API.
  */
+#if !CONFIG_IDF_TARGET_LINUX
 ESP_SYSTEM_INIT_FN(esp_timer_init_nonos, CORE, BIT(0), 101)
 {
     return esp_timer_early_init();
 }
+#else
+/* There is no startup code on Linux, start counting the time when the application is loaded. */
+__attribute__((constructor)) static void esp_timer_init_nonos(void)
+{
+    esp_timer_early_init();
+}
+#endif // !CONFIG_IDF_TARGET_LINUX
 
 void esp_timer_init_include_func(void)
 {
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define SEC  (1000000)
+
+/* A stride which is coprime with all the tested timer counts, to visit the timers in a scrambled order */
+#define SCRAMBLE_STRIDE  7919
+
+typedef struct {
+    SemaphoreHandle_t done;
+    size_t count;
+    size_t fired;
+    int64_t first_fire;
+    int64_t last_fire;
+} scaling_fire_state_t;
+
+static void scaling_fire_cb(void* arg)
+{
+    scaling_fire_state_t* state = (scaling_fire_state_t*) arg;
+    int64_t now = esp_timer_get_time();
+    if (state->fired == 0) {
+        state->first_fire = now;
+    }
+    if (++state->fired == state->count) {
+        state->last_fire = now;
+        xSemaphoreGive(state->done);
+    }
+}
+
+/* The costs depend on the target, the caches and the load of the CPUs, they are reported and not checked:
+ * the test checks that thousands of timers can be armed, stopped and fired */
+TEST_CASE("esp_timer start/stop/fire cost with 10 to 10000 armed timers", "[esp_timer][timeout=120]")
+{
+    const size_t counts[] = { 10, 100, 1000, 10000 };
+    const size_t max_count = counts[sizeof(counts) / sizeof(counts[0]) - 1];
+    esp_timer_handle_t* handles = calloc(max_count, sizeof(esp_timer_handle_t));
+    TEST_ASSERT_NOT_NULL(handles);
+    scaling_fire_state_t state = {
+        .done = xSemaphoreCreateBinary(),
+    };
+    TEST_ASSERT_NOT_NULL(state.done);
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        const size_t count = counts[c];
+        size_t created = 0;
+        esp_timer_create_args_t args = {
+            .callback = &scaling_fire_cb,
+            .arg = &state,
+            .name = "scaling"
+        };
+        while (created < count && esp_timer_create(&args, &handles[created]) == ESP_OK) {
+            ++created;
+        }
+        if (created < count) {
+            printf("Not enough memory for %u timers, stopping\n", (unsigned) count);
+            for (size_t i = 0; i < created; ++i) {
+                TEST_ESP_OK(esp_timer_delete(handles[i]));
+            }
+            break;
+        }
+
+        /* Arm the timers with alarms spread over one second, in a scrambled order */
+        int64_t t0 = esp_timer_get_time();
+        for (size_t i = 0; i < count; ++i) {
+            TEST_ESP_OK(esp_timer_start_once(handles[i], SEC + (i * SCRAMBLE_STRIDE) % SEC));
+        }
+        int64_t start_time = esp_timer_get_time() - t0;
+
+        t0 = esp_timer_get_time();
+        for (size_t i = 0; i < count; ++i) {
+            TEST_ESP_OK(esp_timer_stop(handles[(i * SCRAMBLE_STRIDE) % count]));
+        }
+        int64_t stop_time = esp_timer_get_time() - t0;
+
+        /* Arm all the timers to expire at the same moment, then measure how long it takes to dispatch them */
+        state.count = count;
+        state.fired = 0;
+        int64_t deadline = esp_timer_get_time() + 2 * start_time + 20000;
+        for (size_t i = 0; i < count; ++i) {
+            TEST_ESP_OK(esp_timer_start_once(handles[i], deadline - esp_timer_get_time()));
+        }
+        TEST_ASSERT_TRUE(xSemaphoreTake(state.done, pdMS_TO_TICKS(10000)));
+        int64_t fire_time = state.last_fire - state.first_fire;
+
+        int64_t start_ns = start_time * 1000 / count;
+        printf("%5u timers: start %6" PRId64 " ns, stop %6" PRId64 " ns, fire %6" PRId64 " ns per timer\n",
+               (unsigned) count, start_ns, stop_time * 1000 / count, fire_time * 1000 / count);
+
+        for (size_t i = 0; i < count; ++i) {
+            TEST_ESP_OK(esp_timer_delete(handles[i]));
+        }
+        vTaskDelay(2); // wait for the esp_timer task to delete the timers
+    }
+
+    vSemaphoreDelete(state.done);
+    free(handles);
+}
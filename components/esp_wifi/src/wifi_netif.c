@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2019-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2019-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -24,6 +24,15 @@ struct wifi_netif_driver {
 
 static const char* TAG = "wifi_netif";
 
+// dynamic rx buffers hold the frames passed to the stack, unless unlimited
+#if CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM
+#define WIFI_NETIF_RX_BUFFER_NUM CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM
+#elif defined(CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM)
+#define WIFI_NETIF_RX_BUFFER_NUM CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM
+#else
+#define WIFI_NETIF_RX_BUFFER_NUM 0
+#endif
+
 /**
  * @brief Local storage for netif handles and callbacks for specific wifi interfaces
  */
@@ -84,7 +93,8 @@ static esp_err_t wifi_driver_start(esp_netif_t * esp_netif, void * args)
         .handle =  driver,
         .transmit = wifi_transmit,
         .transmit_wrap = wifi_transmit_wrap,
-        .driver_free_rx_buffer = wifi_free
+        .driver_free_rx_buffer = wifi_free,
+        .rx_buffer_num = WIFI_NETIF_RX_BUFFER_NUM
     };
 
     return esp_netif_set_driver_config(esp_netif, &driver_ifconfig);
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -70,6 +70,14 @@ esp_err_t heap_caps_register_failed_alloc_callback(esp_alloc_failed_hook_t callb
     return ESP_OK;
 }
 
+#if !CONFIG_HEAP_THREAD_CACHE
+// Without the thread caches, there is nothing to flush before reporting on the heaps
+size_t heap_caps_thread_cache_flush(void)
+{
+    return 0;
+}
+#endif
+
 bool heap_caps_match(const heap_t *heap, uint32_t caps)
 {
     return heap->heap != NULL && ((get_all_caps(heap) & caps) == caps);
@@ -283,6 +291,10 @@ size_t heap_caps_get_free_size( uint32_t caps )
             ret += multi_heap_free_size(heap->heap);
         }
     }
+#if CONFIG_HEAP_THREAD_CACHE
+    // The cached blocks are free for the callers, flushing them would empty the caches on every poll
+    ret += heap_caps_thread_cache_free_size(caps);
+#endif
     return ret;
 }
 
@@ -366,6 +378,7 @@ esp_err_t heap_caps_monitor_local_minimum_free_size_stop(void)
 
 void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps )
 {
+    heap_caps_thread_cache_flush();
     memset(info, 0, sizeof(multi_heap_info_t));
 
     heap_t *heap;
@@ -390,6 +403,7 @@ void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps )
 
 void heap_caps_print_heap_info( uint32_t caps )
 {
+    heap_caps_thread_cache_flush();
     multi_heap_info_t info;
     printf("Heap summary for capabilities 0x%08"PRIX32":\n", caps);
     heap_t *heap;
@@ -412,6 +426,7 @@ void heap_caps_print_heap_info( uint32_t caps )
 
 bool heap_caps_check_integrity(uint32_t caps, bool print_errors)
 {
+    heap_caps_thread_cache_flush();
     bool all_heaps = caps & MALLOC_CAP_INVALID;
     bool valid = true;
 
@@ -433,6 +448,7 @@ bool heap_caps_check_integrity_all(bool print_errors)
 
 bool heap_caps_check_integrity_addr(intptr_t addr, bool print_errors)
 {
+    heap_caps_thread_cache_flush();
     heap_t *heap = find_containing_heap((void *)addr);
     if (heap == NULL) {
         return false;
@@ -442,6 +458,7 @@ bool heap_caps_check_integrity_addr(intptr_t addr, bool print_errors)
 
 void heap_caps_dump(uint32_t caps)
 {
+    heap_caps_thread_cache_flush();
     bool all_heaps = caps & MALLOC_CAP_INVALID;
     heap_t *heap;
     SLIST_FOREACH(heap, &registered_heaps, next) {
@@ -586,6 +603,7 @@ __attribute__((noinline)) static bool heap_caps_walker(void* block_ptr, size_t b
 
 void heap_caps_walk(uint32_t caps, heap_caps_walker_cb_t walker_func, void *user_data)
 {
+    heap_caps_thread_cache_flush();
     assert(walker_func != NULL);
 
     bool all_heaps = caps & MALLOC_CAP_INVALID;
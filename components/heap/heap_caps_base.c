@@ -73,6 +73,12 @@ HEAP_IRAM_ATTR void heap_caps_free( void *ptr)
     void *block_owner_ptr = MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr);
     heap_t *heap = find_containing_heap(block_owner_ptr);
     assert(heap != NULL && "free() target pointer is outside heap areas");
+#if CONFIG_HEAP_THREAD_CACHE
+    if (heap_caps_thread_cache_free(heap, block_owner_ptr)) {
+        CALL_HOOK(esp_heap_trace_free_hook, ptr);
+        return;
+    }
+#endif
     multi_heap_free(heap->heap, block_owner_ptr);
 
     CALL_HOOK(esp_heap_trace_free_hook, ptr);
@@ -124,6 +130,18 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
         size = (size + 3) & (~3); // int overflow checked above
     }
 
+#if CONFIG_HEAP_THREAD_CACHE
+    if (alignment <= UNALIGNED_MEM_ALIGNMENT_BYTES && !(caps & MALLOC_CAP_EXEC)) {
+        ret = heap_caps_thread_cache_alloc(size, caps);
+        if (ret != NULL) {
+            CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
+            return ret;
+        }
+    }
+    bool thread_cache_flushed = false;
+retry:
+#endif
+
     for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS; prio++) {
         //Iterate over heaps and check capabilities at this priority
         heap_t *heap;
@@ -169,6 +187,14 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
         }
     }
 
+#if CONFIG_HEAP_THREAD_CACHE
+    //The blocks held in the thread caches may be what this allocation is missing.
+    if (!thread_cache_flushed && heap_caps_thread_cache_flush() > 0) {
+        thread_cache_flushed = true;
+        goto retry;
+    }
+#endif
+
     //Nothing usable found.
     return NULL;
 }
@@ -0,0 +1,402 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/param.h>
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_pool.h"
+#include "sdkconfig.h"
+
+/*
+This file implements pools of fixed-size objects on top of the capabilities-based heap. The objects of a pool are
+carved out of slabs, which are single heap blocks with the capabilities of the pool. The free objects form a singly
+linked list, through their first word, so allocating and freeing an object is a push or a pop under the lock of the
+pool. Each object is preceded by a pointer to its slab, like the header of a heap block, so the slab of an object is
+found in constant time whatever the number of slabs. Each slab also has a bitmap of its allocated objects, to detect
+invalid and double frees, and for heap_caps_pool_walk().
+
+A growable pool allocates a new slab when it runs out of objects. The slabs are only freed with the pool, so the
+objects of a pool never fragment the heap: they are either all in place, or all returned at once.
+*/
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <stdio.h>
+#include <pthread.h>
+
+typedef pthread_mutex_t pool_lock_t;
+#define POOL_LOCK_INIT(PLOCK)   pthread_mutex_init((PLOCK), NULL)
+#define POOL_LOCK_DELETE(PLOCK) pthread_mutex_destroy((PLOCK))
+#define POOL_LOCK(PLOCK)        pthread_mutex_lock((PLOCK))
+#define POOL_UNLOCK(PLOCK)      pthread_mutex_unlock((PLOCK))
+#define POOL_PRINTF             printf
+#define POOL_IRAM_ATTR
+#else
+#include "multi_heap_platform.h"
+
+typedef multi_heap_lock_t pool_lock_t;
+#define POOL_LOCK_INIT(PLOCK)   MULTI_HEAP_LOCK_INIT((PLOCK))
+#define POOL_LOCK_DELETE(PLOCK)
+#define POOL_LOCK(PLOCK)        MULTI_HEAP_LOCK((PLOCK))
+#define POOL_UNLOCK(PLOCK)      MULTI_HEAP_UNLOCK((PLOCK))
+#define POOL_PRINTF             MULTI_HEAP_PRINTF
+#define POOL_IRAM_ATTR          HEAP_IRAM_ATTR
+#endif
+
+// Objects are aligned like the blocks of the heap, and hold at least the link of the free list
+#define POOL_OBJ_ALIGN          (sizeof(void *))
+#define POOL_ALIGN_UP(X)        (((X) + POOL_OBJ_ALIGN - 1) & ~(POOL_OBJ_ALIGN - 1))
+
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+// Same patterns as the heap, see multi_heap_poisoning.c
+#define MALLOC_FILL_PATTERN     0xce
+#define FREE_FILL_PATTERN       0xfe
+#endif
+
+typedef struct pool_free_obj {
+    struct pool_free_obj *next;
+} pool_free_obj_t;
+
+typedef struct pool_slab {
+    struct pool_slab *next;
+    heap_caps_pool_handle_t pool; ///< Pool of the slab, to check the slab pointers of the objects
+    uint8_t *objects; ///< First slot of the slab
+    size_t count;     ///< Number of objects in the slab
+    uint32_t used[];  ///< Bitmap of the allocated objects
+} pool_slab_t;
+
+// Each object of a slab is in a slot, after a pointer to the slab
+typedef struct {
+    pool_slab_t *slab;
+} pool_slot_t;
+
+#define POOL_SLOT_OBJ(SLOT)     ((void *)((pool_slot_t *)(SLOT) + 1))
+
+struct heap_caps_pool {
+    pool_lock_t lock;
+    size_t obj_size;
+    size_t slot_size;
+    uint32_t caps;
+    size_t grow_count;
+    pool_free_obj_t *free_list;
+    pool_slab_t *slabs;
+    size_t total_count;
+    size_t free_count;
+    size_t minimum_free_count;
+    size_t slab_count;
+};
+
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+/* Fill a free object, except its link, with FREE_FILL_PATTERN */
+static POOL_IRAM_ATTR void pool_poison_free_obj(heap_caps_pool_handle_t pool, pool_free_obj_t *obj)
+{
+    memset(obj + 1, FREE_FILL_PATTERN, pool->obj_size - sizeof(pool_free_obj_t));
+}
+
+/* Returns the first byte of a free object, after its link, which is not FREE_FILL_PATTERN, or NULL */
+static POOL_IRAM_ATTR const uint8_t *pool_find_free_obj_corruption(heap_caps_pool_handle_t pool, const pool_free_obj_t *obj)
+{
+    const uint8_t *data = (const uint8_t *)(obj + 1);
+    for (size_t i = 0; i < pool->obj_size - sizeof(pool_free_obj_t); i++) {
+        if (data[i] != FREE_FILL_PATTERN) {
+            return &data[i];
+        }
+    }
+    return NULL;
+}
+#endif
+
+/* Returns the slab containing the object ptr, and the index of the object in the slab, or NULL.
+ * The slab is read from the slot of the object: a pointer which is not in a heap block may fault, like with
+ * heap_caps_free(). */
+static POOL_IRAM_ATTR pool_slab_t *pool_find_slab(heap_caps_pool_handle_t pool, const void *ptr, size_t *index)
+{
+    if ((intptr_t)ptr % POOL_OBJ_ALIGN != 0) {
+        return NULL;
+    }
+    const uint8_t *slot = (const uint8_t *)ptr - sizeof(pool_slot_t);
+    pool_slab_t *slab = ((const pool_slot_t *)slot)->slab;
+    if (slab == NULL || slab->pool != pool
+            || slot < slab->objects || slot >= slab->objects + slab->count * pool->slot_size) {
+        return NULL;
+    }
+    size_t offset = slot - slab->objects;
+    if (offset % pool->slot_size != 0) {
+        return NULL;
+    }
+    *index = offset / pool->slot_size;
+    return slab;
+}
+
+/* Returns true if ptr is in the slots of a slab of the pool. Unlike pool_find_slab(), it does not read ptr,
+ * to follow a free list which may be corrupt, but takes a time proportional to the number of slabs. */
+static bool pool_in_slabs(heap_caps_pool_handle_t pool, const void *ptr)
+{
+    for (const pool_slab_t *slab = pool->slabs; slab != NULL; slab = slab->next) {
+        if ((const uint8_t *)ptr > slab->objects && (const uint8_t *)ptr < slab->objects + slab->count * pool->slot_size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static pool_slab_t *pool_slab_create(heap_caps_pool_handle_t pool, size_t count)
+{
+    size_t header_size = POOL_ALIGN_UP(sizeof(pool_slab_t) + (count + 31) / 32 * sizeof(uint32_t));
+    size_t objects_size;
+    if (__builtin_mul_overflow(pool->slot_size, count, &objects_size) || objects_size > SIZE_MAX - header_size) {
+        return NULL;
+    }
+    pool_slab_t *slab = heap_caps_malloc(header_size + objects_size, pool->caps);
+    if (slab == NULL) {
+        return NULL;
+    }
+    memset(slab, 0, header_size);
+    slab->pool = pool;
+    slab->objects = (uint8_t *)slab + header_size;
+    slab->count = count;
+    for (size_t i = 0; i < count; i++) {
+        ((pool_slot_t *)(slab->objects + i * pool->slot_size))->slab = slab;
+    }
+    return slab;
+}
+
+/* Add the objects of a new slab to the free list, must be called with the lock of the pool */
+static void pool_add_slab(heap_caps_pool_handle_t pool, pool_slab_t *slab)
+{
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    // Push in reverse order, so that the objects are allocated in address order
+    for (size_t i = slab->count; i > 0; i--) {
+        pool_free_obj_t *obj = POOL_SLOT_OBJ(slab->objects + (i - 1) * pool->slot_size);
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+        pool_poison_free_obj(pool, obj);
+#endif
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+    }
+    pool->total_count += slab->count;
+    pool->free_count += slab->count;
+    pool->slab_count++;
+}
+
+heap_caps_pool_handle_t heap_caps_pool_create_growable(size_t obj_size, uint32_t caps, size_t count, size_t grow_count)
+{
+    if (obj_size == 0 || count == 0 || obj_size > SIZE_MAX - POOL_OBJ_ALIGN - sizeof(pool_slot_t)) {
+        return NULL;
+    }
+    obj_size = POOL_ALIGN_UP(MAX(obj_size, sizeof(pool_free_obj_t)));
+
+    // The pool is used from ISRs, it must be in internal memory whatever the memory of the objects
+    heap_caps_pool_handle_t pool = heap_caps_calloc(1, sizeof(struct heap_caps_pool), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->obj_size = obj_size;
+    pool->slot_size = sizeof(pool_slot_t) + obj_size;
+    pool->caps = caps;
+    pool->grow_count = grow_count;
+    pool_slab_t *slab = pool_slab_create(pool, count);
+    if (slab == NULL) {
+        heap_caps_free(pool);
+        return NULL;
+    }
+    POOL_LOCK_INIT(&pool->lock);
+    pool_add_slab(pool, slab);
+    pool->minimum_free_count = pool->free_count;
+    return pool;
+}
+
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, uint32_t caps, size_t count)
+{
+    return heap_caps_pool_create_growable(obj_size, caps, count, 0);
+}
+
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+    pool_slab_t *slab = pool->slabs;
+    while (slab != NULL) {
+        pool_slab_t *next = slab->next;
+        heap_caps_free(slab);
+        slab = next;
+    }
+    POOL_LOCK_DELETE(&pool->lock);
+    heap_caps_free(pool);
+}
+
+/* Pop an object from the free list, must be called with the lock of the pool */
+static POOL_IRAM_ATTR void *pool_pop(heap_caps_pool_handle_t pool)
+{
+    pool_free_obj_t *obj = pool->free_list;
+    if (obj == NULL) {
+        return NULL;
+    }
+    size_t index;
+    pool_slab_t *slab = pool_find_slab(pool, obj, &index);
+    assert(slab != NULL && (slab->used[index / 32] & (1U << (index % 32))) == 0 && "CORRUPT POOL: invalid free list");
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+    assert(pool_find_free_obj_corruption(pool, obj) == NULL && "CORRUPT POOL: free object was written to");
+#endif
+    slab->used[index / 32] |= 1U << (index % 32);
+    pool->free_list = obj->next;
+    pool->free_count--;
+    pool->minimum_free_count = MIN(pool->minimum_free_count, pool->free_count);
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+    memset(obj, MALLOC_FILL_PATTERN, pool->obj_size);
+#endif
+    return obj;
+}
+
+POOL_IRAM_ATTR void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool)
+{
+    assert(pool != NULL);
+    POOL_LOCK(&pool->lock);
+    void *obj = pool_pop(pool);
+    POOL_UNLOCK(&pool->lock);
+
+    if (obj == NULL && pool->grow_count > 0) {
+        // The heap is not called with the lock of the pool held
+        pool_slab_t *slab = pool_slab_create(pool, pool->grow_count);
+        if (slab != NULL) {
+            POOL_LOCK(&pool->lock);
+            pool_add_slab(pool, slab);
+            obj = pool_pop(pool);
+            POOL_UNLOCK(&pool->lock);
+        }
+    }
+    return obj;
+}
+
+POOL_IRAM_ATTR void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    assert(pool != NULL);
+    POOL_LOCK(&pool->lock);
+    size_t index;
+    pool_slab_t *slab = pool_find_slab(pool, ptr, &index);
+    assert(slab != NULL && "heap_caps_pool_free() pointer is not an object of the pool");
+    assert((slab->used[index / 32] & (1U << (index % 32))) != 0 && "heap_caps_pool_free() object is already free");
+    slab->used[index / 32] &= ~(1U << (index % 32));
+    pool_free_obj_t *obj = (pool_free_obj_t *)ptr;
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+    pool_poison_free_obj(pool, obj);
+#endif
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    pool->free_count++;
+    POOL_UNLOCK(&pool->lock);
+}
+
+POOL_IRAM_ATTR void heap_caps_pool_get_info(heap_caps_pool_handle_t pool, heap_caps_pool_info_t *info)
+{
+    assert(pool != NULL && info != NULL);
+    POOL_LOCK(&pool->lock);
+    *info = (heap_caps_pool_info_t) {
+        .obj_size = pool->obj_size,
+        .total_count = pool->total_count,
+        .free_count = pool->free_count,
+        .minimum_free_count = pool->minimum_free_count,
+        .slab_count = pool->slab_count,
+    };
+    POOL_UNLOCK(&pool->lock);
+}
+
+bool heap_caps_pool_check_integrity(heap_caps_pool_handle_t pool, bool print_errors)
+{
+    assert(pool != NULL);
+    bool valid = true;
+
+    /* Slabs are only added at the head of the list, and freed with the pool: the list from a head read under
+     * the lock does not change, so the heap blocks are checked without holding the lock of the pool. */
+    POOL_LOCK(&pool->lock);
+    pool_slab_t *slabs = pool->slabs;
+    POOL_UNLOCK(&pool->lock);
+    for (pool_slab_t *slab = slabs; slab != NULL; slab = slab->next) {
+        valid = heap_caps_check_integrity_addr((intptr_t)slab, print_errors) && valid;
+    }
+
+    POOL_LOCK(&pool->lock);
+    // An overflow of an object overwrites the slab pointer of the next one
+    for (pool_slab_t *slab = pool->slabs; slab != NULL; slab = slab->next) {
+        for (size_t i = 0; i < slab->count; i++) {
+            const pool_slot_t *slot = (const pool_slot_t *)(slab->objects + i * pool->slot_size);
+            if (slot->slab != slab) {
+                if (print_errors) {
+                    POOL_PRINTF("CORRUPT POOL: invalid slab pointer %p before object %p\n", slot->slab, POOL_SLOT_OBJ(slot));
+                }
+                valid = false;
+            }
+        }
+    }
+    if (!valid) {
+        // The free list can not be followed through corrupt slabs
+        POOL_UNLOCK(&pool->lock);
+        return false;
+    }
+
+    size_t free_count = 0;
+    for (pool_free_obj_t *obj = pool->free_list; obj != NULL; obj = obj->next) {
+        size_t index;
+        pool_slab_t *slab = pool_in_slabs(pool, obj) ? pool_find_slab(pool, obj, &index) : NULL;
+        if (slab == NULL || (slab->used[index / 32] & (1U << (index % 32))) != 0) {
+            if (print_errors) {
+                POOL_PRINTF("CORRUPT POOL: invalid free object %p in pool %p\n", obj, pool);
+            }
+            valid = false;
+            break;
+        }
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+        const uint8_t *corrupt = pool_find_free_obj_corruption(pool, obj);
+        if (corrupt != NULL) {
+            if (print_errors) {
+                POOL_PRINTF("CORRUPT POOL: free object %p written to at %p\n", obj, corrupt);
+            }
+            valid = false;
+        }
+#endif
+        // Stops on a loop in the list
+        if (++free_count > pool->free_count) {
+            break;
+        }
+    }
+    if (valid && free_count != pool->free_count) {
+        if (print_errors) {
+            POOL_PRINTF("CORRUPT POOL: %u free objects in pool %p, expected %u\n",
+                        (unsigned) free_count, pool, (unsigned) pool->free_count);
+        }
+        valid = false;
+    }
+    POOL_UNLOCK(&pool->lock);
+    return valid;
+}
+
+void heap_caps_pool_walk(heap_caps_pool_handle_t pool, heap_caps_walker_cb_t walker_func, void *user_data)
+{
+    assert(pool != NULL && walker_func != NULL);
+    POOL_LOCK(&pool->lock);
+    bool walk = true;
+    for (pool_slab_t *slab = pool->slabs; slab != NULL && walk; slab = slab->next) {
+        walker_heap_into_t slab_info = {
+            (intptr_t)slab->objects,
+            (intptr_t)(slab->objects + slab->count * pool->slot_size)
+        };
+        for (size_t i = 0; i < slab->count && walk; i++) {
+            walker_block_info_t obj_info = {
+                POOL_SLOT_OBJ(slab->objects + i * pool->slot_size),
+                pool->obj_size,
+                (slab->used[i / 32] & (1U << (i % 32))) != 0
+            };
+            walk = walker_func(slab_info, obj_info, user_data);
+        }
+    }
+    POOL_UNLOCK(&pool->lock);
+}
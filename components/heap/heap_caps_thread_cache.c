@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "multi_heap.h"
+#include "heap_private.h"
+
+/*
+This file implements a cache of small free blocks in front of the heaps, one per CPU core. Small allocations are
+frequent (lwip, esp_event, mbedtls...), and each of them otherwise walks the registered heaps and takes the lock of the
+heap, which is shared by all cores.
+
+heap_caps_free() pushes a block of at most CONFIG_HEAP_THREAD_CACHE_MAX_BLOCK_SIZE bytes to the cache of the current
+core, and heap_caps_aligned_alloc_base() pops a block of the requested size from it. A cache only holds the blocks of
+one size in each of its lists, and does not hold more than CONFIG_HEAP_THREAD_CACHE_SIZE bytes. Each cache has its own
+lock, which is only contended when a task migrates between reading the core ID and taking the lock, or when the caches
+are flushed.
+
+The cached blocks are still allocated blocks for the underlying heaps. heap_caps_get_free_size() adds their size to the
+free size of the heaps, which keeps the caches warm for callers polling the free memory. heap_caps_get_info() and the
+other functions reporting on the heap blocks would not see them as free, so these functions flush the caches first.
+The caches are also flushed when an allocation fails, before trying again.
+*/
+
+// Blocks sizes of the heaps are multiples of 4 bytes, each list of a cache holds blocks of one size
+#define CACHE_BLOCK_SIZE_STEP   4
+#define CACHE_NUM_LISTS         (CONFIG_HEAP_THREAD_CACHE_MAX_BLOCK_SIZE / CACHE_BLOCK_SIZE_STEP)
+// Size of the smallest block of the TLSF heap, which serves all the smaller requests
+#define CACHE_MIN_BLOCK_SIZE    (3 * sizeof(void *))
+
+/* A free block in a cache */
+typedef struct cached_block_ {
+    struct cached_block_ *next;
+    heap_t *heap;
+} cached_block_t;
+
+typedef struct {
+    multi_heap_lock_t lock;
+    size_t size; ///< Total size of the blocks in the cache
+    cached_block_t *blocks[CACHE_NUM_LISTS]; ///< Lists of the cached blocks by size
+} thread_cache_t;
+
+static thread_cache_t s_thread_caches[portNUM_PROCESSORS] = {
+    [0 ... portNUM_PROCESSORS - 1] = { .lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER },
+};
+
+/* Returns the list holding blocks of 'size' bytes, rounded up to CACHE_BLOCK_SIZE_STEP */
+FORCE_INLINE_ATTR size_t cache_list_for_size(size_t size)
+{
+    return (size + CACHE_BLOCK_SIZE_STEP - 1) / CACHE_BLOCK_SIZE_STEP - 1;
+}
+
+FORCE_INLINE_ATTR size_t cache_list_block_size(size_t list)
+{
+    return (list + 1) * CACHE_BLOCK_SIZE_STEP;
+}
+
+HEAP_IRAM_ATTR void *heap_caps_thread_cache_alloc(size_t size, uint32_t caps)
+{
+    if (size > CONFIG_HEAP_THREAD_CACHE_MAX_BLOCK_SIZE) {
+        return NULL;
+    }
+    size_t list = cache_list_for_size(size < CACHE_MIN_BLOCK_SIZE ? CACHE_MIN_BLOCK_SIZE : size);
+    thread_cache_t *cache = &s_thread_caches[xPortGetCoreID()];
+
+    MULTI_HEAP_LOCK(&cache->lock);
+    cached_block_t *block = cache->blocks[list];
+    // Only the most recently freed block is checked, to keep the lookup O(1)
+    if (block != NULL && (get_all_caps(block->heap) & caps) == caps) {
+        cache->blocks[list] = block->next;
+        cache->size -= cache_list_block_size(list);
+    } else {
+        block = NULL;
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+    return block;
+}
+
+HEAP_IRAM_ATTR bool heap_caps_thread_cache_free(heap_t *heap, void *ptr)
+{
+    size_t block_size = multi_heap_get_allocated_size(heap->heap, ptr);
+    if (block_size < sizeof(cached_block_t) || block_size > CONFIG_HEAP_THREAD_CACHE_MAX_BLOCK_SIZE) {
+        return false;
+    }
+    // A block is only given out for requests which fit in it
+    size_t list = block_size / CACHE_BLOCK_SIZE_STEP - 1;
+    thread_cache_t *cache = &s_thread_caches[xPortGetCoreID()];
+    bool cached = false;
+
+    MULTI_HEAP_LOCK(&cache->lock);
+    if (cache->size + cache_list_block_size(list) <= CONFIG_HEAP_THREAD_CACHE_SIZE) {
+        cached_block_t *block = (cached_block_t *)ptr;
+        block->heap = heap;
+        block->next = cache->blocks[list];
+        cache->blocks[list] = block;
+        cache->size += cache_list_block_size(list);
+        cached = true;
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+    return cached;
+}
+
+size_t heap_caps_thread_cache_free_size(uint32_t caps)
+{
+    size_t size = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        thread_cache_t *cache = &s_thread_caches[core];
+
+        // The blocks of a list may belong to different heaps. A cache holds at most
+        // CONFIG_HEAP_THREAD_CACHE_SIZE / CACHE_MIN_BLOCK_SIZE blocks, so the walk is short.
+        MULTI_HEAP_LOCK(&cache->lock);
+        for (size_t list = 0; list < CACHE_NUM_LISTS; list++) {
+            for (cached_block_t *block = cache->blocks[list]; block != NULL; block = block->next) {
+                if (heap_caps_match(block->heap, caps)) {
+                    size += cache_list_block_size(list);
+                }
+            }
+        }
+        MULTI_HEAP_UNLOCK(&cache->lock);
+    }
+    return size;
+}
+
+HEAP_IRAM_ATTR size_t heap_caps_thread_cache_flush(void)
+{
+    size_t flushed = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        thread_cache_t *cache = &s_thread_caches[core];
+        cached_block_t *blocks[CACHE_NUM_LISTS];
+
+        // Detach the lists, the blocks are freed without holding the lock of the cache
+        MULTI_HEAP_LOCK(&cache->lock);
+        memcpy(blocks, cache->blocks, sizeof(blocks));
+        memset(cache->blocks, 0, sizeof(cache->blocks));
+        flushed += cache->size;
+        cache->size = 0;
+        MULTI_HEAP_UNLOCK(&cache->lock);
+
+        for (size_t list = 0; list < CACHE_NUM_LISTS; list++) {
+            cached_block_t *block = blocks[list];
+            while (block != NULL) {
+                cached_block_t *next = block->next;
+                multi_heap_free(block->heap->heap, block);
+                block = next;
+            }
+        }
+    }
+    return flushed;
+}
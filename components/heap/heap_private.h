@@ -1,10 +1,11 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 #pragma once
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <soc/soc_memory_layout.h>
@@ -12,6 +13,7 @@
 #include "multi_heap_platform.h"
 #include "sys/queue.h"
 #include "esp_attr.h"
+#include "sdkconfig.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -87,6 +89,18 @@ void *heap_caps_calloc_base(size_t n, size_t size, uint32_t caps);
 void *heap_caps_malloc_base(size_t size, uint32_t caps);
 void *heap_caps_aligned_alloc_base(size_t alignment, size_t size, uint32_t caps);
 
+#if CONFIG_HEAP_THREAD_CACHE
+/* Per-core caches of small free blocks, see heap_caps_thread_cache.c.
+
+   heap_caps_thread_cache_alloc returns NULL if no cached block suits the request,
+   heap_caps_thread_cache_free returns false if the block must be freed to its heap,
+   heap_caps_thread_cache_free_size returns the size of the cached blocks of the heaps matching caps.
+*/
+void *heap_caps_thread_cache_alloc(size_t size, uint32_t caps);
+bool heap_caps_thread_cache_free(heap_t *heap, void *ptr);
+size_t heap_caps_thread_cache_free_size(uint32_t caps);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
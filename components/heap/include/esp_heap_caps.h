@@ -207,6 +207,9 @@ size_t heap_caps_get_total_size(uint32_t caps);
  *
  * @note Note that because of heap fragmentation it is probably not possible to allocate a single block of memory
  * of this size. Use heap_caps_get_largest_free_block() for this purpose.
+ *
+ * @note With CONFIG_HEAP_THREAD_CACHE enabled, the blocks held in the per-core thread caches are counted as free,
+ * without returning them to the heaps.
 
  * @param caps        Bitwise OR of MALLOC_CAP_* flags indicating the type
  *                    of memory
@@ -282,6 +285,19 @@ esp_err_t heap_caps_monitor_local_minimum_free_size_stop(void);
  */
 void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps );
 
+/**
+ * @brief Return the free blocks held in the per-core thread caches to their heaps
+ *
+ * With CONFIG_HEAP_THREAD_CACHE enabled, small freed blocks are kept in a cache of the CPU core
+ * which freed them, to serve the next allocations of the same size. The heap information
+ * functions other than heap_caps_get_free_size(), and allocations which fail, flush the caches already. This function can be called
+ * to give the memory back to the heaps explicitly, e.g. before a large allocation.
+ *
+ * @return Total size of the blocks which were returned to the heaps, 0 if
+ *         CONFIG_HEAP_THREAD_CACHE is disabled
+ */
+size_t heap_caps_thread_cache_flush(void);
+
 
 /**
  * @brief Print a summary of all memory with the given capabilities.
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_heap_caps.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of a pool of fixed-size objects
+ */
+typedef struct heap_caps_pool *heap_caps_pool_handle_t;
+
+/**
+ * @brief Information about a pool, see heap_caps_pool_get_info()
+ */
+typedef struct {
+    size_t obj_size;            ///< Size of the objects, rounded up to the pointer size
+    size_t total_count;         ///< Number of objects in all the slabs of the pool
+    size_t free_count;          ///< Number of objects which can be allocated without growing the pool
+    size_t minimum_free_count;  ///< Lowest value of free_count since the pool was created
+    size_t slab_count;          ///< Number of slabs the pool allocated from the heap
+} heap_caps_pool_info_t;
+
+/**
+ * @brief Create a pool of objects of the same size
+ *
+ * The memory of the objects is allocated at once from the heap, as a single block
+ * (slab) with the given capabilities. The objects are then allocated and freed in
+ * constant time, without taking the heap lock, and without fragmenting the heap.
+ *
+ * Like a heap block, each object is preceded by a pointer, to the slab containing it,
+ * so the memory of an object is its size rounded up to the pointer size, plus a pointer.
+ *
+ * @param obj_size Size of the objects, in bytes
+ * @param caps     Bitwise OR of MALLOC_CAP_* flags indicating the type of memory of the objects
+ * @param count    Number of objects in the pool
+ *
+ * @return Handle of the pool, or NULL if the arguments are invalid or the memory is insufficient
+ */
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, uint32_t caps, size_t count);
+
+/**
+ * @brief Create a pool of objects of the same size, which grows when it runs out of objects
+ *
+ * Same as heap_caps_pool_create(), but when all the objects are allocated, heap_caps_pool_alloc()
+ * allocates a new slab of grow_count objects from the heap. Slabs are only returned to the heap
+ * when the pool is deleted.
+ *
+ * @param obj_size   Size of the objects, in bytes
+ * @param caps       Bitwise OR of MALLOC_CAP_* flags indicating the type of memory of the objects
+ * @param count      Number of objects in the first slab
+ * @param grow_count Number of objects in each of the next slabs, 0 to never grow
+ *
+ * @return Handle of the pool, or NULL if the arguments are invalid or the memory is insufficient
+ */
+heap_caps_pool_handle_t heap_caps_pool_create_growable(size_t obj_size, uint32_t caps, size_t count, size_t grow_count);
+
+/**
+ * @brief Delete a pool and return its memory to the heap
+ *
+ * The objects which are still allocated from the pool become invalid.
+ *
+ * @param pool Pool to delete, may be NULL
+ */
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Allocate an object from a pool
+ *
+ * Can be called from an ISR, unless the pool has to grow.
+ *
+ * @param pool Pool to allocate from
+ *
+ * @return Pointer to an object of the pool, or NULL if all the objects are allocated
+ *         and the pool can not grow
+ */
+void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Return an object to its pool
+ *
+ * Can be called from an ISR. Freeing a pointer which is not an allocated object
+ * of the pool is detected, and aborts. Like with heap_caps_free(), a pointer which is
+ * not in the heap may cause an exception instead.
+ *
+ * @param pool Pool the object was allocated from
+ * @param ptr  Object to free, may be NULL
+ */
+void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr);
+
+/**
+ * @brief Get information about the objects of a pool
+ *
+ * @param pool Pool to get information about
+ * @param info Pointer to a structure which will be filled with the information
+ */
+void heap_caps_pool_get_info(heap_caps_pool_handle_t pool, heap_caps_pool_info_t *info);
+
+/**
+ * @brief Check the integrity of a pool
+ *
+ * Checks the heap blocks of the slabs with heap_caps_check_integrity_addr(), the slab
+ * pointers before the objects, which are overwritten when an object overflows, and the
+ * list of free objects of the pool. With comprehensive heap poisoning, also checks
+ * that the free objects were not written to.
+ *
+ * @param pool         Pool to check
+ * @param print_errors Print specific errors if the pool is corrupt
+ *
+ * @return True if the pool is valid, false otherwise
+ */
+bool heap_caps_pool_check_integrity(heap_caps_pool_handle_t pool, bool print_errors);
+
+/**
+ * @brief Call a function for each object of a pool
+ *
+ * The walker function is called for each object, allocated or not, with the slab
+ * containing it as heap information. The pool is locked during the walk, the walker
+ * function must not allocate from or free to the pool.
+ *
+ * @param pool        Pool to walk through
+ * @param walker_func Callback called for each object of the pool. Returning false
+ *                    stops the walk
+ * @param user_data   Opaque pointer to user defined data
+ */
+void heap_caps_pool_walk(heap_caps_pool_handle_t pool, heap_caps_walker_cb_t walker_func, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
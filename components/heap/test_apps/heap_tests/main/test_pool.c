@@ -0,0 +1,255 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_pool.h"
+#include "esp_memory_utils.h"
+#include "sdkconfig.h"
+
+#define POOL_OBJ_SIZE   20
+#define POOL_COUNT      16
+
+TEST_CASE("heap pool allocates and frees objects", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(POOL_OBJ_SIZE, MALLOC_CAP_DEFAULT, POOL_COUNT);
+    TEST_ASSERT_NOT_NULL(pool);
+    void *p[POOL_COUNT];
+
+    for (int i = 0; i < POOL_COUNT; i++) {
+        p[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(p[i]);
+        TEST_ASSERT_EQUAL(0, (intptr_t)p[i] % sizeof(void *));
+        memset(p[i], i, POOL_OBJ_SIZE);
+    }
+    // The pool does not grow
+    TEST_ASSERT_NULL(heap_caps_pool_alloc(pool));
+
+    heap_caps_pool_info_t info;
+    heap_caps_pool_get_info(pool, &info);
+    TEST_ASSERT_EQUAL(POOL_COUNT, info.total_count);
+    TEST_ASSERT_EQUAL(0, info.free_count);
+    TEST_ASSERT_EQUAL(0, info.minimum_free_count);
+    TEST_ASSERT_EQUAL(1, info.slab_count);
+    TEST_ASSERT_GREATER_OR_EQUAL(POOL_OBJ_SIZE, info.obj_size);
+
+    for (int i = 0; i < POOL_COUNT; i++) {
+        for (int j = 0; j < POOL_OBJ_SIZE; j++) {
+            TEST_ASSERT_EQUAL(i, ((uint8_t *)p[i])[j]);
+        }
+        heap_caps_pool_free(pool, p[i]);
+    }
+    heap_caps_pool_get_info(pool, &info);
+    TEST_ASSERT_EQUAL(POOL_COUNT, info.free_count);
+    TEST_ASSERT(heap_caps_pool_check_integrity(pool, true));
+
+    // The last freed object is the next one allocated
+    void *q = heap_caps_pool_alloc(pool);
+    TEST_ASSERT_EQUAL_PTR(p[POOL_COUNT - 1], q);
+    heap_caps_pool_free(pool, q);
+    heap_caps_pool_delete(pool);
+}
+
+TEST_CASE("heap pool grows when it runs out of objects", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create_growable(POOL_OBJ_SIZE, MALLOC_CAP_DEFAULT, 4, 8);
+    TEST_ASSERT_NOT_NULL(pool);
+    void *p[20];
+
+    for (int i = 0; i < 20; i++) {
+        p[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    heap_caps_pool_info_t info;
+    heap_caps_pool_get_info(pool, &info);
+    TEST_ASSERT_EQUAL(3, info.slab_count);
+    TEST_ASSERT_EQUAL(4 + 8 + 8, info.total_count);
+    TEST_ASSERT_EQUAL(0, info.free_count);
+
+    for (int i = 0; i < 20; i++) {
+        heap_caps_pool_free(pool, p[i]);
+    }
+    heap_caps_pool_get_info(pool, &info);
+    TEST_ASSERT_EQUAL(20, info.free_count);
+    TEST_ASSERT(heap_caps_pool_check_integrity(pool, true));
+    heap_caps_pool_delete(pool);
+}
+
+TEST_CASE("heap pool objects have the capabilities of the pool", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(64, MALLOC_CAP_DMA, 4);
+    TEST_ASSERT_NOT_NULL(pool);
+    void *p = heap_caps_pool_alloc(pool);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT(esp_ptr_dma_capable(p));
+    heap_caps_pool_free(pool, p);
+    heap_caps_pool_delete(pool);
+}
+
+typedef struct {
+    size_t used;
+    size_t free;
+    size_t obj_size;
+} pool_walk_data_t;
+
+static bool pool_walker(walker_heap_into_t heap_info, walker_block_info_t block_info, void *user_data)
+{
+    pool_walk_data_t *data = (pool_walk_data_t *)user_data;
+    TEST_ASSERT((intptr_t)block_info.ptr >= heap_info.start && (intptr_t)block_info.ptr < heap_info.end);
+    TEST_ASSERT_EQUAL(data->obj_size, block_info.size);
+    if (block_info.used) {
+        data->used++;
+    } else {
+        data->free++;
+    }
+    return true;
+}
+
+TEST_CASE("heap pool walker reports all the objects", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create_growable(POOL_OBJ_SIZE, MALLOC_CAP_DEFAULT, 8, 8);
+    TEST_ASSERT_NOT_NULL(pool);
+    void *p[10];
+    for (int i = 0; i < 10; i++) {
+        p[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    heap_caps_pool_free(pool, p[3]);
+
+    heap_caps_pool_info_t info;
+    heap_caps_pool_get_info(pool, &info);
+    pool_walk_data_t data = { .obj_size = info.obj_size };
+    heap_caps_pool_walk(pool, pool_walker, &data);
+    TEST_ASSERT_EQUAL(9, data.used);
+    TEST_ASSERT_EQUAL(16 - 9, data.free);
+
+    for (int i = 0; i < 10; i++) {
+        if (i != 3) {
+            heap_caps_pool_free(pool, p[i]);
+        }
+    }
+    heap_caps_pool_delete(pool);
+}
+
+static bool pool_walker_stop(walker_heap_into_t heap_info, walker_block_info_t block_info, void *user_data)
+{
+    size_t *count = (size_t *)user_data;
+    return ++(*count) < 3;
+}
+
+TEST_CASE("heap pool walk stops when the walker returns false", "[heap][pool]")
+{
+    // Two slabs of two objects, the walk stops on the first object of the second slab
+    heap_caps_pool_handle_t pool = heap_caps_pool_create_growable(POOL_OBJ_SIZE, MALLOC_CAP_DEFAULT, 2, 2);
+    TEST_ASSERT_NOT_NULL(pool);
+    void *p[3];
+    for (int i = 0; i < 3; i++) {
+        p[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    size_t count = 0;
+    heap_caps_pool_walk(pool, pool_walker_stop, &count);
+    TEST_ASSERT_EQUAL(3, count);
+
+    for (int i = 0; i < 3; i++) {
+        heap_caps_pool_free(pool, p[i]);
+    }
+    heap_caps_pool_delete(pool);
+}
+
+TEST_CASE("heap pool integrity check detects an overflow of an object", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(POOL_OBJ_SIZE, MALLOC_CAP_DEFAULT, 4);
+    TEST_ASSERT_NOT_NULL(pool);
+    heap_caps_pool_info_t info;
+    heap_caps_pool_get_info(pool, &info);
+    uint8_t *p = heap_caps_pool_alloc(pool);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT(heap_caps_pool_check_integrity(pool, true));
+
+    // The bytes after the object hold the slab pointer of the next object
+    void *saved;
+    memcpy(&saved, p + info.obj_size, sizeof(saved));
+    memset(p + info.obj_size, 0x42, sizeof(saved));
+    TEST_ASSERT_FALSE(heap_caps_pool_check_integrity(pool, true));
+    memcpy(p + info.obj_size, &saved, sizeof(saved));
+    TEST_ASSERT(heap_caps_pool_check_integrity(pool, true));
+
+    heap_caps_pool_free(pool, p);
+    heap_caps_pool_delete(pool);
+}
+
+#ifdef CONFIG_HEAP_POISONING_COMPREHENSIVE
+TEST_CASE("heap pool integrity check detects a write to a free object", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(32, MALLOC_CAP_DEFAULT, 4);
+    TEST_ASSERT_NOT_NULL(pool);
+    uint8_t *p = heap_caps_pool_alloc(pool);
+    TEST_ASSERT_NOT_NULL(p);
+    heap_caps_pool_free(pool, p);
+    TEST_ASSERT(heap_caps_pool_check_integrity(pool, true));
+
+    // Use after free, past the link of the free list
+    p[16] = 0x42;
+    TEST_ASSERT_FALSE(heap_caps_pool_check_integrity(pool, true));
+    p[16] = 0xfe;
+    TEST_ASSERT(heap_caps_pool_check_integrity(pool, true));
+    heap_caps_pool_delete(pool);
+}
+#endif
+
+/* Allocates small objects interleaved with longer lived strings, then frees the objects,
+ * which leaves holes in the heap unless the objects come from a pool */
+static void small_objects_fragmentation(heap_caps_pool_handle_t pool, size_t *free_blocks, size_t *largest_free_block)
+{
+    const int count = 64;
+    void *objs[count];
+    char *strings[count];
+
+    for (int i = 0; i < count; i++) {
+        objs[i] = pool ? heap_caps_pool_alloc(pool) : heap_caps_malloc(POOL_OBJ_SIZE, MALLOC_CAP_DEFAULT);
+        TEST_ASSERT_NOT_NULL(objs[i]);
+        strings[i] = heap_caps_malloc(24 + i % 8, MALLOC_CAP_DEFAULT);
+        TEST_ASSERT_NOT_NULL(strings[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        if (pool) {
+            heap_caps_pool_free(pool, objs[i]);
+        } else {
+            heap_caps_free(objs[i]);
+        }
+    }
+
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_DEFAULT);
+    *free_blocks = info.free_blocks;
+    *largest_free_block = info.largest_free_block;
+
+    for (int i = 0; i < count; i++) {
+        heap_caps_free(strings[i]);
+    }
+}
+
+TEST_CASE("heap pool reduces the fragmentation of small objects", "[heap][pool]")
+{
+    size_t malloc_free_blocks, malloc_largest;
+    size_t pool_free_blocks, pool_largest;
+    multi_heap_info_t before;
+
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(POOL_OBJ_SIZE, MALLOC_CAP_DEFAULT, 64);
+    TEST_ASSERT_NOT_NULL(pool);
+    heap_caps_get_info(&before, MALLOC_CAP_DEFAULT);
+    small_objects_fragmentation(NULL, &malloc_free_blocks, &malloc_largest);
+    small_objects_fragmentation(pool, &pool_free_blocks, &pool_largest);
+    heap_caps_pool_delete(pool);
+
+    printf("free blocks before: %u, with malloc: %u, with a pool: %u\n",
+           (unsigned)before.free_blocks, (unsigned)malloc_free_blocks, (unsigned)pool_free_blocks);
+    TEST_ASSERT_LESS_THAN(malloc_free_blocks, pool_free_blocks);
+    TEST_ASSERT_GREATER_OR_EQUAL(malloc_largest, pool_largest);
+}
@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#define SMALL_ALLOC_TASKS_PER_CORE  2
+#define SMALL_ALLOC_ITERATIONS      20000
+#define SMALL_ALLOC_POINTERS        16
+
+typedef struct {
+    SemaphoreHandle_t done;
+    unsigned seed;
+    bool failed;
+} small_alloc_task_arg_t;
+
+/* Allocations of lwip / esp_event sized objects, with a few of them kept alive at a time */
+static void small_alloc_task(void *param)
+{
+    small_alloc_task_arg_t *arg = (small_alloc_task_arg_t *)param;
+    void *p[SMALL_ALLOC_POINTERS] = { 0 };
+    for (int i = 0; i < SMALL_ALLOC_ITERATIONS; i++) {
+        int n = rand_r(&arg->seed) % SMALL_ALLOC_POINTERS;
+        if (p[n] != NULL) {
+            heap_caps_free(p[n]);
+            p[n] = NULL;
+        } else {
+            size_t size = 8 + rand_r(&arg->seed) % 120;
+            p[n] = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+            if (p[n] == NULL) {
+                arg->failed = true;
+                break;
+            }
+            memset(p[n], 0xA5, size);
+        }
+    }
+    for (int n = 0; n < SMALL_ALLOC_POINTERS; n++) {
+        heap_caps_free(p[n]);
+    }
+    xSemaphoreGive(arg->done);
+    vTaskDelete(NULL);
+}
+
+/* Run with and without CONFIG_HEAP_THREAD_CACHE to compare */
+TEST_CASE("Heap small allocations from several tasks timings", "[heap]")
+{
+    const int num_tasks = SMALL_ALLOC_TASKS_PER_CORE * portNUM_PROCESSORS;
+    small_alloc_task_arg_t args[num_tasks];
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(num_tasks, 0);
+    TEST_ASSERT_NOT_NULL(done);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < num_tasks; i++) {
+        args[i] = (small_alloc_task_arg_t) {
+            .done = done, .seed = i + 1, .failed = false
+        };
+        TEST_ASSERT(xTaskCreatePinnedToCore(small_alloc_task, "small_alloc", 4096, &args[i],
+                                            uxTaskPriorityGet(NULL) - 1, NULL, i % portNUM_PROCESSORS) == pdPASS);
+    }
+    for (int i = 0; i < num_tasks; i++) {
+        TEST_ASSERT(xSemaphoreTake(done, pdMS_TO_TICKS(30000)) == pdTRUE);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    vSemaphoreDelete(done);
+    vTaskDelay(2); // let the idle task clean up the deleted tasks
+
+    for (int i = 0; i < num_tasks; i++) {
+        TEST_ASSERT_FALSE(args[i].failed);
+    }
+    printf("%d tasks, %d malloc/free each: %lld us, %lld ns per operation\n", num_tasks, SMALL_ALLOC_ITERATIONS,
+           elapsed, elapsed * 1000 / (num_tasks * SMALL_ALLOC_ITERATIONS));
+    TEST_ASSERT(heap_caps_check_integrity_all(true));
+}
+
+#if CONFIG_HEAP_THREAD_CACHE
+
+TEST_CASE("Heap thread cache gives back the last freed block of the same size", "[heap]")
+{
+    void *p = heap_caps_malloc(40, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(p);
+    heap_caps_free(p);
+    void *q = heap_caps_malloc(40, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_EQUAL_PTR(p, q);
+    heap_caps_free(q);
+}
+
+TEST_CASE("Heap thread cache keeps heap_caps_get_info exact", "[heap]")
+{
+    void *p[8];
+    multi_heap_info_t before, after;
+
+    heap_caps_get_info(&before, MALLOC_CAP_DEFAULT);
+    for (int i = 0; i < 8; i++) {
+        p[i] = heap_caps_malloc(16 + i * 8, MALLOC_CAP_DEFAULT);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    for (int i = 0; i < 8; i++) {
+        heap_caps_free(p[i]);
+    }
+    heap_caps_get_info(&after, MALLOC_CAP_DEFAULT);
+
+    TEST_ASSERT_EQUAL(before.total_free_bytes, after.total_free_bytes);
+    TEST_ASSERT_EQUAL(before.total_allocated_bytes, after.total_allocated_bytes);
+    TEST_ASSERT_EQUAL(before.allocated_blocks, after.allocated_blocks);
+    TEST_ASSERT_EQUAL(before.largest_free_block, after.largest_free_block);
+    TEST_ASSERT_EQUAL(before.total_free_bytes, heap_caps_get_free_size(MALLOC_CAP_DEFAULT));
+}
+
+TEST_CASE("Heap thread cache blocks count as free without a flush", "[heap]")
+{
+    heap_caps_thread_cache_flush();
+    vTaskSuspendAll();
+    void *p = heap_caps_malloc(40, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(p);
+    size_t block_size = heap_caps_get_allocated_size(p);
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    heap_caps_free(p);
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    // The block is still in the cache
+    size_t flushed = heap_caps_thread_cache_flush();
+    xTaskResumeAll();
+
+    TEST_ASSERT_EQUAL(free_before + block_size, free_after);
+    TEST_ASSERT_GREATER_OR_EQUAL(block_size, flushed);
+}
+
+TEST_CASE("Heap thread cache holds a bounded amount of memory", "[heap]")
+{
+    const int count = CONFIG_HEAP_THREAD_CACHE_SIZE / 32 + 8;
+    void **p = heap_caps_calloc(count, sizeof(void *), MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(p);
+    heap_caps_thread_cache_flush();
+
+    // Without task switches, all the blocks are freed to the cache of the same core
+    vTaskSuspendAll();
+    for (int i = 0; i < count; i++) {
+        p[i] = heap_caps_malloc(32, MALLOC_CAP_DEFAULT);
+    }
+    for (int i = 0; i < count; i++) {
+        heap_caps_free(p[i]);
+    }
+    xTaskResumeAll();
+
+    // The cache of the current core is full, the other caches may hold blocks freed by other tasks
+    size_t flushed = heap_caps_thread_cache_flush();
+    TEST_ASSERT_GREATER_OR_EQUAL(CONFIG_HEAP_THREAD_CACHE_SIZE - 64, flushed);
+    TEST_ASSERT_LESS_OR_EQUAL(CONFIG_HEAP_THREAD_CACHE_SIZE * portNUM_PROCESSORS, flushed);
+    heap_caps_free(p);
+}
+
+#endif // CONFIG_HEAP_THREAD_CACHE
@@ -0,0 +1,469 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "esp_log.h"
+#include "esp_log_binary.h"
+#include "sdkconfig.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std;
+
+static const char *TEST_TAG = "test";
+
+static const uint8_t RECORD_LOG = 2;
+static const uint8_t RECORD_STREAM = 3;
+static const uint8_t RECORD_DROPPED = 4;
+
+static const uint8_t STR_PTR = 0;
+static const uint8_t STR_INLINE = 1;
+
+struct Record {
+    uint8_t type;
+    uint8_t level;
+    vector<uint8_t> payload;
+};
+
+/* Captures the output, which may come from the flush thread as well as from the test */
+struct BinaryLogFixture {
+    BinaryLogFixture()
+    {
+        esp_log_binary_flush();
+        old_vprintf = esp_log_set_vprintf(print_callback);
+        clear();
+    }
+
+    ~BinaryLogFixture()
+    {
+        esp_log_binary_flush();
+        esp_log_set_vprintf(old_vprintf);
+    }
+
+    string flush_and_get_output()
+    {
+        esp_log_binary_flush();
+        lock_guard<mutex> lock(output_mutex);
+        return output;
+    }
+
+    void clear()
+    {
+        lock_guard<mutex> lock(output_mutex);
+        output.clear();
+    }
+
+    vector<Record> flush_and_get_records(size_t *text_lines = nullptr)
+    {
+        string out = flush_and_get_output();
+        vector<Record> records;
+        size_t start = 0;
+        while (start < out.size()) {
+            size_t end = out.find('\n', start);
+            if (end == string::npos) {
+                end = out.size();
+            }
+            string line = out.substr(start, end - start);
+            start = end + 1;
+            if (line.compare(0, 5, "BLOG:") != 0) {
+                if (text_lines) {
+                    (*text_lines)++;
+                }
+                continue;
+            }
+            vector<uint8_t> data = base64_decode(line.substr(5));
+            REQUIRE(data.size() >= 4);
+            uint32_t header;
+            memcpy(&header, data.data(), sizeof(header));
+            REQUIRE((header & 0xFFFF) * 4 == data.size());
+            records.push_back(Record {
+                static_cast<uint8_t>(header >> 16),
+                static_cast<uint8_t>(header >> 24),
+                vector<uint8_t>(data.begin() + 4, data.end())
+            });
+        }
+        return records;
+    }
+
+private:
+    static int print_callback(const char *format, va_list args)
+    {
+        char line[512];
+        int ret = vsnprintf(line, sizeof(line), format, args);
+        lock_guard<mutex> lock(output_mutex);
+        output += line;
+        return ret;
+    }
+
+    static vector<uint8_t> base64_decode(const string &text)
+    {
+        static const string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        vector<uint8_t> data;
+        uint32_t chunk = 0;
+        int bits = 0;
+        for (char c : text) {
+            size_t value = alphabet.find(c);
+            if (value == string::npos) {
+                break;
+            }
+            chunk = (chunk << 6) | value;
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                data.push_back((chunk >> bits) & 0xFF);
+            }
+        }
+        return data;
+    }
+
+    static mutex output_mutex;
+    static string output;
+    vprintf_like_t old_vprintf;
+};
+
+mutex BinaryLogFixture::output_mutex;
+string BinaryLogFixture::output;
+
+struct PayloadReader {
+    const vector<uint8_t> &payload;
+    size_t pos = 0;
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; ; shift += 7) {
+            REQUIRE(pos < payload.size());
+            uint8_t byte = payload[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    int64_t signed_varint()
+    {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    template<typename T> T raw()
+    {
+        T value;
+        REQUIRE(pos + sizeof(value) <= payload.size());
+        memcpy(&value, &payload[pos], sizeof(value));
+        pos += sizeof(value);
+        return value;
+    }
+
+    string inline_str()
+    {
+        REQUIRE(raw<uint8_t>() == STR_INLINE);
+        size_t len = raw<uint8_t>();
+        REQUIRE(pos + len <= payload.size());
+        string str(reinterpret_cast<const char *>(&payload[pos]), len);
+        pos += len;
+        return str;
+    }
+};
+
+static const Record *find_log_record(const vector<Record> &records)
+{
+    for (const Record &record : records) {
+        if (record.type == RECORD_LOG) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+TEST_CASE("records are written out on flush, after a stream record")
+{
+    BinaryLogFixture fix;
+    static const char format[] = "value %d %u %s\n";
+    esp_log_write(ESP_LOG_WARN, TEST_TAG, format, -42, 300u, TEST_TAG);
+
+    vector<Record> records = fix.flush_and_get_records();
+    REQUIRE(records.size() >= 1);
+    const Record *record = find_log_record(records);
+    REQUIRE(record != nullptr);
+    CHECK(record->level == ESP_LOG_WARN);
+
+    PayloadReader reader { record->payload };
+    CHECK(reader.raw<const char *>() == format);
+    CHECK(reader.signed_varint() == -42);
+    CHECK(reader.varint() == 300);
+    CHECK(reader.raw<uint8_t>() == STR_PTR);
+    CHECK(reader.raw<const char *>() == TEST_TAG);
+
+    bool stream_before_log = false;
+    for (const Record &r : records) {
+        if (r.type == RECORD_STREAM) {
+            stream_before_log = true;
+        }
+        if (&r == record) {
+            break;
+        }
+    }
+    CHECK(stream_before_log);
+}
+
+TEST_CASE("messages are not formatted by the calling task")
+{
+    BinaryLogFixture fix;
+    static const char format[] = "pending %d\n";
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format, 1);
+    // The flush thread may have run already, but nothing was formatted in the calling task
+    string out = fix.flush_and_get_output();
+    CHECK(out.find("pending") == string::npos);
+    CHECK(out.find("BLOG:") != string::npos);
+}
+
+TEST_CASE("strings which are not in the executable are copied")
+{
+    BinaryLogFixture fix;
+    static const char format[] = "%s|%5.2f|%c|%p|%lld\n";
+    char dynamic[16];
+    strcpy(dynamic, "dynamic");
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format, dynamic, 2.5, 'x', (void *) 0x1234, -1LL);
+    strcpy(dynamic, "changed");
+
+    vector<Record> records = fix.flush_and_get_records();
+    const Record *record = find_log_record(records);
+    REQUIRE(record != nullptr);
+
+    PayloadReader reader { record->payload };
+    CHECK(reader.raw<const char *>() == format);
+    CHECK(reader.inline_str() == "dynamic");
+    CHECK(reader.raw<double>() == 2.5);
+    CHECK(reader.varint() == 'x');
+    CHECK(reader.raw<void *>() == (void *) 0x1234);
+    CHECK(reader.signed_varint() == -1);
+}
+
+TEST_CASE("format strings which are not in the executable are written out as text")
+{
+    BinaryLogFixture fix;
+    char format[32];
+    strcpy(format, "runtime format %d\n");
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format, 7);
+
+    size_t text_lines = 0;
+    vector<Record> records = fix.flush_and_get_records(&text_lines);
+    CHECK(find_log_record(records) == nullptr);
+    CHECK(text_lines == 1);
+    CHECK(fix.flush_and_get_output().find("runtime format 7") != string::npos);
+}
+
+TEST_CASE("ESP_LOGx records the timestamp and the tag")
+{
+    BinaryLogFixture fix;
+    ESP_LOGI(TEST_TAG, "info %d", 5);
+
+    vector<Record> records = fix.flush_and_get_records();
+    const Record *record = find_log_record(records);
+    REQUIRE(record != nullptr);
+    CHECK(record->level == ESP_LOG_INFO);
+
+    PayloadReader reader { record->payload };
+    const char *format = reader.raw<const char *>();
+    CHECK(strstr(format, "info %d") != nullptr);
+    (void) reader.varint(); // timestamp
+    CHECK(reader.raw<uint8_t>() == STR_PTR);
+    CHECK(reader.raw<const char *>() == TEST_TAG);
+    CHECK(reader.signed_varint() == 5);
+}
+
+TEST_CASE("records are dropped, and reported, when the buffer is full")
+{
+    BinaryLogFixture fix;
+    static const char format[] = "fill %d\n";
+    const size_t count = 10 * CONFIG_LOG_BINARY_BUFFER_SIZE;
+    uint32_t dropped_before = esp_log_binary_get_dropped_count();
+    for (size_t i = 0; i < count; ++i) {
+        esp_log_write(ESP_LOG_INFO, TEST_TAG, format, static_cast<int>(i));
+    }
+    vector<Record> records = fix.flush_and_get_records();
+    uint32_t dropped = esp_log_binary_get_dropped_count() - dropped_before;
+
+    size_t written = 0;
+    int last = -1;
+    bool in_order = true;
+    uint32_t reported = 0;
+    for (const Record &record : records) {
+        if (record.type == RECORD_LOG) {
+            PayloadReader reader { record.payload };
+            reader.raw<const char *>();
+            int value = static_cast<int>(reader.signed_varint());
+            in_order = in_order && value > last;
+            last = value;
+            written++;
+        } else if (record.type == RECORD_DROPPED) {
+            PayloadReader reader { record.payload };
+            reported = reader.raw<uint32_t>();
+        }
+    }
+    CHECK(in_order);
+    CHECK(written + dropped == count);
+    if (dropped > 0) {
+        CHECK(reported == esp_log_binary_get_dropped_count());
+    }
+}
+
+TEST_CASE("logging does not wait while records are written out")
+{
+    static mutex gate_mutex;
+    static condition_variable gate_cv;
+    static bool printing;
+    static bool released;
+    static const char format[] = "blocked %d\n";
+    printing = false;
+    released = false;
+
+    esp_log_binary_flush();
+    vprintf_like_t old_vprintf = esp_log_set_vprintf([](const char *, va_list) -> int {
+        unique_lock<mutex> lock(gate_mutex);
+        printing = true;
+        gate_cv.notify_all();
+        gate_cv.wait(lock, [] { return released; });
+        return 0;
+    });
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format, 1);
+    thread drain([] { esp_log_binary_flush(); });
+    {
+        unique_lock<mutex> lock(gate_mutex);
+        gate_cv.wait(lock, [] { return printing; });
+    }
+
+    // the drain is blocked in the output function, logging from another task must not wait for it
+    future<void> logged = async(launch::async, [] { esp_log_write(ESP_LOG_INFO, TEST_TAG, format, 2); });
+    CHECK(logged.wait_for(chrono::seconds(5)) == future_status::ready);
+
+    {
+        lock_guard<mutex> lock(gate_mutex);
+        released = true;
+    }
+    gate_cv.notify_all();
+    drain.join();
+    logged.wait();
+    esp_log_binary_flush();
+    esp_log_set_vprintf(old_vprintf);
+}
+
+static string format_text(const char *format, ...)
+{
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return text;
+}
+
+/* Logs the message in binary form and appends the same message formatted as text to the expected output */
+#define ROUND_TRIP_LOG(expected, format, ...) do { \
+        esp_log_write(ESP_LOG_INFO, TEST_TAG, format, __VA_ARGS__); \
+        (expected) += format_text(format, __VA_ARGS__); \
+    } while (0)
+
+TEST_CASE("records are formatted like text by the decoder")
+{
+    /* Prints the records between markers, pytest_log_binary_linux.py decodes them
+     * with tools/esp_log_binary_decoder.py and compares them with the expected text */
+    string expected;
+    string records;
+    uint32_t dropped_before = esp_log_binary_get_dropped_count();
+    {
+        BinaryLogFixture fix;
+        char dynamic[16];
+        strcpy(dynamic, "dynamic");
+        ROUND_TRIP_LOG(expected, "int %d %i %d\n", -42, 0, INT32_MAX);
+        ROUND_TRIP_LOG(expected, "unsigned %u %o %x %08X %x\n", 4000000000u, 8u, 0xabcu, 0xbeefu, -1);
+        ROUND_TRIP_LOG(expected, "long %ld %lu %lld %llx\n", -123456789L, 123456789UL, -1234567890123LL, 0xdeadbeefcafeULL);
+        ROUND_TRIP_LOG(expected, "size %zu %zd char %c percent %%\n", (size_t) 42, (ssize_t) -3, 'Z');
+        ROUND_TRIP_LOG(expected, "float %5.2f %e %g %.0f\n", 3.14159, 1e-9, 2.5, 100.0);
+        ROUND_TRIP_LOG(expected, "string '%s' '%s' '%-8s' '%.3s'\n", "literal", dynamic, TEST_TAG, "truncated");
+        ROUND_TRIP_LOG(expected, "width '%*d' '%-*d' '%.*s'\n", 6, 42, 4, 7, 2, dynamic);
+        ROUND_TRIP_LOG(expected, "pointer %p\n", (void *) 0x1234);
+        ROUND_TRIP_LOG(expected, "%s\n", "only a string");
+        records = fix.flush_and_get_output();
+    }
+    CHECK(esp_log_binary_get_dropped_count() == dropped_before);
+    printf("ROUND_TRIP_RECORDS_BEGIN\n%sROUND_TRIP_RECORDS_END\n", records.c_str());
+    printf("ROUND_TRIP_EXPECTED_BEGIN\n%sROUND_TRIP_EXPECTED_END\n", expected.c_str());
+    fflush(stdout);
+}
+
+static atomic<size_t> s_output_bytes;
+
+/* Formats the output like a console would, and only counts it */
+static int count_output(const char *format, va_list args)
+{
+    char line[512];
+    int ret = vsnprintf(line, sizeof(line), format, args);
+    s_output_bytes += ret;
+    return ret;
+}
+
+/* Times the calls only, the records are written out between the batches so that none are dropped */
+static double log_ns_per_call(const char *format, int calls)
+{
+    const int BATCH = 8;
+    double total_ns = 0;
+    for (int i = 0; i < calls; i += BATCH) {
+        auto start = chrono::steady_clock::now();
+        for (int j = 0; j < BATCH; j++) {
+            esp_log_write(ESP_LOG_INFO, TEST_TAG, format, 1234567ul, TEST_TAG, i + j, 95, 41u, "bme280");
+        }
+        total_ns += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        esp_log_binary_flush();
+    }
+    return total_ns / calls;
+}
+
+TEST_CASE("binary and text logging timings and output size")
+{
+    static const char format[] = "I (%lu) %s: temperature %d.%02d C, humidity %u %%, sensor %s\n";
+    // A format string which is not in the executable is written out as text right away
+    char text_format[sizeof(format)];
+    strcpy(text_format, format);
+    const int CALLS = 4096;
+
+    esp_log_binary_flush();
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(count_output);
+    uint32_t dropped_before = esp_log_binary_get_dropped_count();
+
+    // Warm up
+    log_ns_per_call(format, 8);
+    log_ns_per_call(text_format, 8);
+
+    s_output_bytes = 0;
+    double binary_ns = log_ns_per_call(format, CALLS);
+    size_t binary_bytes = s_output_bytes;
+    s_output_bytes = 0;
+    double text_ns = log_ns_per_call(text_format, CALLS);
+    size_t text_bytes = s_output_bytes;
+
+    esp_log_set_vprintf(old_vprintf);
+    CHECK(esp_log_binary_get_dropped_count() == dropped_before);
+    CHECK(binary_bytes > 0);
+    CHECK(text_bytes > 0);
+
+    // The host is not real-time, the timings are only printed
+    printf("binary: %.0f ns per call, %.1f bytes of output per message\n", binary_ns, (double) binary_bytes / CALLS);
+    printf("text: %.0f ns per call, %.1f bytes of output per message\n", text_ns, (double) text_bytes / CALLS);
+    printf("binary log buffers: %d bytes of RAM per core, format strings stay in flash in both cases\n",
+           CONFIG_LOG_BINARY_BUFFER_SIZE);
+}
@@ -0,0 +1,31 @@
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+import io
+import os
+import re
+import sys
+
+import pytest
+from pytest_embedded import Dut
+
+sys.path.append(os.path.join(os.environ['IDF_PATH'], 'tools'))
+import esp_log_binary_decoder  # noqa: E402
+
+
+def expect_block(dut: Dut, name: str) -> str:
+    pattern = re.compile(r'{0}_BEGIN\r?\n(.*?){0}_END'.format(name).encode(), re.DOTALL)
+    return str(dut.expect(pattern, timeout=5).group(1).decode().replace('\r', ''))
+
+
+@pytest.mark.linux
+@pytest.mark.host_test
+def test_log_binary_linux(dut: Dut) -> None:
+    # the records are decoded with the format strings of the ELF file, like idf.py monitor output would be
+    records = expect_block(dut, 'ROUND_TRIP_RECORDS')
+    expected = expect_block(dut, 'ROUND_TRIP_EXPECTED')
+    decoder = esp_log_binary_decoder.BinaryLogDecoder(esp_log_binary_decoder.ElfImage(dut.app.elf_file))
+    decoded = io.StringIO()
+    esp_log_binary_decoder.decode_stream(decoder, io.StringIO(records), decoded)
+    assert decoded.getvalue() == expected
+
+    dut.expect_exact('All tests passed', timeout=5)
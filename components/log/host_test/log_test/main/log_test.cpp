@@ -9,6 +9,9 @@
 #include <cstdio>
 #include <regex>
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
 #include "esp_rom_sys.h"
 #include "esp_log.h"
 #include "esp_private/log_util.h"
@@ -215,6 +218,95 @@ TEST_CASE("changing log level")
 }
 #endif // CONFIG_LOG_DYNAMIC_LEVEL_CONTROL
 
+#if CONFIG_LOG_TAG_LEVEL_CACHE_LOCK_FREE_HASH
+TEST_CASE("changing log level of a tag cached at several addresses")
+{
+    char tag_copy[] = "test";
+    REQUIRE(tag_copy != TEST_TAG);
+    esp_log_level_set("*", ESP_LOG_INFO);
+    CHECK(esp_log_level_get(TEST_TAG) == ESP_LOG_INFO);
+    CHECK(esp_log_level_get(tag_copy) == ESP_LOG_INFO);
+
+    esp_log_level_set(TEST_TAG, ESP_LOG_WARN);
+    CHECK(esp_log_level_get(TEST_TAG) == ESP_LOG_WARN);
+    CHECK(esp_log_level_get(tag_copy) == ESP_LOG_WARN);
+
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    CHECK(esp_log_level_get(TEST_TAG) == ESP_LOG_ERROR);
+    CHECK(esp_log_level_get(tag_copy) == ESP_LOG_ERROR);
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+}
+#endif // CONFIG_LOG_TAG_LEVEL_CACHE_LOCK_FREE_HASH
+
+#if CONFIG_LOG_TAG_LEVEL_CACHE_LOCK_FREE_HASH
+#define TAG_LEVEL_IMPL_NAME "lock-free hash cache"
+#elif CONFIG_LOG_TAG_LEVEL_CACHE_BINARY_MIN_HEAP
+#define TAG_LEVEL_IMPL_NAME "binary min-heap cache"
+#elif CONFIG_LOG_TAG_LEVEL_CACHE_ARRAY
+#define TAG_LEVEL_IMPL_NAME "array cache"
+#elif CONFIG_LOG_TAG_LEVEL_IMPL_LINKED_LIST
+#define TAG_LEVEL_IMPL_NAME "linked list"
+#else
+#define TAG_LEVEL_IMPL_NAME "none"
+#endif
+
+// Catch2 assertions are not thread safe, the number of filtered lookups is returned in 'filtered'
+static double level_get_ns_per_call(const std::vector<const char *> &tags, int rounds, int &filtered)
+{
+    auto start = std::chrono::steady_clock::now();
+    filtered = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (const char *tag : tags) {
+            filtered += esp_log_level_get(tag) < ESP_LOG_DEBUG;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (rounds * tags.size());
+}
+
+// Run with the tag_level_* configs to compare the tag level implementations
+TEST_CASE("esp_log_level_get timings")
+{
+    const int HOT_TAGS = 20;
+    const int ROUNDS = 50000;
+    const int THREADS = 4;
+    static char tags[HOT_TAGS][8];
+    std::vector<const char *> hot_tags;
+    for (int i = 0; i < HOT_TAGS; i++) {
+        snprintf(tags[i], sizeof(tags[i]), "hot%d", i);
+        hot_tags.push_back(tags[i]);
+    }
+    esp_log_level_set("*", ESP_LOG_INFO);
+    esp_log_level_set(tags[0], ESP_LOG_WARN);
+
+    // Warm up, fills the cache
+    int filtered;
+    level_get_ns_per_call(hot_tags, 1, filtered);
+    double single_ns = level_get_ns_per_call(hot_tags, ROUNDS, filtered);
+    CHECK(filtered == ROUNDS * HOT_TAGS);
+
+    std::vector<double> thread_ns(THREADS);
+    std::vector<int> thread_filtered(THREADS);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; i++) {
+        threads.emplace_back([&, i] {
+            thread_ns[i] = level_get_ns_per_call(hot_tags, ROUNDS / THREADS, thread_filtered[i]);
+        });
+    }
+    double max_thread_ns = 0;
+    for (int i = 0; i < THREADS; i++) {
+        threads[i].join();
+        CHECK(thread_filtered[i] == ROUNDS / THREADS * HOT_TAGS);
+        max_thread_ns = std::max(max_thread_ns, thread_ns[i]);
+    }
+    // The host is not real-time, the timings are only printed
+    printf("%s, %d hot tags: %.1f ns per esp_log_level_get, %.1f ns with %d threads\n",
+           TAG_LEVEL_IMPL_NAME, HOT_TAGS, single_ns, max_thread_ns, THREADS);
+
+    esp_log_level_set("*", ESP_LOG_INFO);
+}
+
 TEST_CASE("log buffer")
 {
     PrintFixture fix(ESP_LOG_INFO);
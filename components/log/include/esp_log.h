@@ -15,6 +15,7 @@
 #include "esp_log_color.h"
 #include "esp_log_buffer.h"
 #include "esp_log_timestamp.h"
+#include "esp_log_binary.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +33,10 @@ typedef int (*vprintf_like_t)(const char *, va_list);
  * @note Please note that function callback here must be re-entrant as it can be
  * invoked in parallel from multiple thread context.
  *
+ * @note With CONFIG_LOG_BINARY, the function is also called by the background task which writes
+ * out the buffered records. On the Linux target, this is a POSIX thread and not a FreeRTOS task,
+ * so the function must not call FreeRTOS APIs there.
+ *
  * @param func new Function used for output. Must have same signature as vprintf.
  *
  * @return func old Function used for output.
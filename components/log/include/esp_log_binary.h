@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Write out the binary log records which are still buffered
+ *
+ * With CONFIG_LOG_BINARY enabled, ESP_LOGx calls only copy the address of the format string and
+ * the raw arguments into a per-core buffer. A background task periodically writes the buffered
+ * records out through the function set with esp_log_set_vprintf(). This function writes them
+ * out right away, from the calling task, e.g. before a restart.
+ *
+ * Does nothing if CONFIG_LOG_BINARY is disabled.
+ */
+void esp_log_binary_flush(void);
+
+/**
+ * @brief Get the number of binary log records dropped because the buffer was full
+ *
+ * @return number of records dropped since startup, 0 if CONFIG_LOG_BINARY is disabled
+ */
+uint32_t esp_log_binary_get_dropped_count(void);
+
+#ifdef __cplusplus
+}
+#endif
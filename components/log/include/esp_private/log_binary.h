@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdarg.h>
+#include "esp_log_level.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+#define ESP_LOG_BINARY_NUM_RINGS    (1)
+#else
+#define ESP_LOG_BINARY_NUM_RINGS    (CONFIG_FREERTOS_NUMBER_OF_CORES)
+#endif
+
+/**
+ * @brief Record a log message in the binary log buffer
+ *
+ * @param level  Log level of the message
+ * @param format Format string, must stay valid until the record is written out
+ * @param args   Arguments of the format string
+ *
+ * @return true if the message was recorded (or dropped because the buffer was full),
+ *         false if it can not be recorded in binary form and must be written out as text.
+ */
+bool esp_log_binary_writev(esp_log_level_t level, const char *format, va_list args);
+
+/**
+ * @brief Write out the records of all the binary log buffers
+ *
+ * Called by the flush task, and by esp_log_binary_flush().
+ */
+void esp_log_binary_drain(void);
+
+/**
+ * @brief Write out a line through the function set with esp_log_set_vprintf()
+ */
+void esp_log_binary_print_line(const char *line);
+
+/**
+ * @brief Start a new stream on the next written out record
+ *
+ * Called when the output function changes, so that the new destination receives a stream record
+ * before the log records.
+ */
+void esp_log_binary_restart_stream(void);
+
+/* Functions below are implemented separately for each system target */
+
+/**
+ * @brief Check if the pointer refers to constant data which the decoder can read from the ELF file
+ */
+bool esp_log_binary_impl_ptr_in_image(const void *ptr);
+
+/**
+ * @brief Get the index of the binary log buffer used by the calling task
+ */
+unsigned esp_log_binary_impl_ring_id(void);
+
+/**
+ * @brief Take the lock of the reader state of the binary log buffers
+ *
+ * The records are written out under this lock and not under the log lock, so that the tasks
+ * logging meanwhile don't time out waiting for the log lock.
+ */
+void esp_log_binary_impl_drain_lock(void);
+
+/**
+ * @brief Release the lock taken by esp_log_binary_impl_drain_lock()
+ */
+void esp_log_binary_impl_drain_unlock(void);
+
+/**
+ * @brief Start the flush task if it has not been started yet, and wake it up
+ *
+ * @param urgent true if a buffer is getting full and should be drained right away
+ */
+void esp_log_binary_impl_notify(bool urgent);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,431 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file log_binary.c
+ * @brief Deferred binary logging.
+ *
+ * Instead of formatting the message, esp_log_writev() records the address of the format string
+ * and the raw values of its arguments. The records are written out later by a background task,
+ * and formatted on the host by tools/esp_log_binary_decoder.py, which reads the format strings
+ * from the ELF file of the application.
+ *
+ * Each core has its own ring buffer of 32-bit words. Writers reserve space for a record with a
+ * compare-and-swap on the write offset, fill it in, then commit it by storing its header word.
+ * The flush task is the only reader: it stops at the first record which is not committed yet,
+ * and zeroes the records it has written out, so that a zero header always means "not committed".
+ * When there is not enough contiguous space at the end of the buffer, the writer commits a
+ * padding record there and reserves space at the beginning instead.
+ *
+ * Varints are LEB128 encoded: most arguments are small numbers, which then take a single byte.
+ *
+ * Record layout, little endian, padded to a multiple of 4 bytes:
+ *
+ *  - header word: bits 0..15 are the size in words, bits 16..23 the type, bits 24..31 the level.
+ *  - LOG_BINARY_RECORD_LOG: address of the format string, followed by one field per conversion
+ *    specification of the format string, in order:
+ *      - '*' width or precision, and %d, %i: zigzag encoded varint
+ *      - %o, %u, %x, %X, %c: varint of the argument, as an unsigned value of the argument type size
+ *      - floating point conversions: 8 bytes (double)
+ *      - %p: size of a pointer
+ *      - %s: 1 byte LOG_BINARY_STR_PTR followed by the address of the string, if the decoder
+ *        can read it from the ELF file, or 1 byte LOG_BINARY_STR_INLINE followed by 1 byte length
+ *        and the characters of the string, without the terminating zero.
+ *      - %n and %%: nothing
+ *  - LOG_BINARY_RECORD_STREAM: version and size of a pointer, 1 byte each, 2 reserved bytes,
+ *    followed by the address of esp_log_writev(). The decoder uses this address to find the load
+ *    address of a position independent executable.
+ *  - LOG_BINARY_RECORD_DROPPED: number of records dropped since startup, 4 bytes.
+ *
+ * Records are written out one per line, as "BLOG:" followed by the record in base64, so that they
+ * can be mixed with text output on the same console.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_log_binary.h"
+#include "esp_private/log_binary.h"
+#include "sdkconfig.h"
+
+#define LOG_BINARY_RECORD_PAD       (1)
+#define LOG_BINARY_RECORD_LOG       (2)
+#define LOG_BINARY_RECORD_STREAM    (3)
+#define LOG_BINARY_RECORD_DROPPED   (4)
+
+#define LOG_BINARY_STR_PTR          (0)
+#define LOG_BINARY_STR_INLINE       (1)
+
+#define LOG_BINARY_STREAM_VERSION   (1)
+
+/* The stream record is repeated, so that the decoder can join a stream which is already running */
+#define LOG_BINARY_STREAM_PERIOD    (128)
+
+/* Longer records are written out as text */
+#define LOG_BINARY_RECORD_MAX_SIZE  (160)
+#define LOG_BINARY_RECORD_MAX_WORDS (LOG_BINARY_RECORD_MAX_SIZE / sizeof(uint32_t))
+
+#define LOG_BINARY_RING_WORDS       (CONFIG_LOG_BINARY_BUFFER_SIZE / sizeof(uint32_t))
+
+#define LOG_BINARY_HEADER(words, type, level) ((uint32_t)(words) | ((uint32_t)(type) << 16) | ((uint32_t)(level) << 24))
+#define LOG_BINARY_HEADER_WORDS(header)       ((header) & 0xFFFF)
+#define LOG_BINARY_HEADER_TYPE(header)        (((header) >> 16) & 0xFF)
+
+#define LOG_BINARY_LINE_PREFIX      "BLOG:"
+#define LOG_BINARY_LINE_MAX_SIZE    (sizeof(LOG_BINARY_LINE_PREFIX) + (LOG_BINARY_RECORD_MAX_SIZE + 2) / 3 * 4 + 2)
+
+_Static_assert(LOG_BINARY_RING_WORDS > 2 * LOG_BINARY_RECORD_MAX_WORDS, "CONFIG_LOG_BINARY_BUFFER_SIZE is too small");
+_Static_assert(LOG_BINARY_RING_WORDS <= 0xFFFF, "CONFIG_LOG_BINARY_BUFFER_SIZE is too large");
+
+typedef struct {
+    _Atomic uint32_t write;             /* Word offset where the next record will be reserved */
+    _Atomic uint32_t read;              /* Word offset of the oldest record not written out yet */
+    uint32_t buf[LOG_BINARY_RING_WORDS];
+} log_binary_ring_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} log_binary_writer_t;
+
+static log_binary_ring_t s_rings[ESP_LOG_BINARY_NUM_RINGS];
+static _Atomic uint32_t s_dropped;
+
+/* Set when the output function changes, the next record written out starts a new stream */
+static atomic_bool s_stream_restart;
+
+/* Reader state, protected by the drain lock */
+static uint32_t s_dropped_reported;
+static uint32_t s_records_since_stream;
+static bool s_stream_started;
+static char s_line[LOG_BINARY_LINE_MAX_SIZE];
+
+static inline bool writer_put(log_binary_writer_t *writer, const void *value, size_t size)
+{
+    if (writer->len + size > LOG_BINARY_RECORD_MAX_SIZE) {
+        return false;
+    }
+    memcpy(writer->data + writer->len, value, size);
+    writer->len += size;
+    return true;
+}
+
+/* LEB128: 7 bits per byte, least significant first, the top bit is set in all bytes but the last */
+static bool writer_put_varint(log_binary_writer_t *writer, uint64_t value)
+{
+    uint8_t bytes[10];
+    size_t len = 0;
+    do {
+        bytes[len] = value & 0x7F;
+        value >>= 7;
+        bytes[len++] |= value ? 0x80 : 0;
+    } while (value != 0);
+    return writer_put(writer, bytes, len);
+}
+
+/* Zigzag encoding, so that small negative values are also short: 0, -1, 1, -2, ... map to 0, 1, 2, 3, ... */
+static inline bool writer_put_signed(log_binary_writer_t *writer, long long value)
+{
+    return writer_put_varint(writer, ((uint64_t) value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static bool writer_put_str(log_binary_writer_t *writer, const char *str)
+{
+    if (str != NULL && esp_log_binary_impl_ptr_in_image(str)) {
+        uint8_t kind = LOG_BINARY_STR_PTR;
+        return writer_put(writer, &kind, sizeof(kind)) && writer_put(writer, &str, sizeof(str));
+    }
+    if (str == NULL) {
+        str = "(null)";
+    }
+    size_t len = strlen(str);
+    uint8_t prefix[2] = { LOG_BINARY_STR_INLINE, (uint8_t) len };
+    return len <= UINT8_MAX && writer_put(writer, prefix, sizeof(prefix)) && writer_put(writer, str, len);
+}
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/* Walks the conversion specifications of the format string and records the matching arguments.
+ * Returns false if the format string uses something the decoder can not reproduce.
+ */
+static bool writer_put_args(log_binary_writer_t *writer, const char *format, va_list args)
+{
+    for (const char *p = format; *p != '\0'; ++p) {
+        if (*p != '%') {
+            continue;
+        }
+        ++p;
+        if (*p == '%') {
+            continue;
+        }
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+            ++p;
+        }
+        for (int field = 0; field < 2; ++field) {
+            if (field == 1) {
+                if (*p != '.') {
+                    break;
+                }
+                ++p;
+            }
+            if (*p == '*') {
+                if (!writer_put_signed(writer, va_arg(args, int))) {
+                    return false;
+                }
+                ++p;
+            }
+            while (is_digit(*p)) {
+                ++p;
+            }
+        }
+
+        enum { LEN_INT, LEN_LONG, LEN_LONG_LONG, LEN_SIZE, LEN_PTRDIFF, LEN_INTMAX, LEN_LONG_DOUBLE } len = LEN_INT;
+        switch (*p) {
+        case 'h':
+            p += (p[1] == 'h') ? 2 : 1;
+            break;
+        case 'l':
+            if (p[1] == 'l') {
+                len = LEN_LONG_LONG;
+                p += 2;
+            } else {
+                len = LEN_LONG;
+                p += 1;
+            }
+            break;
+        case 'z': len = LEN_SIZE; ++p; break;
+        case 't': len = LEN_PTRDIFF; ++p; break;
+        case 'j': len = LEN_INTMAX; ++p; break;
+        case 'L': len = LEN_LONG_DOUBLE; ++p; break;
+        default: break;
+        }
+
+        bool ok;
+        switch (*p) {
+        case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c': {
+            long long value;
+            size_t size;
+            switch (len) {
+            case LEN_LONG:      value = va_arg(args, long);         size = sizeof(long);        break;
+            case LEN_LONG_LONG: value = va_arg(args, long long);    size = sizeof(long long);   break;
+            case LEN_SIZE:      value = va_arg(args, size_t);       size = sizeof(size_t);      break;
+            case LEN_PTRDIFF:   value = va_arg(args, ptrdiff_t);    size = sizeof(ptrdiff_t);   break;
+            case LEN_INTMAX:    value = va_arg(args, intmax_t);     size = sizeof(intmax_t);    break;
+            case LEN_INT:       value = va_arg(args, int);          size = sizeof(int);         break;
+            default:            return false;
+            }
+            if (*p == 'd' || *p == 'i') {
+                ok = writer_put_signed(writer, value);
+            } else {
+                // unsigned conversions print the argument as an unsigned value of its own size
+                uint64_t mask = (size < sizeof(uint64_t)) ? (UINT64_C(1) << (size * 8)) - 1 : UINT64_MAX;
+                ok = writer_put_varint(writer, (uint64_t) value & mask);
+            }
+            break;
+        }
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+            double value = (len == LEN_LONG_DOUBLE) ? (double) va_arg(args, long double) : va_arg(args, double);
+            ok = writer_put(writer, &value, sizeof(value));
+            break;
+        }
+        case 'p': {
+            void *value = va_arg(args, void *);
+            ok = writer_put(writer, &value, sizeof(value));
+            break;
+        }
+        case 's':
+            ok = (len == LEN_INT) && writer_put_str(writer, va_arg(args, const char *));
+            break;
+        case 'n':
+            (void) va_arg(args, void *);
+            ok = true;
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Returns the word offset of the reserved space, or -1 if the ring is full */
+static int32_t ring_reserve(log_binary_ring_t *ring, uint32_t words, bool *urgent)
+{
+    uint32_t write = atomic_load_explicit(&ring->write, memory_order_relaxed);
+    uint32_t start, next, read;
+    do {
+        read = atomic_load_explicit(&ring->read, memory_order_acquire);
+        if (write >= read) {
+            const uint32_t to_end = LOG_BINARY_RING_WORDS - write;
+            if (to_end > words || (to_end == words && read != 0)) {
+                start = write;
+                next = (write + words) % LOG_BINARY_RING_WORDS;
+            } else if (read > words) {
+                // wrap around, the space up to the end is taken by a padding record
+                start = 0;
+                next = words;
+            } else {
+                return -1;
+            }
+        } else if (read - write > words) {
+            start = write;
+            next = write + words;
+        } else {
+            return -1;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&ring->write, &write, next,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    if (start != write) {
+        __atomic_store_n(&ring->buf[write], LOG_BINARY_HEADER(LOG_BINARY_RING_WORDS - write, LOG_BINARY_RECORD_PAD, 0), __ATOMIC_RELEASE);
+    }
+    uint32_t used = (next + LOG_BINARY_RING_WORDS - read) % LOG_BINARY_RING_WORDS;
+    *urgent = used > LOG_BINARY_RING_WORDS / 2;
+    return (int32_t) start;
+}
+
+bool esp_log_binary_writev(esp_log_level_t level, const char *format, va_list args)
+{
+    if (!esp_log_binary_impl_ptr_in_image(format)) {
+        return false;
+    }
+
+    uint32_t record[LOG_BINARY_RECORD_MAX_WORDS];
+    log_binary_writer_t writer = {
+        .data = (uint8_t *) record,
+        .len = sizeof(uint32_t),
+    };
+    writer_put(&writer, &format, sizeof(format));
+    va_list args_copy;
+    va_copy(args_copy, args);
+    bool ok = writer_put_args(&writer, format, args_copy);
+    va_end(args_copy);
+    if (!ok) {
+        return false;
+    }
+
+    const uint32_t words = (writer.len + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    log_binary_ring_t *ring = &s_rings[esp_log_binary_impl_ring_id()];
+    bool urgent;
+    int32_t start = ring_reserve(ring, words, &urgent);
+    if (start < 0) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        esp_log_binary_impl_notify(true);
+        return true;
+    }
+    memcpy(&ring->buf[start + 1], &record[1], writer.len - sizeof(uint32_t));
+    __atomic_store_n(&ring->buf[start], LOG_BINARY_HEADER(words, LOG_BINARY_RECORD_LOG, level), __ATOMIC_RELEASE);
+    esp_log_binary_impl_notify(urgent);
+    return true;
+}
+
+static void emit_record(const uint32_t *record, uint32_t words)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const uint8_t *data = (const uint8_t *) record;
+    const size_t len = words * sizeof(uint32_t);
+    char *out = s_line;
+    memcpy(out, LOG_BINARY_LINE_PREFIX, sizeof(LOG_BINARY_LINE_PREFIX) - 1);
+    out += sizeof(LOG_BINARY_LINE_PREFIX) - 1;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t chunk = (uint32_t) data[i] << 16;
+        if (i + 1 < len) {
+            chunk |= (uint32_t) data[i + 1] << 8;
+        }
+        if (i + 2 < len) {
+            chunk |= data[i + 2];
+        }
+        *out++ = alphabet[(chunk >> 18) & 0x3F];
+        *out++ = alphabet[(chunk >> 12) & 0x3F];
+        *out++ = (i + 1 < len) ? alphabet[(chunk >> 6) & 0x3F] : '=';
+        *out++ = (i + 2 < len) ? alphabet[chunk & 0x3F] : '=';
+    }
+    *out++ = '\n';
+    *out = '\0';
+    esp_log_binary_print_line(s_line);
+}
+
+static void emit_stream_record(void)
+{
+    uint32_t record[1 + (4 + sizeof(void *)) / sizeof(uint32_t)] = { 0 };
+    const uint32_t words = sizeof(record) / sizeof(uint32_t);
+    uint8_t *data = (uint8_t *) &record[1];
+    data[0] = LOG_BINARY_STREAM_VERSION;
+    data[1] = sizeof(void *);
+    const void *anchor = (const void *) &esp_log_writev;
+    memcpy(&data[4], &anchor, sizeof(anchor));
+    record[0] = LOG_BINARY_HEADER(words, LOG_BINARY_RECORD_STREAM, 0);
+    emit_record(record, words);
+    s_records_since_stream = 0;
+    s_stream_started = true;
+}
+
+static void emit_log_record(const uint32_t *record, uint32_t words)
+{
+    const bool restart = atomic_exchange_explicit(&s_stream_restart, false, memory_order_relaxed);
+    if (!s_stream_started || restart || s_records_since_stream >= LOG_BINARY_STREAM_PERIOD) {
+        emit_stream_record();
+    }
+    emit_record(record, words);
+    s_records_since_stream++;
+}
+
+static void ring_drain(log_binary_ring_t *ring)
+{
+    uint32_t read = atomic_load_explicit(&ring->read, memory_order_relaxed);
+    while (true) {
+        const uint32_t header = __atomic_load_n(&ring->buf[read], __ATOMIC_ACQUIRE);
+        if (header == 0) {
+            break;
+        }
+        const uint32_t words = LOG_BINARY_HEADER_WORDS(header);
+        if (LOG_BINARY_HEADER_TYPE(header) != LOG_BINARY_RECORD_PAD) {
+            emit_log_record(&ring->buf[read], words);
+        }
+        memset(&ring->buf[read], 0, words * sizeof(uint32_t));
+        read = (read + words) % LOG_BINARY_RING_WORDS;
+        atomic_store_explicit(&ring->read, read, memory_order_release);
+    }
+}
+
+void esp_log_binary_drain(void)
+{
+    esp_log_binary_impl_drain_lock();
+    for (int i = 0; i < ESP_LOG_BINARY_NUM_RINGS; ++i) {
+        ring_drain(&s_rings[i]);
+    }
+    const uint32_t dropped = atomic_load_explicit(&s_dropped, memory_order_relaxed);
+    if (dropped != s_dropped_reported) {
+        uint32_t record[2] = { LOG_BINARY_HEADER(2, LOG_BINARY_RECORD_DROPPED, 0), dropped };
+        emit_log_record(record, 2);
+        s_dropped_reported = dropped;
+    }
+    esp_log_binary_impl_drain_unlock();
+}
+
+void esp_log_binary_restart_stream(void)
+{
+    atomic_store_explicit(&s_stream_restart, true, memory_order_relaxed);
+}
+
+void esp_log_binary_flush(void)
+{
+    esp_log_binary_drain();
+}
+
+uint32_t esp_log_binary_get_dropped_count(void)
+{
+    return atomic_load_explicit(&s_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <time.h>
+#include "esp_private/log_binary.h"
+#include "sdkconfig.h"
+
+/* The flush thread is a plain POSIX thread, it does not depend on the FreeRTOS simulator.
+ * The output function set with esp_log_set_vprintf() is called from it, outside any FreeRTOS task. */
+
+static pthread_once_t s_flush_thread_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t s_drain_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t s_flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_flush_cond = PTHREAD_COND_INITIALIZER;
+static bool s_flush_requested;
+
+static void *log_binary_flush_thread(void *arg)
+{
+    while (true) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long) CONFIG_LOG_BINARY_FLUSH_PERIOD_MS * 1000000;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+
+        pthread_mutex_lock(&s_flush_mutex);
+        while (!s_flush_requested) {
+            if (pthread_cond_timedwait(&s_flush_cond, &s_flush_mutex, &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+        s_flush_requested = false;
+        pthread_mutex_unlock(&s_flush_mutex);
+
+        esp_log_binary_drain();
+    }
+    return NULL;
+}
+
+static void log_binary_start_flush_thread(void)
+{
+    /* The FreeRTOS simulator switches tasks with signals, the flush thread must not handle them */
+    sigset_t all_signals, prev_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &prev_signals);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, log_binary_flush_thread, NULL) == 0) {
+        pthread_detach(thread);
+    }
+    pthread_sigmask(SIG_SETMASK, &prev_signals, NULL);
+}
+
+bool esp_log_binary_impl_ptr_in_image(const void *ptr)
+{
+#if defined(__linux__)
+    /* Read-only sections of the executable, defined by the default GNU linker script */
+    extern const char __executable_start[];
+    extern const char __data_start[];
+    return (const char *) ptr >= __executable_start && (const char *) ptr < __data_start;
+#else
+    /* Everything is written out as text */
+    return false;
+#endif
+}
+
+void esp_log_binary_impl_drain_lock(void)
+{
+    pthread_mutex_lock(&s_drain_mutex);
+}
+
+void esp_log_binary_impl_drain_unlock(void)
+{
+    pthread_mutex_unlock(&s_drain_mutex);
+}
+
+unsigned esp_log_binary_impl_ring_id(void)
+{
+    return 0;
+}
+
+void esp_log_binary_impl_notify(bool urgent)
+{
+    pthread_once(&s_flush_thread_once, log_binary_start_flush_thread);
+    if (urgent) {
+        pthread_mutex_lock(&s_flush_mutex);
+        s_flush_requested = true;
+        pthread_cond_signal(&s_flush_cond);
+        pthread_mutex_unlock(&s_flush_mutex);
+    }
+}
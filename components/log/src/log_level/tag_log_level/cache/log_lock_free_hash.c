@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This file implements a cache of log tag levels which is read without taking
+ * the log lock. It is an open addressing hash table keyed by the address of the
+ * tag, with linear probing. Each entry holds an atomic tag pointer and an atomic
+ * level byte, so esp_log_cache_get_level can be called from any task without
+ * locking, while the other functions are called with the log lock held.
+ *
+ * Entries are never removed, so a reader can not see an entry being reused for
+ * another tag:
+ * - esp_log_cache_add publishes the level of a new entry before its tag.
+ * - esp_log_cache_set_level updates the level byte of all the entries whose tag
+ *   matches, as the same tag string may be referenced from several addresses.
+ * - esp_log_cache_clean marks all the levels as "default", which is what the
+ *   level of every tag is after esp_log_level_set("*", level).
+ *
+ * Once the table is three-quarters full, new tags are not added anymore, and their
+ * level is looked up in the linked list, under the log lock.
+ *
+ * The table has CONFIG_LOG_TAG_LEVEL_IMPL_CACHE_SIZE + 1 entries.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_log_level.h"
+#include "esp_private/log_level.h"
+#include "esp_assert.h"
+#include "sdkconfig.h"
+
+ESP_STATIC_ASSERT(((CONFIG_LOG_TAG_LEVEL_IMPL_CACHE_SIZE & (CONFIG_LOG_TAG_LEVEL_IMPL_CACHE_SIZE + 1)) == 0), "Number of tags to be cached must be 2**n - 1, n >= 2. [1, 3, 7, 15, 31, 63, 127, 255, ...]");
+#define TAG_TABLE_SIZE      (CONFIG_LOG_TAG_LEVEL_IMPL_CACHE_SIZE + 1)
+#define TAG_TABLE_MASK      (TAG_TABLE_SIZE - 1)
+#define TAG_TABLE_MAX_USED  (TAG_TABLE_SIZE * 3 / 4)
+
+// Level of a tag which follows the default log level
+#define LEVEL_DEFAULT       (0xFF)
+
+typedef struct {
+    _Atomic(const char *) tag;
+    _Atomic uint8_t level;
+} tag_entry_t;
+
+static tag_entry_t s_table[TAG_TABLE_SIZE];
+static uint32_t s_used = 0;
+
+static inline uint32_t tag_hash(const char *tag)
+{
+    // Fibonacci hashing of the address, the low bits of which are often the same
+    return ((uint32_t)(uintptr_t) tag * 2654435769u) >> 16;
+}
+
+void esp_log_cache_set_level(const char *tag, esp_log_level_t level)
+{
+    for (uint32_t i = 0; i < TAG_TABLE_SIZE; ++i) {
+        const char *entry_tag = atomic_load_explicit(&s_table[i].tag, memory_order_relaxed);
+        if (entry_tag != NULL && strcmp(entry_tag, tag) == 0) {
+            atomic_store_explicit(&s_table[i].level, (uint8_t) level, memory_order_relaxed);
+        }
+    }
+}
+
+bool esp_log_cache_get_level(const char *tag, esp_log_level_t *level)
+{
+    uint32_t i = tag_hash(tag);
+    for (uint32_t probes = 0; probes < TAG_TABLE_SIZE; ++probes, ++i) {
+        tag_entry_t *entry = &s_table[i & TAG_TABLE_MASK];
+        const char *entry_tag = atomic_load_explicit(&entry->tag, memory_order_acquire);
+        if (entry_tag == tag) {
+            uint8_t entry_level = atomic_load_explicit(&entry->level, memory_order_relaxed);
+            *level = (entry_level == LEVEL_DEFAULT) ? esp_log_get_default_level() : (esp_log_level_t) entry_level;
+            return true;
+        }
+        if (entry_tag == NULL) {
+            break;
+        }
+    }
+    // Not found in cache
+    return false;
+}
+
+void esp_log_cache_clean(void)
+{
+    for (uint32_t i = 0; i < TAG_TABLE_SIZE; ++i) {
+        atomic_store_explicit(&s_table[i].level, LEVEL_DEFAULT, memory_order_relaxed);
+    }
+}
+
+void esp_log_cache_add(const char *tag, esp_log_level_t level)
+{
+    uint32_t i = tag_hash(tag);
+    for (uint32_t probes = 0; probes < TAG_TABLE_SIZE; ++probes, ++i) {
+        tag_entry_t *entry = &s_table[i & TAG_TABLE_MASK];
+        const char *entry_tag = atomic_load_explicit(&entry->tag, memory_order_relaxed);
+        if (entry_tag == tag) {
+            atomic_store_explicit(&entry->level, (uint8_t) level, memory_order_relaxed);
+            return;
+        }
+        if (entry_tag == NULL) {
+            if (s_used >= TAG_TABLE_MAX_USED) {
+                return;
+            }
+            atomic_store_explicit(&entry->level, (uint8_t) level, memory_order_relaxed);
+            atomic_store_explicit(&entry->tag, tag, memory_order_release);
+            s_used++;
+            return;
+        }
+    }
+}
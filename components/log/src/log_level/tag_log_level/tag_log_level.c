@@ -18,7 +18,7 @@
 #include "linked_list/log_linked_list.h"
 #endif
 
-#if CONFIG_LOG_TAG_LEVEL_CACHE_ARRAY || CONFIG_LOG_TAG_LEVEL_CACHE_BINARY_MIN_HEAP
+#if CONFIG_LOG_TAG_LEVEL_CACHE_ARRAY || CONFIG_LOG_TAG_LEVEL_CACHE_BINARY_MIN_HEAP || CONFIG_LOG_TAG_LEVEL_CACHE_LOCK_FREE_HASH
 #define CACHE_ENABLED 1
 #include "cache/log_cache.h"
 #else
@@ -61,6 +61,12 @@ static esp_log_level_t log_level_get(const char *tag, bool timeout)
     if (tag == NULL) {
         return level_for_tag;
     }
+#if CONFIG_LOG_TAG_LEVEL_CACHE_LOCK_FREE_HASH
+    // This cache can be read without the lock, only a cache miss takes it
+    if (esp_log_cache_get_level(tag, &level_for_tag)) {
+        return level_for_tag;
+    }
+#endif
     if (timeout) {
         if (esp_log_impl_lock_timeout() == false) {
             return ESP_LOG_NONE;
@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <assert.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_compiler.h"
+#include "esp_memory_utils.h"
+#include "esp_private/log_binary.h"
+#include "sdkconfig.h"
+
+static TaskHandle_t s_flush_task = NULL;
+static atomic_bool s_flush_task_creating = false;
+static _Atomic(SemaphoreHandle_t) s_drain_mutex = NULL;
+
+static void log_binary_flush_task(void *arg)
+{
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_LOG_BINARY_FLUSH_PERIOD_MS));
+        esp_log_binary_drain();
+    }
+}
+
+bool esp_log_binary_impl_ptr_in_image(const void *ptr)
+{
+    // Constant strings are placed in flash, the decoder reads them from the ELF file
+    return esp_ptr_in_drom(ptr);
+}
+
+void esp_log_binary_impl_drain_lock(void)
+{
+    if (unlikely(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)) {
+        return;
+    }
+    SemaphoreHandle_t mutex = atomic_load(&s_drain_mutex);
+    if (unlikely(mutex == NULL)) {
+        // the first drains may run concurrently, only one of the created mutexes is kept
+        SemaphoreHandle_t created = xSemaphoreCreateMutex();
+        assert(created != NULL);
+        if (atomic_compare_exchange_strong(&s_drain_mutex, &mutex, created)) {
+            mutex = created;
+        } else {
+            vSemaphoreDelete(created);
+        }
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+}
+
+void esp_log_binary_impl_drain_unlock(void)
+{
+    if (unlikely(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)) {
+        return;
+    }
+    xSemaphoreGive(atomic_load(&s_drain_mutex));
+}
+
+unsigned esp_log_binary_impl_ring_id(void)
+{
+    return xPortGetCoreID();
+}
+
+void esp_log_binary_impl_notify(bool urgent)
+{
+    if (xPortInIsrContext()) {
+        return;
+    }
+    if (unlikely(s_flush_task == NULL)) {
+        // records written before the scheduler has started are kept until the flush task runs
+        if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED && !atomic_exchange(&s_flush_task_creating, true)) {
+            xTaskCreate(log_binary_flush_task, "log_binary", CONFIG_LOG_BINARY_TASK_STACK_SIZE, NULL,
+                        CONFIG_LOG_BINARY_TASK_PRIORITY, &s_flush_task);
+        }
+        return;
+    }
+    if (urgent) {
+        xTaskNotifyGive(s_flush_task);
+    }
+}
@@ -9,8 +9,10 @@
 #include <string.h>
 #include <stdio.h>
 #include "esp_log.h"
+#include "esp_log_binary.h"
 #include "esp_private/log_lock.h"
 #include "esp_private/log_level.h"
+#include "esp_private/log_binary.h"
 #include "sdkconfig.h"
 
 static vprintf_like_t s_log_print_func = &vprintf;
@@ -21,6 +23,9 @@ vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
     vprintf_like_t orig_func = s_log_print_func;
     s_log_print_func = func;
     esp_log_impl_unlock();
+#if CONFIG_LOG_BINARY
+    esp_log_binary_restart_stream();
+#endif
     return orig_func;
 }
 
@@ -31,6 +36,11 @@ void esp_log_writev(esp_log_level_t level,
 {
     esp_log_level_t level_for_tag = esp_log_level_get_timeout(tag);
     if (ESP_LOG_NONE != level_for_tag && level <= level_for_tag) {
+#if CONFIG_LOG_BINARY
+        if (esp_log_binary_writev(level, format, args)) {
+            return;
+        }
+#endif
         (*s_log_print_func)(format, args);
     }
 }
@@ -44,3 +54,27 @@ void esp_log_write(esp_log_level_t level,
     esp_log_writev(level, tag, format, list);
     va_end(list);
 }
+
+#if CONFIG_LOG_BINARY
+static void log_print(const char *format, ...)
+{
+    va_list list;
+    va_start(list, format);
+    (*s_log_print_func)(format, list);
+    va_end(list);
+}
+
+void esp_log_binary_print_line(const char *line)
+{
+    log_print("%s", line);
+}
+#else
+void esp_log_binary_flush(void)
+{
+}
+
+uint32_t esp_log_binary_get_dropped_count(void)
+{
+    return 0;
+}
+#endif // CONFIG_LOG_BINARY
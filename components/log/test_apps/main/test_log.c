@@ -16,6 +16,9 @@
 #if CONFIG_LOG_TAG_LEVEL_IMPL_NONE
 #define EXPECTED_US 3
 #define DELTA_US    3
+#elif CONFIG_LOG_TAG_LEVEL_CACHE_LOCK_FREE_HASH
+#define EXPECTED_US 5
+#define DELTA_US    3
 #else
 #define EXPECTED_US 11
 #define DELTA_US    5
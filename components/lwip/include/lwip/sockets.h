@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -12,6 +12,42 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Message of sendmmsg() and recvmmsg()
+ */
+struct mmsghdr {
+    struct msghdr msg_hdr;      /*!< Datagram to send or buffers to receive it */
+    unsigned int msg_len;       /*!< Bytes sent or received */
+};
+
+#define MSG_WAITFORONE 0x40     /* recvmmsg(): only waits for the first datagram */
+
+/**
+ * @brief Sends several datagrams with one call to the TCP/IP task
+ *
+ * For UDP sockets, the datagrams are copied to pbufs and passed to the TCP/IP task
+ * together (in batches of up to 16), instead of one sendmsg() call and one message
+ * to the TCP/IP task (or core lock) per datagram. Other sockets send the messages
+ * one by one.
+ *
+ * @param flags MSG_DONTWAIT and MSG_MORE, as for sendmsg(); other flags fail with EOPNOTSUPP
+ *
+ * @return Number of datagrams sent, msg_len of each holds its length,
+ *         -1 with errno set if the first datagram fails
+ */
+int lwip_sendmmsg(int s, struct mmsghdr *msgvec, unsigned int vlen, int flags);
+
+/**
+ * @brief Receives several datagrams
+ *
+ * Waits for each datagram as recvmsg() would, or only for the first one with MSG_WAITFORONE.
+ * The timeout is checked after each datagram, as the recvmmsg() of Linux does.
+ *
+ * @return Number of datagrams received, msg_len of each holds its length,
+ *         -1 with errno set if no datagram is received
+ */
+int lwip_recvmmsg(int s, struct mmsghdr *msgvec, unsigned int vlen, int flags, struct timeval *timeout);
+
 static inline int accept(int s,struct sockaddr *addr,socklen_t *addrlen)
 { return lwip_accept(s,addr,addrlen); }
 static inline int bind(int s,const struct sockaddr *name, socklen_t namelen)
@@ -38,12 +74,16 @@ static inline ssize_t recv(int s,void *mem,size_t len,int flags)
 { return lwip_recv(s,mem,len,flags); }
 static inline ssize_t recvfrom(int s,void *mem,size_t len,int flags,struct sockaddr *from,socklen_t *fromlen)
 { return lwip_recvfrom(s,mem,len,flags,from,fromlen); }
+static inline int recvmmsg(int s,struct mmsghdr *msgvec,unsigned int vlen,int flags,struct timeval *timeout)
+{ return lwip_recvmmsg(s,msgvec,vlen,flags,timeout); }
 static inline ssize_t send(int s,const void *dataptr,size_t size,int flags)
 { return lwip_send(s,dataptr,size,flags); }
 static inline ssize_t sendmsg(int s,const struct msghdr *message,int flags)
 { return lwip_sendmsg(s,message,flags); }
 static inline ssize_t sendto(int s,const void *dataptr,size_t size,int flags,const struct sockaddr *to,socklen_t tolen)
 { return lwip_sendto(s,dataptr,size,flags,to,tolen); }
+static inline int sendmmsg(int s,struct mmsghdr *msgvec,unsigned int vlen,int flags)
+{ return lwip_sendmmsg(s,msgvec,vlen,flags); }
 static inline int socket(int domain,int type,int protocol)
 { return lwip_socket(domain,type,protocol); }
 static inline const char *inet_ntop(int af, const void *src, char *dst, socklen_t size)
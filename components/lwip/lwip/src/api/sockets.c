@@ -532,6 +532,22 @@ get_socket(int fd)
   return sock;
 }
 
+#if ESP_LWIP
+/* Lets the socket extensions of the port (sockets_ext.c) use a socket like the functions of this file */
+struct lwip_sock *
+lwip_socket_get_ext(int fd)
+{
+  return get_socket(fd);
+}
+
+void
+lwip_socket_done_ext(struct lwip_sock *sock)
+{
+  LWIP_UNUSED_ARG(sock);
+  done_socket(sock);
+}
+#endif /* ESP_LWIP */
+
 /**
  * Allocate a new socket for a given netconn.
  *
@@ -62,6 +62,9 @@
 #include "lwip/stats.h"
 #include "lwip/snmp.h"
 #include "lwip/dhcp.h"
+#if ESP_LWIP && LWIP_CHECKSUM_CTRL_PER_NETIF && LWIP_IPV6
+#include "lwip/nd6.h"
+#endif /* ESP_LWIP && LWIP_CHECKSUM_CTRL_PER_NETIF && LWIP_IPV6 */
 
 #include <string.h>
 
@@ -73,6 +76,28 @@
 #define UDP_ENSURE_LOCAL_PORT_RANGE(port) ((u16_t)(((port) & (u16_t)~UDP_LOCAL_PORT_RANGE_START) + UDP_LOCAL_PORT_RANGE_START))
 #endif
 
+#if ESP_LWIP && LWIP_CHECKSUM_CTRL_PER_NETIF && CHECKSUM_GEN_UDP
+/* Hardware checksum offload skips the datagrams fragmented by the IP layer,
+   so the checksum of those is generated in software on every netif. */
+static int
+udp_chksum_gen_needed(struct netif *netif, struct pbuf *p, const ip_addr_t *dst_ip)
+{
+  if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_UDP)) {
+    return 1;
+  }
+#if LWIP_IPV6
+  if (IP_IS_V6(dst_ip)) {
+    return netif_mtu6(netif) && (p->tot_len + IP6_HLEN > nd6_get_destination_mtu(ip_2_ip6(dst_ip), netif));
+  }
+#endif /* LWIP_IPV6 */
+  LWIP_UNUSED_ARG(dst_ip);
+  return netif->mtu && (p->tot_len + IP_HLEN > netif->mtu);
+}
+#define IF__UDP_CHKSUM_GEN(netif, p, dst_ip) if (udp_chksum_gen_needed(netif, p, dst_ip))
+#else /* ESP_LWIP && LWIP_CHECKSUM_CTRL_PER_NETIF && CHECKSUM_GEN_UDP */
+#define IF__UDP_CHKSUM_GEN(netif, p, dst_ip) IF__NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_UDP)
+#endif /* ESP_LWIP && LWIP_CHECKSUM_CTRL_PER_NETIF && CHECKSUM_GEN_UDP */
+
 /* last local UDP port */
 static u16_t udp_port = UDP_LOCAL_PORT_RANGE_START;
 
@@ -831,7 +856,7 @@ udp_sendto_if_src_chksum(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *d
     udphdr->len = lwip_htons(chklen_hdr);
     /* calculate checksum */
 #if CHECKSUM_GEN_UDP
-    IF__NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_UDP) {
+    IF__UDP_CHKSUM_GEN(netif, q, dst_ip) {
 #if LWIP_CHECKSUM_ON_COPY
       if (have_chksum) {
         chklen = UDP_HLEN;
@@ -862,7 +887,7 @@ udp_sendto_if_src_chksum(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *d
     udphdr->len = lwip_htons(q->tot_len);
     /* calculate checksum */
 #if CHECKSUM_GEN_UDP
-    IF__NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_UDP) {
+    IF__UDP_CHKSUM_GEN(netif, q, dst_ip) {
       /* Checksum is mandatory over IPv6. */
       if (IP_IS_V6(dst_ip) || (pcb->flags & UDP_FLAGS_NOCHKSUM) == 0) {
         u16_t udpchksum;
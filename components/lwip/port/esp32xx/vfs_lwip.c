@@ -16,6 +16,9 @@
 #include "sdkconfig.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
+#include "lwip/api.h"
+#include "lwip/priv/sockets_priv.h"
+#include "esp_vfs_pollset.h"
 
 #ifndef CONFIG_VFS_SUPPORT_IO
 #error This file should only be built when CONFIG_VFS_SUPPORT_IO=y
@@ -55,6 +58,105 @@ static void *lwip_get_socket_select_semaphore(void)
      */
     return (void *) sys_thread_sem_get();
 }
+
+/* Poll set watches of sockets, indexed by (fd - LWIP_SOCKET_OFFSET), protected by SYS_ARCH_PROTECT */
+static esp_vfs_pollset_watch_t *s_pollset_watch[CONFIG_LWIP_MAX_SOCKETS];
+/* lwip's socket event callback which is chained by lwip_pollset_event_callback */
+static netconn_callback s_socket_event_callback;
+
+static void lwip_pollset_event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len)
+{
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    s_socket_event_callback(conn, evt, len);
+
+    uint32_t events;
+    switch (evt) {
+    case NETCONN_EVT_RCVPLUS:
+        events = ESP_VFS_POLLSET_IN;
+        break;
+    case NETCONN_EVT_SENDPLUS:
+        events = ESP_VFS_POLLSET_OUT;
+        break;
+    case NETCONN_EVT_ERROR:
+        events = ESP_VFS_POLLSET_ERR;
+        break;
+    default:
+        return;
+    }
+
+    /* callback_arg.socket is negative until a new connection is accepted */
+    const int index = conn->callback_arg.socket - LWIP_SOCKET_OFFSET;
+    if (index < 0 || index >= CONFIG_LWIP_MAX_SOCKETS) {
+        return;
+    }
+
+    SYS_ARCH_PROTECT(lev);
+    if (s_pollset_watch[index] != NULL) {
+        esp_vfs_pollset_notify(s_pollset_watch[index], events);
+    }
+    SYS_ARCH_UNPROTECT(lev);
+}
+
+static esp_err_t lwip_pollset_watch(int fd, esp_vfs_pollset_watch_t *watch, bool enable, uint32_t *ready_events)
+{
+    SYS_ARCH_DECL_PROTECT(lev);
+    esp_err_t err = ESP_OK;
+
+    struct lwip_sock *sock = lwip_socket_dbg_get_socket(fd);
+    if (sock == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const int index = fd - LWIP_SOCKET_OFFSET;
+
+    SYS_ARCH_PROTECT(lev);
+    if (sock->conn == NULL) {
+        err = ESP_ERR_INVALID_ARG;
+    } else if (enable) {
+        if (s_pollset_watch[index] != NULL && s_pollset_watch[index] != watch) {
+            err = ESP_ERR_INVALID_STATE;
+        } else {
+            if (sock->conn->callback != lwip_pollset_event_callback) {
+                s_socket_event_callback = sock->conn->callback;
+                sock->conn->callback = lwip_pollset_event_callback;
+            }
+            s_pollset_watch[index] = watch;
+            /* same readiness evaluation as lwip_selscan() */
+            *ready_events = 0;
+            if (sock->lastdata.pbuf != NULL || sock->rcvevent > 0) {
+                *ready_events |= ESP_VFS_POLLSET_IN;
+            }
+            if (sock->sendevent != 0) {
+                *ready_events |= ESP_VFS_POLLSET_OUT;
+            }
+            if (sock->errevent != 0) {
+                *ready_events |= ESP_VFS_POLLSET_ERR;
+            }
+        }
+    } else if (s_pollset_watch[index] == watch) {
+        s_pollset_watch[index] = NULL;
+    }
+    SYS_ARCH_UNPROTECT(lev);
+
+    return err;
+}
+
+static int lwip_close_pollset(int fd)
+{
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if (fd >= LWIP_SOCKET_OFFSET && fd < LWIP_SOCKET_OFFSET + CONFIG_LWIP_MAX_SOCKETS) {
+        const int index = fd - LWIP_SOCKET_OFFSET;
+        SYS_ARCH_PROTECT(lev);
+        if (s_pollset_watch[index] != NULL) {
+            /* the poll set drops the watch on HUP */
+            esp_vfs_pollset_notify(s_pollset_watch[index], ESP_VFS_POLLSET_HUP);
+            s_pollset_watch[index] = NULL;
+        }
+        SYS_ARCH_UNPROTECT(lev);
+    }
+    return lwip_close(fd);
+}
 #else // CONFIG_VFS_SUPPORT_SELECT
 
 int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds, struct timeval *timeout)
@@ -93,7 +195,11 @@ void esp_vfs_lwip_sockets_register(void)
         .write = &lwip_write,
         .open = NULL,
         .fstat = &lwip_fstat,
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+        .close = &lwip_close_pollset,
+#else
         .close = &lwip_close,
+#endif
         .read = &lwip_read,
         .fcntl = &lwip_fcntl_r_wrapper,
         .ioctl = &lwip_ioctl_r_wrapper,
@@ -102,6 +208,7 @@ void esp_vfs_lwip_sockets_register(void)
         .get_socket_select_semaphore = &lwip_get_socket_select_semaphore,
         .stop_socket_select = &lwip_stop_socket_select,
         .stop_socket_select_isr = &lwip_stop_socket_select_isr,
+        .pollset_watch = &lwip_pollset_watch,
 #endif // CONFIG_VFS_SUPPORT_SELECT
     };
     /* Non-LWIP file descriptors are from 0 to (LWIP_SOCKET_OFFSET-1). LWIP
@@ -1216,6 +1216,25 @@ static inline uint32_t timeout_from_offered(uint32_t lease, uint32_t min)
 #define CHECKSUM_CHECK_ICMP             0
 #endif
 
+/**
+ * LWIP_CHECKSUM_CTRL_PER_NETIF==1: Checksum generation and check are skipped
+ * on the network interfaces which offload them (see NETIF_SET_CHECKSUM_CTRL).
+ */
+#ifdef CONFIG_LWIP_CHECKSUM_CTRL_PER_NETIF
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    1
+#else
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    0
+#endif
+
+/**
+ * LWIP_CHKSUM: Internet checksum of the software path, word-at-a-time
+ * implementation in port/inet_chksum_fast.c
+ */
+#ifdef CONFIG_LWIP_CHKSUM_OPTIMIZED
+#define LWIP_CHKSUM                     lwip_chksum_fast
+uint16_t lwip_chksum_fast(const void *dataptr, int len);
+#endif
+
 /*
    ---------------------------------------
    ---------- IPv6 options ---------------
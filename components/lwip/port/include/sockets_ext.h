@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -19,6 +19,10 @@ struct lwip_sock;
 
 bool lwip_setsockopt_impl_ext(struct lwip_sock* sock, int level, int optname, const void *optval, uint32_t optlen, int *err);
 bool lwip_getsockopt_impl_ext(struct lwip_sock* sock, int level, int optname, void *optval, uint32_t *optlen, int *err);
+
+/* Socket lookup with a reference for the extensions, released by lwip_socket_done_ext() (defined in sockets.c) */
+struct lwip_sock *lwip_socket_get_ext(int fd);
+void lwip_socket_done_ext(struct lwip_sock *sock);
 #ifdef __cplusplus
 }
 #endif
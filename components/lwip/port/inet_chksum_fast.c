@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include "lwip/opt.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/def.h"
+
+/* The words are loaded through this type, which may alias the packet bytes */
+typedef uint32_t __attribute__((__may_alias__)) chksum_word_t;
+
+#define CHKSUM_ADD_WORDS_4(sum, pw) do { \
+        (sum) += (uint64_t)(pw)[0] + (pw)[1] + (uint64_t)(pw)[2] + (pw)[3]; \
+    } while (0)
+
+/**
+ * @brief Internet checksum of the buffer, the same as lwip_standard_chksum(),
+ *        summing aligned 32-bit words into a 64-bit accumulator
+ *
+ * The 32 bytes of each loop iteration are added without carry handling,
+ * the carries collect in the upper half of the accumulator and are folded once at the end.
+ *
+ * @param dataptr start of the buffer, any alignment
+ * @param len length of the buffer
+ *
+ * @return host order (!) lwip checksum (non-inverted Internet sum)
+ */
+u16_t lwip_chksum_fast(const void *dataptr, int len)
+{
+    const u8_t *pb = (const u8_t *)dataptr;
+    u16_t t = 0;
+    uint64_t sum = 0;
+    int odd = ((mem_ptr_t)pb & 1);
+
+    /* Get aligned to u16_t */
+    if (odd && len > 0) {
+        ((u8_t *)&t)[1] = *pb++;
+        len--;
+    }
+    /* Get aligned to u32_t */
+    if (((mem_ptr_t)pb & 2) && len > 1) {
+        sum += *(const u16_t *)(const void *)pb;
+        pb += 2;
+        len -= 2;
+    }
+
+    const chksum_word_t *pw = (const chksum_word_t *)(const void *)pb;
+    while (len >= 32) {
+        CHKSUM_ADD_WORDS_4(sum, pw);
+        CHKSUM_ADD_WORDS_4(sum, pw + 4);
+        pw += 8;
+        len -= 32;
+    }
+    while (len >= 4) {
+        sum += *pw++;
+        len -= 4;
+    }
+
+    pb = (const u8_t *)pw;
+    if (len > 1) {
+        sum += *(const u16_t *)(const void *)pb;
+        pb += 2;
+        len -= 2;
+    }
+    /* Consume left-over byte, if any */
+    if (len > 0) {
+        ((u8_t *)&t)[0] = *pb;
+    }
+    sum += t;
+
+    /* Fold the 64-bit sum to 16 bits */
+    sum = (sum >> 32) + (sum & 0xffffffffUL);
+    sum = (sum >> 32) + (sum & 0xffffffffUL);
+    u32_t sum32 = (u32_t)sum;
+    sum32 = FOLD_U32T(sum32);
+    sum32 = FOLD_U32T(sum32);
+
+    /* Swap if alignment was odd */
+    if (odd) {
+        sum32 = SWAP_BYTES_IN_WORD(sum32);
+    }
+    return (u16_t)sum32;
+}
@@ -1,13 +1,16 @@
 /*
- * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include "lwip/sockets.h"
 #include "lwip/priv/sockets_priv.h"
+#include "lwip/priv/tcpip_priv.h"
 #include "lwip/api.h"
 #include "lwip/sys.h"
+#include "lwip/inet.h"
 #include "lwip/tcp.h"
 #include "lwip/raw.h"
 #include "lwip/udp.h"
@@ -106,3 +109,216 @@ exit:
     return true;
 #endif /* LWIP_IPV6 */
 }
+
+#if LWIP_UDP
+/* Datagrams of sendmmsg() passed to the tcpip thread at once */
+#define LWIP_SENDMMSG_BATCH 16
+
+struct lwip_mmsg_datagram {
+    struct pbuf *p;
+    ip_addr_t addr;
+    u16_t port;
+    u16_t len;  /* payload length, tot_len of p grows by the headers when it is sent in place */
+};
+
+struct lwip_sendmmsg_call {
+    struct tcpip_api_call_data call;
+    struct netconn *conn;
+    unsigned int count;
+    unsigned int sent;
+    struct lwip_mmsg_datagram datagrams[LWIP_SENDMMSG_BATCH];
+};
+
+/* Converts the destination of a message, the same way as lwip_sendmsg() */
+static int lwip_mmsg_dest(const struct msghdr *msg, ip_addr_t *addr, u16_t *port)
+{
+    const struct sockaddr *to = msg->msg_name;
+    if (to == NULL) {
+        if (msg->msg_namelen != 0) {
+            return err_to_errno(ERR_ARG);
+        }
+        /* connected socket */
+        ip_addr_set_zero(addr);
+        *port = 0;
+        return 0;
+    }
+#if LWIP_IPV4
+    if (to->sa_family == AF_INET && msg->msg_namelen == sizeof(struct sockaddr_in)) {
+        const struct sockaddr_in *sin = msg->msg_name;
+        inet_addr_to_ip4addr(ip_2_ip4(addr), &sin->sin_addr);
+        IP_SET_TYPE_VAL(*addr, IPADDR_TYPE_V4);
+        *port = lwip_ntohs(sin->sin_port);
+        return 0;
+    }
+#endif /* LWIP_IPV4 */
+#if LWIP_IPV6
+    if (to->sa_family == AF_INET6 && msg->msg_namelen == sizeof(struct sockaddr_in6)) {
+        const struct sockaddr_in6 *sin6 = msg->msg_name;
+        inet6_addr_to_ip6addr(ip_2_ip6(addr), &sin6->sin6_addr);
+        if (ip6_addr_has_scope(ip_2_ip6(addr), IP6_UNKNOWN)) {
+            ip6_addr_set_zone(ip_2_ip6(addr), (u8_t)sin6->sin6_scope_id);
+        }
+        IP_SET_TYPE_VAL(*addr, IPADDR_TYPE_V6);
+        *port = lwip_ntohs(sin6->sin6_port);
+#if LWIP_IPV4
+        /* Dual-stack: Unmap IPv4 mapped IPv6 addresses */
+        if (ip6_addr_isipv4mappedipv6(ip_2_ip6(addr))) {
+            unmap_ipv4_mapped_ipv6(ip_2_ip4(addr), ip_2_ip6(addr));
+            IP_SET_TYPE_VAL(*addr, IPADDR_TYPE_V4);
+        }
+#endif /* LWIP_IPV4 */
+        return 0;
+    }
+#endif /* LWIP_IPV6 */
+    return err_to_errno(ERR_ARG);
+}
+
+/* Copies a message to a single pbuf, as lwip_sendmsg() does with LWIP_NETIF_TX_SINGLE_PBUF */
+static int lwip_mmsg_prepare(const struct msghdr *msg, struct lwip_mmsg_datagram *datagram)
+{
+    size_t size = 0;
+    if (msg->msg_iovlen <= 0 || msg->msg_iovlen > IOV_MAX || msg->msg_iov == NULL) {
+        return err_to_errno(ERR_ARG);
+    }
+    for (msg_iovlen_t i = 0; i < msg->msg_iovlen; i++) {
+        size += msg->msg_iov[i].iov_len;
+        if (msg->msg_iov[i].iov_len > 0xFFFF || size > 0xFFFF) {
+            return EMSGSIZE;
+        }
+    }
+    int err = lwip_mmsg_dest(msg, &datagram->addr, &datagram->port);
+    if (err != 0) {
+        return err;
+    }
+    datagram->p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)size, PBUF_RAM);
+    if (datagram->p == NULL) {
+        return err_to_errno(ERR_MEM);
+    }
+    datagram->len = (u16_t)size;
+    size_t offset = 0;
+    for (msg_iovlen_t i = 0; i < msg->msg_iovlen; i++) {
+        MEMCPY((u8_t *)datagram->p->payload + offset, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+        offset += msg->msg_iov[i].iov_len;
+    }
+    return 0;
+}
+
+/* Sends the datagrams until the first error, in the tcpip thread (like lwip_netconn_do_send()) */
+static err_t lwip_sendmmsg_tcpip(struct tcpip_api_call_data *call)
+{
+    struct lwip_sendmmsg_call *msg = (struct lwip_sendmmsg_call *)call;
+    err_t err = netconn_err(msg->conn);
+    while (err == ERR_OK && msg->sent < msg->count) {
+        struct udp_pcb *pcb = msg->conn->pcb.udp;
+        struct lwip_mmsg_datagram *datagram = &msg->datagrams[msg->sent];
+        if (pcb == NULL) {
+            err = ERR_CONN;
+        } else if (ip_addr_isany_val(datagram->addr) || IP_IS_ANY_TYPE_VAL(datagram->addr)) {
+            err = udp_send(pcb, datagram->p);
+        } else {
+            err = udp_sendto(pcb, datagram->p, &datagram->addr, datagram->port);
+        }
+        if (err == ERR_OK) {
+            msg->sent++;
+        }
+    }
+    return err;
+}
+
+static int lwip_sendmmsg_udp(struct lwip_sock *sock, struct mmsghdr *msgvec, unsigned int vlen)
+{
+    unsigned int sent = 0;
+    int err = 0;
+    while (sent < vlen && err == 0) {
+        struct lwip_sendmmsg_call msg = { .conn = sock->conn };
+        while (msg.count < LWIP_SENDMMSG_BATCH && sent + msg.count < vlen) {
+            err = lwip_mmsg_prepare(&msgvec[sent + msg.count].msg_hdr, &msg.datagrams[msg.count]);
+            if (err != 0) {
+                break;
+            }
+            msg.count++;
+        }
+        if (msg.count > 0) {
+            err_t send_err = tcpip_api_call(lwip_sendmmsg_tcpip, &msg.call);
+            for (unsigned int i = 0; i < msg.count; i++) {
+                if (i < msg.sent) {
+                    msgvec[sent + i].msg_len = msg.datagrams[i].len;
+                }
+                pbuf_free(msg.datagrams[i].p);
+            }
+            sent += msg.sent;
+            if (send_err != ERR_OK) {
+                err = err_to_errno(send_err);
+            }
+        }
+    }
+    if (sent == 0 && err != 0) {
+        set_errno(err);
+        return -1;
+    }
+    return (int)sent;
+}
+#endif /* LWIP_UDP */
+
+int lwip_sendmmsg(int s, struct mmsghdr *msgvec, unsigned int vlen, int flags)
+{
+    if (msgvec == NULL && vlen > 0) {
+        set_errno(EFAULT);
+        return -1;
+    }
+    /* the flags of lwip_sendmsg(), UDP sends don't block and ignore MSG_MORE */
+    if ((flags & ~(MSG_DONTWAIT | MSG_MORE)) != 0) {
+        set_errno(EOPNOTSUPP);
+        return -1;
+    }
+    struct lwip_sock *sock = lwip_socket_get_ext(s);
+    if (sock == NULL) {
+        return -1;
+    }
+#if LWIP_UDP
+    if (NETCONNTYPE_GROUP(netconn_type(sock->conn)) == NETCONN_UDP) {
+        int ret = lwip_sendmmsg_udp(sock, msgvec, vlen);
+        lwip_socket_done_ext(sock);
+        return ret;
+    }
+#endif /* LWIP_UDP */
+    lwip_socket_done_ext(sock);
+
+    /* one message at a time for the other sockets */
+    unsigned int sent;
+    for (sent = 0; sent < vlen; sent++) {
+        ssize_t len = lwip_sendmsg(s, &msgvec[sent].msg_hdr, flags);
+        if (len < 0) {
+            return sent > 0 ? (int)sent : -1;
+        }
+        msgvec[sent].msg_len = (unsigned int)len;
+    }
+    return (int)sent;
+}
+
+int lwip_recvmmsg(int s, struct mmsghdr *msgvec, unsigned int vlen, int flags, struct timeval *timeout)
+{
+    if (msgvec == NULL && vlen > 0) {
+        set_errno(EFAULT);
+        return -1;
+    }
+    /* the datagrams are already queued in the receive mailbox of the socket, receiving them needs no tcpip call */
+    u32_t start = sys_now();
+    int recv_flags = flags & ~MSG_WAITFORONE;
+    unsigned int received;
+    for (received = 0; received < vlen; received++) {
+        ssize_t len = lwip_recvmsg(s, &msgvec[received].msg_hdr, recv_flags);
+        if (len < 0) {
+            break;
+        }
+        msgvec[received].msg_len = (unsigned int)len;
+        if (flags & MSG_WAITFORONE) {
+            recv_flags |= MSG_DONTWAIT;
+        }
+        if (timeout && (sys_now() - start) >= (u32_t)(timeout->tv_sec * 1000 + timeout->tv_usec / 1000)) {
+            received++;
+            break;
+        }
+    }
+    return received > 0 ? (int)received : -1;
+}
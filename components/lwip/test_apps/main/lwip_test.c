@@ -1,10 +1,12 @@
 /*
- * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 #include <stdio.h>
 #include <string.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <esp_types.h>
 
 #include "freertos/FreeRTOS.h"
@@ -14,12 +16,14 @@
 #include "unity_fixture.h"
 
 #include "soc/soc_caps.h"
+#include "esp_cpu.h"
 
 #include "lwip/inet.h"
 #include "lwip/netdb.h"
 #include "lwip/sockets.h"
 #include "lwip/tcpip.h"
 #include "lwip/prot/iana.h"
+#include "lwip/inet_chksum.h"
 #include "ping/ping_sock.h"
 #include "dhcpserver/dhcpserver.h"
 #include "dhcpserver/dhcpserver_options.h"
@@ -319,6 +323,214 @@ TEST(lwip, sntp_client_time_2048)
     test_sntp_timestamps(2048, false); // NTP timestamp MSB is cleared for time after 2036
 }
 
+#define MMSG_TEST_DATAGRAMS 40
+#define MMSG_TEST_BATCH 5
+
+TEST(lwip, sendmmsg_recvmmsg_localhost)
+{
+    test_case_uses_tcpip();
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(5001),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, rx);
+    TEST_ASSERT_EQUAL(0, bind(rx, (struct sockaddr *)&addr, sizeof(addr)));
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, tx);
+
+    // datagrams of different lengths, split into two io vectors
+    static uint8_t payload[MMSG_TEST_DATAGRAMS][MMSG_TEST_DATAGRAMS + 2];
+    struct iovec iov[MMSG_TEST_DATAGRAMS][2];
+    struct mmsghdr msgs[MMSG_TEST_DATAGRAMS] = { 0 };
+    for (int i = 0; i < MMSG_TEST_DATAGRAMS; i++) {
+        memset(payload[i], i, sizeof(payload[i]));
+        iov[i][0] = (struct iovec) { .iov_base = payload[i], .iov_len = 2 };
+        iov[i][1] = (struct iovec) { .iov_base = payload[i] + 2, .iov_len = i };
+        msgs[i].msg_hdr = (struct msghdr) { .msg_name = &addr, .msg_namelen = sizeof(addr), .msg_iov = iov[i], .msg_iovlen = 2 };
+    }
+    // the loopback queue and the receive mailbox hold a few datagrams, send and receive in rounds
+    for (int first = 0; first < MMSG_TEST_DATAGRAMS; first += MMSG_TEST_BATCH) {
+        TEST_ASSERT_EQUAL(MMSG_TEST_BATCH, sendmmsg(tx, &msgs[first], MMSG_TEST_BATCH, 0));
+        for (int i = first; i < first + MMSG_TEST_BATCH; i++) {
+            TEST_ASSERT_EQUAL(i + 2, msgs[i].msg_len);
+        }
+        uint8_t buffers[MMSG_TEST_BATCH][MMSG_TEST_DATAGRAMS + 2];
+        struct iovec rx_iov[MMSG_TEST_BATCH];
+        struct mmsghdr rx_msgs[MMSG_TEST_BATCH] = { 0 };
+        for (int i = 0; i < MMSG_TEST_BATCH; i++) {
+            rx_iov[i] = (struct iovec) { .iov_base = buffers[i], .iov_len = sizeof(buffers[i]) };
+            rx_msgs[i].msg_hdr = (struct msghdr) { .msg_iov = &rx_iov[i], .msg_iovlen = 1 };
+        }
+        int received = 0;
+        while (received < MMSG_TEST_BATCH) {
+            int ret = recvmmsg(rx, &rx_msgs[received], MMSG_TEST_BATCH - received, MSG_WAITFORONE, NULL);
+            TEST_ASSERT_GREATER_THAN(0, ret);
+            received += ret;
+        }
+        for (int i = 0; i < MMSG_TEST_BATCH; i++) {
+            TEST_ASSERT_EQUAL(first + i + 2, rx_msgs[i].msg_len);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(payload[first + i], buffers[i], rx_msgs[i].msg_len);
+        }
+    }
+    // nothing left, so a non-blocking receive fails
+    struct mmsghdr empty = { 0 };
+    uint8_t byte;
+    struct iovec empty_iov = { .iov_base = &byte, .iov_len = 1 };
+    empty.msg_hdr = (struct msghdr) { .msg_iov = &empty_iov, .msg_iovlen = 1 };
+    TEST_ASSERT_EQUAL(-1, recvmmsg(rx, &empty, 1, MSG_DONTWAIT, NULL));
+    TEST_ASSERT_EQUAL(EAGAIN, errno);
+    // an invalid destination fails the first datagram
+    msgs[0].msg_hdr.msg_namelen = 1;
+    TEST_ASSERT_EQUAL(-1, sendmmsg(tx, msgs, 1, 0));
+    close(tx);
+    close(rx);
+}
+
+TEST(lwip, sendmmsg_partial_and_flags)
+{
+    test_case_uses_tcpip();
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(5002),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, rx);
+    TEST_ASSERT_EQUAL(0, bind(rx, (struct sockaddr *)&addr, sizeof(addr)));
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, tx);
+
+    static uint8_t payload[MMSG_TEST_BATCH][MMSG_TEST_BATCH + 1];
+    struct iovec iov[MMSG_TEST_BATCH];
+    struct mmsghdr msgs[MMSG_TEST_BATCH] = { 0 };
+    for (int i = 0; i < MMSG_TEST_BATCH; i++) {
+        memset(payload[i], i, sizeof(payload[i]));
+        iov[i] = (struct iovec) { .iov_base = payload[i], .iov_len = i + 1 };
+        msgs[i].msg_hdr = (struct msghdr) { .msg_name = &addr, .msg_namelen = sizeof(addr), .msg_iov = &iov[i], .msg_iovlen = 1 };
+        msgs[i].msg_len = UINT_MAX;
+    }
+    // unsupported flags fail before sending anything
+    TEST_ASSERT_EQUAL(-1, sendmmsg(tx, msgs, MMSG_TEST_BATCH, MSG_OOB));
+    TEST_ASSERT_EQUAL(EOPNOTSUPP, errno);
+    TEST_ASSERT_EQUAL(-1, sendmmsg(tx, msgs, MMSG_TEST_BATCH, MSG_PEEK));
+    TEST_ASSERT_EQUAL(EOPNOTSUPP, errno);
+    for (int i = 0; i < MMSG_TEST_BATCH; i++) {
+        TEST_ASSERT_EQUAL(UINT_MAX, msgs[i].msg_len);
+    }
+
+    // the invalid destination of the fourth datagram stops the send, msg_len is set for the sent ones only
+    const int valid = 3;
+    msgs[valid].msg_hdr.msg_namelen = 1;
+    TEST_ASSERT_EQUAL(valid, sendmmsg(tx, msgs, MMSG_TEST_BATCH, MSG_DONTWAIT));
+    for (int i = 0; i < MMSG_TEST_BATCH; i++) {
+        TEST_ASSERT_EQUAL(i < valid ? i + 1 : UINT_MAX, msgs[i].msg_len);
+    }
+
+    uint8_t buffers[MMSG_TEST_BATCH][MMSG_TEST_BATCH + 1];
+    struct iovec rx_iov[MMSG_TEST_BATCH];
+    struct mmsghdr rx_msgs[MMSG_TEST_BATCH] = { 0 };
+    for (int i = 0; i < MMSG_TEST_BATCH; i++) {
+        rx_iov[i] = (struct iovec) { .iov_base = buffers[i], .iov_len = sizeof(buffers[i]) };
+        rx_msgs[i].msg_hdr = (struct msghdr) { .msg_iov = &rx_iov[i], .msg_iovlen = 1 };
+    }
+    int received = 0;
+    while (received < valid) {
+        int ret = recvmmsg(rx, &rx_msgs[received], valid - received, MSG_WAITFORONE, NULL);
+        TEST_ASSERT_GREATER_THAN(0, ret);
+        received += ret;
+    }
+    for (int i = 0; i < valid; i++) {
+        TEST_ASSERT_EQUAL(i + 1, rx_msgs[i].msg_len);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(payload[i], buffers[i], rx_msgs[i].msg_len);
+    }
+    // the datagrams after the failed one were not sent
+    TEST_ASSERT_EQUAL(-1, recvmmsg(rx, &rx_msgs[0], 1, MSG_DONTWAIT, NULL));
+    TEST_ASSERT_EQUAL(EAGAIN, errno);
+
+    // sending the rest, MSG_MORE is accepted and ignored for UDP
+    msgs[valid].msg_hdr.msg_namelen = sizeof(addr);
+    TEST_ASSERT_EQUAL(MMSG_TEST_BATCH - valid, sendmmsg(tx, &msgs[valid], MMSG_TEST_BATCH - valid, MSG_MORE));
+    for (int i = valid; i < MMSG_TEST_BATCH; i++) {
+        TEST_ASSERT_EQUAL(i + 1, msgs[i].msg_len);
+    }
+    received = 0;
+    while (received < MMSG_TEST_BATCH - valid) {
+        int ret = recvmmsg(rx, &rx_msgs[received], MMSG_TEST_BATCH - valid - received, MSG_WAITFORONE, NULL);
+        TEST_ASSERT_GREATER_THAN(0, ret);
+        received += ret;
+    }
+    for (int i = 0; i < MMSG_TEST_BATCH - valid; i++) {
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(payload[valid + i], buffers[i], rx_msgs[i].msg_len);
+    }
+    close(tx);
+    close(rx);
+}
+
+#if CONFIG_LWIP_CHKSUM_OPTIMIZED
+/* the generic lwIP routine (LWIP_CHKSUM_ALGORITHM 2), replaced by lwip_chksum_fast() in this configuration */
+static u16_t test_standard_chksum(const void *dataptr, int len)
+{
+    const u8_t *pb = (const u8_t *)dataptr;
+    u16_t t = 0;
+    u32_t sum = 0;
+    int odd = ((mem_ptr_t)pb & 1);
+
+    if (odd && len > 0) {
+        ((u8_t *)&t)[1] = *pb++;
+        len--;
+    }
+    const u16_t *ps = (const u16_t *)(const void *)pb;
+    while (len > 1) {
+        sum += *ps++;
+        len -= 2;
+    }
+    if (len > 0) {
+        ((u8_t *)&t)[0] = *(const u8_t *)ps;
+    }
+    sum += t;
+    sum = FOLD_U32T(sum);
+    sum = FOLD_U32T(sum);
+    if (odd) {
+        sum = SWAP_BYTES_IN_WORD(sum);
+    }
+    return (u16_t)sum;
+}
+
+TEST(lwip, chksum_fast)
+{
+    // RFC 1071 example, sums to 0xddf2 in network byte order
+    const uint8_t rfc1071[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+    TEST_ASSERT_EQUAL_HEX16(PP_HTONS(0xddf2), LWIP_CHKSUM(rfc1071, sizeof(rfc1071)));
+
+    // every alignment and the lengths around the 32 bytes of the unrolled loop, random and all-ones data
+    static uint8_t buffer[1600];
+    for (int pattern = 0; pattern < 2; pattern++) {
+        for (int i = 0; i < sizeof(buffer); i++) {
+            buffer[i] = pattern ? 0xff : (uint8_t)esp_random();
+        }
+        for (int offset = 0; offset < 8; offset++) {
+            for (int len = 0; len < 100; len++) {
+                TEST_ASSERT_EQUAL_HEX16(test_standard_chksum(buffer + offset, len), LWIP_CHKSUM(buffer + offset, len));
+            }
+            int len = sizeof(buffer) - offset;
+            TEST_ASSERT_EQUAL_HEX16(test_standard_chksum(buffer + offset, len), LWIP_CHKSUM(buffer + offset, len));
+        }
+    }
+
+    // checksum of a full-size TCP segment
+    uint32_t start = esp_cpu_get_cycle_count();
+    volatile u16_t sum = test_standard_chksum(buffer, 1460);
+    uint32_t standard_cycles = esp_cpu_get_cycle_count() - start;
+    start = esp_cpu_get_cycle_count();
+    sum = LWIP_CHKSUM(buffer, 1460);
+    uint32_t fast_cycles = esp_cpu_get_cycle_count() - start;
+    (void)sum;
+    printf("checksum of 1460 bytes: %" PRIu32 " cycles, generic routine %" PRIu32 " cycles\n", fast_cycles, standard_cycles);
+}
+#endif // CONFIG_LWIP_CHKSUM_OPTIMIZED
+
 TEST_GROUP_RUNNER(lwip)
 {
     RUN_TEST_CASE(lwip, localhost_ping_test)
@@ -326,6 +538,11 @@ TEST_GROUP_RUNNER(lwip)
     RUN_TEST_CASE(lwip, dhcp_server_start_stop_localhost)
     RUN_TEST_CASE(lwip, sntp_client_time_2015)
     RUN_TEST_CASE(lwip, sntp_client_time_2048)
+    RUN_TEST_CASE(lwip, sendmmsg_recvmmsg_localhost)
+    RUN_TEST_CASE(lwip, sendmmsg_partial_and_flags)
+#if CONFIG_LWIP_CHKSUM_OPTIMIZED
+    RUN_TEST_CASE(lwip, chksum_fast)
+#endif
 }
 
 void app_main(void)
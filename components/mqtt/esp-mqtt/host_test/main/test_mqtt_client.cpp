@@ -3,11 +3,17 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <net/if.h>
 #include <random>
 #include <string_view>
 #include <type_traits>
+#include <vector>
 #include "esp_transport.h"
 #include <catch2/catch_test_macros.hpp>
 
@@ -15,6 +21,7 @@
 extern "C" {
 #include "Mockesp_event.h"
 #include "Mockesp_mac.h"
+#include "Mockesp_tls.h"
 #include "Mockesp_transport.h"
 #include "Mockesp_transport_ssl.h"
 #include "Mockesp_transport_tcp.h"
@@ -28,6 +35,15 @@ extern "C" {
 #include "Mockidf_additions.h"
 #endif
 #include "Mockesp_timer.h"
+#include "Mockesp_random.h"
+#include "mqtt_msg.h"
+
+    /* Provided by the address sanitizer the tests are built with */
+    int __sanitizer_install_malloc_and_free_hooks(void (*malloc_hook)(const volatile void *, size_t),
+            void (*free_hook)(const volatile void *));
+
+    void test_mqtt_client_set_connected(esp_mqtt_client_handle_t client);
+    esp_err_t test_mqtt_client_receive_puback(esp_mqtt_client_handle_t client, int msg_id);
 
     /*
      * The following functions are not directly called but the generation of them
@@ -48,6 +64,109 @@ auto random_string(std::size_t n)
     return str;
 }
 
+namespace {
+
+/*
+ * Stands in for the broker on the other side of the mocked transport: parses the publish messages written by the
+ * client, and keeps the ids of the messages to acknowledge.
+ */
+struct broker_stand_in {
+    // Overhead of a TLS record with AES-GCM, and of the TCP/IPv4 headers of a segment
+    static constexpr size_t tls_record_overhead = 5 + 8 + 16;
+    static constexpr size_t tcp_segment_overhead = 40;
+    static constexpr size_t mss = 1460;
+
+    std::vector<uint8_t> stream;
+    std::vector<int> msg_ids_to_ack;
+    size_t publish_count = 0;
+    size_t payload_bytes = 0;
+    size_t errors = 0;
+    size_t writes = 0;
+    size_t wire_bytes = 0;  /*!< Bytes on the wire if each write was a TLS record sent immediately */
+
+    explicit broker_stand_in(size_t max_messages)
+    {
+        // No allocations while the client is measured
+        stream.reserve(4096);
+        msg_ids_to_ack.reserve(max_messages);
+    }
+
+    void receive(const char *buffer, int len)
+    {
+        writes++;
+        size_t record_len = len + tls_record_overhead;
+        wire_bytes += record_len + (record_len + mss - 1) / mss * tcp_segment_overhead;
+        stream.insert(stream.end(), buffer, buffer + len);
+        size_t start = 0, message_len;
+        while ((message_len = parse(start)) > 0) {
+            start += message_len;
+        }
+        stream.erase(stream.begin(), stream.begin() + start);
+    }
+
+    /* Parses the message at the start of the stream, returns its length or 0 if it is not complete */
+    size_t parse(size_t start)
+    {
+        const uint8_t *message = stream.data() + start;
+        size_t available = stream.size() - start;
+        size_t remaining_len = 0;
+        size_t header_len = 1;
+        for (int shift = 0; ; shift += 7) {
+            if (header_len >= available) {
+                return 0;
+            }
+            remaining_len |= (message[header_len] & 0x7f) << shift;
+            if ((message[header_len++] & 0x80) == 0) {
+                break;
+            }
+        }
+        if (available < header_len + remaining_len) {
+            return 0;
+        }
+        if ((message[0] >> 4) != MQTT_MSG_TYPE_PUBLISH) {
+            errors++;
+        }
+        int qos = (message[0] >> 1) & 3;
+        size_t offset = header_len + 2 + (message[header_len] << 8 | message[header_len + 1]);
+        if (qos > 0) {
+            msg_ids_to_ack.push_back(message[offset] << 8 | message[offset + 1]);
+            offset += 2;
+        }
+        publish_count++;
+        payload_bytes += header_len + remaining_len - offset;
+        return header_len + remaining_len;
+    }
+};
+
+broker_stand_in *s_broker;
+
+int broker_receive(esp_transport_handle_t transport, const char *buffer, int len, int timeout_ms, int num_calls)
+{
+    s_broker->receive(buffer, len);
+    return len;
+}
+
+int failing_write(esp_transport_handle_t transport, const char *buffer, int len, int timeout_ms, int num_calls)
+{
+    return -1;
+}
+
+bool s_count_allocations;
+size_t s_allocation_count;
+
+void count_allocation(const volatile void *ptr, size_t size)
+{
+    if (s_count_allocations) {
+        s_allocation_count++;
+    }
+}
+
+void count_free(const volatile void *ptr)
+{
+}
+
+} // namespace
+
 using unique_mqtt_client = std::unique_ptr < std::remove_pointer_t<esp_mqtt_client_handle_t>, decltype([](esp_mqtt_client_handle_t client)
 {
     esp_mqtt_client_destroy(client);
@@ -131,6 +250,184 @@ SCENARIO("MQTT Client Operation")
                 // Only need to start the client, destroy is called automatically at the end of
                 // scope
             }
+            SECTION("Zero copy publish to a broker stand-in") {
+                static bool hooks_installed = false;
+                if (!hooks_installed) {
+                    REQUIRE(__sanitizer_install_malloc_and_free_hooks(count_allocation, count_free) != 0);
+                    hooks_installed = true;
+                }
+                test_mqtt_client_set_connected(client.get());
+                // Each message is acknowledged before the next one is published, they can all use the same id
+                esp_random_IgnoreAndReturn(1);
+                const int count = 1000;
+                const size_t len = 1024;
+                std::vector<char *> payloads(count);
+                for (char *&payload : payloads) {
+                    payload = static_cast<char *>(malloc(len));
+                    REQUIRE(payload != nullptr);
+                    memset(payload, 'x', len);
+                }
+
+                for (int qos : {0, 1}) {
+                    size_t allocations[2];
+                    for (bool zero_copy : {false, true}) {
+                        broker_stand_in broker(count);
+                        s_broker = &broker;
+                        esp_transport_write_Stub(broker_receive);
+                        s_allocation_count = 0;
+                        s_count_allocations = true;
+                        auto start = std::chrono::steady_clock::now();
+                        int failures = 0;
+                        for (int i = 0; i < count; i++) {
+                            int msg_id = zero_copy ?
+                                         esp_mqtt_client_publish_zero_copy(client.get(), "/topic", payloads[i], len, qos, 0) :
+                                         esp_mqtt_client_publish(client.get(), "/topic", payloads[i], len, qos, 0);
+                            failures += msg_id < 0;
+                            for (int ack : broker.msg_ids_to_ack) {
+                                failures += test_mqtt_client_receive_puback(client.get(), ack) != ESP_OK;
+                            }
+                            broker.msg_ids_to_ack.clear();
+                        }
+                        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                        s_count_allocations = false;
+                        s_broker = nullptr;
+                        CHECK(failures == 0);
+                        CHECK(broker.errors == 0);
+                        CHECK(broker.publish_count == static_cast<size_t>(count));
+                        CHECK(broker.payload_bytes == count * len);
+                        CHECK(esp_mqtt_client_get_outbox_size(client.get()) == 0);
+                        allocations[zero_copy] = s_allocation_count;
+                        printf("%s QoS%d: %lld messages/s, %.2f allocations per message\n",
+                               zero_copy ? "esp_mqtt_client_publish_zero_copy" : "esp_mqtt_client_publish", qos,
+                               static_cast<long long>(count * 1000000LL / std::max<long long>(elapsed.count(), 1)),
+                               static_cast<double>(s_allocation_count) / count);
+                    }
+                    // The payloads handed over to the client are freed by it
+                    if (qos == 0) {
+                        for (char *&payload : payloads) {
+                            payload = static_cast<char *>(malloc(len));
+                            REQUIRE(payload != nullptr);
+                            memset(payload, 'x', len);
+                        }
+                    }
+                    CHECK(allocations[true] <= allocations[false]);
+                }
+                esp_transport_write_Stub(nullptr);
+            }
+            SECTION("Batched publish to a broker stand-in") {
+                test_mqtt_client_set_connected(client.get());
+                esp_random_IgnoreAndReturn(1);
+                const int count = 1000;
+                // Small sensor readings, published in bursts
+                const size_t len = 32;
+                char payload[len];
+                memset(payload, 'x', len);
+                for (int qos : {0, 1}) {
+                    // The batch and its TLS record overhead fit in a TCP segment
+                    for (int batch_size : {0, 1400}) {
+                        config.buffer.batch_size = batch_size;
+                        // Only written once full or flushed
+                        config.buffer.batch_timeout_ms = 60 * 1000;
+                        http_parser_parse_url_ExpectAnyArgsAndReturn(0);
+                        http_parser_parse_url_ReturnThruPtr_u(&ret_uri);
+                        REQUIRE(esp_mqtt_set_config(client.get(), &config) == ESP_OK);
+
+                        broker_stand_in broker(count);
+                        s_broker = &broker;
+                        esp_transport_write_Stub(broker_receive);
+                        auto start = std::chrono::steady_clock::now();
+                        int failures = 0;
+                        for (int i = 0; i < count; i++) {
+                            failures += esp_mqtt_client_publish(client.get(), "sensors/1/temperature", payload, len, qos, 0) < 0;
+                            for (int ack : broker.msg_ids_to_ack) {
+                                failures += test_mqtt_client_receive_puback(client.get(), ack) != ESP_OK;
+                            }
+                            broker.msg_ids_to_ack.clear();
+                        }
+                        CHECK((batch_size == 0 || broker.publish_count < static_cast<size_t>(count)));
+                        REQUIRE(esp_mqtt_client_flush(client.get()) == ESP_OK);
+                        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                        for (int ack : broker.msg_ids_to_ack) {
+                            failures += test_mqtt_client_receive_puback(client.get(), ack) != ESP_OK;
+                        }
+                        s_broker = nullptr;
+                        CHECK(failures == 0);
+                        CHECK(broker.errors == 0);
+                        CHECK(broker.publish_count == static_cast<size_t>(count));
+                        CHECK(broker.payload_bytes == count * len);
+                        CHECK(esp_mqtt_client_get_outbox_size(client.get()) == 0);
+                        if (batch_size > 0) {
+                            CHECK(broker.writes < static_cast<size_t>(count) / 10);
+                        } else {
+                            CHECK(broker.writes >= static_cast<size_t>(count));
+                        }
+                        printf("QoS%d batch size %d: %.3f transport writes (TLS records) per message, "
+                               "%.1f bytes on the wire per message, %lld ns per message\n", qos, batch_size,
+                               static_cast<double>(broker.writes) / count, static_cast<double>(broker.wire_bytes) / count,
+                               static_cast<long long>(elapsed.count() / count));
+                    }
+                }
+                esp_transport_write_Stub(nullptr);
+            }
+            SECTION("Changing the batch size writes out the batched messages") {
+                test_mqtt_client_set_connected(client.get());
+                esp_random_IgnoreAndReturn(1);
+                const size_t len = 32;
+                char payload[len];
+                memset(payload, 'x', len);
+                broker_stand_in broker(4);
+                s_broker = &broker;
+                esp_transport_write_Stub(broker_receive);
+
+                config.buffer.batch_size = 1400;
+                config.buffer.batch_timeout_ms = 60 * 1000;
+                http_parser_parse_url_ExpectAnyArgsAndReturn(0);
+                http_parser_parse_url_ReturnThruPtr_u(&ret_uri);
+                REQUIRE(esp_mqtt_set_config(client.get(), &config) == ESP_OK);
+                REQUIRE(esp_mqtt_client_publish(client.get(), "sensors/1/temperature", payload, len, 0, 0) >= 0);
+                CHECK(broker.writes == 0);
+
+                // Batch size 0 disables batching
+                config.buffer.batch_size = 0;
+                http_parser_parse_url_ExpectAnyArgsAndReturn(0);
+                http_parser_parse_url_ReturnThruPtr_u(&ret_uri);
+                REQUIRE(esp_mqtt_set_config(client.get(), &config) == ESP_OK);
+                CHECK(broker.publish_count == 1);
+                REQUIRE(esp_mqtt_client_publish(client.get(), "sensors/1/temperature", payload, len, 0, 0) >= 0);
+                CHECK(broker.publish_count == 2);
+
+                // A failure to write out the batched messages is reported, and aborts the connection
+                config.buffer.batch_size = 1400;
+                http_parser_parse_url_ExpectAnyArgsAndReturn(0);
+                http_parser_parse_url_ReturnThruPtr_u(&ret_uri);
+                REQUIRE(esp_mqtt_set_config(client.get(), &config) == ESP_OK);
+                REQUIRE(esp_mqtt_client_publish(client.get(), "sensors/1/temperature", payload, len, 0, 0) >= 0);
+                esp_transport_write_Stub(failing_write);
+                esp_transport_close_IgnoreAndReturn(0);
+                esp_transport_get_error_handle_IgnoreAndReturn(nullptr);
+                esp_tls_get_and_clear_last_error_IgnoreAndReturn(ESP_OK);
+                esp_transport_get_errno_IgnoreAndReturn(0);
+                esp_event_post_to_IgnoreAndReturn(ESP_OK);
+                esp_event_loop_run_IgnoreAndReturn(ESP_OK);
+                config.buffer.batch_size = 0;
+                http_parser_parse_url_ExpectAnyArgsAndReturn(0);
+                http_parser_parse_url_ReturnThruPtr_u(&ret_uri);
+                CHECK(esp_mqtt_set_config(client.get(), &config) == ESP_FAIL);
+                s_broker = nullptr;
+                esp_transport_write_Stub(nullptr);
+            }
+            SECTION("User registers topic handlers") {
+                auto handler = [](esp_mqtt_event_handle_t event, void *arg) {};
+                int arg = 0;
+                REQUIRE(esp_mqtt_client_unregister_topic_handler(client.get(), "a/b", handler, &arg) == ESP_ERR_NOT_FOUND);
+                REQUIRE(esp_mqtt_client_register_topic_handler(client.get(), "a/+", handler, &arg) == ESP_OK);
+                REQUIRE(esp_mqtt_client_register_topic_handler(client.get(), "$share/group/a/#", handler, &arg) == ESP_OK);
+                REQUIRE(esp_mqtt_client_register_topic_handler(client.get(), "a/#/b", handler, &arg) == ESP_ERR_INVALID_ARG);
+                REQUIRE(esp_mqtt_client_register_topic_handler(nullptr, "a/b", handler, &arg) == ESP_ERR_INVALID_ARG);
+                REQUIRE(esp_mqtt_client_unregister_topic_handler(client.get(), "a/+", handler, &arg) == ESP_OK);
+                REQUIRE(esp_mqtt_client_unregister_topic_handler(client.get(), "a/+", handler, &arg) == ESP_ERR_NOT_FOUND);
+                // The handler left registered is freed with the client
+            }
         }
         SECTION("Client with all allocating configuration set") {
             auto host = random_string(20);
@@ -0,0 +1,22 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "mqtt_client_priv.h"
+
+/*
+ * Access to the private state of the client, for the tests which stand in for the broker
+ * without running the client task.
+ */
+
+void test_mqtt_client_set_connected(esp_mqtt_client_handle_t client)
+{
+    client->state = MQTT_STATE_CONNECTED;
+}
+
+esp_err_t test_mqtt_client_receive_puback(esp_mqtt_client_handle_t client, int msg_id)
+{
+    // Same as the client task receiving a PUBACK
+    return outbox_delete(client->outbox, msg_id, MQTT_MSG_TYPE_PUBLISH);
+}
@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "sdkconfig.h"
+
+#if !CONFIG_MQTT_OUTBOX_PERSISTENT && !CONFIG_MQTT_CUSTOM_OUTBOX
+#include "mqtt_outbox.h"
+extern "C" {
+#include "mqtt_msg.h"
+}
+
+namespace {
+
+outbox_item_handle_t enqueue(outbox_handle_t outbox, int msg_id, int msg_type = MQTT_MSG_TYPE_PUBLISH)
+{
+    uint8_t data[16] = {};
+    outbox_message_t message = {};
+    message.data = data;
+    message.len = sizeof(data);
+    message.msg_id = msg_id;
+    message.msg_qos = 1;
+    message.msg_type = msg_type;
+    return outbox_enqueue(outbox, &message, 0);
+}
+
+} // namespace
+
+TEST_CASE("Outbox finds and deletes messages by id")
+{
+    outbox_handle_t outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    // Enough messages for the index to grow several times, with ids wrapping around like the client's
+    const int count = 2000;
+    std::vector<int> msg_ids(count);
+    std::iota(msg_ids.begin(), msg_ids.end(), UINT16_MAX - count / 2);
+    for (int &msg_id : msg_ids) {
+        msg_id = (msg_id % UINT16_MAX) + 1;
+        REQUIRE(enqueue(outbox, msg_id) != nullptr);
+    }
+    CHECK(outbox_get_size(outbox) == count * 16);
+    for (int msg_id : msg_ids) {
+        outbox_item_handle_t item = outbox_get(outbox, msg_id);
+        REQUIRE(item != nullptr);
+        size_t len;
+        uint16_t id;
+        int type, qos;
+        REQUIRE(outbox_item_get_data(item, &len, &id, &type, &qos) != nullptr);
+        CHECK(id == msg_id);
+    }
+    CHECK(outbox_get(outbox, UINT16_MAX / 2) == nullptr);
+
+    std::shuffle(msg_ids.begin(), msg_ids.end(), std::mt19937 {42});
+    for (size_t i = 0; i < msg_ids.size(); i++) {
+        CHECK(outbox_delete(outbox, msg_ids[i], MQTT_MSG_TYPE_SUBSCRIBE) == ESP_FAIL);
+        REQUIRE(outbox_delete(outbox, msg_ids[i], MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+        CHECK(outbox_get(outbox, msg_ids[i]) == nullptr);
+        if (i + 1 < msg_ids.size()) {
+            CHECK(outbox_get(outbox, msg_ids[i + 1]) != nullptr);
+        }
+    }
+    CHECK(outbox_get_size(outbox) == 0);
+    CHECK(outbox_dequeue(outbox, QUEUED, nullptr) == nullptr);
+    outbox_destroy(outbox);
+}
+
+TEST_CASE("Outbox keeps the order of the messages with the same id")
+{
+    outbox_handle_t outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    // QoS 0 messages stored in the outbox all have id 0
+    outbox_item_handle_t first = enqueue(outbox, 0);
+    outbox_item_handle_t subscribe = enqueue(outbox, 0, MQTT_MSG_TYPE_SUBSCRIBE);
+    outbox_item_handle_t last = enqueue(outbox, 0);
+    REQUIRE((first && subscribe && last));
+    CHECK(outbox_get(outbox, 0) == first);
+    CHECK(outbox_dequeue(outbox, QUEUED, nullptr) == first);
+
+    REQUIRE(outbox_delete(outbox, 0, MQTT_MSG_TYPE_SUBSCRIBE) == ESP_OK);
+    REQUIRE(outbox_delete(outbox, 0, MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+    CHECK(outbox_get(outbox, 0) == last);
+    REQUIRE(outbox_delete_item(outbox, last) == ESP_OK);
+    CHECK(outbox_get(outbox, 0) == nullptr);
+    outbox_destroy(outbox);
+}
+
+TEST_CASE("Outbox takes over the remaining data of a message")
+{
+    outbox_handle_t outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    uint8_t header[] = {0x32, 0x0a, 0x00, 0x01, 't', 0x00, 0x01};
+    const char *payload = "abc";
+    auto *remaining_data = static_cast<uint8_t *>(malloc(strlen(payload)));
+    REQUIRE(remaining_data != nullptr);
+    memcpy(remaining_data, payload, strlen(payload));
+
+    outbox_message_t message = {};
+    message.data = header;
+    message.len = sizeof(header);
+    message.msg_id = 1;
+    message.msg_qos = 1;
+    message.msg_type = MQTT_MSG_TYPE_PUBLISH;
+    message.remaining_data = remaining_data;
+    message.remaining_len = strlen(payload);
+    message.remaining_data_owned = true;
+    outbox_item_handle_t item = outbox_enqueue(outbox, &message, 0);
+    REQUIRE(item != nullptr);
+    CHECK(message.remaining_data == nullptr);
+    CHECK(outbox_get_size(outbox) == sizeof(header) + strlen(payload));
+
+    size_t len;
+    uint16_t id;
+    int type, qos;
+    uint8_t *data = outbox_item_get_data(item, &len, &id, &type, &qos);
+    REQUIRE(data != nullptr);
+    CHECK(len == sizeof(header));
+    CHECK(memcmp(data, header, sizeof(header)) == 0);
+    CHECK(outbox_item_get_remaining_data(item, &len) == remaining_data);
+    CHECK(len == strlen(payload));
+
+    // The remaining data is freed with the message
+    REQUIRE(outbox_delete(outbox, 1, MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+    CHECK(outbox_get_size(outbox) == 0);
+
+    // Messages whose remaining data is not handed over are copied
+    message.remaining_data = reinterpret_cast<uint8_t *>(const_cast<char *>(payload));
+    message.remaining_data_owned = false;
+    item = outbox_enqueue(outbox, &message, 0);
+    REQUIRE(item != nullptr);
+    CHECK(outbox_item_get_remaining_data(item, &len) == nullptr);
+    data = outbox_item_get_data(item, &len, &id, &type, &qos);
+    REQUIRE(len == sizeof(header) + strlen(payload));
+    CHECK(memcmp(data + sizeof(header), payload, strlen(payload)) == 0);
+    outbox_destroy(outbox);
+}
+
+TEST_CASE("Outbox lookup time does not depend on the number of messages")
+{
+    for (int count : {100, 10000}) {
+        outbox_handle_t outbox = outbox_init();
+        REQUIRE(outbox != nullptr);
+        for (int msg_id = 1; msg_id <= count; msg_id++) {
+            REQUIRE(enqueue(outbox, msg_id) != nullptr);
+        }
+        const int lookups = 100000;
+        int found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            found += outbox_set_pending(outbox, i % count + 1, TRANSMITTED) == ESP_OK;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        CHECK(found == lookups);
+        printf("Outbox of %d messages: %lld ns per lookup\n", count, static_cast<long long>(elapsed.count() / lookups));
+        outbox_destroy(outbox);
+    }
+}
+
+#endif // !CONFIG_MQTT_OUTBOX_PERSISTENT && !CONFIG_MQTT_CUSTOM_OUTBOX
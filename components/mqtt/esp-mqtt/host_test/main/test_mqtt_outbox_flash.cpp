@@ -0,0 +1,265 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "sdkconfig.h"
+
+#if CONFIG_MQTT_OUTBOX_PERSISTENT
+#include "esp_partition.h"
+#include "mqtt_outbox.h"
+extern "C" {
+#include "mqtt_msg.h"
+#include "esp_private/partition_linux.h"
+#include "Mockesp_timer.h"
+}
+
+namespace {
+
+const esp_partition_t *outbox_partition()
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                       CONFIG_MQTT_OUTBOX_PARTITION_LABEL);
+    REQUIRE(partition != nullptr);
+    return partition;
+}
+
+void erase_outbox_partition()
+{
+    const esp_partition_t *partition = outbox_partition();
+    REQUIRE(esp_partition_erase_range(partition, 0, partition->size) == ESP_OK);
+}
+
+std::string message_payload(int msg_id, size_t len)
+{
+    std::string payload(len, '\0');
+    for (size_t i = 0; i < len; i++) {
+        payload[i] = static_cast<char>('a' + (msg_id + i) % 26);
+    }
+    return payload;
+}
+
+outbox_item_handle_t enqueue(outbox_handle_t outbox, int msg_id, size_t len = 100)
+{
+    std::string payload = message_payload(msg_id, len);
+    outbox_message_t message = {};
+    message.data = reinterpret_cast<uint8_t *>(payload.data());
+    message.len = static_cast<int>(len);
+    message.msg_id = msg_id;
+    message.msg_qos = 1;
+    message.msg_type = MQTT_MSG_TYPE_PUBLISH;
+    return outbox_enqueue(outbox, &message, 0);
+}
+
+void check_message(outbox_handle_t outbox, int msg_id, size_t len = 100)
+{
+    outbox_item_handle_t item = outbox_get(outbox, msg_id);
+    REQUIRE(item != nullptr);
+    size_t data_len;
+    uint16_t id;
+    int type, qos;
+    uint8_t *data = outbox_item_get_data(item, &data_len, &id, &type, &qos);
+    REQUIRE(data != nullptr);
+    CHECK(id == msg_id);
+    CHECK(type == MQTT_MSG_TYPE_PUBLISH);
+    CHECK(qos == 1);
+    CHECK(std::string(reinterpret_cast<char *>(data), data_len) == message_payload(msg_id, len));
+}
+
+} // namespace
+
+TEST_CASE("Persistent outbox restores its messages in order after a reboot")
+{
+    esp_timer_get_time_IgnoreAndReturn(0);
+    erase_outbox_partition();
+    outbox_handle_t outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    for (int msg_id = 1; msg_id <= 10; msg_id++) {
+        REQUIRE(enqueue(outbox, msg_id) != nullptr);
+    }
+    REQUIRE(outbox_delete(outbox, 3, MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+    REQUIRE(outbox_delete(outbox, 7, MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+    outbox_set_pending(outbox, 1, TRANSMITTED);
+    uint64_t size = outbox_get_size(outbox);
+    outbox_destroy(outbox);
+
+    outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    CHECK(outbox_get_size(outbox) == size);
+    CHECK(outbox_get(outbox, 3) == nullptr);
+    CHECK(outbox_get(outbox, 7) == nullptr);
+    // All the restored messages are queued, in the order they were enqueued
+    for (int msg_id : {1, 2, 4, 5, 6, 8, 9, 10}) {
+        outbox_item_handle_t item = outbox_dequeue(outbox, QUEUED, nullptr);
+        REQUIRE(item != nullptr);
+        check_message(outbox, msg_id);
+        REQUIRE(outbox_delete_item(outbox, item) == ESP_OK);
+    }
+    CHECK(outbox_get_size(outbox) == 0);
+    outbox_destroy(outbox);
+
+    outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    CHECK(outbox_dequeue(outbox, QUEUED, nullptr) == nullptr);
+    outbox_destroy(outbox);
+}
+
+TEST_CASE("Persistent outbox is full when the log wraps around to a message")
+{
+    esp_timer_get_time_IgnoreAndReturn(0);
+    erase_outbox_partition();
+    outbox_handle_t outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    CHECK(enqueue(outbox, 1, 10000) == nullptr); // larger than a sector
+
+    int msg_id = 1;
+    while (enqueue(outbox, msg_id, 1000) != nullptr) {
+        msg_id++;
+    }
+    const int count = msg_id - 1;
+    REQUIRE(count > 10);
+
+    // Deleting the messages of the first sector makes room for new messages
+    REQUIRE(outbox_delete(outbox, 1, MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+    CHECK(enqueue(outbox, count + 1, 1000) == nullptr);
+    for (int i = 2; i <= 4; i++) {
+        REQUIRE(outbox_delete(outbox, i, MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+    }
+    REQUIRE(enqueue(outbox, count + 1, 1000) != nullptr);
+    outbox_destroy(outbox);
+
+    outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    for (int i = 5; i <= count + 1; i++) {
+        check_message(outbox, i, 1000);
+    }
+    outbox_delete_all_items(outbox);
+    outbox_destroy(outbox);
+}
+
+TEST_CASE("Persistent outbox throughput")
+{
+    esp_timer_get_time_IgnoreAndReturn(0);
+    erase_outbox_partition();
+    const esp_partition_t *partition = outbox_partition();
+    outbox_handle_t outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+
+    // Each message is acknowledged after the next 8 ones are enqueued, the log wraps around several times
+    const int in_flight = 8;
+    const size_t len = 200;
+    const int count = static_cast<int>(partition->size / len) * 4;
+    auto start = std::chrono::steady_clock::now();
+    for (int msg_id = 1; msg_id <= count; msg_id++) {
+        REQUIRE(enqueue(outbox, msg_id, len) != nullptr);
+        if (msg_id > in_flight) {
+            REQUIRE(outbox_delete(outbox, msg_id - in_flight, MQTT_MSG_TYPE_PUBLISH) == ESP_OK);
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    printf("Persistent outbox: %d messages of %zu bytes in %lld us\n", count, len, static_cast<long long>(elapsed.count()));
+    CHECK(outbox_get_size(outbox) == in_flight * len);
+    outbox_destroy(outbox);
+
+    outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    for (int msg_id = count - in_flight + 1; msg_id <= count; msg_id++) {
+        check_message(outbox, msg_id, len);
+    }
+    outbox_delete_all_items(outbox);
+    outbox_destroy(outbox);
+}
+
+TEST_CASE("Persistent outbox recovers from a power loss")
+{
+    esp_timer_get_time_IgnoreAndReturn(0);
+    // A record of 100 bytes is written in 32 words, the power is lost at each of them and at the deletion of a message
+    for (size_t words_before_power_off = 0; words_before_power_off < 36; words_before_power_off++) {
+        erase_outbox_partition();
+        outbox_handle_t outbox = outbox_init();
+        REQUIRE(outbox != nullptr);
+        for (int msg_id = 1; msg_id <= 3; msg_id++) {
+            REQUIRE(enqueue(outbox, msg_id) != nullptr);
+        }
+
+        esp_partition_fail_after(words_before_power_off, ESP_PARTITION_FAIL_AFTER_MODE_WRITE);
+        bool enqueued = enqueue(outbox, 4) != nullptr;
+        outbox_delete(outbox, 2, MQTT_MSG_TYPE_PUBLISH);
+        esp_partition_fail_after(SIZE_MAX, ESP_PARTITION_FAIL_AFTER_MODE_WRITE);
+        outbox_destroy(outbox);
+
+        outbox = outbox_init();
+        REQUIRE(outbox != nullptr);
+        check_message(outbox, 1);
+        check_message(outbox, 3);
+        // The power may be lost after the last word of a record was written, but before the write returned
+        if (outbox_get(outbox, 2) != nullptr) {
+            check_message(outbox, 2);
+        }
+        if (enqueued || outbox_get(outbox, 4) != nullptr) {
+            check_message(outbox, 4);
+        }
+        CHECK((enqueued || words_before_power_off >= 32 || outbox_get(outbox, 4) == nullptr));
+
+        // The outbox keeps working after the recovery
+        REQUIRE(enqueue(outbox, 5) != nullptr);
+        outbox_destroy(outbox);
+        outbox = outbox_init();
+        REQUIRE(outbox != nullptr);
+        check_message(outbox, 5);
+        outbox_delete_all_items(outbox);
+        outbox_destroy(outbox);
+    }
+}
+
+TEST_CASE("Persistent outbox ids are not reused by the publishes after a restore")
+{
+    esp_timer_get_time_IgnoreAndReturn(0);
+    erase_outbox_partition();
+    outbox_handle_t outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    std::set<uint16_t> ids;
+
+    // Publishes the messages the way the client does, with the ids assigned by the message layer
+    auto publish = [&](int count) {
+        mqtt_connection_t connection = {};
+        REQUIRE(mqtt_msg_buffer_init(&connection, 256) == ESP_OK);
+        connection.outbox = outbox;
+        for (int i = 0; i < count; i++) {
+            uint16_t msg_id = 0;
+            mqtt_message_t *msg = mqtt_msg_publish(&connection, "/topic", "data", 4, 1, 0, &msg_id);
+            REQUIRE(msg->length > 0);
+            CHECK(ids.insert(msg_id).second);
+            outbox_message_t message = {};
+            message.data = msg->data;
+            message.len = msg->length;
+            message.msg_id = msg_id;
+            message.msg_qos = 1;
+            message.msg_type = MQTT_MSG_TYPE_PUBLISH;
+            REQUIRE(outbox_enqueue(outbox, &message, 0) != nullptr);
+        }
+        mqtt_msg_buffer_destroy(&connection);
+    };
+
+    publish(5);
+    // The device crashes before the messages are acknowledged, the next session starts with a new connection
+    outbox_destroy(outbox);
+    outbox = outbox_init();
+    REQUIRE(outbox != nullptr);
+    for (uint16_t msg_id : ids) {
+        CHECK(outbox_get(outbox, msg_id) != nullptr);
+    }
+    publish(5);
+    CHECK(ids.size() == 10);
+
+    outbox_delete_all_items(outbox);
+    outbox_destroy(outbox);
+}
+
+#endif // CONFIG_MQTT_OUTBOX_PERSISTENT
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "mqtt_topic_router.h"
+
+namespace {
+
+struct recorder {
+    std::vector<int> calls;
+};
+
+struct handler_ctx {
+    recorder *rec;
+    int id;
+};
+
+void record(esp_mqtt_event_handle_t event, void *arg)
+{
+    auto *ctx = static_cast<handler_ctx *>(arg);
+    ctx->rec->calls.push_back(ctx->id);
+}
+
+std::vector<int> dispatch(mqtt_topic_router_handle_t router, recorder &rec, const char *topic, int offset = 0)
+{
+    esp_mqtt_event_t event = {};
+    event.event_id = MQTT_EVENT_DATA;
+    event.topic = offset ? nullptr : const_cast<char *>(topic);
+    event.topic_len = offset ? 0 : strlen(topic);
+    event.current_data_offset = offset;
+    rec.calls.clear();
+    int called = mqtt_topic_router_dispatch(router, &event);
+    CHECK(called == static_cast<int>(rec.calls.size()));
+    std::sort(rec.calls.begin(), rec.calls.end());
+    return rec.calls;
+}
+
+} // namespace
+
+TEST_CASE("Topic router matches the filters with wildcards")
+{
+    mqtt_topic_router_handle_t router = mqtt_topic_router_create();
+    REQUIRE(router != nullptr);
+    recorder rec;
+    const char *filters[] = {"a/b", "a/+", "a/#", "#", "+/b", "a/b/c", "$SYS/#", "+/+", "a/", "+/+/c", "/a"};
+    std::vector<handler_ctx> ctx;
+    for (int i = 0; i < static_cast<int>(std::size(filters)); i++) {
+        ctx.push_back({&rec, i});
+    }
+    for (size_t i = 0; i < std::size(filters); i++) {
+        REQUIRE(mqtt_topic_router_add(router, filters[i], record, &ctx[i]) == ESP_OK);
+    }
+
+    CHECK(dispatch(router, rec, "a/b") == std::vector<int> {0, 1, 2, 3, 4, 7});
+    CHECK(dispatch(router, rec, "a") == std::vector<int> {2, 3});
+    CHECK(dispatch(router, rec, "a/b/c") == std::vector<int> {2, 3, 5, 9});
+    CHECK(dispatch(router, rec, "a/") == std::vector<int> {1, 2, 3, 7, 8});
+    CHECK(dispatch(router, rec, "/a") == std::vector<int> {3, 7, 10});
+    CHECK(dispatch(router, rec, "x/b") == std::vector<int> {3, 4, 7});
+    CHECK(dispatch(router, rec, "x/y/z") == std::vector<int> {3});
+    // First level wildcards don't match the topics starting with '$'
+    CHECK(dispatch(router, rec, "$SYS/broker") == std::vector<int> {6});
+
+    REQUIRE(mqtt_topic_router_remove(router, "#", record, &ctx[3]) == ESP_OK);
+    REQUIRE(mqtt_topic_router_remove(router, "a/+", record, &ctx[1]) == ESP_OK);
+    CHECK(mqtt_topic_router_remove(router, "a/+", record, &ctx[1]) == ESP_ERR_NOT_FOUND);
+    CHECK(mqtt_topic_router_remove(router, "a/b", record, &ctx[1]) == ESP_ERR_NOT_FOUND);
+    CHECK(mqtt_topic_router_remove(router, "q/r", record, &ctx[1]) == ESP_ERR_NOT_FOUND);
+    CHECK(dispatch(router, rec, "a/b") == std::vector<int> {0, 2, 4, 7});
+    CHECK(dispatch(router, rec, "x/y/z").empty());
+    mqtt_topic_router_destroy(router);
+}
+
+TEST_CASE("Topic router validates the filters and handles shared subscriptions")
+{
+    mqtt_topic_router_handle_t router = mqtt_topic_router_create();
+    REQUIRE(router != nullptr);
+    recorder rec;
+    handler_ctx ctx = {&rec, 1};
+    for (const char *filter : {"", "a/#/b", "a/b#", "a+/b", "$share/", "$share/g", "$share/g/", "$share//a", "$share/g+/a"}) {
+        CAPTURE(filter);
+        CHECK(mqtt_topic_router_add(router, filter, record, &ctx) == ESP_ERR_INVALID_ARG);
+        CHECK(mqtt_topic_router_remove(router, filter, record, &ctx) == ESP_ERR_INVALID_ARG);
+    }
+    CHECK(mqtt_topic_router_add(router, nullptr, record, &ctx) == ESP_ERR_INVALID_ARG);
+    CHECK(mqtt_topic_router_add(router, "a", nullptr, &ctx) == ESP_ERR_INVALID_ARG);
+
+    // The broker delivers the messages of shared subscriptions with the original topic
+    REQUIRE(mqtt_topic_router_add(router, "$share/group/sensors/+/temp", record, &ctx) == ESP_OK);
+    CHECK(dispatch(router, rec, "sensors/1/temp") == std::vector<int> {1});
+    CHECK(dispatch(router, rec, "$share/group/sensors/1/temp").empty());
+    // Same filter from another group, the handler is registered once
+    REQUIRE(mqtt_topic_router_add(router, "$share/other/sensors/+/temp", record, &ctx) == ESP_OK);
+    CHECK(dispatch(router, rec, "sensors/1/temp") == std::vector<int> {1});
+    REQUIRE(mqtt_topic_router_remove(router, "sensors/+/temp", record, &ctx) == ESP_OK);
+    CHECK(dispatch(router, rec, "sensors/1/temp").empty());
+    mqtt_topic_router_destroy(router);
+}
+
+namespace {
+
+struct unregistering_ctx {
+    mqtt_topic_router_handle_t router;
+    handler_ctx *other;
+    int calls;
+};
+
+void unregister_other(esp_mqtt_event_handle_t event, void *arg)
+{
+    auto *ctx = static_cast<unregistering_ctx *>(arg);
+    ctx->calls++;
+    ctx->other->rec->calls.push_back(-1);
+    CHECK(mqtt_topic_router_remove(ctx->router, "a/b", record, ctx->other) == ESP_OK);
+}
+
+} // namespace
+
+TEST_CASE("Topic router passes all fragments of a message to its handlers once")
+{
+    mqtt_topic_router_handle_t router = mqtt_topic_router_create();
+    REQUIRE(router != nullptr);
+    recorder rec;
+    handler_ctx ctx[] = {{&rec, 0}, {&rec, 1}};
+    // The same handler and argument for overlapping filters is called once
+    REQUIRE(mqtt_topic_router_add(router, "a/b", record, &ctx[0]) == ESP_OK);
+    REQUIRE(mqtt_topic_router_add(router, "a/+", record, &ctx[0]) == ESP_OK);
+    REQUIRE(mqtt_topic_router_add(router, "#", record, &ctx[0]) == ESP_OK);
+    REQUIRE(mqtt_topic_router_add(router, "a/#", record, &ctx[1]) == ESP_OK);
+    CHECK(dispatch(router, rec, "a/b") == std::vector<int> {0, 1});
+    CHECK(dispatch(router, rec, nullptr, 100) == std::vector<int> {0, 1});
+    CHECK(dispatch(router, rec, nullptr, 200) == std::vector<int> {0, 1});
+    CHECK(dispatch(router, rec, "b") == std::vector<int> {0});
+    CHECK(dispatch(router, rec, nullptr, 100) == std::vector<int> {0});
+
+    // A handler unregistered during the dispatch doesn't get the rest of the message
+    REQUIRE(mqtt_topic_router_remove(router, "a/+", record, &ctx[0]) == ESP_OK);
+    REQUIRE(mqtt_topic_router_remove(router, "#", record, &ctx[0]) == ESP_OK);
+    unregistering_ctx unregistering = {router, &ctx[0], 0};
+    REQUIRE(mqtt_topic_router_add(router, "+/b", unregister_other, &unregistering) == ESP_OK);
+    CHECK(dispatch(router, rec, "a/b") == std::vector<int> {-1, 0, 1});
+    CHECK(unregistering.calls == 1);
+    REQUIRE(mqtt_topic_router_remove(router, "+/b", unregister_other, &unregistering) == ESP_OK);
+    CHECK(dispatch(router, rec, nullptr, 100) == std::vector<int> {1});
+    CHECK(unregistering.calls == 1);
+    mqtt_topic_router_destroy(router);
+}
+
+TEST_CASE("Topic router dispatch time does not depend on the number of filters")
+{
+    recorder rec;
+    std::vector<handler_ctx> ctx;
+    for (int i = 0; i < 200; i++) {
+        ctx.push_back({&rec, i});
+    }
+    for (int filter_count : {20, 200}) {
+        mqtt_topic_router_handle_t router = mqtt_topic_router_create();
+        REQUIRE(router != nullptr);
+        // Devices with a few wildcard subscriptions, like an application subscribed to its fleet
+        for (int i = 0; i < filter_count; i++) {
+            std::string filter;
+            switch (i % 4) {
+            case 0: filter = "fleet/dev" + std::to_string(i) + "/cmd"; break;
+            case 1: filter = "fleet/dev" + std::to_string(i) + "/+/state"; break;
+            case 2: filter = "fleet/dev" + std::to_string(i) + "/#"; break;
+            default: filter = "$share/workers/fleet/+/telemetry/" + std::to_string(i); break;
+            }
+            REQUIRE(mqtt_topic_router_add(router, filter.c_str(), record, &ctx[i]) == ESP_OK);
+        }
+        const int messages = 100000;
+        size_t matched = 0;
+        esp_mqtt_event_t event = {};
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < messages; i++) {
+            char topic[64];
+            event.topic = topic;
+            event.topic_len = snprintf(topic, sizeof(topic), "fleet/dev%d/light/state", i % filter_count);
+            rec.calls.clear();
+            matched += mqtt_topic_router_dispatch(router, &event);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        // dev<i>/+/state for i % 4 == 1, dev<i>/# for i % 4 == 2
+        CHECK(matched == messages / 2);
+        printf("Topic router with %d filters: %lld ns per message\n", filter_count,
+               static_cast<long long>(elapsed.count() / messages));
+        mqtt_topic_router_destroy(router);
+    }
+}
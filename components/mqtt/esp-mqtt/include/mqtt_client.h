@@ -214,6 +214,12 @@ typedef struct esp_mqtt_event_t {
 
 typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
 
+/**
+ * Handler of the messages received on the topics matching a topic filter,
+ * see esp_mqtt_client_register_topic_handler()
+ */
+typedef void (*esp_mqtt_topic_handler_t)(esp_mqtt_event_handle_t event, void *handler_arg);
+
 /**
  * *MQTT* client configuration structure
  *
@@ -355,6 +361,11 @@ typedef struct esp_mqtt_client_config_t {
         int size;     /*!< size of *MQTT* send/receive buffer*/
         int out_size; /*!< size of *MQTT* output buffer. If not defined, defaults to the size defined by
               ``buffer_size`` */
+        int batch_size; /*!< size of the buffer in which publish messages are batched, to be written to the
+              transport together. If not defined (0), batching is disabled */
+        int batch_timeout_ms; /*!< time after which the batched publish messages are written, in milliseconds
+              (defaults to ``CONFIG_MQTT_BATCH_TIMEOUT_MS``, 10 ms). A message published from another task into
+              an empty batch buffer may wait for the MQTT task until ``CONFIG_MQTT_POLL_READ_TIMEOUT_MS`` */
     } buffer; /*!< Buffer size configuration.*/
 
     /**
@@ -555,6 +566,54 @@ int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client,
 int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
                             const char *data, int len, int qos, int retain);
 
+/**
+ * @brief Client to send a publish message to the broker, without copying the
+ * payload
+ *
+ * Same as esp_mqtt_client_publish(), but the client takes ownership of the
+ * payload buffer instead of copying it: the payload is written to the network
+ * directly from this buffer, after the header which is created separately,
+ * and QoS 1 and QoS 2 messages keep it in the outbox until they are
+ * acknowledged.
+ *
+ * Notes:
+ * - The payload buffer must be allocated with malloc() or heap_caps_malloc().
+ * It is freed by the client in all cases, including when this API fails, and
+ * must not be accessed once this API is called.
+ * - Outboxes which don't support taking ownership of the payload, like the
+ * persistent outbox, copy it and the client frees the buffer once sent.
+ *
+ * @param client    *MQTT* client handle
+ * @param topic     topic string
+ * @param data      payload buffer (set to NULL, sending empty payload message)
+ * @param len       data length, if set to 0, length is calculated from payload
+ * string
+ * @param qos       QoS of publish message
+ * @param retain    retain flag
+ *
+ * @return message_id of the publish message (for QoS 0 message_id will always
+ * be zero) on success. -1 on failure, -2 in case of full outbox.
+ */
+int esp_mqtt_client_publish_zero_copy(esp_mqtt_client_handle_t client, const char *topic,
+                                      char *data, int len, int qos, int retain);
+
+/**
+ * @brief Writes the batched publish messages to the transport
+ *
+ * With batching enabled (``buffer.batch_size`` in the client configuration),
+ * the publish messages are copied to the batch buffer and written together
+ * once it is full, after ``buffer.batch_timeout_ms``, before any other message
+ * or when this API is called. Batched QoS 0 messages are lost if the
+ * connection is aborted before they are written.
+ *
+ * @param client    *MQTT* client handle
+ *
+ * @return ESP_OK on success, also if there is nothing to write
+ *         ESP_ERR_INVALID_ARG on wrong initialization
+ *         ESP_FAIL if writing failed, the connection is then aborted
+ */
+esp_err_t esp_mqtt_client_flush(esp_mqtt_client_handle_t client);
+
 /**
  * @brief Enqueue a message to the outbox, to be sent later. Typically used for
  * messages with qos>0, but could be also used for qos=0 messages if store=true.
@@ -642,6 +701,56 @@ esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client,
  */
 esp_err_t esp_mqtt_client_unregister_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event, esp_event_handler_t event_handler);
 
+/**
+ * @brief Registers a handler of the messages received on the topics matching a topic filter
+ *
+ * The handler is called from the *MQTT* task with the MQTT_EVENT_DATA events of
+ * the matching messages, after the event is posted to the event handlers,
+ * which still receive all messages. The filters are matched in a trie, so the
+ * cost of finding the handlers depends on the number of levels of the topic,
+ * not on the number of filters.
+ *
+ * Notes:
+ * - The filter may contain the `+` and `#` wildcards, which don't match the
+ * topics starting with `$` at the first level.
+ * - Shared subscription filters `$share/<group>/<filter>` match the topics of
+ * `<filter>`, as the broker delivers the messages with the original topic.
+ * - A handler is called once for each fragment of a matching message, also
+ * when it is registered with the same argument for several matching filters.
+ * The following fragments are passed to the handlers matched by the first one.
+ * - The handler may register and unregister topic handlers, and is not called
+ * anymore for a message once unregistered.
+ * - Subscribing to the topics on the broker is still done with
+ * esp_mqtt_client_subscribe().
+ *
+ * @param client        *MQTT* client handle
+ * @param topic_filter  topic filter
+ * @param handler       handler callback
+ * @param handler_arg   handler context
+ *
+ * @return ESP_OK on success, also if the handler is already registered for the
+ *         filter with this argument
+ *         ESP_ERR_INVALID_ARG on invalid topic filter
+ *         ESP_ERR_NO_MEM if failed to allocate
+ */
+esp_err_t esp_mqtt_client_register_topic_handler(esp_mqtt_client_handle_t client, const char *topic_filter,
+        esp_mqtt_topic_handler_t handler, void *handler_arg);
+
+/**
+ * @brief Unregisters a handler registered with esp_mqtt_client_register_topic_handler()
+ *
+ * @param client        *MQTT* client handle
+ * @param topic_filter  topic filter the handler was registered with
+ * @param handler       handler callback
+ * @param handler_arg   handler context it was registered with
+ *
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_ARG on invalid topic filter
+ *         ESP_ERR_NOT_FOUND if the handler is not registered for the filter
+ */
+esp_err_t esp_mqtt_client_unregister_topic_handler(esp_mqtt_client_handle_t client, const char *topic_filter,
+        esp_mqtt_topic_handler_t handler, void *handler_arg);
+
 /**
  * @brief Get outbox size
  *
@@ -26,6 +26,7 @@
 #include "esp_transport_ws.h"
 #include "esp_log.h"
 #include "mqtt_outbox.h"
+#include "mqtt_topic_router.h"
 #include "freertos/event_groups.h"
 #include <errno.h>
 #include <string.h>
@@ -64,6 +65,10 @@ typedef struct mqtt_state {
     uint16_t pending_msg_id;
     int pending_msg_type;
     int pending_publish_qos;
+    uint8_t *batch_buffer;      /*!< Messages written to the transport together, NULL if batching is disabled */
+    size_t batch_buffer_size;
+    size_t batch_len;
+    uint64_t batch_tick;        /*!< Time the first message of the batch was added */
 } mqtt_state_t;
 
 typedef struct {
@@ -98,6 +103,7 @@ typedef struct {
     void *ds_data;
     int message_retransmit_timeout;
     uint64_t outbox_limit;
+    int batch_timeout_ms;
     esp_transport_handle_t transport;
     struct ifreq * if_name;
 } mqtt_config_storage_t;
@@ -128,6 +134,7 @@ struct esp_mqtt_client {
     bool run;
     bool wait_for_ping_resp;
     outbox_handle_t outbox;
+    mqtt_topic_router_handle_t topic_router;
     EventGroupHandle_t status_bits;
     SemaphoreHandle_t  api_lock;
     TaskHandle_t       task_handle;
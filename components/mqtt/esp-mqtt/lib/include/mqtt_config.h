@@ -36,6 +36,12 @@
 #define MQTT_BUFFER_SIZE_BYTE       1024
 #endif
 
+#if CONFIG_MQTT_BATCH_TIMEOUT_MS
+#define MQTT_BATCH_TIMEOUT_MS       CONFIG_MQTT_BATCH_TIMEOUT_MS
+#else
+#define MQTT_BATCH_TIMEOUT_MS       10
+#endif
+
 #if CONFIG_MQTT_TASK_PRIORITY
 #define MQTT_TASK_PRIORITY          CONFIG_MQTT_TASK_PRIORITY
 #else
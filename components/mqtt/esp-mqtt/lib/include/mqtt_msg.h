@@ -5,6 +5,7 @@
 
 #include "mqtt_config.h"
 #include "mqtt_client.h"
+#include "mqtt_outbox.h"
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -90,6 +91,7 @@ typedef struct mqtt_connection {
     uint8_t *buffer;
     size_t buffer_length;
     mqtt_connect_info_t information;
+    outbox_handle_t outbox;     /*!< assigned message ids skip the ids of the messages in this outbox, if set */
 
 } mqtt_connection_t;
 
@@ -135,6 +137,8 @@ void mqtt_msg_buffer_destroy(mqtt_connection_t *connection);
 
 mqtt_message_t *mqtt_msg_connect(mqtt_connection_t *connection, mqtt_connect_info_t *info);
 mqtt_message_t *mqtt_msg_publish(mqtt_connection_t *connection, const char *topic, const char *data, int data_length, int qos, int retain, uint16_t *message_id);
+/* Creates only the header of a publish message, its payload of data_length bytes is written separately */
+mqtt_message_t *mqtt_msg_publish_header(mqtt_connection_t *connection, const char *topic, int data_length, int qos, int retain, uint16_t *message_id);
 mqtt_message_t *mqtt_msg_puback(mqtt_connection_t *connection, uint16_t message_id);
 mqtt_message_t *mqtt_msg_pubrec(mqtt_connection_t *connection, uint16_t message_id);
 mqtt_message_t *mqtt_msg_pubrel(mqtt_connection_t *connection, uint16_t message_id);
@@ -5,6 +5,7 @@
  */
 #ifndef _MQTT_OUTOBX_H_
 #define _MQTT_OUTOBX_H_
+#include <stdbool.h>
 #include "platform.h"
 #include "esp_err.h"
 
@@ -27,6 +28,8 @@ typedef struct outbox_message {
     int msg_type;
     uint8_t *remaining_data;
     int remaining_len;
+    bool remaining_data_owned;  /*!< remaining_data was allocated with malloc(), the outbox may keep it instead of
+                                     copying it, and sets remaining_data to NULL when it takes it over */
 } outbox_message_t;
 
 typedef enum pending_state {
@@ -41,6 +44,14 @@ outbox_item_handle_t outbox_enqueue(outbox_handle_t outbox, outbox_message_handl
 outbox_item_handle_t outbox_dequeue(outbox_handle_t outbox, pending_state_t pending, outbox_tick_t *tick);
 outbox_item_handle_t outbox_get(outbox_handle_t outbox, int msg_id);
 uint8_t *outbox_item_get_data(outbox_item_handle_t item,  size_t *len, uint16_t *msg_id, int *msg_type, int *qos);
+/**
+ * @brief Returns the data of an item following the data returned by outbox_item_get_data()
+ *
+ * Only the remaining data taken over by the outbox is not stored with the rest of the message.
+ *
+ * @return pointer to the data, NULL if outbox_item_get_data() returns the whole message
+ */
+uint8_t *outbox_item_get_remaining_data(outbox_item_handle_t item, size_t *len);
 esp_err_t outbox_delete(outbox_handle_t outbox, int msg_id, int msg_type);
 esp_err_t outbox_delete_item(outbox_handle_t outbox, outbox_item_handle_t item);
 int outbox_delete_expired(outbox_handle_t outbox, outbox_tick_t current_tick, outbox_tick_t timeout);
@@ -0,0 +1,62 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef _MQTT_TOPIC_ROUTER_H_
+#define _MQTT_TOPIC_ROUTER_H_
+#include <stddef.h>
+#include "esp_err.h"
+#include "mqtt_client.h"
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Maps topic filters to the handlers registered with esp_mqtt_client_register_topic_handler().
+ *
+ * The filters are stored level by level in a trie, the literal levels of all nodes being indexed in a
+ * single hash table keyed by the parent node and the level, so matching a topic costs one lookup per
+ * topic level plus one per matching wildcard branch, whatever the number of filters.
+ */
+typedef struct mqtt_topic_router *mqtt_topic_router_handle_t;
+
+mqtt_topic_router_handle_t mqtt_topic_router_create(void);
+
+/**
+ * @brief Adds a handler for the filter, shared subscription filters (`$share/<group>/<filter>`) are
+ * stored as the filter following the group, the broker delivering them with the plain topic
+ *
+ * @return ESP_OK on success, also if the handler is already registered for the filter
+ *         ESP_ERR_INVALID_ARG if the filter is not a valid topic filter
+ *         ESP_ERR_NO_MEM if failed to allocate
+ */
+esp_err_t mqtt_topic_router_add(mqtt_topic_router_handle_t router, const char *filter,
+                                esp_mqtt_topic_handler_t handler, void *handler_arg);
+
+/**
+ * @return ESP_OK on success
+ *         ESP_ERR_INVALID_ARG if the filter is not a valid topic filter
+ *         ESP_ERR_NOT_FOUND if the handler is not registered for the filter
+ */
+esp_err_t mqtt_topic_router_remove(mqtt_topic_router_handle_t router, const char *filter,
+                                   esp_mqtt_topic_handler_t handler, void *handler_arg);
+
+/**
+ * @brief Calls the handlers of the filters matching the topic of the event, once per handler and argument
+ *
+ * Events without a topic are the following fragments of a message, passed to the handlers matched
+ * by its first fragment. The handlers are collected before being called, so they may register and
+ * unregister handlers.
+ *
+ * @return number of handlers called
+ */
+int mqtt_topic_router_dispatch(mqtt_topic_router_handle_t router, esp_mqtt_event_handle_t event);
+
+void mqtt_topic_router_destroy(mqtt_topic_router_handle_t router);
+
+#ifdef  __cplusplus
+}
+#endif
+#endif
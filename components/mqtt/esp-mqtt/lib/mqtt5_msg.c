@@ -122,11 +122,18 @@ static uint16_t append_message_id(mqtt_connection_t *connection, uint16_t messag
 {
     // If message_id is zero then we should assign one, otherwise
     // we'll use the one supplied by the caller
-    while (message_id == 0) {
+    if (message_id == 0) {
 #if MQTT_MSG_ID_INCREMENTAL
         message_id = ++ connection->last_message_id;
 #else
         message_id = platform_random(65535);
+#endif
+        // the outbox may hold messages of a previous session, restored with their ids, take the next free id
+        while (message_id == 0 || (connection->outbox && outbox_get(connection->outbox, message_id))) {
+            message_id++;
+        }
+#if MQTT_MSG_ID_INCREMENTAL
+        connection->last_message_id = message_id;
 #endif
     }
 
@@ -720,7 +727,7 @@ esp_err_t mqtt5_msg_parse_connack_property(uint8_t *buffer, size_t buffer_len, m
     return ESP_OK;
 }
 
-mqtt_message_t *mqtt5_msg_publish(mqtt_connection_t *connection, const char *topic, const char *data, int data_length, int qos, int retain, uint16_t *message_id, const esp_mqtt5_publish_property_config_t *property, const char *resp_info)
+static mqtt_message_t *msg_publish(mqtt_connection_t *connection, const char *topic, const char *data, int data_length, bool header_only, int qos, int retain, uint16_t *message_id, const esp_mqtt5_publish_property_config_t *property, const char *resp_info)
 {
     init_message(connection);
 
@@ -731,7 +738,7 @@ mqtt_message_t *mqtt5_msg_publish(mqtt_connection_t *connection, const char *top
     int topic_len = (topic == NULL || topic[0] == '\0') ? 0 : strlen(topic);
     APPEND_CHECK(append_property(connection, 0, 2, topic, topic_len), fail_message(connection));
 
-    if (data == NULL && data_length > 0) {
+    if (data == NULL && data_length > 0 && !header_only) {
         return fail_message(connection);
     }
 
@@ -791,7 +798,11 @@ mqtt_message_t *mqtt5_msg_publish(mqtt_connection_t *connection, const char *top
     }
     APPEND_CHECK(update_property_len_value(connection, connection->outbound_message.length - properties_offset - 1, properties_offset), fail_message(connection));
 
-    if (connection->outbound_message.length + data_length > connection->buffer_length) {
+    if (header_only) {
+        // The payload is written separately -> the message is a fragment holding only the header
+        connection->outbound_message.fragmented_msg_data_offset = connection->outbound_message.length;
+        connection->outbound_message.fragmented_msg_total_length = data_length + connection->outbound_message.fragmented_msg_data_offset;
+    } else if (connection->outbound_message.length + data_length > connection->buffer_length) {
         // Not enough size in buffer -> fragment this message
         connection->outbound_message.fragmented_msg_data_offset = connection->outbound_message.length;
         memcpy(connection->buffer + connection->outbound_message.length, data, connection->buffer_length - connection->outbound_message.length);
@@ -807,6 +818,16 @@ mqtt_message_t *mqtt5_msg_publish(mqtt_connection_t *connection, const char *top
     return fini_message(connection, MQTT_MSG_TYPE_PUBLISH, 0, qos, retain);
 }
 
+mqtt_message_t *mqtt5_msg_publish(mqtt_connection_t *connection, const char *topic, const char *data, int data_length, int qos, int retain, uint16_t *message_id, const esp_mqtt5_publish_property_config_t *property, const char *resp_info)
+{
+    return msg_publish(connection, topic, data, data_length, false, qos, retain, message_id, property, resp_info);
+}
+
+mqtt_message_t *mqtt5_msg_publish_header(mqtt_connection_t *connection, const char *topic, int data_length, int qos, int retain, uint16_t *message_id, const esp_mqtt5_publish_property_config_t *property, const char *resp_info)
+{
+    return msg_publish(connection, topic, NULL, data_length, true, qos, retain, message_id, property, resp_info);
+}
+
 int mqtt5_msg_get_reason_code(uint8_t *buffer, size_t length)
 {
     uint8_t len_bytes = 0;
@@ -64,11 +64,18 @@ static uint16_t append_message_id(mqtt_connection_t *connection, uint16_t messag
 {
     // If message_id is zero then we should assign one, otherwise
     // we'll use the one supplied by the caller
-    while (message_id == 0) {
+    if (message_id == 0) {
 #if MQTT_MSG_ID_INCREMENTAL
         message_id = ++connection->last_message_id;
 #else
         message_id = platform_random(65535);
+#endif
+        // the outbox may hold messages of a previous session, restored with their ids, take the next free id
+        while (message_id == 0 || (connection->outbox && outbox_get(connection->outbox, message_id))) {
+            message_id++;
+        }
+#if MQTT_MSG_ID_INCREMENTAL
+        connection->last_message_id = message_id;
 #endif
     }
 
@@ -436,7 +443,7 @@ mqtt_message_t *mqtt_msg_connect(mqtt_connection_t *connection, mqtt_connect_inf
     return fini_message(connection, MQTT_MSG_TYPE_CONNECT, 0, 0, 0);
 }
 
-mqtt_message_t *mqtt_msg_publish(mqtt_connection_t *connection, const char *topic, const char *data, int data_length, int qos, int retain, uint16_t *message_id)
+static mqtt_message_t *msg_publish(mqtt_connection_t *connection, const char *topic, const char *data, int data_length, bool header_only, int qos, int retain, uint16_t *message_id)
 {
     set_message_header_size(connection);
 
@@ -448,7 +455,7 @@ mqtt_message_t *mqtt_msg_publish(mqtt_connection_t *connection, const char *topi
         return fail_message(connection);
     }
 
-    if (data == NULL && data_length > 0) {
+    if (data == NULL && data_length > 0 && !header_only) {
         return fail_message(connection);
     }
 
@@ -460,7 +467,11 @@ mqtt_message_t *mqtt_msg_publish(mqtt_connection_t *connection, const char *topi
         *message_id = 0;
     }
 
-    if (data != NULL) {
+    if (header_only) {
+        // The payload is written separately -> the message is a fragment holding only the header
+        connection->outbound_message.fragmented_msg_data_offset = connection->outbound_message.length;
+        connection->outbound_message.fragmented_msg_total_length = data_length + connection->outbound_message.fragmented_msg_data_offset;
+    } else if (data != NULL) {
         if (connection->outbound_message.length + data_length > connection->buffer_length) {
             // Not enough size in buffer -> fragment this message
             connection->outbound_message.fragmented_msg_data_offset = connection->outbound_message.length;
@@ -476,6 +487,16 @@ mqtt_message_t *mqtt_msg_publish(mqtt_connection_t *connection, const char *topi
     return fini_message(connection, MQTT_MSG_TYPE_PUBLISH, 0, qos, retain);
 }
 
+mqtt_message_t *mqtt_msg_publish(mqtt_connection_t *connection, const char *topic, const char *data, int data_length, int qos, int retain, uint16_t *message_id)
+{
+    return msg_publish(connection, topic, data, data_length, false, qos, retain, message_id);
+}
+
+mqtt_message_t *mqtt_msg_publish_header(mqtt_connection_t *connection, const char *topic, int data_length, int qos, int retain, uint16_t *message_id)
+{
+    return msg_publish(connection, topic, NULL, data_length, true, qos, retain, message_id);
+}
+
 mqtt_message_t *mqtt_msg_puback(mqtt_connection_t *connection, uint16_t message_id)
 {
     set_message_header_size(connection);
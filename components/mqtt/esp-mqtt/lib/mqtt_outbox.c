@@ -10,38 +10,119 @@
 #ifndef CONFIG_MQTT_CUSTOM_OUTBOX
 static const char *TAG = "outbox";
 
+// The items are indexed by msg_id in a hash table, which doubles when it holds twice as many items as buckets
+#define OUTBOX_INDEX_MIN_BUCKETS    16
+#define OUTBOX_INDEX_MAX_BUCKETS    (UINT16_MAX + 1)
+
 typedef struct outbox_item {
     char *buffer;
     int len;
+    uint8_t *remaining_data;        /*!< Data following the buffer, taken over from the client */
+    int remaining_len;
     int msg_id;
     int msg_type;
     int msg_qos;
     outbox_tick_t tick;
     pending_state_t pending;
-    STAILQ_ENTRY(outbox_item) next;
+    TAILQ_ENTRY(outbox_item) next;
+    struct outbox_item *index_next; /*!< Next item of the same hash bucket, in enqueue order */
+    char header[];                  /*!< Buffer of the items which remaining data is taken over */
 } outbox_item_t;
 
-STAILQ_HEAD(outbox_list_t, outbox_item);
+TAILQ_HEAD(outbox_list_t, outbox_item);
 
 struct outbox_t {
     _Atomic uint64_t size;
     struct outbox_list_t *list;
+    outbox_item_t **index;
+    size_t index_buckets;           /*!< Power of two */
+    size_t count;
 };
 
+static inline outbox_item_t **outbox_index_bucket(outbox_handle_t outbox, int msg_id)
+{
+    return &outbox->index[msg_id & (outbox->index_buckets - 1)];
+}
+
+static void outbox_index_insert(outbox_handle_t outbox, outbox_item_handle_t item)
+{
+    outbox_item_t **link = outbox_index_bucket(outbox, item->msg_id);
+    while (*link) {
+        link = &(*link)->index_next;
+    }
+    item->index_next = NULL;
+    *link = item;
+}
+
+static void outbox_index_grow(outbox_handle_t outbox)
+{
+    if (outbox->count < 2 * outbox->index_buckets || outbox->index_buckets >= OUTBOX_INDEX_MAX_BUCKETS) {
+        return;
+    }
+    outbox_item_t **index = calloc(2 * outbox->index_buckets, sizeof(outbox_item_t *));
+    if (index == NULL) {
+        // Keep the current table, with longer chains
+        return;
+    }
+    free(outbox->index);
+    outbox->index = index;
+    outbox->index_buckets *= 2;
+    outbox_item_handle_t item;
+    TAILQ_FOREACH(item, outbox->list, next) {
+        outbox_index_insert(outbox, item);
+    }
+}
+
+/* Removes the item from the list and the index, returns false if it is not in the outbox */
+static bool outbox_remove(outbox_handle_t outbox, outbox_item_handle_t item)
+{
+    outbox_item_t **link = outbox_index_bucket(outbox, item->msg_id);
+    while (*link && *link != item) {
+        link = &(*link)->index_next;
+    }
+    if (*link == NULL) {
+        return false;
+    }
+    *link = item->index_next;
+    TAILQ_REMOVE(outbox->list, item, next);
+    outbox->count--;
+    outbox->size -= item->len;
+    return true;
+}
+
+static void outbox_free_item(outbox_item_handle_t item)
+{
+    if (item->buffer != item->header) {
+        free(item->buffer);
+    }
+    free(item->remaining_data);
+    free(item);
+}
+
 outbox_handle_t outbox_init(void)
 {
     outbox_handle_t outbox = calloc(1, sizeof(struct outbox_t));
     ESP_MEM_CHECK(TAG, outbox, return NULL);
     outbox->list = calloc(1, sizeof(struct outbox_list_t));
-    ESP_MEM_CHECK(TAG, outbox->list, {free(outbox); return NULL;});
+    outbox->index = calloc(OUTBOX_INDEX_MIN_BUCKETS, sizeof(outbox_item_t *));
+    ESP_MEM_CHECK(TAG, outbox->list && outbox->index, {
+        free(outbox->list);
+        free(outbox->index);
+        free(outbox);
+        return NULL;
+    });
+    outbox->index_buckets = OUTBOX_INDEX_MIN_BUCKETS;
     outbox->size = 0;
-    STAILQ_INIT(outbox->list);
+    TAILQ_INIT(outbox->list);
     return outbox;
 }
 
 outbox_item_handle_t outbox_enqueue(outbox_handle_t outbox, outbox_message_handle_t message, outbox_tick_t tick)
 {
-    outbox_item_handle_t item = calloc(1, sizeof(outbox_item_t));
+    // Keep the remaining data instead of copying it if the client hands it over, the rest of the message is then
+    // only a header, allocated with the item
+    bool take_remaining = message->remaining_data && message->remaining_data_owned;
+    outbox_item_handle_t item = calloc(1, sizeof(outbox_item_t) + (take_remaining ? message->len : 0));
     ESP_MEM_CHECK(TAG, item, return NULL);
     item->msg_id = message->msg_id;
     item->msg_type = message->msg_type;
@@ -49,16 +130,27 @@ outbox_item_handle_t outbox_enqueue(outbox_handle_t outbox, outbox_message_handl
     item->tick = tick;
     item->len =  message->len + message->remaining_len;
     item->pending = QUEUED;
-    item->buffer = heap_caps_malloc(message->len + message->remaining_len, MQTT_OUTBOX_MEMORY);
-    ESP_MEM_CHECK(TAG, item->buffer, {
-        free(item);
-        return NULL;
-    });
-    memcpy(item->buffer, message->data, message->len);
-    if (message->remaining_data) {
-        memcpy(item->buffer + message->len, message->remaining_data, message->remaining_len);
+    if (take_remaining) {
+        item->buffer = item->header;
+        memcpy(item->buffer, message->data, message->len);
+        item->remaining_data = message->remaining_data;
+        item->remaining_len = message->remaining_len;
+        message->remaining_data = NULL;
+    } else {
+        item->buffer = heap_caps_malloc(message->len + message->remaining_len, MQTT_OUTBOX_MEMORY);
+        ESP_MEM_CHECK(TAG, item->buffer, {
+            free(item);
+            return NULL;
+        });
+        memcpy(item->buffer, message->data, message->len);
+        if (message->remaining_data) {
+            memcpy(item->buffer + message->len, message->remaining_data, message->remaining_len);
+        }
     }
-    STAILQ_INSERT_TAIL(outbox->list, item, next);
+    TAILQ_INSERT_TAIL(outbox->list, item, next);
+    outbox_index_insert(outbox, item);
+    outbox->count++;
+    outbox_index_grow(outbox);
     outbox->size += item->len;
     ESP_LOGD(TAG, "ENQUEUE msgid=%d, msg_type=%d, len=%d, size=%"PRIu64, message->msg_id, message->msg_type, message->len + message->remaining_len, outbox_get_size(outbox));
     return item;
@@ -67,7 +159,7 @@ outbox_item_handle_t outbox_enqueue(outbox_handle_t outbox, outbox_message_handl
 outbox_item_handle_t outbox_get(outbox_handle_t outbox, int msg_id)
 {
     outbox_item_handle_t item;
-    STAILQ_FOREACH(item, outbox->list, next) {
+    for (item = *outbox_index_bucket(outbox, msg_id); item; item = item->index_next) {
         if (item->msg_id == msg_id) {
             return item;
         }
@@ -78,7 +170,7 @@ outbox_item_handle_t outbox_get(outbox_handle_t outbox, int msg_id)
 outbox_item_handle_t outbox_dequeue(outbox_handle_t outbox, pending_state_t pending, outbox_tick_t *tick)
 {
     outbox_item_handle_t item;
-    STAILQ_FOREACH(item, outbox->list, next) {
+    TAILQ_FOREACH(item, outbox->list, next) {
         if (item->pending == pending) {
             if (tick) {
                 *tick = item->tick;
@@ -91,23 +183,17 @@ outbox_item_handle_t outbox_dequeue(outbox_handle_t outbox, pending_state_t pend
 
 esp_err_t outbox_delete_item(outbox_handle_t outbox, outbox_item_handle_t item_to_delete)
 {
-    outbox_item_handle_t item;
-    STAILQ_FOREACH(item, outbox->list, next) {
-        if (item == item_to_delete) {
-            STAILQ_REMOVE(outbox->list, item, outbox_item, next);
-            outbox->size -= item->len;
-            free(item->buffer);
-            free(item);
-            return ESP_OK;
-        }
+    if (!outbox_remove(outbox, item_to_delete)) {
+        return ESP_FAIL;
     }
-    return ESP_FAIL;
+    outbox_free_item(item_to_delete);
+    return ESP_OK;
 }
 
 uint8_t *outbox_item_get_data(outbox_item_handle_t item,  size_t *len, uint16_t *msg_id, int *msg_type, int *qos)
 {
     if (item) {
-        *len = item->len;
+        *len = item->len - item->remaining_len;
         *msg_id = item->msg_id;
         *msg_type = item->msg_type;
         *qos = item->msg_qos;
@@ -116,19 +202,25 @@ uint8_t *outbox_item_get_data(outbox_item_handle_t item,  size_t *len, uint16_t
     return NULL;
 }
 
+uint8_t *outbox_item_get_remaining_data(outbox_item_handle_t item, size_t *len)
+{
+    if (item && item->remaining_data) {
+        *len = item->remaining_len;
+        return item->remaining_data;
+    }
+    return NULL;
+}
+
 esp_err_t outbox_delete(outbox_handle_t outbox, int msg_id, int msg_type)
 {
-    outbox_item_handle_t item, tmp;
-    STAILQ_FOREACH_SAFE(item, outbox->list, next, tmp) {
+    outbox_item_handle_t item;
+    for (item = *outbox_index_bucket(outbox, msg_id); item; item = item->index_next) {
         if (item->msg_id == msg_id && (0xFF & (item->msg_type)) == msg_type) {
-            STAILQ_REMOVE(outbox->list, item, outbox_item, next);
-            outbox->size -= item->len;
-            free(item->buffer);
-            free(item);
+            outbox_remove(outbox, item);
+            outbox_free_item(item);
             ESP_LOGD(TAG, "DELETED msgid=%d, msg_type=%d, remain size=%"PRIu64, msg_id, msg_type, outbox_get_size(outbox));
             return ESP_OK;
         }
-
     }
     return ESP_FAIL;
 }
@@ -165,13 +257,11 @@ int outbox_delete_single_expired(outbox_handle_t outbox, outbox_tick_t current_t
 {
     int msg_id = -1;
     outbox_item_handle_t item;
-    STAILQ_FOREACH(item, outbox->list, next) {
+    TAILQ_FOREACH(item, outbox->list, next) {
         if (current_tick - item->tick > timeout) {
-            STAILQ_REMOVE(outbox->list, item, outbox_item, next);
-            free(item->buffer);
-            outbox->size -= item->len;
+            outbox_remove(outbox, item);
             msg_id = item->msg_id;
-            free(item);
+            outbox_free_item(item);
             return msg_id;
         }
 
@@ -183,12 +273,10 @@ int outbox_delete_expired(outbox_handle_t outbox, outbox_tick_t current_tick, ou
 {
     int deleted_items = 0;
     outbox_item_handle_t item, tmp;
-    STAILQ_FOREACH_SAFE(item, outbox->list, next, tmp) {
+    TAILQ_FOREACH_SAFE(item, outbox->list, next, tmp) {
         if (current_tick - item->tick > timeout) {
-            STAILQ_REMOVE(outbox->list, item, outbox_item, next);
-            free(item->buffer);
-            outbox->size -= item->len;
-            free(item);
+            outbox_remove(outbox, item);
+            outbox_free_item(item);
             deleted_items ++;
         }
 
@@ -204,16 +292,18 @@ uint64_t outbox_get_size(outbox_handle_t outbox)
 void outbox_delete_all_items(outbox_handle_t outbox)
 {
     outbox_item_handle_t item, tmp;
-    STAILQ_FOREACH_SAFE(item, outbox->list, next, tmp) {
-        STAILQ_REMOVE(outbox->list, item, outbox_item, next);
-        outbox->size -= item->len;
-        free(item->buffer);
-        free(item);
+    TAILQ_FOREACH_SAFE(item, outbox->list, next, tmp) {
+        outbox_free_item(item);
     }
+    TAILQ_INIT(outbox->list);
+    memset(outbox->index, 0, outbox->index_buckets * sizeof(outbox_item_t *));
+    outbox->count = 0;
+    outbox->size = 0;
 }
 void outbox_destroy(outbox_handle_t outbox)
 {
     outbox_delete_all_items(outbox);
+    free(outbox->index);
     free(outbox->list);
     free(outbox);
 }
@@ -0,0 +1,551 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "mqtt_outbox.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include "mqtt_config.h"
+#include "sys/queue.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+/*
+ * Outbox keeping the messages in a data partition, so that they survive a reboot.
+ *
+ * The partition is a log of records, written sector after sector and wrapping around at the end. A record is a header
+ * followed by the message, and never crosses a sector boundary. Deleting a message clears the `deleted` word of its
+ * record, which flash allows without erasing. A sector is erased when the log wraps around to it, which is only
+ * possible once all its records are deleted, otherwise the outbox is full.
+ *
+ * Only an index of the messages is kept in RAM, it is rebuilt by scanning the partition in outbox_init(). Records
+ * which were not completely written before a power loss fail the CRC check and are ignored, as is the rest of their
+ * sector. The restored messages are queued, to be sent again once connected.
+ */
+
+static const char *TAG = "outbox_flash";
+
+#define OUTBOX_RECORD_MAGIC     0x424f514dUL    // "MQOB"
+#define OUTBOX_ERASED_WORD      0xffffffffUL
+#define OUTBOX_ALIGN(x)         (((x) + 3) & ~3UL)
+
+// The items are indexed by msg_id in a hash table, which doubles when it holds twice as many items as buckets
+#define OUTBOX_INDEX_MIN_BUCKETS    16
+#define OUTBOX_INDEX_MAX_BUCKETS    (UINT16_MAX + 1)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;       /*!< Order of the messages in the outbox */
+    uint32_t len;       /*!< Length of the message following the header */
+    uint32_t msg_type;
+    uint16_t msg_id;
+    uint16_t msg_qos;
+    uint32_t crc;       /*!< CRC32 of the fields above and of the message */
+    uint32_t deleted;   /*!< OUTBOX_ERASED_WORD while the message is in the outbox, 0 once deleted */
+} outbox_record_t;
+
+#define OUTBOX_RECORD_CRC_LEN   offsetof(outbox_record_t, crc)
+
+typedef struct outbox_item {
+    outbox_handle_t outbox;
+    uint32_t offset;    /*!< Offset of the record in the partition */
+    uint32_t seq;
+    int len;
+    int msg_id;
+    int msg_type;
+    int msg_qos;
+    outbox_tick_t tick;
+    pending_state_t pending;
+    TAILQ_ENTRY(outbox_item) next;
+    struct outbox_item *index_next; /*!< Next item of the same hash bucket, in enqueue order */
+} outbox_item_t;
+
+TAILQ_HEAD(outbox_list_t, outbox_item);
+
+struct outbox_t {
+    _Atomic uint64_t size;
+    struct outbox_list_t list;
+    outbox_item_t **index;
+    size_t index_buckets;       /*!< Power of two */
+    size_t count;
+    const esp_partition_t *partition;
+    size_t sector_size;
+    size_t sector_count;
+    uint16_t *sector_items;     /*!< Number of messages of the outbox in each sector */
+    size_t write_sector;
+    size_t write_offset;        /*!< Offset of the next record in the write sector */
+    uint32_t seq;
+    uint8_t *write_buffer;      /*!< Record being written */
+    uint8_t *read_buffer;       /*!< Message returned by outbox_item_get_data() */
+    size_t read_buffer_len;
+};
+
+static bool s_partition_in_use;
+
+static inline outbox_item_t **outbox_index_bucket(outbox_handle_t outbox, int msg_id)
+{
+    return &outbox->index[msg_id & (outbox->index_buckets - 1)];
+}
+
+static void outbox_index_insert(outbox_handle_t outbox, outbox_item_handle_t item)
+{
+    outbox_item_t **link = outbox_index_bucket(outbox, item->msg_id);
+    while (*link) {
+        link = &(*link)->index_next;
+    }
+    item->index_next = NULL;
+    *link = item;
+}
+
+/* Adds the item at the end of the outbox */
+static void outbox_insert(outbox_handle_t outbox, outbox_item_handle_t item)
+{
+    TAILQ_INSERT_TAIL(&outbox->list, item, next);
+    outbox_index_insert(outbox, item);
+    outbox->count++;
+    outbox->size += item->len;
+    if (outbox->count < 2 * outbox->index_buckets || outbox->index_buckets >= OUTBOX_INDEX_MAX_BUCKETS) {
+        return;
+    }
+    outbox_item_t **index = calloc(2 * outbox->index_buckets, sizeof(outbox_item_t *));
+    if (index == NULL) {
+        // Keep the current table, with longer chains
+        return;
+    }
+    free(outbox->index);
+    outbox->index = index;
+    outbox->index_buckets *= 2;
+    TAILQ_FOREACH(item, &outbox->list, next) {
+        outbox_index_insert(outbox, item);
+    }
+}
+
+/* Removes the item from the list and the index, returns false if it is not in the outbox */
+static bool outbox_remove(outbox_handle_t outbox, outbox_item_handle_t item)
+{
+    outbox_item_t **link = outbox_index_bucket(outbox, item->msg_id);
+    while (*link && *link != item) {
+        link = &(*link)->index_next;
+    }
+    if (*link == NULL) {
+        return false;
+    }
+    *link = item->index_next;
+    TAILQ_REMOVE(&outbox->list, item, next);
+    outbox->count--;
+    return true;
+}
+
+static uint32_t outbox_record_crc(const outbox_record_t *record, const uint8_t *data)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)record, OUTBOX_RECORD_CRC_LEN);
+    return esp_rom_crc32_le(crc, data, record->len);
+}
+
+static int outbox_item_cmp(const void *a, const void *b)
+{
+    const outbox_item_t *item_a = *(const outbox_item_t *const *)a;
+    const outbox_item_t *item_b = *(const outbox_item_t *const *)b;
+    return (int32_t)(item_a->seq - item_b->seq);
+}
+
+static bool outbox_sector_is_erased(outbox_handle_t outbox, size_t sector, size_t offset)
+{
+    uint32_t words[32];
+    while (offset < outbox->sector_size) {
+        size_t len = MIN(sizeof(words), outbox->sector_size - offset);
+        if (esp_partition_read(outbox->partition, sector * outbox->sector_size + offset, words, len) != ESP_OK) {
+            return false;
+        }
+        for (size_t i = 0; i < len / sizeof(uint32_t); i++) {
+            if (words[i] != OUTBOX_ERASED_WORD) {
+                return false;
+            }
+        }
+        offset += len;
+    }
+    return true;
+}
+
+/*
+ * Scans the records of one sector, adds the messages to 'items' and returns the offset following the last valid
+ * record, or the sector size if the sector can not be appended to.
+ */
+static size_t outbox_scan_sector(outbox_handle_t outbox, size_t sector, outbox_item_t ***items, size_t *item_count,
+                                 uint32_t *last_seq, size_t *last_sector, bool *found)
+{
+    size_t offset = 0;
+    while (offset + sizeof(outbox_record_t) <= outbox->sector_size) {
+        outbox_record_t record;
+        uint32_t record_offset = sector * outbox->sector_size + offset;
+        if (esp_partition_read(outbox->partition, record_offset, &record, sizeof(record)) != ESP_OK) {
+            return outbox->sector_size;
+        }
+        if (record.magic == OUTBOX_ERASED_WORD) {
+            // End of the log in this sector, unless a record was interrupted before its header was written
+            return outbox_sector_is_erased(outbox, sector, offset) ? offset : outbox->sector_size;
+        }
+        if (record.magic != OUTBOX_RECORD_MAGIC || record.len > outbox->sector_size - offset - sizeof(record) ||
+                esp_partition_read(outbox->partition, record_offset + sizeof(record), outbox->write_buffer, record.len) != ESP_OK ||
+                outbox_record_crc(&record, outbox->write_buffer) != record.crc) {
+            ESP_LOGW(TAG, "Incomplete record at 0x%" PRIx32 ", ignoring the rest of the sector", record_offset);
+            return outbox->sector_size;
+        }
+        if (!*found || (int32_t)(record.seq - *last_seq) > 0) {
+            *last_seq = record.seq;
+            *last_sector = sector;
+            *found = true;
+        }
+        if (record.deleted == OUTBOX_ERASED_WORD) {
+            outbox_item_handle_t item = calloc(1, sizeof(outbox_item_t));
+            outbox_item_t **new_items = realloc(*items, (*item_count + 1) * sizeof(outbox_item_t *));
+            if (item == NULL || new_items == NULL) {
+                free(item);
+                if (new_items) {
+                    *items = new_items;
+                }
+                ESP_LOGE(TAG, "Memory exhausted, message id=%d lost", record.msg_id);
+                return outbox->sector_size;
+            }
+            item->outbox = outbox;
+            item->offset = record_offset;
+            item->seq = record.seq;
+            item->len = record.len;
+            item->msg_id = record.msg_id;
+            item->msg_type = record.msg_type;
+            item->msg_qos = record.msg_qos;
+            item->tick = platform_tick_get_ms();
+            item->pending = QUEUED;
+            new_items[(*item_count)++] = item;
+            *items = new_items;
+            outbox->sector_items[sector]++;
+        }
+        offset += OUTBOX_ALIGN(sizeof(record) + record.len);
+    }
+    return outbox->sector_size;
+}
+
+static void outbox_restore(outbox_handle_t outbox)
+{
+    outbox_item_t **items = NULL;
+    size_t item_count = 0;
+    size_t *end_offsets = calloc(outbox->sector_count, sizeof(size_t));
+    uint32_t last_seq = 0;
+    size_t last_sector = outbox->sector_count - 1;
+    bool found = false;
+
+    for (size_t sector = 0; sector < outbox->sector_count; sector++) {
+        size_t end = outbox_scan_sector(outbox, sector, &items, &item_count, &last_seq, &last_sector, &found);
+        if (end_offsets) {
+            end_offsets[sector] = end;
+        }
+    }
+    if (item_count > 0) {
+        qsort(items, item_count, sizeof(outbox_item_t *), outbox_item_cmp);
+    }
+    for (size_t i = 0; i < item_count; i++) {
+        outbox_insert(outbox, items[i]);
+    }
+    free(items);
+
+    // Append after the newest record, the first append after an empty scan moves to sector 0
+    outbox->seq = found ? last_seq + 1 : 0;
+    outbox->write_sector = last_sector;
+    outbox->write_offset = (found && end_offsets) ? end_offsets[last_sector] : outbox->sector_size;
+    free(end_offsets);
+    if (item_count > 0) {
+        ESP_LOGI(TAG, "Restored %u messages, %" PRIu64 " bytes", (unsigned)item_count, outbox_get_size(outbox));
+    }
+}
+
+outbox_handle_t outbox_init(void)
+{
+    if (s_partition_in_use) {
+        ESP_LOGE(TAG, "Partition %s is already used by another client", CONFIG_MQTT_OUTBOX_PARTITION_LABEL);
+        return NULL;
+    }
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                       CONFIG_MQTT_OUTBOX_PARTITION_LABEL);
+    if (partition == NULL || partition->size < 2 * partition->erase_size) {
+        ESP_LOGE(TAG, "Partition %s not found or smaller than two sectors", CONFIG_MQTT_OUTBOX_PARTITION_LABEL);
+        return NULL;
+    }
+    outbox_handle_t outbox = calloc(1, sizeof(struct outbox_t));
+    ESP_MEM_CHECK(TAG, outbox, return NULL);
+    outbox->partition = partition;
+    outbox->sector_size = partition->erase_size;
+    outbox->sector_count = partition->size / partition->erase_size;
+    outbox->sector_items = calloc(outbox->sector_count, sizeof(uint16_t));
+    outbox->write_buffer = malloc(outbox->sector_size);
+    outbox->index = calloc(OUTBOX_INDEX_MIN_BUCKETS, sizeof(outbox_item_t *));
+    ESP_MEM_CHECK(TAG, outbox->sector_items && outbox->write_buffer && outbox->index, {
+        free(outbox->sector_items);
+        free(outbox->write_buffer);
+        free(outbox->index);
+        free(outbox);
+        return NULL;
+    });
+    outbox->index_buckets = OUTBOX_INDEX_MIN_BUCKETS;
+    TAILQ_INIT(&outbox->list);
+    outbox_restore(outbox);
+    s_partition_in_use = true;
+    return outbox;
+}
+
+/* Returns the offset of space for a record of 'len' bytes in the partition, or -1 if the outbox is full */
+static int32_t outbox_reserve(outbox_handle_t outbox, size_t len)
+{
+    if (outbox->write_offset + len > outbox->sector_size) {
+        size_t sector = (outbox->write_sector + 1) % outbox->sector_count;
+        if (outbox->sector_items[sector] > 0) {
+            ESP_LOGE(TAG, "Outbox partition is full");
+            return -1;
+        }
+        if (esp_partition_erase_range(outbox->partition, sector * outbox->sector_size, outbox->sector_size) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to erase sector %u", (unsigned)sector);
+            return -1;
+        }
+        outbox->write_sector = sector;
+        outbox->write_offset = 0;
+    }
+    return outbox->write_sector * outbox->sector_size + outbox->write_offset;
+}
+
+outbox_item_handle_t outbox_enqueue(outbox_handle_t outbox, outbox_message_handle_t message, outbox_tick_t tick)
+{
+    size_t len = message->len + message->remaining_len;
+    size_t record_len = OUTBOX_ALIGN(sizeof(outbox_record_t) + len);
+    if (record_len > outbox->sector_size) {
+        ESP_LOGE(TAG, "Message of %u bytes does not fit in a sector", (unsigned)len);
+        return NULL;
+    }
+    outbox_item_handle_t item = calloc(1, sizeof(outbox_item_t));
+    ESP_MEM_CHECK(TAG, item, return NULL);
+    int32_t offset = outbox_reserve(outbox, record_len);
+    if (offset < 0) {
+        free(item);
+        return NULL;
+    }
+
+    outbox_record_t *record = (outbox_record_t *)outbox->write_buffer;
+    uint8_t *data = outbox->write_buffer + sizeof(outbox_record_t);
+    memcpy(data, message->data, message->len);
+    if (message->remaining_data) {
+        memcpy(data + message->len, message->remaining_data, message->remaining_len);
+    }
+    memset(data + len, 0xff, record_len - sizeof(outbox_record_t) - len);
+    *record = (outbox_record_t) {
+        .magic = OUTBOX_RECORD_MAGIC,
+        .seq = outbox->seq,
+        .len = len,
+        .msg_type = message->msg_type,
+        .msg_id = message->msg_id,
+        .msg_qos = message->msg_qos,
+        .deleted = OUTBOX_ERASED_WORD,
+    };
+    record->crc = outbox_record_crc(record, data);
+    if (esp_partition_write(outbox->partition, offset, record, record_len) != ESP_OK) {
+        // The sector may hold a partial record, don't append to it anymore
+        ESP_LOGE(TAG, "Failed to write message id=%d", message->msg_id);
+        outbox->write_offset = outbox->sector_size;
+        free(item);
+        return NULL;
+    }
+    outbox->write_offset += record_len;
+    outbox->sector_items[outbox->write_sector]++;
+    outbox->seq++;
+
+    item->outbox = outbox;
+    item->offset = offset;
+    item->seq = record->seq;
+    item->msg_id = message->msg_id;
+    item->msg_type = message->msg_type;
+    item->msg_qos = message->msg_qos;
+    item->tick = tick;
+    item->len = len;
+    item->pending = QUEUED;
+    outbox_insert(outbox, item);
+    ESP_LOGD(TAG, "ENQUEUE msgid=%d, msg_type=%d, len=%d, offset=0x%" PRIx32 ", size=%"PRIu64, message->msg_id, message->msg_type, item->len, item->offset, outbox_get_size(outbox));
+    return item;
+}
+
+outbox_item_handle_t outbox_get(outbox_handle_t outbox, int msg_id)
+{
+    outbox_item_handle_t item;
+    for (item = *outbox_index_bucket(outbox, msg_id); item; item = item->index_next) {
+        if (item->msg_id == msg_id) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+outbox_item_handle_t outbox_dequeue(outbox_handle_t outbox, pending_state_t pending, outbox_tick_t *tick)
+{
+    outbox_item_handle_t item;
+    TAILQ_FOREACH(item, &outbox->list, next) {
+        if (item->pending == pending) {
+            if (tick) {
+                *tick = item->tick;
+            }
+            return item;
+        }
+    }
+    return NULL;
+}
+
+/* Marks the record deleted, and frees the item, which must have been removed from the outbox */
+static void outbox_free_item(outbox_handle_t outbox, outbox_item_handle_t item)
+{
+    const uint32_t deleted = 0;
+    if (esp_partition_write(outbox->partition, item->offset + offsetof(outbox_record_t, deleted), &deleted, sizeof(deleted)) != ESP_OK) {
+        // The message is sent again after a reboot
+        ESP_LOGW(TAG, "Failed to mark message id=%d deleted", item->msg_id);
+    }
+    outbox->sector_items[item->offset / outbox->sector_size]--;
+    outbox->size -= item->len;
+    free(item);
+}
+
+esp_err_t outbox_delete_item(outbox_handle_t outbox, outbox_item_handle_t item_to_delete)
+{
+    if (!outbox_remove(outbox, item_to_delete)) {
+        return ESP_FAIL;
+    }
+    outbox_free_item(outbox, item_to_delete);
+    return ESP_OK;
+}
+
+uint8_t *outbox_item_get_data(outbox_item_handle_t item,  size_t *len, uint16_t *msg_id, int *msg_type, int *qos)
+{
+    if (item == NULL) {
+        return NULL;
+    }
+    // The message is read to a buffer of the outbox, valid until the next call
+    outbox_handle_t outbox = item->outbox;
+    if (outbox->read_buffer_len < (size_t)item->len) {
+        uint8_t *buffer = realloc(outbox->read_buffer, item->len);
+        ESP_MEM_CHECK(TAG, buffer, return NULL);
+        outbox->read_buffer = buffer;
+        outbox->read_buffer_len = item->len;
+    }
+    if (esp_partition_read(outbox->partition, item->offset + sizeof(outbox_record_t), outbox->read_buffer, item->len) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read message id=%d", item->msg_id);
+        return NULL;
+    }
+    *len = item->len;
+    *msg_id = item->msg_id;
+    *msg_type = item->msg_type;
+    *qos = item->msg_qos;
+    return outbox->read_buffer;
+}
+
+uint8_t *outbox_item_get_remaining_data(outbox_item_handle_t item, size_t *len)
+{
+    // The records hold whole messages
+    return NULL;
+}
+
+esp_err_t outbox_delete(outbox_handle_t outbox, int msg_id, int msg_type)
+{
+    outbox_item_handle_t item;
+    for (item = *outbox_index_bucket(outbox, msg_id); item; item = item->index_next) {
+        if (item->msg_id == msg_id && (0xFF & (item->msg_type)) == msg_type) {
+            outbox_remove(outbox, item);
+            outbox_free_item(outbox, item);
+            ESP_LOGD(TAG, "DELETED msgid=%d, msg_type=%d, remain size=%"PRIu64, msg_id, msg_type, outbox_get_size(outbox));
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t outbox_set_pending(outbox_handle_t outbox, int msg_id, pending_state_t pending)
+{
+    outbox_item_handle_t item = outbox_get(outbox, msg_id);
+    if (item) {
+        item->pending = pending;
+        return ESP_OK;
+    }
+    return ESP_FAIL;
+}
+
+pending_state_t outbox_item_get_pending(outbox_item_handle_t item)
+{
+    if (item) {
+        return item->pending;
+    }
+    return QUEUED;
+}
+
+esp_err_t outbox_set_tick(outbox_handle_t outbox, int msg_id, outbox_tick_t tick)
+{
+    outbox_item_handle_t item = outbox_get(outbox, msg_id);
+    if (item) {
+        item->tick = tick;
+        return ESP_OK;
+    }
+    return ESP_FAIL;
+}
+
+int outbox_delete_single_expired(outbox_handle_t outbox, outbox_tick_t current_tick, outbox_tick_t timeout)
+{
+    outbox_item_handle_t item;
+    TAILQ_FOREACH(item, &outbox->list, next) {
+        if (current_tick - item->tick > timeout) {
+            int msg_id = item->msg_id;
+            outbox_remove(outbox, item);
+            outbox_free_item(outbox, item);
+            return msg_id;
+        }
+    }
+    return -1;
+}
+
+int outbox_delete_expired(outbox_handle_t outbox, outbox_tick_t current_tick, outbox_tick_t timeout)
+{
+    int deleted_items = 0;
+    outbox_item_handle_t item, tmp;
+    TAILQ_FOREACH_SAFE(item, &outbox->list, next, tmp) {
+        if (current_tick - item->tick > timeout) {
+            outbox_remove(outbox, item);
+            outbox_free_item(outbox, item);
+            deleted_items ++;
+        }
+    }
+    return deleted_items;
+}
+
+uint64_t outbox_get_size(outbox_handle_t outbox)
+{
+    return outbox->size;
+}
+
+void outbox_delete_all_items(outbox_handle_t outbox)
+{
+    outbox_item_handle_t item, tmp;
+    TAILQ_FOREACH_SAFE(item, &outbox->list, next, tmp) {
+        outbox_remove(outbox, item);
+        outbox_free_item(outbox, item);
+    }
+}
+
+void outbox_destroy(outbox_handle_t outbox)
+{
+    // The messages stay in the partition, they are restored by the next outbox_init()
+    outbox_item_handle_t item, tmp;
+    TAILQ_FOREACH_SAFE(item, &outbox->list, next, tmp) {
+        free(item);
+    }
+    free(outbox->index);
+    free(outbox->sector_items);
+    free(outbox->write_buffer);
+    free(outbox->read_buffer);
+    free(outbox);
+    s_partition_in_use = false;
+}
@@ -0,0 +1,408 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "mqtt_topic_router.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+#include "esp_log.h"
+
+static const char *TAG = "mqtt_router";
+
+#define MQTT_SHARED_SUBSCRIPTION_PREFIX "$share/"
+// The literal levels are indexed in a hash table, which doubles when it holds more nodes than buckets
+#define ROUTER_INDEX_MIN_BUCKETS        16
+#define ROUTER_INDEX_MAX_BUCKETS        (1 << 16)
+
+typedef struct mqtt_topic_handler_entry {
+    esp_mqtt_topic_handler_t handler;
+    void *handler_arg;
+    struct mqtt_topic_handler_entry *next;
+} mqtt_topic_handler_entry_t;
+
+typedef struct mqtt_topic_node {
+    struct mqtt_topic_node *parent;
+    struct mqtt_topic_node *index_next;     /*!< Next node of the same hash bucket */
+    struct mqtt_topic_node *single_level;   /*!< '+' child */
+    struct mqtt_topic_node *multi_level;    /*!< '#' child, always a leaf */
+    mqtt_topic_handler_entry_t *handlers;   /*!< Handlers of the filter ending at this node */
+    size_t children;                        /*!< Number of literal children, in the index */
+    uint32_t hash;
+    size_t level_len;
+    char level[];
+} mqtt_topic_node_t;
+
+typedef struct {
+    esp_mqtt_topic_handler_t handler;       /*!< NULL once unregistered */
+    void *handler_arg;
+} mqtt_topic_match_t;
+
+struct mqtt_topic_router {
+    mqtt_topic_node_t root;
+    mqtt_topic_node_t **index;
+    size_t index_buckets;                   /*!< Power of two */
+    size_t count;                           /*!< Number of literal nodes */
+    mqtt_topic_match_t *matches;            /*!< Handlers matched by the current message */
+    size_t match_count;
+    size_t match_capacity;
+};
+
+static uint32_t router_hash(const mqtt_topic_node_t *parent, const char *level, size_t level_len)
+{
+    // FNV-1a of the parent node and the level
+    uint32_t hash = 2166136261u ^ (uint32_t)((uintptr_t)parent >> 3);
+    for (size_t i = 0; i < level_len; i++) {
+        hash = (hash ^ (uint8_t)level[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static inline mqtt_topic_node_t **router_index_bucket(mqtt_topic_router_handle_t router, uint32_t hash)
+{
+    return &router->index[hash & (router->index_buckets - 1)];
+}
+
+static mqtt_topic_node_t *router_lookup(mqtt_topic_router_handle_t router, const mqtt_topic_node_t *parent,
+                                        const char *level, size_t level_len)
+{
+    uint32_t hash = router_hash(parent, level, level_len);
+    for (mqtt_topic_node_t *node = *router_index_bucket(router, hash); node; node = node->index_next) {
+        if (node->hash == hash && node->parent == parent && node->level_len == level_len &&
+                memcmp(node->level, level, level_len) == 0) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+static void router_index_grow(mqtt_topic_router_handle_t router)
+{
+    if (router->count <= router->index_buckets || router->index_buckets >= ROUTER_INDEX_MAX_BUCKETS) {
+        return;
+    }
+    mqtt_topic_node_t **index = calloc(2 * router->index_buckets, sizeof(mqtt_topic_node_t *));
+    if (index == NULL) {
+        // Keep the current table, with longer chains
+        return;
+    }
+    mqtt_topic_node_t **old_index = router->index;
+    size_t old_buckets = router->index_buckets;
+    router->index = index;
+    router->index_buckets *= 2;
+    for (size_t i = 0; i < old_buckets; i++) {
+        mqtt_topic_node_t *node = old_index[i];
+        while (node) {
+            mqtt_topic_node_t *next = node->index_next;
+            mqtt_topic_node_t **bucket = router_index_bucket(router, node->hash);
+            node->index_next = *bucket;
+            *bucket = node;
+            node = next;
+        }
+    }
+    free(old_index);
+}
+
+static mqtt_topic_node_t *router_node_create(mqtt_topic_node_t *parent, const char *level, size_t level_len)
+{
+    mqtt_topic_node_t *node = calloc(1, sizeof(mqtt_topic_node_t) + level_len);
+    ESP_MEM_CHECK(TAG, node, return NULL);
+    node->parent = parent;
+    node->level_len = level_len;
+    memcpy(node->level, level, level_len);
+    return node;
+}
+
+/* Frees the nodes which don't lead to any handler anymore, from the node up to the root */
+static void router_prune(mqtt_topic_router_handle_t router, mqtt_topic_node_t *node)
+{
+    while (node != &router->root && node->handlers == NULL && node->children == 0 &&
+            node->single_level == NULL && node->multi_level == NULL) {
+        mqtt_topic_node_t *parent = node->parent;
+        if (parent->single_level == node) {
+            parent->single_level = NULL;
+        } else if (parent->multi_level == node) {
+            parent->multi_level = NULL;
+        } else {
+            mqtt_topic_node_t **link = router_index_bucket(router, node->hash);
+            while (*link != node) {
+                link = &(*link)->index_next;
+            }
+            *link = node->index_next;
+            parent->children--;
+            router->count--;
+        }
+        free(node);
+        node = parent;
+    }
+}
+
+/* Returns the filter without the shared subscription prefix, or NULL if it is not a valid topic filter */
+static const char *router_filter_validate(const char *filter)
+{
+    if (filter == NULL) {
+        return NULL;
+    }
+    if (strncmp(filter, MQTT_SHARED_SUBSCRIPTION_PREFIX, strlen(MQTT_SHARED_SUBSCRIPTION_PREFIX)) == 0) {
+        // $share/<group>/<filter>, the group is a single level without wildcards
+        const char *group = filter + strlen(MQTT_SHARED_SUBSCRIPTION_PREFIX);
+        size_t group_len = strcspn(group, "/+#");
+        if (group_len == 0 || group[group_len] != '/') {
+            ESP_LOGE(TAG, "Invalid shared subscription %s", filter);
+            return NULL;
+        }
+        filter = group + group_len + 1;
+    }
+    if (*filter == '\0') {
+        ESP_LOGE(TAG, "Empty topic filter");
+        return NULL;
+    }
+    for (const char *level = filter;; level++) {
+        size_t level_len = strcspn(level, "/");
+        bool wildcard = memchr(level, '+', level_len) || memchr(level, '#', level_len);
+        if (wildcard && (level_len != 1 || (level[0] == '#' && level[1] != '\0'))) {
+            ESP_LOGE(TAG, "Invalid wildcard in topic filter %s", filter);
+            return NULL;
+        }
+        level += level_len;
+        if (*level == '\0') {
+            return filter;
+        }
+    }
+}
+
+/*
+ * Returns the node of a valid filter, NULL if it is not in the trie. With create set, the missing levels
+ * are added, and on failure to allocate the deepest node which exists is returned for the caller to prune.
+ */
+static mqtt_topic_node_t *router_find(mqtt_topic_router_handle_t router, const char *filter, bool create,
+                                      esp_err_t *err)
+{
+    mqtt_topic_node_t *node = &router->root;
+    *err = ESP_OK;
+    for (const char *level = filter;; level++) {
+        size_t level_len = strcspn(level, "/");
+        mqtt_topic_node_t **wildcard = NULL;
+        if (level_len == 1 && level[0] == '+') {
+            wildcard = &node->single_level;
+        } else if (level_len == 1 && level[0] == '#') {
+            wildcard = &node->multi_level;
+        }
+        mqtt_topic_node_t *next = wildcard ? *wildcard : router_lookup(router, node, level, level_len);
+        if (next == NULL) {
+            if (!create) {
+                return NULL;
+            }
+            next = router_node_create(node, level, level_len);
+            if (next == NULL) {
+                *err = ESP_ERR_NO_MEM;
+                return node;
+            }
+            if (wildcard) {
+                *wildcard = next;
+            } else {
+                next->hash = router_hash(node, level, level_len);
+                mqtt_topic_node_t **bucket = router_index_bucket(router, next->hash);
+                next->index_next = *bucket;
+                *bucket = next;
+                node->children++;
+                router->count++;
+                router_index_grow(router);
+            }
+        }
+        node = next;
+        level += level_len;
+        if (*level == '\0') {
+            return node;
+        }
+    }
+}
+
+mqtt_topic_router_handle_t mqtt_topic_router_create(void)
+{
+    mqtt_topic_router_handle_t router = calloc(1, sizeof(struct mqtt_topic_router));
+    ESP_MEM_CHECK(TAG, router, return NULL);
+    router->index = calloc(ROUTER_INDEX_MIN_BUCKETS, sizeof(mqtt_topic_node_t *));
+    ESP_MEM_CHECK(TAG, router->index, {
+        free(router);
+        return NULL;
+    });
+    router->index_buckets = ROUTER_INDEX_MIN_BUCKETS;
+    return router;
+}
+
+esp_err_t mqtt_topic_router_add(mqtt_topic_router_handle_t router, const char *filter,
+                                esp_mqtt_topic_handler_t handler, void *handler_arg)
+{
+    filter = router_filter_validate(filter);
+    if (filter == NULL || handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err;
+    mqtt_topic_node_t *node = router_find(router, filter, true, &err);
+    if (err != ESP_OK) {
+        router_prune(router, node);
+        return err;
+    }
+    for (mqtt_topic_handler_entry_t *entry = node->handlers; entry; entry = entry->next) {
+        if (entry->handler == handler && entry->handler_arg == handler_arg) {
+            return ESP_OK;
+        }
+    }
+    mqtt_topic_handler_entry_t *entry = calloc(1, sizeof(mqtt_topic_handler_entry_t));
+    ESP_MEM_CHECK(TAG, entry, {
+        router_prune(router, node);
+        return ESP_ERR_NO_MEM;
+    });
+    entry->handler = handler;
+    entry->handler_arg = handler_arg;
+    entry->next = node->handlers;
+    node->handlers = entry;
+    return ESP_OK;
+}
+
+esp_err_t mqtt_topic_router_remove(mqtt_topic_router_handle_t router, const char *filter,
+                                   esp_mqtt_topic_handler_t handler, void *handler_arg)
+{
+    filter = router_filter_validate(filter);
+    if (filter == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err;
+    mqtt_topic_node_t *node = router_find(router, filter, false, &err);
+    mqtt_topic_handler_entry_t **link = node ? &node->handlers : NULL;
+    while (link && *link && ((*link)->handler != handler || (*link)->handler_arg != handler_arg)) {
+        link = &(*link)->next;
+    }
+    if (link == NULL || *link == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    mqtt_topic_handler_entry_t *entry = *link;
+    *link = entry->next;
+    free(entry);
+    router_prune(router, node);
+    // Don't pass the rest of the current message to a handler which is gone
+    for (size_t i = 0; i < router->match_count; i++) {
+        if (router->matches[i].handler == handler && router->matches[i].handler_arg == handler_arg) {
+            router->matches[i].handler = NULL;
+        }
+    }
+    return ESP_OK;
+}
+
+static void router_collect(mqtt_topic_router_handle_t router, const mqtt_topic_node_t *node)
+{
+    for (const mqtt_topic_handler_entry_t *entry = node->handlers; entry; entry = entry->next) {
+        size_t i = 0;
+        while (i < router->match_count && (router->matches[i].handler != entry->handler ||
+                                           router->matches[i].handler_arg != entry->handler_arg)) {
+            i++;
+        }
+        if (i < router->match_count) {
+            // Already matched by another filter
+            continue;
+        }
+        if (router->match_count == router->match_capacity) {
+            size_t capacity = router->match_capacity ? 2 * router->match_capacity : 8;
+            mqtt_topic_match_t *matches = realloc(router->matches, capacity * sizeof(mqtt_topic_match_t));
+            ESP_MEM_CHECK(TAG, matches, return);
+            router->matches = matches;
+            router->match_capacity = capacity;
+        }
+        router->matches[router->match_count].handler = entry->handler;
+        router->matches[router->match_count].handler_arg = entry->handler_arg;
+        router->match_count++;
+    }
+}
+
+/*
+ * Matches the topic from the level, NULL once all levels are consumed. Wildcards of the first level don't
+ * match the topics starting with '$' (MQTT-4.7.2-1).
+ */
+static void router_match(mqtt_topic_router_handle_t router, const mqtt_topic_node_t *node,
+                         const char *level, const char *topic_end, bool wildcards)
+{
+    if (node->multi_level && wildcards) {
+        router_collect(router, node->multi_level);
+    }
+    if (level == NULL) {
+        router_collect(router, node);
+        return;
+    }
+    const char *level_end = memchr(level, '/', topic_end - level);
+    const char *next_level = level_end ? level_end + 1 : NULL;
+    if (level_end == NULL) {
+        level_end = topic_end;
+    }
+    const mqtt_topic_node_t *child = node->children ? router_lookup(router, node, level, level_end - level) : NULL;
+    if (child) {
+        router_match(router, child, next_level, topic_end, true);
+    }
+    if (node->single_level && wildcards) {
+        router_match(router, node->single_level, next_level, topic_end, true);
+    }
+}
+
+int mqtt_topic_router_dispatch(mqtt_topic_router_handle_t router, esp_mqtt_event_handle_t event)
+{
+    if (event->current_data_offset == 0) {
+        router->match_count = 0;
+        if (event->topic && event->topic_len > 0) {
+            router_match(router, &router->root, event->topic, event->topic + event->topic_len, event->topic[0] != '$');
+        }
+    }
+    int called = 0;
+    for (size_t i = 0; i < router->match_count; i++) {
+        if (router->matches[i].handler) {
+            router->matches[i].handler(event, router->matches[i].handler_arg);
+            called++;
+        }
+    }
+    return called;
+}
+
+static void router_free_node(mqtt_topic_node_t *node)
+{
+    mqtt_topic_handler_entry_t *entry = node->handlers;
+    while (entry) {
+        mqtt_topic_handler_entry_t *next = entry->next;
+        free(entry);
+        entry = next;
+    }
+    free(node);
+}
+
+/* Frees the wildcard children of the node, the literal nodes are all freed from the index */
+static void router_free_wildcards(mqtt_topic_node_t *node)
+{
+    if (node->single_level) {
+        router_free_wildcards(node->single_level);
+        router_free_node(node->single_level);
+    }
+    if (node->multi_level) {
+        router_free_node(node->multi_level);
+    }
+}
+
+void mqtt_topic_router_destroy(mqtt_topic_router_handle_t router)
+{
+    if (router == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < router->index_buckets; i++) {
+        mqtt_topic_node_t *node = router->index[i];
+        while (node) {
+            mqtt_topic_node_t *next = node->index_next;
+            router_free_wildcards(node);
+            router_free_node(node);
+            node = next;
+        }
+    }
+    router_free_wildcards(&router->root);
+    free(router->matches);
+    free(router->index);
+    free(router);
+}
@@ -113,7 +113,7 @@ esp_err_t esp_mqtt5_get_publish_data(esp_mqtt5_client_handle_t client, uint8_t *
 
     if (property.topic_alias) {
         if (*msg_topic_len == 0) {
-            ESP_LOGI(TAG, "Publish topic is empty, use topic alias");
+            ESP_LOGD(TAG, "Publish topic is empty, use topic alias");
             *msg_topic = esp_mqtt5_client_get_topic_alias(client->mqtt5_config->peer_topic_alias, property.topic_alias, msg_topic_len);
             if (!*msg_topic) {
                 ESP_LOGE(TAG, "%s: esp_mqtt5_client_get_topic_alias() failed", __func__);
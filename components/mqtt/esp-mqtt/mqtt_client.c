@@ -42,6 +42,7 @@ static char *create_string(const char *ptr, int len);
 static int mqtt_message_receive(esp_mqtt_client_handle_t client, int read_poll_timeout_ms);
 static void esp_mqtt_client_dispatch_transport_error(esp_mqtt_client_handle_t client);
 static esp_err_t send_disconnect_msg(esp_mqtt_client_handle_t client);
+static esp_err_t esp_mqtt_flush_batch(esp_mqtt_client_handle_t client);
 
 /**
  * @brief Processes error reported from transport layer (considering the message read status)
@@ -415,6 +416,27 @@ esp_err_t esp_mqtt_set_config(esp_mqtt_client_handle_t client, const esp_mqtt_cl
     ESP_MEM_CHECK(TAG, client->mqtt_state.in_buffer, goto _mqtt_set_config_failed);
     client->mqtt_state.in_buffer_length = buffer_size;
 
+    // batching is disabled unless a batch size is set
+    int batch_size = config->buffer.batch_size > 0 ? config->buffer.batch_size : 0;
+    esp_err_t flush_err = ESP_OK;
+    if ((size_t)batch_size != client->mqtt_state.batch_buffer_size) {
+        // Don't lose the messages batched with the previous configuration
+        if (client->state == MQTT_STATE_CONNECTED && esp_mqtt_flush_batch(client) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write the batched messages, aborting connection");
+            esp_mqtt_abort_connection(client);
+            flush_err = ESP_FAIL;
+        }
+        free(client->mqtt_state.batch_buffer);
+        client->mqtt_state.batch_buffer = NULL;
+        client->mqtt_state.batch_buffer_size = 0;
+        if (batch_size > 0) {
+            client->mqtt_state.batch_buffer = (uint8_t *)malloc(batch_size);
+            ESP_MEM_CHECK(TAG, client->mqtt_state.batch_buffer, goto _mqtt_set_config_failed);
+            client->mqtt_state.batch_buffer_size = batch_size;
+        }
+    }
+    client->config->batch_timeout_ms = config->buffer.batch_timeout_ms > 0 ? config->buffer.batch_timeout_ms : MQTT_BATCH_TIMEOUT_MS;
+
     client->config->message_retransmit_timeout = config->session.message_retransmit_timeout;
     if (config->session.message_retransmit_timeout <= 0) {
         client->config->message_retransmit_timeout = MQTT_DEFAULT_RETRANSMIT_TIMEOUT_MS;
@@ -619,7 +641,7 @@ esp_err_t esp_mqtt_set_config(esp_mqtt_client_handle_t client, const esp_mqtt_cl
 
     MQTT_API_UNLOCK(client);
 
-    return config_has_conflict;
+    return flush_err != ESP_OK ? flush_err : config_has_conflict;
 _mqtt_set_config_failed:
     esp_mqtt_destroy_config(client);
     MQTT_API_UNLOCK(client);
@@ -632,6 +654,10 @@ void esp_mqtt_destroy_config(esp_mqtt_client_handle_t client)
         return;
     }
     free(client->mqtt_state.in_buffer);
+    free(client->mqtt_state.batch_buffer);
+    client->mqtt_state.batch_buffer = NULL;
+    client->mqtt_state.batch_buffer_size = 0;
+    client->mqtt_state.batch_len = 0;
     mqtt_msg_buffer_destroy(&client->mqtt_state.connection);
     free(client->config->host);
     free(client->config->uri);
@@ -697,12 +723,12 @@ static esp_err_t process_keepalive(esp_mqtt_client_handle_t client)
     return ESP_OK;
 }
 
-static inline esp_err_t esp_mqtt_write(esp_mqtt_client_handle_t client)
+static esp_err_t esp_mqtt_transport_write(esp_mqtt_client_handle_t client, const uint8_t *data, int len)
 {
-    int wlen = 0, widx = 0, len = client->mqtt_state.connection.outbound_message.length;
+    int wlen = 0, widx = 0;
     while (len > 0) {
         wlen = esp_transport_write(client->transport,
-                                   (char *)client->mqtt_state.connection.outbound_message.data + widx,
+                                   (const char *)data + widx,
                                    len,
                                    client->config->network_timeout_ms);
         if (wlen < 0) {
@@ -721,6 +747,71 @@ static inline esp_err_t esp_mqtt_write(esp_mqtt_client_handle_t client)
     return ESP_OK;
 }
 
+static esp_err_t esp_mqtt_flush_batch(esp_mqtt_client_handle_t client)
+{
+    size_t len = client->mqtt_state.batch_len;
+    if (len == 0) {
+        return ESP_OK;
+    }
+    client->mqtt_state.batch_len = 0;
+    return esp_mqtt_transport_write(client, client->mqtt_state.batch_buffer, len);
+}
+
+/*
+ * Writes the data after the batched messages, in the same transport write if it fits the batch buffer. Unless
+ * flush is set, the data may be left in the batch buffer, to be written with the following messages.
+ */
+static esp_err_t esp_mqtt_write_buffered(esp_mqtt_client_handle_t client, const uint8_t *data, int len, bool flush)
+{
+    mqtt_state_t *state = &client->mqtt_state;
+    if (state->batch_buffer == NULL || (flush && state->batch_len == 0)) {
+        return esp_mqtt_transport_write(client, data, len);
+    }
+    // The MQTT task may be waiting to read for longer than the batch timeout, if the batch was empty
+    if (state->batch_len + len > state->batch_buffer_size ||
+            (state->batch_len > 0 && has_timed_out(state->batch_tick, client->config->batch_timeout_ms))) {
+        esp_err_t err = esp_mqtt_flush_batch(client);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if ((size_t)len >= state->batch_buffer_size) {
+            return esp_mqtt_transport_write(client, data, len);
+        }
+    }
+    if (state->batch_len == 0) {
+        state->batch_tick = platform_tick_get_ms();
+    }
+    memcpy(state->batch_buffer + state->batch_len, data, len);
+    state->batch_len += len;
+    if (flush || state->batch_len == state->batch_buffer_size) {
+        return esp_mqtt_flush_batch(client);
+    }
+    return ESP_OK;
+}
+
+static inline esp_err_t esp_mqtt_write_data(esp_mqtt_client_handle_t client, const uint8_t *data, int len)
+{
+    return esp_mqtt_write_buffered(client, data, len, true);
+}
+
+/* Writes a publish message, which may be batched */
+static inline esp_err_t esp_mqtt_write_publish_data(esp_mqtt_client_handle_t client, const uint8_t *data, int len)
+{
+    return esp_mqtt_write_buffered(client, data, len, false);
+}
+
+static inline esp_err_t esp_mqtt_write(esp_mqtt_client_handle_t client)
+{
+    return esp_mqtt_write_data(client, client->mqtt_state.connection.outbound_message.data,
+                               client->mqtt_state.connection.outbound_message.length);
+}
+
+static inline esp_err_t esp_mqtt_write_publish(esp_mqtt_client_handle_t client)
+{
+    return esp_mqtt_write_publish_data(client, client->mqtt_state.connection.outbound_message.data,
+                                       client->mqtt_state.connection.outbound_message.length);
+}
+
 static esp_err_t esp_mqtt_connect(esp_mqtt_client_handle_t client, int timeout_ms)
 {
     int read_len, connect_rsp_code = 0;
@@ -823,6 +914,8 @@ static void esp_mqtt_abort_connection(esp_mqtt_client_handle_t client)
 {
     MQTT_API_LOCK(client);
     esp_transport_close(client->transport);
+    // The batched QoS 1 and 2 messages are resent from the outbox
+    client->mqtt_state.batch_len = 0;
     client->wait_timeout_ms = client->config->reconnect_timeout_ms;
     client->reconnect_tick = platform_tick_get_ms();
     client->state = MQTT_STATE_WAIT_RECONNECT;
@@ -843,6 +936,7 @@ static bool create_client_data(esp_mqtt_client_handle_t client)
 
     client->outbox = outbox_init();
     ESP_MEM_CHECK(TAG, client->outbox, return false);
+    client->mqtt_state.connection.outbox = client->outbox;
     client->status_bits = xEventGroupCreate();
     ESP_MEM_CHECK(TAG, client->status_bits, return false);
 
@@ -908,6 +1002,7 @@ esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client)
     if (client->outbox) {
         outbox_destroy(client->outbox);
     }
+    mqtt_topic_router_destroy(client->topic_router);
     if (client->status_bits) {
         vEventGroupDelete(client->status_bits);
     }
@@ -1106,6 +1201,9 @@ post_data_event:
     client->event.topic = msg_topic;
     client->event.topic_len = msg_topic_len;
     esp_mqtt_dispatch_event(client);
+    if (client->topic_router) {
+        mqtt_topic_router_dispatch(client->topic_router, &client->event);
+    }
 
     if (msg_read_len < msg_total_len) {
         size_t buf_len = client->mqtt_state.in_buffer_length;
@@ -1511,8 +1609,16 @@ static esp_err_t mqtt_resend_queued(esp_mqtt_client_handle_t client, outbox_item
         ESP_LOGD(TAG, "Sending Duplicated QoS%d message with id=%d", client->mqtt_state.pending_publish_qos, client->mqtt_state.pending_msg_id);
     }
 
-    // try to resend the data
-    if (esp_mqtt_write(client) != ESP_OK) {
+    // try to resend the data, publish messages may be batched
+    esp_err_t err = client->mqtt_state.pending_msg_type == MQTT_MSG_TYPE_PUBLISH ? esp_mqtt_write_publish(client) : esp_mqtt_write(client);
+#ifndef CONFIG_MQTT_CUSTOM_OUTBOX
+    size_t remaining_len = 0;
+    uint8_t *remaining_data = outbox_item_get_remaining_data(item, &remaining_len);
+    if (err == ESP_OK && remaining_data) {
+        err = esp_mqtt_write_publish_data(client, remaining_data, remaining_len);
+    }
+#endif
+    if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error to resend data ");
         esp_mqtt_abort_connection(client);
         return ESP_FAIL;
@@ -1664,22 +1770,25 @@ static void esp_mqtt_task(void *pv)
             // resend all non-transmitted messages first
             outbox_item_handle_t item = outbox_dequeue(client->outbox, QUEUED, NULL);
             if (item) {
-                if (mqtt_resend_queued(client, item) == ESP_OK) {
-                    if (client->mqtt_state.pending_msg_type == MQTT_MSG_TYPE_PUBLISH && client->mqtt_state.pending_publish_qos == 0) {
-                        // delete all qos0 publish messages once we process them
-                        if (outbox_delete_item(client->outbox, item) != ESP_OK) {
-                            ESP_LOGE(TAG, "Failed to remove queued qos0 message from the outbox");
+                do {
+                    if (mqtt_resend_queued(client, item) == ESP_OK) {
+                        if (client->mqtt_state.pending_msg_type == MQTT_MSG_TYPE_PUBLISH && client->mqtt_state.pending_publish_qos == 0) {
+                            // delete all qos0 publish messages once we process them
+                            if (outbox_delete_item(client->outbox, item) != ESP_OK) {
+                                ESP_LOGE(TAG, "Failed to remove queued qos0 message from the outbox");
+                            }
                         }
-                    }
-                    if (client->mqtt_state.pending_publish_qos > 0) {
-                        outbox_set_pending(client->outbox, client->mqtt_state.pending_msg_id, TRANSMITTED);
+                        if (client->mqtt_state.pending_publish_qos > 0) {
+                            outbox_set_pending(client->outbox, client->mqtt_state.pending_msg_id, TRANSMITTED);
 #ifdef MQTT_PROTOCOL_5
-                        if (client->mqtt_state.connection.information.protocol_ver == MQTT_PROTOCOL_V_5) {
-                            esp_mqtt5_increment_packet_counter(client);
-                        }
+                            if (client->mqtt_state.connection.information.protocol_ver == MQTT_PROTOCOL_V_5) {
+                                esp_mqtt5_increment_packet_counter(client);
+                            }
 #endif
+                        }
                     }
-                }
+                    // keep adding the queued messages to the batch until it is written
+                } while (client->mqtt_state.batch_len > 0 && (item = outbox_dequeue(client->outbox, QUEUED, NULL)) != NULL);
                 // resend other "transmitted" messages after 1s
             } else if (has_timed_out(last_retransmit, client->config->message_retransmit_timeout)) {
                 last_retransmit = platform_tick_get_ms();
@@ -1695,6 +1804,14 @@ static void esp_mqtt_task(void *pv)
                 }
             }
 
+            if (client->mqtt_state.batch_len > 0 &&
+                    has_timed_out(client->mqtt_state.batch_tick, client->config->batch_timeout_ms)) {
+                if (esp_mqtt_flush_batch(client) != ESP_OK) {
+                    esp_mqtt_abort_connection(client);
+                    break;
+                }
+            }
+
             if (process_keepalive(client) != ESP_OK) {
                 break;
             }
@@ -1733,7 +1850,10 @@ static void esp_mqtt_task(void *pv)
         }
         MQTT_API_UNLOCK(client);
         if (MQTT_STATE_CONNECTED == client->state) {
-            if (esp_transport_poll_read(client->transport, max_poll_timeout(client, MQTT_POLL_READ_TIMEOUT_MS)) < 0) {
+            // wake up in time to write the batched messages, if there are any
+            int poll_timeout = client->mqtt_state.batch_len > 0 && client->config->batch_timeout_ms < MQTT_POLL_READ_TIMEOUT_MS ?
+                               client->config->batch_timeout_ms : MQTT_POLL_READ_TIMEOUT_MS;
+            if (esp_transport_poll_read(client->transport, max_poll_timeout(client, poll_timeout)) < 0) {
                 ESP_LOGE(TAG, "Poll read error: %d, aborting connection", errno);
                 esp_mqtt_abort_connection(client);
             }
@@ -1741,7 +1861,10 @@ static void esp_mqtt_task(void *pv)
 
     }
     esp_transport_close(client->transport);
+#ifndef CONFIG_MQTT_OUTBOX_PERSISTENT
+    // A persistent outbox keeps its messages until the client is started again, or after a reboot
     outbox_delete_all_items(client->outbox);
+#endif
     xEventGroupSetBits(client->status_bits, STOPPED_BIT);
     client->state = MQTT_STATE_DISCONNECTED;
 
@@ -2131,7 +2254,7 @@ MQTT_API_LOCK(client);
 
     while (sending)  {
 
-        if (esp_mqtt_write(client) != ESP_OK) {
+        if (esp_mqtt_write_publish(client) != ESP_OK) {
             esp_mqtt_abort_connection(client);
             ret = -1;
             goto cannot_publish;
@@ -2181,6 +2304,135 @@ cannot_publish:
     return ret;
 }
 
+int esp_mqtt_client_publish_zero_copy(esp_mqtt_client_handle_t client, const char *topic, char *data, int len, int qos, int retain)
+{
+    if (!client) {
+        ESP_LOGE(TAG, "Client was not initialized");
+        free(data);
+        return -1;
+    }
+#if MQTT_SKIP_PUBLISH_IF_DISCONNECTED
+    if (client->state != MQTT_STATE_CONNECTED) {
+        ESP_LOGI(TAG, "Publishing skipped: client is not connected");
+        free(data);
+        return -1;
+    }
+#endif
+    if (len <= 0 && data != NULL) {
+        len = strlen(data);
+    }
+
+    MQTT_API_LOCK(client);
+    int ret = -1;
+    bool data_owned = true;
+#ifdef MQTT_PROTOCOL_5
+    if (client->mqtt_state.connection.information.protocol_ver == MQTT_PROTOCOL_V_5) {
+        if (esp_mqtt5_client_publish_check(client, qos, retain) != ESP_OK) {
+            ESP_LOGI(TAG, "MQTT5 publish check fail");
+            goto exit;
+        }
+    }
+#endif
+    if (client->config->outbox_limit > 0 && qos > 0) {
+        if (len + outbox_get_size(client->outbox) > client->config->outbox_limit) {
+            ret = -2;
+            goto exit;
+        }
+    }
+
+    // Only the header is created in the connection buffer, the payload is written from the buffer of the user
+    uint16_t pending_msg_id = 0;
+    if (client->mqtt_state.connection.information.protocol_ver == MQTT_PROTOCOL_V_5) {
+#ifdef MQTT_PROTOCOL_5
+        mqtt5_msg_publish_header(&client->mqtt_state.connection, topic, len, qos, retain, &pending_msg_id,
+                                 client->mqtt5_config->publish_property_info, client->mqtt5_config->server_resp_property_info.response_info);
+        if (client->mqtt_state.connection.outbound_message.length) {
+            client->mqtt5_config->publish_property_info = NULL;
+        }
+#endif
+    } else {
+        mqtt_msg_publish_header(&client->mqtt_state.connection, topic, len, qos, retain, &pending_msg_id);
+    }
+    client->mqtt_state.connection.outbound_message.fragmented_msg_data_offset = 0;
+    client->mqtt_state.connection.outbound_message.fragmented_msg_total_length = 0;
+    if (client->mqtt_state.connection.outbound_message.length == 0) {
+        ESP_LOGE(TAG, "Publish message cannot be created");
+        goto exit;
+    }
+
+    if (qos > 0) {
+        client->mqtt_state.pending_msg_type = MQTT_MSG_TYPE_PUBLISH;
+        client->mqtt_state.pending_msg_id = pending_msg_id;
+        client->mqtt_state.pending_publish_qos = qos;
+        outbox_message_t msg = {
+            .data = client->mqtt_state.connection.outbound_message.data,
+            .len = client->mqtt_state.connection.outbound_message.length,
+            .msg_id = pending_msg_id,
+            .msg_type = MQTT_MSG_TYPE_PUBLISH,
+            .msg_qos = qos,
+            .remaining_data = (uint8_t *)data,
+            .remaining_len = len,
+            .remaining_data_owned = true,
+        };
+        if (outbox_enqueue(client->outbox, &msg, platform_tick_get_ms()) == NULL) {
+            goto exit;
+        }
+        // The outbox frees the payload with the message if it took it over, it stays valid while the client is locked
+        data_owned = msg.remaining_data != NULL;
+    }
+
+    /* Skip sending if not connected (rely on resending) */
+    if (client->state != MQTT_STATE_CONNECTED) {
+        ESP_LOGD(TAG, "Publish: client is not connected");
+        if (qos > 0) {
+            ret = pending_msg_id;
+        } else {
+            ESP_LOGW(TAG, "Publish: Losing qos0 data when client not connected");
+        }
+        mqtt_delete_expired_messages(client);
+        goto exit;
+    }
+
+    if (esp_mqtt_write_publish(client) != ESP_OK || esp_mqtt_write_publish_data(client, (const uint8_t *)data, len) != ESP_OK) {
+        esp_mqtt_abort_connection(client);
+        goto exit;
+    }
+
+    if (qos > 0) {
+#ifdef MQTT_PROTOCOL_5
+        if (client->mqtt_state.connection.information.protocol_ver == MQTT_PROTOCOL_V_5) {
+            esp_mqtt5_increment_packet_counter(client);
+        }
+#endif
+        outbox_set_tick(client->outbox, pending_msg_id, platform_tick_get_ms());
+        outbox_set_pending(client->outbox, pending_msg_id, TRANSMITTED);
+    }
+    ret = pending_msg_id;
+
+exit:
+    if (data_owned) {
+        free(data);
+    }
+    MQTT_API_UNLOCK(client);
+    return ret;
+}
+
+esp_err_t esp_mqtt_client_flush(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        ESP_LOGE(TAG, "Client was not initialized");
+        return ESP_ERR_INVALID_ARG;
+    }
+    MQTT_API_LOCK(client);
+    esp_err_t err = ESP_OK;
+    if (client->state == MQTT_STATE_CONNECTED && esp_mqtt_flush_batch(client) != ESP_OK) {
+        esp_mqtt_abort_connection(client);
+        err = ESP_FAIL;
+    }
+    MQTT_API_UNLOCK(client);
+    return err;
+}
+
 int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char *topic, const char *data, int len, int qos, int retain, bool store)
 {
     if (!client) {
@@ -2251,6 +2503,38 @@ esp_err_t esp_mqtt_client_unregister_event(esp_mqtt_client_handle_t client, esp_
 #endif
 }
 
+esp_err_t esp_mqtt_client_register_topic_handler(esp_mqtt_client_handle_t client, const char *topic_filter,
+        esp_mqtt_topic_handler_t handler, void *handler_arg)
+{
+    if (client == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    MQTT_API_LOCK(client);
+    if (client->topic_router == NULL) {
+        client->topic_router = mqtt_topic_router_create();
+        if (client->topic_router == NULL) {
+            MQTT_API_UNLOCK(client);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    esp_err_t ret = mqtt_topic_router_add(client->topic_router, topic_filter, handler, handler_arg);
+    MQTT_API_UNLOCK(client);
+    return ret;
+}
+
+esp_err_t esp_mqtt_client_unregister_topic_handler(esp_mqtt_client_handle_t client, const char *topic_filter,
+        esp_mqtt_topic_handler_t handler, void *handler_arg)
+{
+    if (client == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    MQTT_API_LOCK(client);
+    esp_err_t ret = client->topic_router ?
+                    mqtt_topic_router_remove(client->topic_router, topic_filter, handler, handler_arg) : ESP_ERR_NOT_FOUND;
+    MQTT_API_UNLOCK(client);
+    return ret;
+}
+
 static void esp_mqtt_client_dispatch_transport_error(esp_mqtt_client_handle_t client)
 {
     client->event.event_id = MQTT_EVENT_ERROR;
@@ -7,6 +7,7 @@
 #include "esp_private/partition_linux.h"
 #include "nvs.h"
 #include <random>
+#include <vector>
 #include <fcntl.h>
 #include <unistd.h>
 #include "esp_partition.h"
@@ -120,7 +121,9 @@ public:
 
         esp_partition_file_mmap_ctrl_t *p_ctrl = esp_partition_get_file_mmap_ctrl_act();
         REQUIRE(p_ctrl != nullptr);
-        std::generate_n(p_part_desc_addr_start, p_ctrl->flash_file_size, gen);
+        std::vector<uint8_t> contents(p_ctrl->flash_file_size);
+        std::generate(contents.begin(), contents.end(), gen);
+        REQUIRE(esp_partition_file_overwrite(0, contents.data(), contents.size()) == ESP_OK);
     }
 
     // absolute sectorNumber is used here
@@ -371,6 +371,47 @@ TEST_CASE("can write one item a thousand times", "[nvs]")
     s_perf << "Time to write one item a thousand times: " << esp_partition_get_total_time() << " us (" << esp_partition_get_erase_ops() << " " << esp_partition_get_write_ops() << " " << esp_partition_get_read_ops() << " " << esp_partition_get_write_bytes() << " " << esp_partition_get_read_bytes() << ")" << std::endl;
 }
 
+TEST_CASE("Page reads and marks variable length data entries in one batch", "[nvs]")
+{
+    PartitionEmulationFixture f;
+    nvs::Page page;
+    TEST_ESP_OK(page.load(f.part(), 0));
+
+    // 31 full data entries and one partially used entry
+    const size_t size = 31 * nvs::Page::ENTRY_SIZE + 7;
+    uint8_t data[size];
+    uint8_t buf[size];
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<uint8_t>(i * 13);
+    }
+    // data entry count which is an exact multiple of the entry size
+    uint8_t aligned[4 * nvs::Page::ENTRY_SIZE];
+    fill_n(aligned, sizeof(aligned), 0x5a);
+    // initialize the page
+    TEST_ESP_OK(page.writeItem(1, "stuff", 1));
+
+    esp_partition_clear_stats();
+    TEST_ESP_OK(page.writeItem(1, nvs::ItemType::BLOB, "blob", data, size));
+    const size_t write_ops = esp_partition_get_write_ops();
+    TEST_ESP_OK(page.writeItem(1, nvs::ItemType::BLOB, "aligned", aligned, sizeof(aligned)));
+
+    esp_partition_clear_stats();
+    TEST_ESP_OK(page.readItem(1, nvs::ItemType::BLOB, "blob", buf, sizeof(buf)));
+    const size_t read_ops = esp_partition_get_read_ops();
+    CHECK(memcmp(buf, data, size) == 0);
+
+    fill_n(buf, sizeof(buf), 0xff);
+    TEST_ESP_OK(page.readItem(1, nvs::ItemType::BLOB, "aligned", buf, sizeof(aligned)));
+    CHECK(memcmp(buf, aligned, sizeof(aligned)) == 0);
+
+    s_perf << "Ops to write and read a " << size << " B blob: " << write_ops << " W " << read_ops << " R" << std::endl;
+    // header, data and tail entries are written and marked separately, states of all data entries
+    // spanning three words of the entry table are written in one batch
+    CHECK(write_ops == 6);
+    // header lookup, data entries
+    CHECK(read_ops == 2);
+}
+
 TEST_CASE("storage doesn't add duplicates within multiple pages", "[nvs]")
 {
     PartitionEmulationFixture f(0, 8);
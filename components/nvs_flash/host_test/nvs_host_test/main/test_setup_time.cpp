@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <catch2/catch_test_case_info.hpp>
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <cstdio>
+#include "esp_private/partition_linux.h"
+
+// Reports the time each test case spends setting up the emulated flash
+class FlashSetupTimeListener : public Catch::EventListenerBase {
+public:
+    using Catch::EventListenerBase::EventListenerBase;
+
+    void testCaseStarting(Catch::TestCaseInfo const &) override
+    {
+        setup_time_at_start = esp_partition_file_get_setup_time();
+    }
+
+    void testCaseEnded(Catch::TestCaseStats const &stats) override
+    {
+        int64_t setup_time = esp_partition_file_get_setup_time() - setup_time_at_start;
+        if (setup_time > 0) {
+            printf("%s: flash emulation set up in %lld us\n", stats.testInfo->name.c_str(), (long long) setup_time);
+        }
+    }
+
+private:
+    int64_t setup_time_at_start = 0;
+};
+
+CATCH_REGISTER_LISTENER(FlashSetupTimeListener)
@@ -82,16 +82,14 @@ public:
     // writes block of data to the offset relative to the beginning of partition
     esp_err_t write_raw(const size_t dst_offset, const void* src, size_t size)
     {
-        // instead of esp_partition_write_raw we will write directly to the mapped memory as some of our write
+        // instead of esp_partition_write_raw we will overwrite the emulated flash as some of our write
         // operations are actually simulating wrong flash behaviour and linux emulator prevents usto do invalid flash operations
-        // mapped memory base: p_part_desc_addr_start
         // partition begin offset: esp_partition.address
         // partition size esp_partition.size
 
         if((dst_offset + size) > esp_partition.size) return ESP_ERR_INVALID_SIZE;
 
-        memcpy(p_part_desc_addr_start + esp_partition.address + dst_offset, src, size);
-        return ESP_OK;
+        return esp_partition_file_overwrite(esp_partition.address + dst_offset, src, size);
     }
 
     // dumps content of memory at  given dst_offset and of the size to the console
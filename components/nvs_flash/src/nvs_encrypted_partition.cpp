@@ -62,6 +62,41 @@ esp_err_t NVSEncryptedPartition::read(size_t src_offset, void* dst, size_t size)
     return ESP_OK;
 }
 
+esp_err_t NVSEncryptedPartition::readv(const esp_partition_read_vec_t* vec, size_t count)
+{
+    // data are encrypted per entry, so segments have to consist of whole entries
+    for (size_t i = 0; i < count; i++) {
+        if (vec[i].size % sizeof(Item) != 0) return ESP_ERR_INVALID_SIZE;
+    }
+
+    // read data of all segments at once
+    esp_err_t read_result = esp_partition_readv(mESPPartition, vec, count);
+    if (read_result != ESP_OK) {
+        return read_result;
+    }
+
+    // decrypt data entry by entry
+    uint8_t data_unit[16];
+
+    memset(data_unit, 0, sizeof(data_unit));
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *destination = reinterpret_cast<uint8_t*>(vec[i].dst);
+
+        for (size_t offset = 0; offset < vec[i].size; offset += sizeof(Item)) {
+            uint32_t relAddr = vec[i].offset + offset;
+
+            memcpy(data_unit, &relAddr, sizeof(relAddr));
+
+            if (mbedtls_aes_crypt_xts(&mDctxt, MBEDTLS_AES_DECRYPT, sizeof(Item), data_unit, destination + offset, destination + offset) != 0)  {
+                return ESP_ERR_NVS_XTS_DECR_FAILED;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
 esp_err_t NVSEncryptedPartition::write(size_t addr, const void* src, size_t size)
 {
     if (size % ESP_ENCRYPT_BLOCK_SIZE != 0) return ESP_ERR_INVALID_SIZE;
@@ -33,6 +33,8 @@ public:
 
     esp_err_t write(size_t dst_offset, const void* src, size_t size) override;
 
+    esp_err_t readv(const esp_partition_read_vec_t* vec, size_t count) override;
+
 protected:
     mbedtls_aes_xts_context mEctxt;
     mbedtls_aes_xts_context mDctxt;
@@ -277,19 +277,41 @@ esp_err_t Page::readItem(uint8_t nsIndex, ItemType datatype, const char* key, vo
         return ESP_ERR_NVS_INVALID_LENGTH;
     }
 
+    // Data entries are read in one batch, whole entries directly into the destination buffer
+    // and the last partially used entry through a temporary item
     uint8_t* dst = reinterpret_cast<uint8_t*>(data);
-    size_t left = item.varLength.dataSize;
-    for (size_t i = index + 1; i < index + item.span; ++i) {
-        Item ditem;
-        rc = readEntry(i, ditem);
+    const size_t left = item.varLength.dataSize;
+    const size_t dataEntries = item.span - 1;
+    const size_t fullEntries = std::min(left / ENTRY_SIZE, dataEntries);
+    const size_t tailSize = (fullEntries < dataEntries) ? std::min(left - fullEntries * ENTRY_SIZE, ENTRY_SIZE) : 0;
+    const size_t readEntries = fullEntries + (tailSize > 0 ? 1 : 0);
+    if (readEntries > 0) {
+        uint32_t phyAddr;
+        uint32_t lastAddr;
+        rc = getEntryAddress(index + 1, &phyAddr);
+        if (rc == ESP_OK) {
+            rc = getEntryAddress(index + readEntries, &lastAddr);
+        }
         if (rc != ESP_OK) {
             return rc;
         }
-        size_t willCopy = ENTRY_SIZE;
-        willCopy = (left < willCopy) ? left : willCopy;
-        memcpy(dst, ditem.rawData, willCopy);
-        left -= willCopy;
-        dst += willCopy;
+
+        Item tail;
+        esp_partition_read_vec_t vec[2];
+        size_t vecCount = 0;
+        if (fullEntries > 0) {
+            vec[vecCount++] = {phyAddr, dst, fullEntries * ENTRY_SIZE};
+        }
+        if (tailSize > 0) {
+            vec[vecCount++] = {lastAddr, &tail, ENTRY_SIZE};
+        }
+        rc = mPartition->readv(vec, vecCount);
+        if (rc != ESP_OK) {
+            return rc;
+        }
+        if (tailSize > 0) {
+            memcpy(dst + fullEntries * ENTRY_SIZE, tail.rawData, tailSize);
+        }
     }
     if (Item::calculateCrc32(reinterpret_cast<uint8_t * >(data), item.varLength.dataSize) != item.varLength.dataCrc32) {
         rc = eraseEntryAndSpan(index);
@@ -812,8 +834,14 @@ esp_err_t Page::alterEntryRangeState(size_t begin, size_t end, EntryState state)
     NVS_ASSERT_OR_RETURN(end > begin, ESP_FAIL);
     size_t wordIndex = mEntryTable.getWordIndex(end - 1);
     esp_err_t err;
+    // Changed words are written in one batch, from the last entry towards the first one.
+    // The entry table in RAM is only updated once the whole batch is written.
+    TEntryTable entryTable = mEntryTable;
+    uint32_t words[TEntryTable::byteSize() / 4];
+    esp_partition_write_vec_t vec[TEntryTable::byteSize() / 4];
+    size_t vecCount = 0;
     for (ptrdiff_t i = end - 1; i >= static_cast<ptrdiff_t>(begin); --i) {
-        err = mEntryTable.set(i, state);
+        err = entryTable.set(i, state);
         if (err != ESP_OK) {
             return err;
         }
@@ -821,18 +849,22 @@ esp_err_t Page::alterEntryRangeState(size_t begin, size_t end, EntryState state)
         if (i == static_cast<ptrdiff_t>(begin)) {
             nextWordIndex = (size_t) -1;
         } else {
-            nextWordIndex = mEntryTable.getWordIndex(i - 1);
+            nextWordIndex = entryTable.getWordIndex(i - 1);
         }
         if (nextWordIndex != wordIndex) {
-            uint32_t word = mEntryTable.data()[wordIndex];
-            auto rc = mPartition->write_raw(mBaseAddress + ENTRY_TABLE_OFFSET + static_cast<uint32_t>(wordIndex) * 4,
-                                            &word, 4);
-            if (rc != ESP_OK) {
-                return rc;
-            }
+            words[vecCount] = entryTable.data()[wordIndex];
+            vec[vecCount] = {mBaseAddress + ENTRY_TABLE_OFFSET + static_cast<uint32_t>(wordIndex) * 4, &words[vecCount], 4};
+            ++vecCount;
         }
         wordIndex = nextWordIndex;
     }
+    err = mPartition->writev_raw(vec, vecCount);
+    if (err != ESP_OK) {
+        // Part of the batch may have been written, the entry table on flash is unknown
+        mState = PageState::INVALID;
+        return err;
+    }
+    mEntryTable = entryTable;
     return ESP_OK;
 }
 
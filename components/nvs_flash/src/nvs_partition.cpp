@@ -56,6 +56,33 @@ esp_err_t NVSPartition::erase_range(size_t dst_offset, size_t size)
     return esp_partition_erase_range(mESPPartition, dst_offset, size);
 }
 
+esp_err_t NVSPartition::readv(const esp_partition_read_vec_t* vec, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (vec[i].size % ESP_ENCRYPT_BLOCK_SIZE != 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    return esp_partition_readv(mESPPartition, vec, count);
+}
+
+esp_err_t NVSPartition::writev_raw(const esp_partition_write_vec_t* vec, size_t count)
+{
+    // esp_partition_writev encrypts the data on flash encrypted partitions, write them one by one as is
+    if (mESPPartition->encrypted) {
+        for (size_t i = 0; i < count; i++) {
+            esp_err_t err = esp_partition_write_raw(mESPPartition, vec[i].offset, vec[i].src, vec[i].size);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        return ESP_OK;
+    }
+
+    return esp_partition_writev(mESPPartition, vec, count);
+}
+
 uint32_t NVSPartition::get_address()
 {
     return mESPPartition->address;
@@ -89,6 +89,25 @@ public:
      */
     esp_err_t erase_range(size_t dst_offset, size_t size) override;
 
+    /**
+     * Look into \c esp_partition_readv for more details.
+     *
+     * @return
+     *      - ESP_OK on success
+     *      - ESP_ERR_INVALID_ARG if size of any segment isn't a multiple of ESP_ENCRYPT_BLOCK_SIZE
+     *      - other error codes from the esp_partition API
+     */
+    esp_err_t readv(const esp_partition_read_vec_t* vec, size_t count) override;
+
+    /**
+     * Look into \c esp_partition_writev for more details.
+     *
+     * @return
+     *      - ESP_OK on success
+     *      - error codes from the esp_partition API
+     */
+    esp_err_t writev_raw(const esp_partition_write_vec_t* vec, size_t count) override;
+
     /**
      * @return the base address of the partition.
      */
@@ -8,6 +8,7 @@
 #define PARTITION_HPP_
 
 #include "esp_err.h"
+#include "esp_partition.h"
 
 namespace nvs {
 
@@ -35,6 +36,17 @@ public:
 
     virtual esp_err_t erase_range(size_t dst_offset, size_t size) = 0;
 
+    /**
+     * Read several segments in one batch, each segment is transformed like by read().
+     */
+    virtual esp_err_t readv(const esp_partition_read_vec_t* vec, size_t count) = 0;
+
+    /**
+     * Write several segments in one batch and in the array order, without any transformation
+     * like write_raw().
+     */
+    virtual esp_err_t writev_raw(const esp_partition_write_vec_t* vec, size_t count) = 0;
+
     /**
      * Return the address of the beginning of the partition.
      */
@@ -83,6 +83,8 @@ static time_t vfs_spiffs_get_mtime(const spiffs_stat* s);
 
 static esp_spiffs_t * _efs[CONFIG_SPIFFS_MAX_PARTITIONS];
 
+static void esp_spiffs_gc_task_stop_internal(esp_spiffs_t * efs);
+
 static void esp_spiffs_free(esp_spiffs_t ** efs)
 {
     esp_spiffs_t * e = *efs;
@@ -91,6 +93,10 @@ static void esp_spiffs_free(esp_spiffs_t ** efs)
     }
     *efs = NULL;
 
+    if (e->gc_task) {
+        esp_spiffs_gc_task_stop_internal(e);
+    }
+
     if (e->fs) {
         SPIFFS_unmount(e->fs);
         free(e->fs);
@@ -399,6 +405,104 @@ esp_err_t esp_spiffs_gc(const char* partition_label, size_t size_to_gc)
     return ESP_OK;
 }
 
+static inline void vfs_spiffs_io_begin(esp_spiffs_t * efs)
+{
+    atomic_fetch_add(&efs->io_active, 1);
+}
+
+static inline void vfs_spiffs_io_end(esp_spiffs_t * efs)
+{
+    efs->io_last_tick = xTaskGetTickCount();
+    atomic_fetch_sub(&efs->io_active, 1);
+}
+
+static bool esp_spiffs_gc_task_may_run(esp_spiffs_t * efs)
+{
+    if (atomic_load(&efs->io_active) != 0) {
+        return false;
+    }
+    return (xTaskGetTickCount() - efs->io_last_tick) >= pdMS_TO_TICKS(efs->gc_cfg.idle_ms);
+}
+
+static void esp_spiffs_gc_task(void* arg)
+{
+    esp_spiffs_t * efs = (esp_spiffs_t *)arg;
+    const esp_spiffs_gc_task_config_t * cfg = &efs->gc_cfg;
+
+    while (!efs->gc_task_stop) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(cfg->period_ms));
+
+        TickType_t start = xTaskGetTickCount();
+        uint32_t erases = 0;
+        while (!efs->gc_task_stop && erases < cfg->max_erases_per_period
+                && (xTaskGetTickCount() - start) < pdMS_TO_TICKS(cfg->max_busy_ms_per_period)
+                && esp_spiffs_gc_task_may_run(efs)) {
+            s32_t res = spiffs_api_gc_step(efs->fs, cfg->target_free_blocks);
+            if (res < 0 && res != SPIFFS_ERR_NOT_MOUNTED) {
+                ESP_LOGW(TAG, "background GC failed, %" PRId32, res);
+            }
+            if (res <= 0) {
+                break;
+            }
+            erases++;
+        }
+    }
+
+    xSemaphoreGive(efs->gc_task_done);
+    vTaskDelete(NULL);
+}
+
+static void esp_spiffs_gc_task_stop_internal(esp_spiffs_t * efs)
+{
+    efs->gc_task_stop = true;
+    xTaskNotifyGive(efs->gc_task);
+    xSemaphoreTake(efs->gc_task_done, portMAX_DELAY);
+    vSemaphoreDelete(efs->gc_task_done);
+    efs->gc_task_done = NULL;
+    efs->gc_task = NULL;
+}
+
+esp_err_t esp_spiffs_gc_task_start(const char* partition_label, const esp_spiffs_gc_task_config_t *config)
+{
+    if (config == NULL || config->target_free_blocks == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int index;
+    if (esp_spiffs_by_label(partition_label, &index) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_spiffs_t * efs = _efs[index];
+    if (efs->gc_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    efs->gc_cfg = *config;
+    efs->gc_task_stop = false;
+    efs->gc_task_done = xSemaphoreCreateBinary();
+    if (efs->gc_task_done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(esp_spiffs_gc_task, "spiffs_gc", config->task_stack_size, efs,
+                    config->task_priority, &efs->gc_task) != pdPASS) {
+        ESP_LOGE(TAG, "GC task could not be created");
+        vSemaphoreDelete(efs->gc_task_done);
+        efs->gc_task_done = NULL;
+        efs->gc_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_spiffs_gc_task_stop(const char* partition_label)
+{
+    int index;
+    if (esp_spiffs_by_label(partition_label, &index) != ESP_OK || _efs[index]->gc_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_spiffs_gc_task_stop_internal(_efs[index]);
+    return ESP_OK;
+}
+
 #ifdef CONFIG_VFS_SUPPORT_DIR
 static const esp_vfs_dir_ops_t s_vfs_spiffs_dir = {
     .stat_p = &vfs_spiffs_stat,
@@ -543,7 +647,9 @@ static int vfs_spiffs_open(void* ctx, const char * path, int flags, int mode)
     assert(path);
     esp_spiffs_t * efs = (esp_spiffs_t *)ctx;
     int spiffs_flags = spiffs_mode_conv(flags);
+    vfs_spiffs_io_begin(efs);
     int fd = SPIFFS_open(efs->fs, path, spiffs_flags, mode);
+    vfs_spiffs_io_end(efs);
     if (fd < 0) {
         errno = spiffs_res_to_errno(SPIFFS_errno(efs->fs));
         SPIFFS_clearerr(efs->fs);
@@ -558,7 +664,9 @@ static int vfs_spiffs_open(void* ctx, const char * path, int flags, int mode)
 static ssize_t vfs_spiffs_write(void* ctx, int fd, const void * data, size_t size)
 {
     esp_spiffs_t * efs = (esp_spiffs_t *)ctx;
+    vfs_spiffs_io_begin(efs);
     ssize_t res = SPIFFS_write(efs->fs, fd, (void *)data, size);
+    vfs_spiffs_io_end(efs);
     if (res < 0) {
         errno = spiffs_res_to_errno(SPIFFS_errno(efs->fs));
         SPIFFS_clearerr(efs->fs);
@@ -570,7 +678,9 @@ static ssize_t vfs_spiffs_write(void* ctx, int fd, const void * data, size_t siz
 static ssize_t vfs_spiffs_read(void* ctx, int fd, void * dst, size_t size)
 {
     esp_spiffs_t * efs = (esp_spiffs_t *)ctx;
+    vfs_spiffs_io_begin(efs);
     ssize_t res = SPIFFS_read(efs->fs, fd, dst, size);
+    vfs_spiffs_io_end(efs);
     if (res < 0) {
         errno = spiffs_res_to_errno(SPIFFS_errno(efs->fs));
         SPIFFS_clearerr(efs->fs);
@@ -582,7 +692,9 @@ static ssize_t vfs_spiffs_read(void* ctx, int fd, void * dst, size_t size)
 static int vfs_spiffs_close(void* ctx, int fd)
 {
     esp_spiffs_t * efs = (esp_spiffs_t *)ctx;
+    vfs_spiffs_io_begin(efs);
     int res = SPIFFS_close(efs->fs, fd);
+    vfs_spiffs_io_end(efs);
     if (res < 0) {
         errno = spiffs_res_to_errno(SPIFFS_errno(efs->fs));
         SPIFFS_clearerr(efs->fs);
@@ -626,7 +738,9 @@ static int vfs_spiffs_fstat(void* ctx, int fd, struct stat * st)
 static int vfs_spiffs_fsync(void* ctx, int fd)
 {
     esp_spiffs_t * efs = (esp_spiffs_t *)ctx;
+    vfs_spiffs_io_begin(efs);
     int res = SPIFFS_fflush(efs->fs, fd);
+    vfs_spiffs_io_end(efs);
     if (res < 0) {
         errno = spiffs_res_to_errno(SPIFFS_errno(efs->fs));
         SPIFFS_clearerr(efs->fs);
@@ -664,7 +778,9 @@ static int vfs_spiffs_rename(void* ctx, const char *src, const char *dst)
     assert(src);
     assert(dst);
     esp_spiffs_t * efs = (esp_spiffs_t *)ctx;
+    vfs_spiffs_io_begin(efs);
     int res = SPIFFS_rename(efs->fs, src, dst);
+    vfs_spiffs_io_end(efs);
     if (res < 0) {
         errno = spiffs_res_to_errno(SPIFFS_errno(efs->fs));
         SPIFFS_clearerr(efs->fs);
@@ -677,7 +793,9 @@ static int vfs_spiffs_unlink(void* ctx, const char *path)
 {
     assert(path);
     esp_spiffs_t * efs = (esp_spiffs_t *)ctx;
+    vfs_spiffs_io_begin(efs);
     int res = SPIFFS_remove(efs->fs, path);
+    vfs_spiffs_io_end(efs);
     if (res < 0) {
         errno = spiffs_res_to_errno(SPIFFS_errno(efs->fs));
         SPIFFS_clearerr(efs->fs);
@@ -831,7 +949,9 @@ static int vfs_spiffs_truncate(void* ctx, const char *path, off_t length)
         goto err;
     }
 
+    vfs_spiffs_io_begin(efs);
     int res = SPIFFS_ftruncate(efs->fs, fd, length);
+    vfs_spiffs_io_end(efs);
     if (res < 0) {
         (void)SPIFFS_close(efs->fs, fd);
         goto err;
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -13,6 +14,7 @@
 #include <dirent.h>
 #include <limits.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "Mockqueue.h"
 
@@ -310,11 +312,130 @@ TEST(spiffs, erase_check)
 #endif
 }
 
+#define GC_BENCH_HIST_BUCKETS 16
+
+typedef struct {
+    uint32_t hist[GC_BENCH_HIST_BUCKETS];   // log2 buckets of write latency in us
+    uint32_t writes;
+    uint32_t writes_with_gc;                // writes which had to erase blocks inline
+    uint64_t max_us;
+} gc_bench_result_t;
+
+static uint32_t s_gc_bench_erases;
+
+static s32_t gc_bench_counting_erase(spiffs *fs, uint32_t addr, uint32_t size)
+{
+    s_gc_bench_erases++;
+    return spiffs_api_erase(fs, addr, size);
+}
+
+static uint64_t gc_bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void gc_bench_print(const char *name, const gc_bench_result_t *r)
+{
+    printf("%s: %" PRIu32 " writes, %" PRIu32 " with inline GC, max %" PRIu64 " us\n",
+           name, r->writes, r->writes_with_gc, r->max_us);
+    for (int i = 0; i < GC_BENCH_HIST_BUCKETS; ++i) {
+        if (r->hist[i]) {
+            printf("  < %6u us: %" PRIu32 "\n", 1u << (i + 1), r->hist[i]);
+        }
+    }
+}
+
+/* Rewrites a set of files on a mostly full file system, so that the writes keep running
+ * out of free blocks. If background_gc_target is non-zero, the incremental GC step used by
+ * the background GC task is run between rewrites, as the task would do while the file
+ * system is idle.
+ */
+static void gc_bench_run(uint32_t background_gc_target, gc_bench_result_t *r)
+{
+    spiffs fs;
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, "storage");
+    TEST_ASSERT_NOT_NULL(partition);
+    TEST_ESP_OK(esp_partition_erase_range(partition, 0, partition->size));
+
+    init_spiffs(&fs, 5);
+    fs.cfg.hal_erase_f = gc_bench_counting_erase;
+    memset(r, 0, sizeof(*r));
+
+    const int chunk_sz = 512;
+    char chunk[chunk_sz];
+    memset(chunk, 0xa5, chunk_sz);
+
+    // static content taking most of the space
+    spiffs_file f = SPIFFS_open(&fs, "static", SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR, 0);
+    TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+    for (int i = 0; i < (int)(partition->size * 6 / 10) / chunk_sz; ++i) {
+        TEST_ASSERT_EQUAL(chunk_sz, SPIFFS_write(&fs, f, chunk, chunk_sz));
+    }
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(&fs, f));
+
+    const int file_count = 4;
+    const int file_sz = 32 * 1024;
+    for (int round = 0; round < 60; ++round) {
+        for (int n = 0; n < file_count; ++n) {
+            char name[16];
+            snprintf(name, sizeof(name), "log%d", n);
+            f = SPIFFS_open(&fs, name, SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR, 0);
+            TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+            for (int off = 0; off < file_sz; off += chunk_sz) {
+                uint32_t erases = s_gc_bench_erases;
+                uint64_t start = gc_bench_now_us();
+                TEST_ASSERT_EQUAL(chunk_sz, SPIFFS_write(&fs, f, chunk, chunk_sz));
+                uint64_t us = gc_bench_now_us() - start;
+
+                int bucket = 0;
+                while (bucket < GC_BENCH_HIST_BUCKETS - 1 && us >= (2u << bucket)) {
+                    bucket++;
+                }
+                r->hist[bucket]++;
+                r->writes++;
+                r->max_us = us > r->max_us ? us : r->max_us;
+                if (s_gc_bench_erases != erases) {
+                    r->writes_with_gc++;
+                }
+            }
+            TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(&fs, f));
+
+            if (background_gc_target) {
+                while (spiffs_api_gc_step(&fs, background_gc_target) > 0) {
+                }
+            }
+        }
+    }
+
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_check(&fs));
+    deinit_spiffs(&fs);
+}
+
+TEST(spiffs, background_gc_write_latency)
+{
+    gc_bench_result_t inline_gc;
+    gc_bench_result_t background_gc;
+
+    gc_bench_run(0, &inline_gc);
+    gc_bench_run(16, &background_gc);
+
+    gc_bench_print("inline GC only", &inline_gc);
+    gc_bench_print("with background GC", &background_gc);
+
+    TEST_ASSERT_EQUAL(inline_gc.writes, background_gc.writes);
+    TEST_ASSERT_LESS_THAN_UINT32(inline_gc.writes_with_gc, background_gc.writes_with_gc);
+}
+
 TEST_GROUP_RUNNER(spiffs)
 {
     RUN_TEST_CASE(spiffs, format_disk_open_file_write_and_read_file);
     RUN_TEST_CASE(spiffs, can_read_spiffs_image);
     RUN_TEST_CASE(spiffs, erase_check);
+#if !CONFIG_ESP_PARTITION_ERASE_CHECK
+    RUN_TEST_CASE(spiffs, background_gc_write_latency);
+#endif
 }
 
 static void run_all_tests(void)
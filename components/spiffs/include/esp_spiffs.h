@@ -8,6 +8,9 @@
 #define _ESP_SPIFFS_H_
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -124,6 +127,66 @@ esp_err_t esp_spiffs_check(const char* partition_label);
  */
 esp_err_t esp_spiffs_gc(const char* partition_label, size_t size_to_gc);
 
+/**
+ * @brief Configuration of the background garbage collection task
+ */
+typedef struct {
+        size_t target_free_blocks;          /*!< Number of free (erased) blocks the task tries to keep available.
+                                                 SPIFFS runs GC inline in write operations once 3 or fewer blocks are free,
+                                                 so this should be larger than 3 to keep GC out of the write path. */
+        uint32_t period_ms;                 /*!< Interval at which the task wakes up to check the number of free blocks */
+        uint32_t max_erases_per_period;     /*!< Maximum number of blocks erased by the task in one period */
+        uint32_t max_busy_ms_per_period;    /*!< Maximum time spent collecting garbage in one period */
+        uint32_t idle_ms;                   /*!< Time without foreground file system access required before the task
+                                                 starts collecting. The task also never collects while a foreground
+                                                 operation is in progress. */
+        uint32_t task_stack_size;           /*!< Stack size of the task */
+        uint32_t task_priority;             /*!< Priority of the task */
+} esp_spiffs_gc_task_config_t;
+
+#define ESP_SPIFFS_GC_TASK_CONFIG_DEFAULT() { \
+        .target_free_blocks = 6, \
+        .period_ms = 100, \
+        .max_erases_per_period = 2, \
+        .max_busy_ms_per_period = 20, \
+        .idle_ms = 50, \
+        .task_stack_size = CONFIG_SPIFFS_GC_TASK_STACK_SIZE, \
+        .task_priority = CONFIG_SPIFFS_GC_TASK_PRIORITY, \
+}
+
+/**
+ * @brief Start the background garbage collection task for a mounted SPIFFS partition
+ *
+ * The task runs at low priority and erases blocks ahead of time, one block at a time,
+ * so that writes rarely have to run GC themselves. Fully deleted blocks are erased first;
+ * only when there are none, the block with the most deleted pages is cleaned.
+ * Collection pauses while foreground file system operations are in progress and resumes
+ * after the partition was idle for config->idle_ms.
+ *
+ * The task is stopped automatically when the partition is unregistered.
+ *
+ * @param partition_label  Same label as passed to esp_vfs_spiffs_register.
+ * @param config           Task configuration, see ESP_SPIFFS_GC_TASK_CONFIG_DEFAULT
+ * @return
+ *          - ESP_OK                  if the task was started
+ *          - ESP_ERR_INVALID_ARG     if config is NULL or target_free_blocks is 0
+ *          - ESP_ERR_INVALID_STATE   if the partition is not mounted or the task is already running
+ *          - ESP_ERR_NO_MEM          if the task could not be created
+ */
+esp_err_t esp_spiffs_gc_task_start(const char* partition_label, const esp_spiffs_gc_task_config_t *config);
+
+/**
+ * @brief Stop the background garbage collection task
+ *
+ * Waits until the GC step in progress (if any) is finished.
+ *
+ * @param partition_label  Same label as passed to esp_vfs_spiffs_register.
+ * @return
+ *          - ESP_OK                  if the task was stopped
+ *          - ESP_ERR_INVALID_STATE   if the partition is not mounted or the task is not running
+ */
+esp_err_t esp_spiffs_gc_task_stop(const char* partition_label);
+
 #ifdef __cplusplus
 }
 #endif
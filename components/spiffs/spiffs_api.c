@@ -9,6 +9,7 @@
 #include "esp_partition.h"
 #include "esp_spiffs.h"
 #include "spiffs_api.h"
+#include "spiffs_nucleus.h"
 
 static const char* TAG = "SPIFFS";
 
@@ -55,6 +56,35 @@ s32_t spiffs_api_erase(spiffs *fs, uint32_t addr, uint32_t size)
     return 0;
 }
 
+s32_t spiffs_api_gc_step(spiffs *fs, uint32_t target_free_blocks)
+{
+    if (fs->free_blocks >= target_free_blocks || fs->stats_p_deleted == 0) {
+        return 0;
+    }
+    u32_t deleted_before = fs->stats_p_deleted;
+
+    /* Cheap case first: a block with only deleted pages can be erased without moving anything */
+    s32_t res = SPIFFS_gc_quick(fs, 0);
+    if (res == SPIFFS_ERR_NO_DELETED_BLOCKS) {
+        SPIFFS_clearerr(fs);
+        /* Ask for exactly the currently free amount: spiffs_gc_check then cleans a single
+         * candidate block, after which the free page count exceeds the request.
+         */
+        s32_t free_pages = (SPIFFS_PAGES_PER_BLOCK(fs) - SPIFFS_OBJ_LOOKUP_PAGES(fs)) * (fs->block_count - 2)
+                           - fs->stats_p_allocated - fs->stats_p_deleted;
+        res = SPIFFS_gc(fs, free_pages > 0 ? free_pages * SPIFFS_DATA_PAGE_SIZE(fs) : 0);
+    }
+    if (res == SPIFFS_ERR_FULL) {
+        SPIFFS_clearerr(fs);
+        return 0;
+    }
+    if (res < 0) {
+        SPIFFS_clearerr(fs);
+        return res;
+    }
+    return fs->stats_p_deleted < deleted_before ? 1 : 0;
+}
+
 void spiffs_api_check(spiffs *fs, spiffs_check_type type,
                             spiffs_check_report report, uint32_t arg1, uint32_t arg2)
 {
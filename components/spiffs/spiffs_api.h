@@ -8,10 +8,12 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "spiffs.h"
+#include "esp_spiffs.h"
 #include "esp_compiler.h"
 
 #ifdef __cplusplus
@@ -35,6 +37,12 @@ typedef struct {
     uint32_t fds_sz;                        /*!< File Descriptor Buffer Length */
     uint8_t *cache;                         /*!< Cache Buffer */
     uint32_t cache_sz;                      /*!< Cache Buffer Length */
+    atomic_uint io_active;                  /*!< Number of foreground operations in progress */
+    volatile TickType_t io_last_tick;       /*!< Tick count at the end of the last foreground operation */
+    TaskHandle_t gc_task;                   /*!< Background GC task, NULL if not running */
+    SemaphoreHandle_t gc_task_done;         /*!< Given by the background GC task when it exits */
+    volatile bool gc_task_stop;             /*!< Set to request the background GC task to exit */
+    esp_spiffs_gc_task_config_t gc_cfg;     /*!< Background GC task configuration */
 } esp_spiffs_t;
 
 s32_t spiffs_api_read(spiffs *fs, uint32_t addr, uint32_t size, uint8_t *dst);
@@ -43,6 +51,21 @@ s32_t spiffs_api_write(spiffs *fs, uint32_t addr, uint32_t size, uint8_t *src);
 
 s32_t spiffs_api_erase(spiffs *fs, uint32_t addr, uint32_t size);
 
+/**
+ * @brief Run one incremental garbage collection step
+ *
+ * Erases at most one block: a fully deleted block if there is one, otherwise the best
+ * GC candidate block is cleaned (its live pages moved) and erased.
+ *
+ * @param fs                  Mounted SPIFFS instance
+ * @param target_free_blocks  Do nothing if at least this many blocks are already free
+ * @return
+ *          - 1 if deleted pages were reclaimed
+ *          - 0 if nothing was done: target already reached, or nothing left to reclaim
+ *          - negative SPIFFS error code on failure
+ */
+s32_t spiffs_api_gc_step(spiffs *fs, uint32_t target_free_blocks);
+
 void spiffs_api_check(spiffs *fs, spiffs_check_type type,
                             spiffs_check_report report, uint32_t arg1, uint32_t arg2);
 
@@ -249,6 +249,8 @@ typedef struct
     void* (*get_socket_select_semaphore)(void);
     /** get_socket_select_semaphore returns semaphore allocated in the socket driver; set only for the socket driver */
     esp_err_t (*end_select)(void *end_select_args);
+    /** pollset_watch attaches or detaches a poll set watch to a file descriptor of this VFS, see esp_vfs_pollset.h */
+    esp_err_t (*pollset_watch)(int fd, esp_vfs_pollset_watch_t *watch, bool enable, uint32_t *ready_events);
 #endif // CONFIG_VFS_SUPPORT_SELECT || defined __DOXYGEN__
 } esp_vfs_t;
 
@@ -50,6 +50,13 @@ typedef struct
     void *sem;              /*!< semaphore instance */
 } esp_vfs_select_sem_t;
 
+/**
+ * @brief Opaque watch handle passed by a poll set to the driver of a watched file descriptor
+ *
+ * See esp_vfs_pollset.h for details.
+ */
+typedef struct esp_vfs_pollset_watch esp_vfs_pollset_watch_t;
+
 
 #ifdef CONFIG_VFS_SUPPORT_DIR
 
@@ -221,6 +228,7 @@ typedef      void  (*esp_vfs_stop_socket_select_op_t)          (void *sem);
 typedef      void  (*esp_vfs_stop_socket_select_isr_op_t)      (void *sem, BaseType_t *woken);
 typedef      void* (*esp_vfs_get_socket_select_semaphore_op_t) (void);
 typedef esp_err_t  (*esp_vfs_end_select_op_t)                  (void *end_select_args);
+typedef esp_err_t  (*esp_vfs_pollset_watch_op_t)               (int fd, esp_vfs_pollset_watch_t *watch, bool enable, uint32_t *ready_events);
 
 /**
  * @brief Struct containing function pointers to select related functionality.
@@ -244,6 +252,9 @@ typedef struct {
 
     /** get_socket_select_semaphore returns semaphore allocated in the socket driver; set only for the socket driver */
     const esp_vfs_end_select_op_t                  end_select;
+
+    /** pollset_watch attaches (enable=true) or detaches (enable=false) a poll set watch to a file descriptor of this VFS; when attaching, the driver reports the currently ready ESP_VFS_POLLSET_* events in ready_events */
+    const esp_vfs_pollset_watch_op_t               pollset_watch;
 } esp_vfs_select_ops_t;
 
 #endif // CONFIG_VFS_SUPPORT_SELECT
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "esp_vfs_ops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VFS_POLLSET_IN   (1 << 0)   /*!< File descriptor became readable */
+#define ESP_VFS_POLLSET_OUT  (1 << 1)   /*!< File descriptor became writable */
+#define ESP_VFS_POLLSET_ERR  (1 << 2)   /*!< Error condition, always reported */
+#define ESP_VFS_POLLSET_HUP  (1 << 3)   /*!< File descriptor was closed, always reported; the fd is removed from the poll set */
+
+/**
+ * @brief Poll set handle
+ */
+typedef struct esp_vfs_pollset *esp_vfs_pollset_handle_t;
+
+/**
+ * @brief Event reported by esp_vfs_pollset_wait()
+ */
+typedef struct {
+    int fd;             /*!< Global file descriptor */
+    uint32_t events;    /*!< ESP_VFS_POLLSET_* events which occurred since the last report */
+    void *user_data;    /*!< User data given to esp_vfs_pollset_add() */
+} esp_vfs_pollset_event_t;
+
+/**
+ * @brief Create a poll set
+ *
+ * A poll set is a persistent set of file descriptors which can be waited on repeatedly
+ * without rebuilding fd sets and calling start_select/end_select of every VFS for each wait.
+ * Drivers push readiness changes to the poll set, so esp_vfs_pollset_wait() only visits the
+ * file descriptors which became ready.
+ *
+ * Notifications are edge-triggered: an event is reported once for each transition reported by
+ * the driver. The application is expected to drain the file descriptor (e.g. read until EAGAIN)
+ * after receiving ESP_VFS_POLLSET_IN.
+ *
+ * Only file descriptors of VFS drivers implementing the pollset_watch operation can be added
+ * (currently lwip sockets and eventfd).
+ *
+ * @param max_fds      Maximum number of file descriptors which can be in the poll set at the same time
+ * @param ret_pollset  Output, handle of the created poll set
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if max_fds is zero or ret_pollset is NULL
+ *      - ESP_ERR_NO_MEM if out of memory
+ */
+esp_err_t esp_vfs_pollset_create(size_t max_fds, esp_vfs_pollset_handle_t *ret_pollset);
+
+/**
+ * @brief Delete a poll set
+ *
+ * All file descriptors are detached from their drivers. The poll set must not be waited on by any task.
+ *
+ * @param pollset  Poll set handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if pollset is NULL
+ */
+esp_err_t esp_vfs_pollset_delete(esp_vfs_pollset_handle_t pollset);
+
+/**
+ * @brief Add a file descriptor to a poll set
+ *
+ * If the file descriptor is already ready for some of the requested events, they are reported
+ * by the next esp_vfs_pollset_wait() call.
+ *
+ * @param pollset    Poll set handle
+ * @param fd         Global file descriptor
+ * @param events     ESP_VFS_POLLSET_IN and/or ESP_VFS_POLLSET_OUT
+ * @param user_data  Pointer reported together with the events of this file descriptor
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if pollset or fd is invalid
+ *      - ESP_ERR_INVALID_STATE if fd is already in this or another poll set
+ *      - ESP_ERR_NOT_SUPPORTED if the VFS driver of fd doesn't support poll sets
+ *      - ESP_ERR_NO_MEM if the poll set is full
+ */
+esp_err_t esp_vfs_pollset_add(esp_vfs_pollset_handle_t pollset, int fd, uint32_t events, void *user_data);
+
+/**
+ * @brief Change the requested events and user data of a file descriptor in a poll set
+ *
+ * Current readiness is re-evaluated, so events which are already pending are reported again.
+ *
+ * @param pollset    Poll set handle
+ * @param fd         Global file descriptor
+ * @param events     ESP_VFS_POLLSET_IN and/or ESP_VFS_POLLSET_OUT
+ * @param user_data  Pointer reported together with the events of this file descriptor
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if pollset is NULL
+ *      - ESP_ERR_NOT_FOUND if fd is not in the poll set
+ */
+esp_err_t esp_vfs_pollset_modify(esp_vfs_pollset_handle_t pollset, int fd, uint32_t events, void *user_data);
+
+/**
+ * @brief Remove a file descriptor from a poll set
+ *
+ * Pending events of the file descriptor are discarded. File descriptors closed while in the
+ * poll set are removed automatically after their ESP_VFS_POLLSET_HUP event has been reported.
+ *
+ * @param pollset  Poll set handle
+ * @param fd       Global file descriptor
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if pollset is NULL
+ *      - ESP_ERR_NOT_FOUND if fd is not in the poll set
+ */
+esp_err_t esp_vfs_pollset_remove(esp_vfs_pollset_handle_t pollset, int fd);
+
+/**
+ * @brief Wait for events on the file descriptors of a poll set
+ *
+ * @param pollset     Poll set handle
+ * @param events      Output array for the reported events
+ * @param max_events  Size of the events array
+ * @param timeout_ms  Maximum time to wait, 0 to poll without blocking, negative to wait forever
+ *
+ * @return Number of events stored in the array, 0 on timeout, -1 with errno set to EINVAL
+ *         if the arguments are invalid
+ */
+int esp_vfs_pollset_wait(esp_vfs_pollset_handle_t pollset, esp_vfs_pollset_event_t *events, int max_events, int timeout_ms);
+
+/**
+ * @brief Notify a poll set about events on a watched file descriptor
+ *
+ * Called by VFS drivers implementing pollset_watch, from task context, whenever the file
+ * descriptor becomes ready. Events which weren't requested are ignored, except
+ * ESP_VFS_POLLSET_ERR and ESP_VFS_POLLSET_HUP. The driver reports ESP_VFS_POLLSET_HUP when
+ * the file descriptor is closed and must not use the watch afterwards.
+ *
+ * The driver must guarantee that the watch is not notified after pollset_watch returns from
+ * detaching it.
+ *
+ * @param watch   Watch handle given to pollset_watch
+ * @param events  ESP_VFS_POLLSET_* events
+ */
+void esp_vfs_pollset_notify(esp_vfs_pollset_watch_t *watch, uint32_t events);
+
+/**
+ * @brief Notify a poll set about events on a watched file descriptor from ISR
+ *
+ * @see esp_vfs_pollset_notify()
+ *
+ * @param watch   Watch handle given to pollset_watch
+ * @param events  ESP_VFS_POLLSET_* events
+ * @param woken   is set to pdTRUE if the function wakes up a task with higher priority
+ */
+void esp_vfs_pollset_notify_isr(esp_vfs_pollset_watch_t *watch, uint32_t events, BaseType_t *woken);
+
+#ifdef __cplusplus
+}
+#endif
@@ -73,6 +73,18 @@ const vfs_entry_t *get_vfs_for_path(const char *path);
  */
 const vfs_entry_t *get_vfs_for_index(int index);
 
+/**
+ * Get vfs entry and local fd for a global file descriptor.
+ *
+ * Both values come from a single consistent snapshot of the fd table entry.
+ *
+ * @param fd Global file descriptor.
+ * @param local_fd Output, file descriptor local to the returned VFS.
+ *
+ * @return Pointer to the `vfs_entry_t` owning the fd, or NULL if the fd is not in use.
+ */
+const vfs_entry_t *get_vfs_for_fd(int fd, int *local_fd);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,7 @@
 
 #include "sdkconfig.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
@@ -16,6 +17,7 @@
 #include "esp_vfs.h"
 #include "unity.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "test_utils.h"
 #include "ccomp_timer.h"
 #include "driver/uart.h"
@@ -264,6 +266,122 @@ TEST_CASE("Open & write & close through VFS passes performance test", "[vfs]")
 
 }
 
+#define CONTENTION_TEST_MAX_TASKS   4
+#define CONTENTION_TEST_ITERATIONS  20000
+
+typedef struct {
+    int fd;
+    int expected_local_fd;
+    int64_t time_us;
+    bool fd_mismatch;
+    SemaphoreHandle_t done;
+} contention_test_task_param_t;
+
+static contention_test_task_param_t contention_test_params[CONTENTION_TEST_MAX_TASKS];
+
+static int contention_test_vfs_open(const char *path, int flags, int mode)
+{
+    // path is "/<n>", local FDs are 1-based to differ from the global ones
+    return atoi(path + 1) + 1;
+}
+
+static int contention_test_vfs_close(int fd)
+{
+    return 0;
+}
+
+static ssize_t contention_test_vfs_write(int fd, const void *data, size_t size)
+{
+    return size;
+}
+
+static ssize_t contention_test_vfs_read(int fd, void *dst, size_t size)
+{
+    // the task index is passed in the buffer, check that the local FD matches it
+    const int task_index = *(int *) dst;
+    if (contention_test_params[task_index].expected_local_fd != fd) {
+        contention_test_params[task_index].fd_mismatch = true;
+    }
+    return size;
+}
+
+static off_t contention_test_vfs_lseek(int fd, off_t offset, int whence)
+{
+    return offset;
+}
+
+static void contention_test_task(void *arg)
+{
+    const int task_index = (int) arg;
+    contention_test_task_param_t *param = &contention_test_params[task_index];
+    int buf = task_index;
+
+    const int64_t start = esp_timer_get_time();
+    for (int i = 0; i < CONTENTION_TEST_ITERATIONS; ++i) {
+        write(param->fd, &buf, sizeof(buf));
+        read(param->fd, &buf, sizeof(buf));
+        lseek(param->fd, 0, SEEK_SET);
+    }
+    param->time_us = esp_timer_get_time() - start;
+    xSemaphoreGive(param->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Small I/O on distinct FDs from concurrent tasks", "[vfs]")
+{
+    esp_vfs_t desc = {
+        .flags = ESP_VFS_FLAG_DEFAULT,
+        .open = contention_test_vfs_open,
+        .close = contention_test_vfs_close,
+        .write = contention_test_vfs_write,
+        .read = contention_test_vfs_read,
+        .lseek = contention_test_vfs_lseek,
+    };
+    TEST_ESP_OK( esp_vfs_register(VFS_PREF1, &desc, NULL) );
+
+    for (int task_count = 1; task_count <= CONTENTION_TEST_MAX_TASKS; task_count *= 2) {
+        for (int i = 0; i < task_count; ++i) {
+            char path[16];
+            snprintf(path, sizeof(path), VFS_PREF1 "/%d", i);
+            contention_test_params[i] = (contention_test_task_param_t) {
+                .fd = open(path, 0, 0),
+                .expected_local_fd = i + 1,
+                .done = xSemaphoreCreateBinary(),
+            };
+            TEST_ASSERT_NOT_EQUAL(-1, contention_test_params[i].fd);
+            TEST_ASSERT_NOT_NULL(contention_test_params[i].done);
+        }
+
+        for (int i = 0; i < task_count; ++i) {
+            xTaskCreatePinnedToCore(contention_test_task, "io", CONCURRENT_TEST_STACK_SIZE, (void *) i,
+                                    3, NULL, i % CONFIG_FREERTOS_NUMBER_OF_CORES);
+        }
+
+        // meanwhile, keep the fd table writers busy
+        for (int i = 0; i < 100; ++i) {
+            const int fd = open(VFS_PREF1 "/99", 0, 0);
+            TEST_ASSERT_NOT_EQUAL(-1, fd);
+            TEST_ASSERT_NOT_EQUAL(-1, close(fd));
+        }
+
+        int64_t max_time_us = 0;
+        for (int i = 0; i < task_count; ++i) {
+            TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(contention_test_params[i].done, portMAX_DELAY));
+            vSemaphoreDelete(contention_test_params[i].done);
+            TEST_ASSERT_FALSE(contention_test_params[i].fd_mismatch);
+            TEST_ASSERT_NOT_EQUAL(-1, close(contention_test_params[i].fd));
+            if (contention_test_params[i].time_us > max_time_us) {
+                max_time_us = contention_test_params[i].time_us;
+            }
+        }
+        const int64_t total_ops = (int64_t) task_count * CONTENTION_TEST_ITERATIONS * 3;
+        printf("%d task(s): %lld I/O calls in %lld us, %lld calls/s\n", task_count,
+               total_ops, max_time_us, total_ops * 1000000 / max_time_us);
+    }
+
+    TEST_ESP_OK( esp_vfs_unregister(VFS_PREF1) );
+}
+
 static int vfs_overlap_test_open(const char * path, int flags, int mode)
 {
     return 0;
@@ -0,0 +1,216 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "esp_timer.h"
+#include "esp_vfs.h"
+#include "esp_vfs_eventfd.h"
+#include "esp_vfs_pollset.h"
+#include "lwip/sockets.h"
+#include "test_utils.h"
+
+#define TEST_POLLSET_FDS 8
+#define TEST_POLLSET_BENCH_FDS 32
+
+static void eventfd_signal(int fd)
+{
+    uint64_t val = 1;
+    TEST_ASSERT_EQUAL(sizeof(val), write(fd, &val, sizeof(val)));
+}
+
+static void eventfd_drain(int fd)
+{
+    uint64_t val;
+    TEST_ASSERT_EQUAL(sizeof(val), read(fd, &val, sizeof(val)));
+}
+
+TEST_CASE("pollset reports only eventfds which became ready", "[vfs][pollset]")
+{
+    esp_vfs_eventfd_config_t config = { .max_fds = TEST_POLLSET_FDS };
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+
+    esp_vfs_pollset_handle_t pollset;
+    TEST_ESP_OK(esp_vfs_pollset_create(TEST_POLLSET_FDS, &pollset));
+
+    int fds[TEST_POLLSET_FDS];
+    for (int i = 0; i < TEST_POLLSET_FDS; i++) {
+        fds[i] = eventfd(0, 0);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, fds[i]);
+        TEST_ESP_OK(esp_vfs_pollset_add(pollset, fds[i], ESP_VFS_POLLSET_IN, &fds[i]));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_vfs_pollset_add(pollset, fds[0], ESP_VFS_POLLSET_IN, NULL));
+
+    esp_vfs_pollset_event_t events[TEST_POLLSET_FDS];
+    TEST_ASSERT_EQUAL(0, esp_vfs_pollset_wait(pollset, events, TEST_POLLSET_FDS, 0));
+    TEST_ASSERT_EQUAL(0, esp_vfs_pollset_wait(pollset, events, TEST_POLLSET_FDS, 20));
+
+    // Edge-triggered: two writes before the wait are reported once
+    eventfd_signal(fds[3]);
+    eventfd_signal(fds[3]);
+    eventfd_signal(fds[5]);
+    TEST_ASSERT_EQUAL(2, esp_vfs_pollset_wait(pollset, events, TEST_POLLSET_FDS, 0));
+    TEST_ASSERT_EQUAL(fds[3], events[0].fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_POLLSET_IN, events[0].events);
+    TEST_ASSERT_EQUAL_PTR(&fds[3], events[0].user_data);
+    TEST_ASSERT_EQUAL(fds[5], events[1].fd);
+    TEST_ASSERT_EQUAL(0, esp_vfs_pollset_wait(pollset, events, TEST_POLLSET_FDS, 0));
+    eventfd_drain(fds[3]);
+    eventfd_drain(fds[5]);
+
+    // Readiness present before adding the fd is not lost
+    TEST_ESP_OK(esp_vfs_pollset_remove(pollset, fds[1]));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_vfs_pollset_remove(pollset, fds[1]));
+    eventfd_signal(fds[1]);
+    TEST_ASSERT_EQUAL(0, esp_vfs_pollset_wait(pollset, events, TEST_POLLSET_FDS, 0));
+    TEST_ESP_OK(esp_vfs_pollset_add(pollset, fds[1], ESP_VFS_POLLSET_IN | ESP_VFS_POLLSET_OUT, NULL));
+    TEST_ASSERT_EQUAL(1, esp_vfs_pollset_wait(pollset, events, TEST_POLLSET_FDS, 0));
+    TEST_ASSERT_EQUAL(fds[1], events[0].fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_POLLSET_IN | ESP_VFS_POLLSET_OUT, events[0].events);
+    eventfd_drain(fds[1]);
+
+    // Closing a watched fd reports HUP and removes the fd from the poll set
+    TEST_ASSERT_EQUAL(0, close(fds[2]));
+    TEST_ASSERT_EQUAL(1, esp_vfs_pollset_wait(pollset, events, TEST_POLLSET_FDS, 0));
+    TEST_ASSERT_EQUAL(fds[2], events[0].fd);
+    TEST_ASSERT(events[0].events & ESP_VFS_POLLSET_HUP);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_vfs_pollset_remove(pollset, fds[2]));
+
+    TEST_ESP_OK(esp_vfs_pollset_delete(pollset));
+    for (int i = 0; i < TEST_POLLSET_FDS; i++) {
+        if (i != 2) {
+            TEST_ASSERT_EQUAL(0, close(fds[i]));
+        }
+    }
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+}
+
+static void signal_task(void *arg)
+{
+    int fd = *(int *)arg;
+    vTaskDelay(pdMS_TO_TICKS(50));
+    eventfd_signal(fd);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("pollset wait wakes up on eventfd write from another task", "[vfs][pollset]")
+{
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+
+    esp_vfs_pollset_handle_t pollset;
+    TEST_ESP_OK(esp_vfs_pollset_create(2, &pollset));
+
+    int fd = eventfd(0, EFD_SUPPORT_ISR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    TEST_ESP_OK(esp_vfs_pollset_add(pollset, fd, ESP_VFS_POLLSET_IN, NULL));
+
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(signal_task, "signal_task", 2048, &fd, 5, NULL));
+    esp_vfs_pollset_event_t event;
+    TEST_ASSERT_EQUAL(1, esp_vfs_pollset_wait(pollset, &event, 1, 1000));
+    TEST_ASSERT_EQUAL(fd, event.fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_POLLSET_IN, event.events);
+
+    TEST_ESP_OK(esp_vfs_pollset_delete(pollset));
+    TEST_ASSERT_EQUAL(0, close(fd));
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+}
+
+TEST_CASE("pollset reports readable UDP socket", "[vfs][pollset]")
+{
+    test_case_uses_tcpip();
+
+    const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, sock);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(8765),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, bind(sock, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, connect(sock, (struct sockaddr *)&addr, sizeof(addr)));
+
+    esp_vfs_pollset_handle_t pollset;
+    TEST_ESP_OK(esp_vfs_pollset_create(1, &pollset));
+    TEST_ESP_OK(esp_vfs_pollset_add(pollset, sock, ESP_VFS_POLLSET_IN, NULL));
+
+    esp_vfs_pollset_event_t event;
+    TEST_ASSERT_EQUAL(0, esp_vfs_pollset_wait(pollset, &event, 1, 20));
+
+    const char message[] = "pollset";
+    TEST_ASSERT_EQUAL(sizeof(message), write(sock, message, sizeof(message)));
+    TEST_ASSERT_EQUAL(1, esp_vfs_pollset_wait(pollset, &event, 1, 1000));
+    TEST_ASSERT_EQUAL(sock, event.fd);
+    TEST_ASSERT(event.events & ESP_VFS_POLLSET_IN);
+
+    char buf[sizeof(message)];
+    TEST_ASSERT_EQUAL(sizeof(message), read(sock, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, esp_vfs_pollset_wait(pollset, &event, 1, 0));
+
+    TEST_ESP_OK(esp_vfs_pollset_delete(pollset));
+    TEST_ASSERT_EQUAL(0, close(sock));
+}
+
+TEST_CASE("pollset wait cost scales with ready fds, not watched fds", "[vfs][pollset]")
+{
+    const int watched = TEST_POLLSET_BENCH_FDS;
+    esp_vfs_eventfd_config_t config = { .max_fds = watched };
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+
+    esp_vfs_pollset_handle_t pollset;
+    TEST_ESP_OK(esp_vfs_pollset_create(watched, &pollset));
+
+    int fds[TEST_POLLSET_BENCH_FDS];
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    int max_fd = 0;
+    for (int i = 0; i < watched; i++) {
+        fds[i] = eventfd(0, 0);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, fds[i]);
+        TEST_ESP_OK(esp_vfs_pollset_add(pollset, fds[i], ESP_VFS_POLLSET_IN, NULL));
+        max_fd = fds[i] > max_fd ? fds[i] : max_fd;
+    }
+
+    const int iterations = 200;
+    esp_vfs_pollset_event_t event;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        const int fd = fds[i % watched];
+        eventfd_signal(fd);
+        for (int j = 0; j < watched; j++) {
+            FD_SET(fds[j], &rfds);
+        }
+        struct timeval tv = { 0 };
+        TEST_ASSERT_EQUAL(1, select(max_fd + 1, &rfds, NULL, NULL, &tv));
+        eventfd_drain(fd);
+    }
+    const int64_t select_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < iterations; i++) {
+        const int fd = fds[i % watched];
+        eventfd_signal(fd);
+        TEST_ASSERT_EQUAL(1, esp_vfs_pollset_wait(pollset, &event, 1, 0));
+        TEST_ASSERT_EQUAL(fd, event.fd);
+        eventfd_drain(fd);
+    }
+    const int64_t pollset_us = esp_timer_get_time() - start;
+
+    printf("%d watched fds, 1 ready: select %d us/iter, pollset %d us/iter\n", watched,
+           (int)(select_us / iterations), (int)(pollset_us / iterations));
+    TEST_ASSERT_LESS_THAN(select_us, pollset_us);
+
+    TEST_ESP_OK(esp_vfs_pollset_delete(pollset));
+    for (int i = 0; i < watched; i++) {
+        TEST_ASSERT_EQUAL(0, close(fds[i]));
+    }
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+}
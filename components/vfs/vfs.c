@@ -54,14 +54,24 @@ typedef int8_t vfs_index_t;
 _Static_assert((1 << (sizeof(vfs_index_t)*8)) >= VFS_MAX_COUNT, "VFS index type too small");
 _Static_assert(((vfs_index_t) -1) < 0, "vfs_index_t must be a signed type");
 
-typedef struct {
-    bool permanent :1;
-    bool has_pending_close :1;
-    bool has_pending_select :1;
-    uint8_t _reserved :5;
-    vfs_index_t vfs_index;
-    local_fd_t local_fd;
+/* An fd table entry fits into one 32-bit word, so that it can be loaded and stored atomically.
+ * Writers (open, close, fd registration) serialize on s_fd_table_lock and publish whole entries
+ * with fd_table_store(). Readers on the I/O hot path take a consistent snapshot with
+ * fd_table_load() and never take the lock, so the VFS index and the local fd they see always
+ * belong together.
+ */
+typedef union {
+    struct {
+        bool permanent :1;
+        bool has_pending_close :1;
+        bool has_pending_select :1;
+        uint8_t _reserved :5;
+        vfs_index_t vfs_index;
+        local_fd_t local_fd;
+    };
+    uint32_t raw;
 } fd_table_t;
+_Static_assert(sizeof(fd_table_t) == sizeof(uint32_t), "fd table entry must fit into one atomic word");
 
 typedef struct {
     bool isset; // none or at least one bit is set in the following 3 fd sets
@@ -76,6 +86,19 @@ static size_t s_vfs_count = 0;
 static fd_table_t s_fd_table[MAX_FDS] = { [0 ... MAX_FDS-1] = FD_TABLE_ENTRY_UNUSED };
 static _lock_t s_fd_table_lock;
 
+static inline fd_table_t fd_table_load(int fd)
+{
+    fd_table_t entry;
+    entry.raw = __atomic_load_n(&s_fd_table[fd].raw, __ATOMIC_ACQUIRE);
+    return entry;
+}
+
+/* Must be called with s_fd_table_lock held */
+static inline void fd_table_store(int fd, fd_table_t entry)
+{
+    __atomic_store_n(&s_fd_table[fd].raw, entry.raw, __ATOMIC_RELEASE);
+}
+
 static ssize_t esp_get_free_index(void) {
     for (ssize_t i = 0; i < VFS_MAX_COUNT; i++) {
         if (s_vfs[i] == NULL) {
@@ -194,6 +217,7 @@ static esp_vfs_fs_ops_t *esp_minify_vfs(const esp_vfs_t * const vfs, vfs_compone
             .stop_socket_select_isr = vfs->stop_socket_select_isr,
             .get_socket_select_semaphore = vfs->get_socket_select_semaphore,
             .end_select = vfs->end_select,
+            .pollset_watch = vfs->pollset_watch,
         };
 
         memcpy(proxy.select, &tmp, sizeof(esp_vfs_select_ops_t));
@@ -371,7 +395,8 @@ static esp_err_t esp_vfs_make_fs_ops(const esp_vfs_t *vfs, esp_vfs_fs_ops_t **mi
         vfs->stop_socket_select == NULL &&
         vfs->stop_socket_select_isr == NULL &&
         vfs->get_socket_select_semaphore == NULL &&
-        vfs->end_select == NULL;
+        vfs->end_select == NULL &&
+        vfs->pollset_watch == NULL;
 
     if (!skip_select) {
         proxy.select = (esp_vfs_select_ops_t*) heap_caps_malloc(sizeof(esp_vfs_select_ops_t), VFS_MALLOC_FLAGS);
@@ -525,16 +550,14 @@ esp_err_t esp_vfs_register_fd_range(const esp_vfs_t *vfs, void *ctx, int min_fd,
                 s_vfs[index] = NULL;
                 for (int j = min_fd; j < i; ++j) {
                     if (s_fd_table[j].vfs_index == index) {
-                        s_fd_table[j] = FD_TABLE_ENTRY_UNUSED;
+                        fd_table_store(j, FD_TABLE_ENTRY_UNUSED);
                     }
                 }
                 _lock_release(&s_fd_table_lock);
                 ESP_LOGW(TAG, "esp_vfs_register_fd_range cannot set fd %d (used by other VFS)", i);
                 return ESP_ERR_INVALID_ARG;
             }
-            s_fd_table[i].permanent = true;
-            s_fd_table[i].vfs_index = index;
-            s_fd_table[i].local_fd = i;
+            fd_table_store(i, (fd_table_t) { .permanent = true, .vfs_index = index, .local_fd = i });
         }
         _lock_release(&s_fd_table_lock);
 
@@ -577,7 +600,7 @@ esp_err_t esp_vfs_unregister_with_id(esp_vfs_id_t vfs_id)
     // Delete all references from the FD lookup-table
     for (int j = 0; j < VFS_MAX_COUNT; ++j) {
         if (s_fd_table[j].vfs_index == vfs_id) {
-            s_fd_table[j] = FD_TABLE_ENTRY_UNUSED;
+            fd_table_store(j, FD_TABLE_ENTRY_UNUSED);
         }
     }
     _lock_release(&s_fd_table_lock);
@@ -623,13 +646,11 @@ esp_err_t esp_vfs_register_fd_with_local_fd(esp_vfs_id_t vfs_id, int local_fd, b
     _lock_acquire(&s_fd_table_lock);
     for (int i = 0; i < MAX_FDS; ++i) {
         if (s_fd_table[i].vfs_index == -1) {
-            s_fd_table[i].permanent = permanent;
-            s_fd_table[i].vfs_index = vfs_id;
-            if (local_fd >= 0) {
-                s_fd_table[i].local_fd = local_fd;
-            } else {
-                s_fd_table[i].local_fd = i;
-            }
+            fd_table_store(i, (fd_table_t) {
+                .permanent = permanent,
+                .vfs_index = vfs_id,
+                .local_fd = local_fd >= 0 ? local_fd : i,
+            });
             *fd = i;
             ret = ESP_OK;
             break;
@@ -653,9 +674,9 @@ esp_err_t esp_vfs_unregister_fd(esp_vfs_id_t vfs_id, int fd)
     }
 
     _lock_acquire(&s_fd_table_lock);
-    fd_table_t *item = s_fd_table + fd;
-    if (item->permanent == true && item->vfs_index == vfs_id && item->local_fd == fd) {
-        *item = FD_TABLE_ENTRY_UNUSED;
+    const fd_table_t item = s_fd_table[fd];
+    if (item.permanent == true && item.vfs_index == vfs_id && item.local_fd == fd) {
+        fd_table_store(fd, FD_TABLE_ENTRY_UNUSED);
         ret = ESP_OK;
     }
     _lock_release(&s_fd_table_lock);
@@ -738,27 +759,21 @@ static inline bool fd_valid(int fd)
     return (fd < MAX_FDS) && (fd >= 0);
 }
 
-static const vfs_entry_t *get_vfs_for_fd(int fd)
+/* Lock-free: the VFS and the local fd are taken from the same snapshot of the fd table entry */
+const vfs_entry_t *get_vfs_for_fd(int fd, int *local_fd)
 {
     const vfs_entry_t *vfs = NULL;
+    *local_fd = -1;
     if (fd_valid(fd)) {
-        const int index = s_fd_table[fd].vfs_index; // single read -> no locking is required
-        vfs = get_vfs_for_index(index);
+        const fd_table_t entry = fd_table_load(fd);
+        vfs = get_vfs_for_index(entry.vfs_index);
+        if (vfs) {
+            *local_fd = entry.local_fd;
+        }
     }
     return vfs;
 }
 
-static inline int get_local_fd(const vfs_entry_t *vfs, int fd)
-{
-    int local_fd = -1;
-
-    if (vfs && fd_valid(fd)) {
-        local_fd = s_fd_table[fd].local_fd; // single read -> no locking is required
-    }
-
-    return local_fd;
-}
-
 static const char* translate_path(const vfs_entry_t* vfs, const char* src_path)
 {
     assert(strncmp(src_path, vfs->path_prefix, vfs->path_prefix_len) == 0);
@@ -915,9 +930,11 @@ int esp_vfs_open(struct _reent *r, const char * path, int flags, int mode)
         _lock_acquire(&s_fd_table_lock);
         for (int i = 0; i < MAX_FDS; ++i) {
             if (s_fd_table[i].vfs_index == -1) {
-                s_fd_table[i].permanent = false;
-                s_fd_table[i].vfs_index = vfs->offset;
-                s_fd_table[i].local_fd = fd_within_vfs;
+                fd_table_store(i, (fd_table_t) {
+                    .permanent = false,
+                    .vfs_index = vfs->offset,
+                    .local_fd = fd_within_vfs,
+                });
                 _lock_release(&s_fd_table_lock);
                 return i;
             }
@@ -935,8 +952,8 @@ int esp_vfs_open(struct _reent *r, const char * path, int flags, int mode)
 
 ssize_t esp_vfs_write(struct _reent *r, int fd, const void * data, size_t size)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -948,8 +965,8 @@ ssize_t esp_vfs_write(struct _reent *r, int fd, const void * data, size_t size)
 
 off_t esp_vfs_lseek(struct _reent *r, int fd, off_t size, int mode)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -961,8 +978,8 @@ off_t esp_vfs_lseek(struct _reent *r, int fd, off_t size, int mode)
 
 ssize_t esp_vfs_read(struct _reent *r, int fd, void * dst, size_t size)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -975,8 +992,8 @@ ssize_t esp_vfs_read(struct _reent *r, int fd, void * dst, size_t size)
 ssize_t esp_vfs_pread(int fd, void *dst, size_t size, off_t offset)
 {
     struct _reent *r = __getreent();
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -989,8 +1006,8 @@ ssize_t esp_vfs_pread(int fd, void *dst, size_t size, off_t offset)
 ssize_t esp_vfs_pwrite(int fd, const void *src, size_t size, off_t offset)
 {
     struct _reent *r = __getreent();
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -1002,8 +1019,8 @@ ssize_t esp_vfs_pwrite(int fd, const void *src, size_t size, off_t offset)
 
 int esp_vfs_close(struct _reent *r, int fd)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -1012,11 +1029,13 @@ int esp_vfs_close(struct _reent *r, int fd)
     CHECK_AND_CALL(ret, r, vfs, close, local_fd);
 
     _lock_acquire(&s_fd_table_lock);
-    if (!s_fd_table[fd].permanent) {
-        if (s_fd_table[fd].has_pending_select) {
-            s_fd_table[fd].has_pending_close = true;
+    fd_table_t entry = s_fd_table[fd];
+    if (!entry.permanent) {
+        if (entry.has_pending_select) {
+            entry.has_pending_close = true;
+            fd_table_store(fd, entry);
         } else {
-            s_fd_table[fd] = FD_TABLE_ENTRY_UNUSED;
+            fd_table_store(fd, FD_TABLE_ENTRY_UNUSED);
         }
     }
     _lock_release(&s_fd_table_lock);
@@ -1025,8 +1044,8 @@ int esp_vfs_close(struct _reent *r, int fd)
 
 int esp_vfs_fstat(struct _reent *r, int fd, struct stat * st)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -1038,8 +1057,8 @@ int esp_vfs_fstat(struct _reent *r, int fd, struct stat * st)
 
 int esp_vfs_fcntl_r(struct _reent *r, int fd, int cmd, int arg)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
         return -1;
@@ -1051,8 +1070,8 @@ int esp_vfs_fcntl_r(struct _reent *r, int fd, int cmd, int arg)
 
 int esp_vfs_ioctl(int fd, int cmd, ...)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1068,8 +1087,8 @@ int esp_vfs_ioctl(int fd, int cmd, ...)
 
 int esp_vfs_fsync(int fd)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1324,8 +1343,8 @@ int esp_vfs_truncate(const char *path, off_t length)
 
 int esp_vfs_ftruncate(int fd, off_t length)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1374,8 +1393,9 @@ static int set_global_fd_sets(const fds_triple_t *vfs_fds_triple, int size, fd_s
         const fds_triple_t *item = &vfs_fds_triple[i];
         if (item->isset) {
             for (int fd = 0; fd < MAX_FDS; ++fd) {
-                if (s_fd_table[fd].vfs_index == i) {
-                    const int local_fd = s_fd_table[fd].local_fd; // single read -> no locking is required
+                const fd_table_t entry = fd_table_load(fd);
+                if (entry.vfs_index == i) {
+                    const int local_fd = entry.local_fd;
                     if (readfds && esp_vfs_safe_fd_isset(local_fd, &item->readfds)) {
                         ESP_LOGD(TAG, "FD %d in readfds was set from VFS ID %d", fd, i);
                         FD_SET(fd, readfds);
@@ -1450,14 +1470,19 @@ int esp_vfs_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds
 
     int (*socket_select)(int, fd_set *, fd_set *, fd_set *, struct timeval *) = NULL;
     for (int fd = 0; fd < nfds; ++fd) {
-        _lock_acquire(&s_fd_table_lock);
-        const bool is_socket_fd = s_fd_table[fd].permanent;
-        const int vfs_index = s_fd_table[fd].vfs_index;
-        const int local_fd = s_fd_table[fd].local_fd;
+        fd_table_t entry;
         if (esp_vfs_safe_fd_isset(fd, errorfds)) {
-            s_fd_table[fd].has_pending_select = true;
+            _lock_acquire(&s_fd_table_lock);
+            entry = s_fd_table[fd];
+            entry.has_pending_select = true;
+            fd_table_store(fd, entry);
+            _lock_release(&s_fd_table_lock);
+        } else {
+            entry = fd_table_load(fd);
         }
-        _lock_release(&s_fd_table_lock);
+        const bool is_socket_fd = entry.permanent;
+        const int vfs_index = entry.vfs_index;
+        const int local_fd = entry.local_fd;
 
         if (vfs_index < 0) {
             continue;
@@ -1619,7 +1644,7 @@ int esp_vfs_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds
     _lock_acquire(&s_fd_table_lock);
     for (int fd = 0; fd < nfds; ++fd) {
         if (s_fd_table[fd].has_pending_close) {
-            s_fd_table[fd] = FD_TABLE_ENTRY_UNUSED;
+            fd_table_store(fd, FD_TABLE_ENTRY_UNUSED);
         }
     }
     _lock_release(&s_fd_table_lock);
@@ -1686,8 +1711,8 @@ void esp_vfs_select_triggered_isr(esp_vfs_select_sem_t sem, BaseType_t *woken)
 
 int tcgetattr(int fd, struct termios *p)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1700,8 +1725,8 @@ int tcgetattr(int fd, struct termios *p)
 
 int tcsetattr(int fd, int optional_actions, const struct termios *p)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1714,8 +1739,8 @@ int tcsetattr(int fd, int optional_actions, const struct termios *p)
 
 int tcdrain(int fd)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1728,8 +1753,8 @@ int tcdrain(int fd)
 
 int tcflush(int fd, int select)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1742,8 +1767,8 @@ int tcflush(int fd, int select)
 
 int tcflow(int fd, int action)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1756,8 +1781,8 @@ int tcflow(int fd, int action)
 
 pid_t tcgetsid(int fd)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
@@ -1770,8 +1795,8 @@ pid_t tcgetsid(int fd)
 
 int tcsendbreak(int fd, int duration)
 {
-    const vfs_entry_t* vfs = get_vfs_for_fd(fd);
-    const int local_fd = get_local_fd(vfs, fd);
+    int local_fd;
+    const vfs_entry_t* vfs = get_vfs_for_fd(fd, &local_fd);
     struct _reent* r = __getreent();
     if (vfs == NULL || local_fd < 0) {
         __errno_r(r) = EBADF;
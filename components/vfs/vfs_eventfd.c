@@ -19,6 +19,7 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_vfs.h"
+#include "esp_vfs_pollset.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/portmacro.h"
 #include "spinlock.h"
@@ -59,6 +60,8 @@ typedef struct {
     volatile uint64_t       value;
     // a double-linked list for all pending select args with this fd
     event_select_args_t     *select_args;
+    // poll set watching this fd, if any
+    esp_vfs_pollset_watch_t *pollset_watch;
     _lock_t                 lock;
     // only for event fds that support ISR.
     portMUX_TYPE            data_spin_lock;
@@ -89,6 +92,26 @@ static void trigger_select_for_event_isr(event_context_t *event, BaseType_t *tas
     }
 }
 
+static void notify_pollset_for_event(event_context_t *event, uint32_t events)
+{
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+    if (event->pollset_watch != NULL) {
+        esp_vfs_pollset_notify(event->pollset_watch, events);
+    }
+#endif
+}
+
+static void notify_pollset_for_event_isr(event_context_t *event, uint32_t events, BaseType_t *task_woken)
+{
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+    if (event->pollset_watch != NULL) {
+        BaseType_t local_woken = pdFALSE;
+        esp_vfs_pollset_notify_isr(event->pollset_watch, events, &local_woken);
+        *task_woken = (local_woken || *task_woken);
+    }
+#endif
+}
+
 #ifdef CONFIG_VFS_SUPPORT_SELECT
 static esp_err_t event_start_select(int                  nfds,
                                     fd_set              *readfds,
@@ -216,6 +239,41 @@ static esp_err_t event_end_select(void *end_select_args)
 
     return ESP_OK;
 }
+
+static esp_err_t event_pollset_watch(int fd, esp_vfs_pollset_watch_t *watch, bool enable, uint32_t *ready_events)
+{
+    esp_err_t error = ESP_OK;
+
+    if (fd >= s_event_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    _lock_acquire_recursive(&s_events[fd].lock);
+    if (s_events[fd].support_isr) {
+        portENTER_CRITICAL(&s_events[fd].data_spin_lock);
+    }
+
+    if (s_events[fd].fd != fd) {
+        error = ESP_ERR_INVALID_ARG;
+    } else if (enable) {
+        if (s_events[fd].pollset_watch != NULL && s_events[fd].pollset_watch != watch) {
+            error = ESP_ERR_INVALID_STATE;
+        } else {
+            s_events[fd].pollset_watch = watch;
+            // event fds are always writable
+            *ready_events = ESP_VFS_POLLSET_OUT | (s_events[fd].is_set ? ESP_VFS_POLLSET_IN : 0);
+        }
+    } else if (s_events[fd].pollset_watch == watch) {
+        s_events[fd].pollset_watch = NULL;
+    }
+
+    if (s_events[fd].support_isr) {
+        portEXIT_CRITICAL(&s_events[fd].data_spin_lock);
+    }
+    _lock_release_recursive(&s_events[fd].lock);
+
+    return error;
+}
 #endif // CONFIG_VFS_SUPPORT_SELECT
 
 static ssize_t signal_event_fd_from_isr(int fd, const void *data, size_t size)
@@ -230,6 +288,7 @@ static ssize_t signal_event_fd_from_isr(int fd, const void *data, size_t size)
         s_events[fd].is_set = true;
         s_events[fd].value += *val;
         trigger_select_for_event_isr(&s_events[fd], &task_woken);
+        notify_pollset_for_event_isr(&s_events[fd], ESP_VFS_POLLSET_IN, &task_woken);
     } else {
         errno = EBADF;
         ret = -1;
@@ -271,6 +330,7 @@ static ssize_t event_write(int fd, const void *data, size_t size)
             s_events[fd].value += *val;
             ret = size;
             trigger_select_for_event(&s_events[fd]);
+            notify_pollset_for_event(&s_events[fd], ESP_VFS_POLLSET_IN);
         } else {
             errno = EBADF;
             ret = -1;
@@ -339,6 +399,9 @@ static int event_close(int fd)
             trigger_select_for_event(&s_events[fd]);
         }
         s_events[fd].value = 0;
+        // the poll set drops the watch on HUP
+        notify_pollset_for_event(&s_events[fd], ESP_VFS_POLLSET_HUP);
+        s_events[fd].pollset_watch = NULL;
         if (s_events[fd].support_isr) {
             portEXIT_CRITICAL(&s_events[fd].data_spin_lock);
         }
@@ -375,6 +438,7 @@ esp_err_t esp_vfs_eventfd_register(const esp_vfs_eventfd_config_t *config)
 #ifdef CONFIG_VFS_SUPPORT_SELECT
         .start_select = &event_start_select,
         .end_select   = &event_end_select,
+        .pollset_watch = &event_pollset_watch,
 #endif
     };
     return esp_vfs_register_with_id(&vfs, NULL, &s_eventfd_vfs_id);
@@ -433,6 +497,7 @@ int eventfd(unsigned int initval, int flags)
             s_events[i].is_set = false;
             s_events[i].value = initval;
             s_events[i].select_args = NULL;
+            s_events[i].pollset_watch = NULL;
             if (support_isr) {
                 portEXIT_CRITICAL(&s_events[i].data_spin_lock);
             }
@@ -0,0 +1,384 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/lock.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_vfs_pollset.h"
+#include "esp_vfs_private.h"
+
+#define POLLSET_ALWAYS_REPORTED (ESP_VFS_POLLSET_ERR | ESP_VFS_POLLSET_HUP)
+#define POLLSET_REQUESTABLE     (ESP_VFS_POLLSET_IN | ESP_VFS_POLLSET_OUT)
+
+/*
+ * One watch per file descriptor in the poll set. Watches live in an array owned by the poll set,
+ * the driver of the file descriptor keeps a pointer to the watch while it is attached.
+ *
+ * Fields written by drivers (pending, queued, closed, next_ready) and the ready list are
+ * protected by the poll set spinlock, so that notifications can come from ISRs. The remaining
+ * fields are only changed by the control functions under ctl_lock.
+ */
+struct esp_vfs_pollset_watch {
+    struct esp_vfs_pollset *pollset;
+    const vfs_entry_t *vfs;
+    int fd;                     // global fd
+    int local_fd;               // fd passed to the driver
+    void *user_data;
+    bool in_use;
+    volatile uint32_t events;   // requested events
+    uint32_t pending;           // events notified but not reported yet
+    bool queued;                // the watch is in the ready list
+    bool closed;                // the driver reported ESP_VFS_POLLSET_HUP and dropped the watch
+    struct esp_vfs_pollset_watch *next_ready;
+};
+
+struct esp_vfs_pollset {
+    portMUX_TYPE lock;
+    SemaphoreHandle_t ready_sem;
+    _lock_t ctl_lock;
+    esp_vfs_pollset_watch_t *ready_head;
+    esp_vfs_pollset_watch_t *ready_tail;
+    size_t max_fds;
+    esp_vfs_pollset_watch_t watches[];
+};
+
+/* Must be called with pollset->lock held. Returns true if the watch was put to the ready list. */
+static inline bool pollset_mark_ready(esp_vfs_pollset_watch_t *watch, uint32_t events)
+{
+    struct esp_vfs_pollset *pollset = watch->pollset;
+
+    if (events & ESP_VFS_POLLSET_HUP) {
+        watch->closed = true;
+    }
+    events &= watch->events | POLLSET_ALWAYS_REPORTED;
+    if (events == 0) {
+        return false;
+    }
+    watch->pending |= events;
+    if (watch->queued) {
+        return false;
+    }
+    watch->queued = true;
+    watch->next_ready = NULL;
+    if (pollset->ready_tail) {
+        pollset->ready_tail->next_ready = watch;
+    } else {
+        pollset->ready_head = watch;
+    }
+    pollset->ready_tail = watch;
+    return true;
+}
+
+/* Must be called with pollset->lock held */
+static void pollset_unqueue(struct esp_vfs_pollset *pollset, esp_vfs_pollset_watch_t *watch)
+{
+    if (!watch->queued) {
+        return;
+    }
+    esp_vfs_pollset_watch_t *prev = NULL;
+    for (esp_vfs_pollset_watch_t *it = pollset->ready_head; it != NULL; prev = it, it = it->next_ready) {
+        if (it == watch) {
+            if (prev) {
+                prev->next_ready = it->next_ready;
+            } else {
+                pollset->ready_head = it->next_ready;
+            }
+            if (pollset->ready_tail == it) {
+                pollset->ready_tail = prev;
+            }
+            break;
+        }
+    }
+    watch->queued = false;
+    watch->pending = 0;
+}
+
+void esp_vfs_pollset_notify(esp_vfs_pollset_watch_t *watch, uint32_t events)
+{
+    struct esp_vfs_pollset *pollset = watch->pollset;
+
+    portENTER_CRITICAL(&pollset->lock);
+    const bool wake = pollset_mark_ready(watch, events);
+    portEXIT_CRITICAL(&pollset->lock);
+
+    if (wake) {
+        xSemaphoreGive(pollset->ready_sem);
+    }
+}
+
+void esp_vfs_pollset_notify_isr(esp_vfs_pollset_watch_t *watch, uint32_t events, BaseType_t *woken)
+{
+    struct esp_vfs_pollset *pollset = watch->pollset;
+
+    portENTER_CRITICAL_ISR(&pollset->lock);
+    const bool wake = pollset_mark_ready(watch, events);
+    portEXIT_CRITICAL_ISR(&pollset->lock);
+
+    if (wake) {
+        xSemaphoreGiveFromISR(pollset->ready_sem, woken);
+    }
+}
+
+static esp_err_t pollset_driver_watch(esp_vfs_pollset_watch_t *watch, bool enable, uint32_t *ready_events)
+{
+    return watch->vfs->vfs->select->pollset_watch(watch->local_fd, watch, enable, ready_events);
+}
+
+/* Must be called with pollset->ctl_lock held */
+static esp_vfs_pollset_watch_t *pollset_find(struct esp_vfs_pollset *pollset, int fd)
+{
+    for (size_t i = 0; i < pollset->max_fds; i++) {
+        esp_vfs_pollset_watch_t *watch = &pollset->watches[i];
+        if (watch->in_use && !watch->closed && watch->fd == fd) {
+            return watch;
+        }
+    }
+    return NULL;
+}
+
+/* Must be called with pollset->ctl_lock held */
+static void pollset_release(struct esp_vfs_pollset *pollset, esp_vfs_pollset_watch_t *watch)
+{
+    if (!watch->closed) {
+        uint32_t unused;
+        pollset_driver_watch(watch, false, &unused);
+    }
+    portENTER_CRITICAL(&pollset->lock);
+    pollset_unqueue(pollset, watch);
+    watch->closed = false;
+    portEXIT_CRITICAL(&pollset->lock);
+    watch->in_use = false;
+}
+
+esp_err_t esp_vfs_pollset_create(size_t max_fds, esp_vfs_pollset_handle_t *ret_pollset)
+{
+    if (max_fds == 0 || max_fds > MAX_FDS || ret_pollset == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct esp_vfs_pollset *pollset = heap_caps_calloc(1, sizeof(struct esp_vfs_pollset) + max_fds * sizeof(esp_vfs_pollset_watch_t),
+                                                       VFS_MALLOC_FLAGS);
+    if (pollset == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pollset->ready_sem = xSemaphoreCreateBinary();
+    if (pollset->ready_sem == NULL) {
+        free(pollset);
+        return ESP_ERR_NO_MEM;
+    }
+    portMUX_INITIALIZE(&pollset->lock);
+    _lock_init(&pollset->ctl_lock);
+    pollset->max_fds = max_fds;
+    for (size_t i = 0; i < max_fds; i++) {
+        pollset->watches[i].pollset = pollset;
+        pollset->watches[i].fd = -1;
+    }
+
+    *ret_pollset = pollset;
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_pollset_delete(esp_vfs_pollset_handle_t pollset)
+{
+    if (pollset == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    _lock_acquire(&pollset->ctl_lock);
+    for (size_t i = 0; i < pollset->max_fds; i++) {
+        if (pollset->watches[i].in_use) {
+            pollset_release(pollset, &pollset->watches[i]);
+        }
+    }
+    _lock_release(&pollset->ctl_lock);
+
+    _lock_close(&pollset->ctl_lock);
+    vSemaphoreDelete(pollset->ready_sem);
+    free(pollset);
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_pollset_add(esp_vfs_pollset_handle_t pollset, int fd, uint32_t events, void *user_data)
+{
+    if (pollset == NULL || (events & ~POLLSET_REQUESTABLE) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int local_fd;
+    const vfs_entry_t *vfs = get_vfs_for_fd(fd, &local_fd);
+    if (vfs == NULL || local_fd < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (vfs->vfs->select == NULL || vfs->vfs->select->pollset_watch == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    esp_err_t err = ESP_OK;
+    _lock_acquire(&pollset->ctl_lock);
+
+    esp_vfs_pollset_watch_t *watch = NULL;
+    if (pollset_find(pollset, fd) != NULL) {
+        err = ESP_ERR_INVALID_STATE;
+        goto out;
+    }
+    for (size_t i = 0; i < pollset->max_fds; i++) {
+        if (!pollset->watches[i].in_use) {
+            watch = &pollset->watches[i];
+            break;
+        }
+    }
+    if (watch == NULL) {
+        err = ESP_ERR_NO_MEM;
+        goto out;
+    }
+
+    watch->vfs = vfs;
+    watch->fd = fd;
+    watch->local_fd = local_fd;
+    watch->user_data = user_data;
+    watch->events = events;
+    watch->pending = 0;
+    watch->queued = false;
+    watch->closed = false;
+
+    uint32_t ready_events = 0;
+    err = pollset_driver_watch(watch, true, &ready_events);
+    if (err != ESP_OK) {
+        goto out;
+    }
+    watch->in_use = true;
+    if (ready_events) {
+        esp_vfs_pollset_notify(watch, ready_events);
+    }
+
+out:
+    _lock_release(&pollset->ctl_lock);
+    return err;
+}
+
+esp_err_t esp_vfs_pollset_modify(esp_vfs_pollset_handle_t pollset, int fd, uint32_t events, void *user_data)
+{
+    if (pollset == NULL || (events & ~POLLSET_REQUESTABLE) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    _lock_acquire(&pollset->ctl_lock);
+
+    esp_vfs_pollset_watch_t *watch = pollset_find(pollset, fd);
+    if (watch == NULL) {
+        err = ESP_ERR_NOT_FOUND;
+        goto out;
+    }
+
+    portENTER_CRITICAL(&pollset->lock);
+    watch->events = events;
+    watch->user_data = user_data;
+    watch->pending &= events | POLLSET_ALWAYS_REPORTED;
+    portEXIT_CRITICAL(&pollset->lock);
+
+    // Attaching an already attached watch only queries the current readiness
+    uint32_t ready_events = 0;
+    err = pollset_driver_watch(watch, true, &ready_events);
+    if (err == ESP_OK && ready_events) {
+        esp_vfs_pollset_notify(watch, ready_events);
+    }
+
+out:
+    _lock_release(&pollset->ctl_lock);
+    return err;
+}
+
+esp_err_t esp_vfs_pollset_remove(esp_vfs_pollset_handle_t pollset, int fd)
+{
+    if (pollset == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    _lock_acquire(&pollset->ctl_lock);
+
+    esp_vfs_pollset_watch_t *watch = pollset_find(pollset, fd);
+    if (watch == NULL) {
+        err = ESP_ERR_NOT_FOUND;
+    } else {
+        pollset_release(pollset, watch);
+    }
+
+    _lock_release(&pollset->ctl_lock);
+    return err;
+}
+
+/* Moves up to max_events ready watches to the events array, O(number of ready fds) */
+static int pollset_drain(struct esp_vfs_pollset *pollset, esp_vfs_pollset_event_t *events, int max_events)
+{
+    int count = 0;
+
+    _lock_acquire(&pollset->ctl_lock);
+    while (count < max_events) {
+        portENTER_CRITICAL(&pollset->lock);
+        esp_vfs_pollset_watch_t *watch = pollset->ready_head;
+        if (watch == NULL) {
+            portEXIT_CRITICAL(&pollset->lock);
+            break;
+        }
+        pollset->ready_head = watch->next_ready;
+        if (pollset->ready_head == NULL) {
+            pollset->ready_tail = NULL;
+        }
+        const uint32_t pending = watch->pending;
+        const bool closed = watch->closed;
+        watch->queued = false;
+        watch->pending = 0;
+        portEXIT_CRITICAL(&pollset->lock);
+
+        events[count].fd = watch->fd;
+        events[count].events = pending;
+        events[count].user_data = watch->user_data;
+        count++;
+
+        if (closed) {
+            // The driver has already dropped the watch, the slot can be reused
+            watch->closed = false;
+            watch->in_use = false;
+        }
+    }
+    _lock_release(&pollset->ctl_lock);
+
+    return count;
+}
+
+int esp_vfs_pollset_wait(esp_vfs_pollset_handle_t pollset, esp_vfs_pollset_event_t *events, int max_events, int timeout_ms)
+{
+    if (pollset == NULL || events == NULL || max_events <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    TickType_t ticks_to_wait = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    while (true) {
+        const int count = pollset_drain(pollset, events, max_events);
+        if (count > 0 || ticks_to_wait == 0) {
+            return count;
+        }
+        // The semaphore may be stale if the watch it was given for has already been drained,
+        // in that case the loop waits again for the rest of the timeout.
+        if (xSemaphoreTake(pollset->ready_sem, ticks_to_wait) != pdTRUE) {
+            return pollset_drain(pollset, events, max_events);
+        }
+        if (ticks_to_wait != portMAX_DELAY && xTaskCheckForTimeOut(&timeout, &ticks_to_wait) == pdTRUE) {
+            ticks_to_wait = 0;
+        }
+    }
+}
@@ -52,6 +52,20 @@ esp_err_t Partition::read(size_t src_addr, void *dest, size_t size)
     return result;
 }
 
+esp_err_t Partition::readv(const esp_partition_read_vec_t *vec, size_t count)
+{
+    esp_err_t result = ESP_OK;
+    result = esp_partition_readv(this->partition, vec, count);
+    return result;
+}
+
+esp_err_t Partition::writev(const esp_partition_write_vec_t *vec, size_t count)
+{
+    esp_err_t result = ESP_OK;
+    result = esp_partition_writev(this->partition, vec, count);
+    return result;
+}
+
 size_t Partition::get_sector_size()
 {
     return this->partition->erase_size;
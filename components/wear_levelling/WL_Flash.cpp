@@ -19,6 +19,11 @@ static const char *TAG = "wl_flash";
 #define WL_CFG_CRC_CONST UINT32_MAX
 #endif // WL_CFG_CRC_CONST
 
+// Maximal number of remapped pages passed to the partition in one batch
+#ifndef WL_FLASH_VEC_BATCH
+#define WL_FLASH_VEC_BATCH 16
+#endif // WL_FLASH_VEC_BATCH
+
 #define WL_RESULT_CHECK(result) \
     if (result != ESP_OK) { \
         ESP_LOGE(TAG,"%s(%d): result = 0x%08" PRIx32, __FUNCTION__, __LINE__, (uint32_t) result); \
@@ -579,15 +584,20 @@ esp_err_t WL_Flash::write(size_t dest_addr, const void *src, size_t size)
         return ESP_ERR_INVALID_STATE;
     }
     ESP_LOGD(TAG, "%s - dest_addr= 0x%08" PRIx32 ", size= 0x%08" PRIx32 , __func__, (uint32_t) dest_addr, (uint32_t) size);
+    // pages are remapped one by one and the resulting segments are written in batches
+    esp_partition_write_vec_t vec[WL_FLASH_VEC_BATCH];
+    size_t vec_count = 0;
     uint32_t count = (size - 1) / this->cfg.wl_page_size;
-    for (size_t i = 0; i < count; i++) {
+    for (size_t i = 0; i <= count; i++) {
         size_t virt_addr = this->calcAddr(dest_addr + i * this->cfg.wl_page_size);
-        result = this->partition->write(this->cfg.wl_partition_start_addr + virt_addr, &((uint8_t *)src)[i * this->cfg.wl_page_size], this->cfg.wl_page_size);
-        WL_RESULT_CHECK(result);
+        size_t page_size = (i < count) ? this->cfg.wl_page_size : size - count * this->cfg.wl_page_size;
+        vec[vec_count++] = {this->cfg.wl_partition_start_addr + virt_addr, &((const uint8_t *)src)[i * this->cfg.wl_page_size], page_size};
+        if (vec_count == WL_FLASH_VEC_BATCH || i == count) {
+            result = this->partition->writev(vec, vec_count);
+            WL_RESULT_CHECK(result);
+            vec_count = 0;
+        }
     }
-    size_t virt_addr_last = this->calcAddr(dest_addr + count * this->cfg.wl_page_size);
-    result = this->partition->write(this->cfg.wl_partition_start_addr + virt_addr_last, &((uint8_t *)src)[count * this->cfg.wl_page_size], size - count * this->cfg.wl_page_size);
-    WL_RESULT_CHECK(result);
     return result;
 }
 
@@ -598,16 +608,21 @@ esp_err_t WL_Flash::read(size_t src_addr, void *dest, size_t size)
         return ESP_ERR_INVALID_STATE;
     }
     ESP_LOGD(TAG, "%s - src_addr= 0x%08" PRIx32 ", size= 0x%08" PRIx32 , __func__, (uint32_t) src_addr, (uint32_t) size);
+    // pages are remapped one by one and the resulting segments are read in batches
+    esp_partition_read_vec_t vec[WL_FLASH_VEC_BATCH];
+    size_t vec_count = 0;
     uint32_t count = (size - 1) / this->cfg.wl_page_size;
-    for (size_t i = 0; i < count; i++) {
+    for (size_t i = 0; i <= count; i++) {
         size_t virt_addr = this->calcAddr(src_addr + i * this->cfg.wl_page_size);
-        ESP_LOGV(TAG, "%s - real_addr= 0x%08" PRIx32 ", size= 0x%08" PRIx32 , __func__, (uint32_t) (this->cfg.wl_partition_start_addr + virt_addr), (uint32_t) size);
-        result = this->partition->read(this->cfg.wl_partition_start_addr + virt_addr, &((uint8_t *)dest)[i * this->cfg.wl_page_size], this->cfg.wl_page_size);
-        WL_RESULT_CHECK(result);
+        size_t page_size = (i < count) ? this->cfg.wl_page_size : size - count * this->cfg.wl_page_size;
+        ESP_LOGV(TAG, "%s - real_addr= 0x%08" PRIx32 ", size= 0x%08" PRIx32 , __func__, (uint32_t) (this->cfg.wl_partition_start_addr + virt_addr), (uint32_t) page_size);
+        vec[vec_count++] = {this->cfg.wl_partition_start_addr + virt_addr, &((uint8_t *)dest)[i * this->cfg.wl_page_size], page_size};
+        if (vec_count == WL_FLASH_VEC_BATCH || i == count) {
+            result = this->partition->readv(vec, vec_count);
+            WL_RESULT_CHECK(result);
+            vec_count = 0;
+        }
     }
-    size_t virt_addr_last = this->calcAddr(src_addr + count * this->cfg.wl_page_size);
-    result = this->partition->read(this->cfg.wl_partition_start_addr + virt_addr_last, &((uint8_t *)dest)[count * this->cfg.wl_page_size], size - count * this->cfg.wl_page_size);
-    WL_RESULT_CHECK(result);
     return result;
 }
 
@@ -99,6 +99,58 @@ TEST_CASE("write and read back data", "[wear_levelling]")
     free(read);
 }
 
+TEST_CASE("multi-page read and write issue one flash operation per batch", "[wear_levelling]")
+{
+    esp_err_t result;
+    wl_handle_t wl_handle;
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+
+    result = wl_mount(partition, &wl_handle);
+    REQUIRE(result == ESP_OK);
+
+    // 16 pages fit into one batch of WL_Flash
+    const size_t sector_size = wl_sector_size(wl_handle);
+    const size_t size = 16 * sector_size;
+    uint8_t* data = (uint8_t*) malloc(size);
+    uint8_t* read = (uint8_t*) malloc(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (uint8_t) (i * 7 + i / sector_size);
+    }
+
+    result = wl_erase_range(wl_handle, 0, size);
+    REQUIRE(result == ESP_OK);
+
+    esp_partition_clear_stats();
+    result = wl_write(wl_handle, 0, data, size);
+    REQUIRE(result == ESP_OK);
+    result = wl_read(wl_handle, 0, read, size);
+    REQUIRE(result == ESP_OK);
+    REQUIRE(memcmp(data, read, size) == 0);
+
+    ESP_LOGI(TAG, "%zu pages: %zu write ops, %zu read ops", size / sector_size, esp_partition_get_write_ops(), esp_partition_get_read_ops());
+    CHECK(esp_partition_get_write_ops() == 1);
+    CHECK(esp_partition_get_read_ops() == 1);
+    CHECK(esp_partition_get_write_bytes() == size);
+    CHECK(esp_partition_get_read_bytes() == size);
+
+    // unaligned size spanning more than one batch
+    const size_t big_size = size * 2 + sector_size / 2;
+    uint8_t* big = (uint8_t*) malloc(big_size);
+    esp_partition_clear_stats();
+    result = wl_read(wl_handle, 0, big, big_size);
+    REQUIRE(result == ESP_OK);
+    REQUIRE(memcmp(data, big, size) == 0);
+    CHECK(esp_partition_get_read_ops() == 3);
+
+    result = wl_unmount(wl_handle);
+    REQUIRE(result == ESP_OK);
+
+    free(big);
+    free(data);
+    free(read);
+}
+
 TEST_CASE("power down test", "[wear_levelling]")
 {
     esp_err_t result;
@@ -30,6 +30,15 @@ public:
     virtual esp_err_t write(size_t dest_addr, const void *src, size_t size);
     virtual esp_err_t read(size_t src_addr, void *dest, size_t size);
 
+    /**
+     * @brief Read several segments in one batch, see esp_partition_readv
+     */
+    virtual esp_err_t readv(const esp_partition_read_vec_t *vec, size_t count);
+    /**
+     * @brief Write several segments in one batch and in the array order, see esp_partition_writev
+     */
+    virtual esp_err_t writev(const esp_partition_write_vec_t *vec, size_t count);
+
     virtual size_t get_sector_size();
     virtual bool is_readonly();
 
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include <sys/time.h>
+#include "pcap_file.h"
+
+#define PCAP_MAGIC_US       0xa1b2c3d4
+#define PCAP_MAGIC_NS       0xa1b23c4d
+#define PCAP_VERSION_MAJOR  2
+#define PCAP_VERSION_MINOR  4
+#define PCAP_SNAPLEN        65535
+#define PCAP_LINKTYPE_ETHERNET 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+} pcap_file_header_t;
+
+typedef struct {
+    uint32_t ts_sec;
+    uint32_t ts_frac;
+    uint32_t caplen;
+    uint32_t len;
+} pcap_record_header_t;
+
+static uint32_t pcap_u32(const pcap_file_t *pcap, uint32_t value)
+{
+    return pcap->swapped ? __builtin_bswap32(value) : value;
+}
+
+esp_err_t pcap_file_open_read(pcap_file_t *pcap, const char *path)
+{
+    memset(pcap, 0, sizeof(*pcap));
+    pcap->file = fopen(path, "rb");
+    if (pcap->file == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    pcap_file_header_t header;
+    if (fread(&header, sizeof(header), 1, pcap->file) != 1) {
+        goto invalid;
+    }
+    if (header.magic == PCAP_MAGIC_US || header.magic == PCAP_MAGIC_NS) {
+        pcap->swapped = false;
+    } else if (header.magic == __builtin_bswap32(PCAP_MAGIC_US) || header.magic == __builtin_bswap32(PCAP_MAGIC_NS)) {
+        pcap->swapped = true;
+    } else {
+        goto invalid;
+    }
+    pcap->nanoseconds = pcap_u32(pcap, header.magic) == PCAP_MAGIC_NS;
+    if (pcap_u32(pcap, header.linktype) != PCAP_LINKTYPE_ETHERNET) {
+        goto invalid;
+    }
+    return ESP_OK;
+
+invalid:
+    pcap_file_close(pcap);
+    return ESP_ERR_INVALID_VERSION;
+}
+
+esp_err_t pcap_file_open_write(pcap_file_t *pcap, const char *path)
+{
+    memset(pcap, 0, sizeof(*pcap));
+    pcap->file = fopen(path, "wb");
+    if (pcap->file == NULL) {
+        return ESP_FAIL;
+    }
+    pcap_file_header_t header = {
+        .magic = PCAP_MAGIC_US,
+        .version_major = PCAP_VERSION_MAJOR,
+        .version_minor = PCAP_VERSION_MINOR,
+        .snaplen = PCAP_SNAPLEN,
+        .linktype = PCAP_LINKTYPE_ETHERNET,
+    };
+    if (fwrite(&header, sizeof(header), 1, pcap->file) != 1) {
+        pcap_file_close(pcap);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+int pcap_file_read(pcap_file_t *pcap, void *frame, size_t size, uint64_t *timestamp_us)
+{
+    pcap_record_header_t record;
+    size_t read = fread(&record, 1, sizeof(record), pcap->file);
+    if (read == 0 && feof(pcap->file)) {
+        return 0;
+    }
+    if (read != sizeof(record)) {
+        return -1;
+    }
+    uint32_t caplen = pcap_u32(pcap, record.caplen);
+    uint32_t frac = pcap_u32(pcap, record.ts_frac);
+    *timestamp_us = (uint64_t)pcap_u32(pcap, record.ts_sec) * 1000000 + (pcap->nanoseconds ? frac / 1000 : frac);
+    size_t len = caplen < size ? caplen : size;
+    if (fread(frame, 1, len, pcap->file) != len) {
+        return -1;
+    }
+    if (caplen > len && fseek(pcap->file, caplen - len, SEEK_CUR) != 0) {
+        return -1;
+    }
+    return len;
+}
+
+esp_err_t pcap_file_rewind(pcap_file_t *pcap)
+{
+    return fseek(pcap->file, sizeof(pcap_file_header_t), SEEK_SET) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t pcap_file_write(pcap_file_t *pcap, const void *frame, size_t len)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    pcap_record_header_t record = {
+        .ts_sec = now.tv_sec,
+        .ts_frac = now.tv_usec,
+        .caplen = len,
+        .len = len,
+    };
+    if (fwrite(&record, sizeof(record), 1, pcap->file) != 1 ||
+            fwrite(frame, 1, len, pcap->file) != len) {
+        return ESP_FAIL;
+    }
+    // keep the capture readable when the application is interrupted
+    return fflush(pcap->file) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+void pcap_file_close(pcap_file_t *pcap)
+{
+    if (pcap->file) {
+        fclose(pcap->file);
+        pcap->file = NULL;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+/**
+ * @brief Ethernet frames stored in the classic pcap file format (readable by tcpdump and Wireshark)
+ */
+typedef struct pcap_file {
+    FILE *file;
+    bool swapped;           /*!< File written with the other byte order */
+    bool nanoseconds;       /*!< Timestamps in nanoseconds instead of microseconds */
+} pcap_file_t;
+
+/**
+ * @brief Opens a capture for reading, checks that it holds Ethernet frames
+ *
+ * @return ESP_OK on success
+ *         ESP_ERR_NOT_FOUND if the file cannot be opened
+ *         ESP_ERR_INVALID_VERSION if the file is not a pcap file or the link type is not Ethernet
+ */
+esp_err_t pcap_file_open_read(pcap_file_t *pcap, const char *path);
+
+/**
+ * @brief Creates (or truncates) a capture of Ethernet frames
+ *
+ * @return ESP_OK on success, ESP_FAIL if the file cannot be written
+ */
+esp_err_t pcap_file_open_write(pcap_file_t *pcap, const char *path);
+
+/**
+ * @brief Reads the next frame
+ *
+ * @param[out] timestamp_us capture time of the frame
+ *
+ * @return length of the frame, 0 at the end of the file, -1 on error
+ *         Frames longer than the buffer are truncated to the buffer size
+ */
+int pcap_file_read(pcap_file_t *pcap, void *frame, size_t size, uint64_t *timestamp_us);
+
+/**
+ * @brief Moves back to the first frame of the capture
+ */
+esp_err_t pcap_file_rewind(pcap_file_t *pcap);
+
+/**
+ * @brief Appends a frame stamped with the current time
+ */
+esp_err_t pcap_file_write(pcap_file_t *pcap, const void *frame, size_t len);
+
+void pcap_file_close(pcap_file_t *pcap);
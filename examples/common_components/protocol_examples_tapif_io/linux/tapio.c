@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -24,17 +24,46 @@
 #include <linux/if.h>
 #include <linux/if_tun.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "pcap_file.h"
+
 #define DEVTAP "/dev/net/tun"
-#define DEVTAP_NAME "tap0"
+#if CONFIG_EXAMPLE_CONNECT_TAPIF_IO_TAP
+#define DEVTAP_NAME CONFIG_EXAMPLE_CONNECT_TAPIF_DEV_NAME
+#endif
 
+#define MAX_FRAME_SIZE 1518 /* max packet size including VLAN excluding CRC */
 
 typedef struct tap_io {
     esp_netif_driver_base_t base;
     int fd;
+    pcap_file_t replay;         /* Frames received by the interface in the replay mode */
+    pcap_file_t capture;        /* Frames sent and received by the interface, if the capture is enabled */
+    sys_mutex_t capture_lock;
 } tap_io_t;
 
 static const char *TAG = "tap-netif";
 
+static void tapio_capture(tap_io_t *io, const void *frame, size_t len)
+{
+    if (io->capture.file == NULL) {
+        return;
+    }
+    sys_mutex_lock(&io->capture_lock);
+    if (pcap_file_write(&io->capture, frame, len) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write to the capture, stopped capturing");
+        pcap_file_close(&io->capture);
+    }
+    sys_mutex_unlock(&io->capture_lock);
+}
+
+static bool tapio_simulated_loss(int loss_percent)
+{
+    return loss_percent && ((double)rand()/(double)RAND_MAX) < ((double)loss_percent)/100.0;
+}
+
+#if CONFIG_EXAMPLE_CONNECT_TAPIF_IO_TAP
 static void tapio_input_task(void *arg)
 {
     tap_io_t *io = arg;
@@ -50,7 +79,7 @@ static void tapio_input_task(void *arg)
         if (ret == 1) {
             /* Handle incoming packet. */
             ssize_t readlen;
-            char buf[1518]; /* max packet size including VLAN excluding CRC */
+            char buf[MAX_FRAME_SIZE];
 
             /* Obtain the size of the packet and put it into the "len"
                variable. */
@@ -59,12 +88,11 @@ static void tapio_input_task(void *arg)
                 ESP_LOGE(TAG, "Failed to read from tap fd: returned %ld", readlen);
                 exit(1);
             }
-#if CONFIG_EXAMPLE_CONNECT_TAPIF_IN_LOSS
-            if (((double)rand()/(double)RAND_MAX) < ((double)CONFIG_EXAMPLE_CONNECT_TAPIF_IN_LOSS)/100.0) {
+            if (tapio_simulated_loss(CONFIG_EXAMPLE_CONNECT_TAPIF_IN_LOSS)) {
                 ESP_LOGW(TAG, "Simulated packet drop on input");
                 continue;
             }
-#endif
+            tapio_capture(io, buf, readlen);
             esp_netif_receive(io->base.netif, buf, readlen, NULL);
         } else if (ret == -1) {
             if (errno == EINTR /* Interrupted system call (used by FreeRTOS simulated interrupts) */) {
@@ -75,6 +103,51 @@ static void tapio_input_task(void *arg)
         }
     }
 }
+#endif // CONFIG_EXAMPLE_CONNECT_TAPIF_IO_TAP
+
+#if CONFIG_EXAMPLE_CONNECT_TAPIF_IO_PCAP
+/* Feeds the frames of the replayed capture to the interface. Runs at the lowest priority, so the next
+ * frame is fed only once the stack and the application consumed the previous ones */
+static void tapio_replay_task(void *arg)
+{
+    tap_io_t *io = arg;
+    static char buf[MAX_FRAME_SIZE];
+    uint64_t frames = 0;
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_REPLAY_DELAY_MS));
+    for (int loop = 0; CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_REPLAY_LOOPS == 0 || loop < CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_REPLAY_LOOPS; loop++) {
+#if CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_REPLAY_TIMING
+        uint64_t first_frame_us = 0;
+        TickType_t start = xTaskGetTickCount();
+#endif
+        uint64_t timestamp_us;
+        int len;
+        while ((len = pcap_file_read(&io->replay, buf, sizeof(buf), &timestamp_us)) > 0) {
+#if CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_REPLAY_TIMING
+            if (first_frame_us == 0) {
+                first_frame_us = timestamp_us;
+            }
+            TickType_t due = start + pdMS_TO_TICKS((timestamp_us - first_frame_us) / 1000);
+            TickType_t now = xTaskGetTickCount();
+            if ((int32_t)(due - now) > 0) {
+                vTaskDelay(due - now);
+            }
+#endif
+            if (tapio_simulated_loss(CONFIG_EXAMPLE_CONNECT_TAPIF_IN_LOSS)) {
+                continue;
+            }
+            tapio_capture(io, buf, len);
+            esp_netif_receive(io->base.netif, buf, len, NULL);
+            frames++;
+        }
+        if (len < 0 || pcap_file_rewind(&io->replay) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to read the replayed capture");
+            break;
+        }
+    }
+    ESP_LOGI(TAG, "Replayed %llu frames", (unsigned long long)frames);
+    vTaskDelete(NULL);
+}
+#endif // CONFIG_EXAMPLE_CONNECT_TAPIF_IO_PCAP
 
 static esp_err_t tapio_start(esp_netif_t *esp_netif, void *arg)
 {
@@ -82,7 +155,11 @@ static esp_err_t tapio_start(esp_netif_t *esp_netif, void *arg)
     io->base.netif = esp_netif;
     esp_netif_action_start(esp_netif, 0, 0, 0);
 
+#if CONFIG_EXAMPLE_CONNECT_TAPIF_IO_PCAP
+    sys_thread_new("tapio_replay", tapio_replay_task, io, DEFAULT_THREAD_STACKSIZE, tskIDLE_PRIORITY + 1);
+#else
     sys_thread_new("tapio_rx", tapio_input_task, io, DEFAULT_THREAD_STACKSIZE, DEFAULT_THREAD_PRIO);
+#endif
 
     return ESP_OK;
 }
@@ -91,6 +168,25 @@ void *tapio_create(void)
 {
     static tap_io_t tap_io = {};
     tap_io.base.post_attach = tapio_start;
+    tap_io.fd = -1;
+
+    if (strlen(CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_CAPTURE) > 0) {
+        if (sys_mutex_new(&tap_io.capture_lock) != ERR_OK ||
+                pcap_file_open_write(&tap_io.capture, CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_CAPTURE) != ESP_OK) {
+            ESP_LOGE(TAG, "Cannot create the capture %s", CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_CAPTURE);
+            return NULL;
+        }
+    }
+
+#if CONFIG_EXAMPLE_CONNECT_TAPIF_IO_PCAP
+    esp_err_t err = pcap_file_open_read(&tap_io.replay, CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_REPLAY);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot replay %s: %s", CONFIG_EXAMPLE_CONNECT_TAPIF_PCAP_REPLAY,
+                 err == ESP_ERR_NOT_FOUND ? "cannot open the file" : "not a pcap capture of Ethernet frames");
+        return NULL;
+    }
+    return &tap_io;
+#else
     tap_io.fd = open(DEVTAP, O_RDWR);
     if (tap_io.fd == -1) {
         ESP_LOGE(TAG, "Cannot open tap device %s", DEVTAP);
@@ -110,6 +206,7 @@ void *tapio_create(void)
 
 
     return &tap_io;
+#endif // CONFIG_EXAMPLE_CONNECT_TAPIF_IO_PCAP
 }
 
 esp_err_t tapio_output(void *h, void *buffer, size_t len)
@@ -117,13 +214,16 @@ esp_err_t tapio_output(void *h, void *buffer, size_t len)
     tap_io_t *io = h;
     ssize_t written;
 
-#if CONFIG_EXAMPLE_CONNECT_TAPIF_OUT_LOSS
-    if (((double)rand()/(double)RAND_MAX) < ((double)CONFIG_EXAMPLE_CONNECT_TAPIF_OUT_LOSS)/100.0) {
+    if (tapio_simulated_loss(CONFIG_EXAMPLE_CONNECT_TAPIF_OUT_LOSS)) {
         ESP_LOGW(TAG, "Simulated packet drop on output");
         return ESP_OK; /* ESP_OK because we simulate packet loss on cable */
     }
-#endif
 
+    tapio_capture(io, buffer, len);
+    if (io->fd < 0) {
+        /* replay mode, the frames go nowhere */
+        return ESP_OK;
+    }
     /* signal that packet should be sent(); */
     written = write(io->fd, buffer, len);
     if (written < len) {
@@ -0,0 +1,110 @@
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+"""Host side peer of the socket_perf example.
+
+sink:   receives the data of the "Send throughput" test
+source: sends data for the "Receive throughput" test, connecting to the example
+echo:   answers the requests of the "Round trip latency" test
+"""
+import argparse
+import socket
+import time
+
+DEF_PORT = 5001
+
+
+def report(start: float, now: float, total: int, packets: int) -> None:
+    seconds = now - start
+    print('{:6.1f} sec {:9.2f} MBytes {:9.2f} Mbits/sec {:10.0f} packets/sec'.format(
+        seconds, total / 1e6, total * 8 / seconds / 1e6, packets / seconds))
+
+
+def sink(sock: socket.socket) -> None:
+    total = packets = 0
+    start = last = 0.0
+    while True:
+        try:
+            data = sock.recv(65536)
+        except socket.timeout:
+            break
+        if not data:
+            break
+        last = time.monotonic()
+        if not packets:
+            start = last
+        total += len(data)
+        packets += 1
+    if packets:
+        # the idle timeout is not part of the test
+        report(start, last, total, packets)
+
+
+def source(sock: socket.socket, length: int, duration: float) -> None:
+    payload = bytes(length)
+    total = packets = 0
+    start = time.monotonic()
+    while time.monotonic() - start < duration:
+        total += sock.send(payload)
+        packets += 1
+    report(start, time.monotonic(), total, packets)
+
+
+def echo(sock: socket.socket, udp: bool) -> None:
+    while True:
+        if udp:
+            data, addr = sock.recvfrom(65536)
+            sock.sendto(data, addr)
+        else:
+            data = sock.recv(65536)
+            if not data:
+                break
+            sock.sendall(data)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Peer of the socket_perf example')
+    parser.add_argument('mode', choices=['sink', 'source', 'echo'])
+    parser.add_argument('--udp', action='store_true', help='use UDP instead of TCP')
+    parser.add_argument('--host', default='192.168.5.100', help='address of the example (source mode)')
+    parser.add_argument('--port', type=int, default=DEF_PORT)
+    parser.add_argument('--len', type=int, default=1460, help='length of the writes or datagrams (source mode)')
+    parser.add_argument('--time', type=float, default=10, help='duration of the test (source mode)')
+    args = parser.parse_args()
+
+    sock_type = socket.SOCK_DGRAM if args.udp else socket.SOCK_STREAM
+    if args.mode == 'source':
+        with socket.socket(socket.AF_INET, sock_type) as sock:
+            sock.connect((args.host, args.port))
+            if not args.udp:
+                sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            source(sock, args.len, args.time)
+        return
+
+    with socket.socket(socket.AF_INET, sock_type) as server:
+        server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        server.bind(('', args.port))
+        print('{} {} peer on port {}'.format('UDP' if args.udp else 'TCP', args.mode, args.port))
+        while True:
+            if args.udp:
+                if args.mode == 'sink':
+                    # waits for the first datagram, then ends the test after a second of silence
+                    server.settimeout(None)
+                    server.recv(1, socket.MSG_PEEK)
+                    server.settimeout(1)
+                    sink(server)
+                else:
+                    echo(server, True)
+                continue
+            server.listen(1)
+            conn, addr = server.accept()
+            print('Connection from {}'.format(addr[0]))
+            with conn:
+                if args.mode == 'sink':
+                    sink(conn)
+                else:
+                    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                    echo(conn, False)
+
+
+if __name__ == '__main__':
+    main()
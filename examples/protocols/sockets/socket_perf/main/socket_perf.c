@@ -0,0 +1,405 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Socket throughput and latency example
+
+   Measures TCP and UDP throughput and round trip latency of the network stack, in the way of iperf,
+   against a peer running scripts/run_perf_peer.py. On the Linux target, the traffic goes through
+   lwIP and esp_netif to a tap interface or comes from a replayed pcap capture.
+*/
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "protocol_examples_common.h"
+
+#include "lwip/sockets.h"
+
+#define PERF_LEN            CONFIG_EXAMPLE_PERF_LEN
+#define PERF_DURATION_US    (CONFIG_EXAMPLE_PERF_DURATION * 1000000LL)
+#define PERF_INTERVAL_US    (CONFIG_EXAMPLE_PERF_INTERVAL * 1000000LL)
+/* Receive tests end when the peer stays silent that long */
+#define PERF_IDLE_TIMEOUT_S 1
+/* Round trips kept to compute the percentiles of the latency */
+#define PERF_LATENCY_SAMPLES 65536
+
+#if CONFIG_EXAMPLE_PERF_UDP_BATCH > 1
+/* Datagrams per sendmmsg() or recvmmsg() call */
+#define PERF_BATCH CONFIG_EXAMPLE_PERF_UDP_BATCH
+#else
+#define PERF_BATCH 1
+#endif
+
+#if CONFIG_EXAMPLE_PERF_TCP
+#define PERF_SOCK_TYPE SOCK_STREAM
+#define PERF_PROTOCOL "TCP"
+#else
+#define PERF_SOCK_TYPE SOCK_DGRAM
+#define PERF_PROTOCOL "UDP"
+#endif
+
+static const char *TAG = "socket_perf";
+
+typedef struct {
+    int64_t start_us;
+    int64_t interval_start_us;
+    uint64_t bytes;
+    uint64_t packets;
+    uint64_t interval_bytes;
+    uint64_t interval_packets;
+} perf_stats_t;
+
+static void perf_stats_start(perf_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->start_us = stats->interval_start_us = esp_timer_get_time();
+}
+
+static void perf_report(const perf_stats_t *stats, int64_t from_us, int64_t to_us, uint64_t bytes, uint64_t packets)
+{
+    double seconds = (to_us - from_us) / 1e6;
+    if (seconds <= 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "%6.1f-%6.1f sec %9.2f MBytes %9.2f Mbits/sec %10.0f packets/sec",
+             (from_us - stats->start_us) / 1e6, (to_us - stats->start_us) / 1e6,
+             bytes / 1e6, bytes * 8 / seconds / 1e6, packets / seconds);
+}
+
+static void perf_stats_add(perf_stats_t *stats, size_t len)
+{
+    stats->interval_bytes += len;
+    stats->interval_packets++;
+    int64_t now = esp_timer_get_time();
+    if (now - stats->interval_start_us >= PERF_INTERVAL_US) {
+        perf_report(stats, stats->interval_start_us, now, stats->interval_bytes, stats->interval_packets);
+        stats->bytes += stats->interval_bytes;
+        stats->packets += stats->interval_packets;
+        stats->interval_bytes = stats->interval_packets = 0;
+        stats->interval_start_us = now;
+    }
+}
+
+static void perf_stats_end(perf_stats_t *stats, int64_t end_us)
+{
+    stats->bytes += stats->interval_bytes;
+    stats->packets += stats->interval_packets;
+    ESP_LOGI(TAG, "Total:");
+    perf_report(stats, stats->start_us, end_us, stats->bytes, stats->packets);
+}
+
+static int perf_connect(void)
+{
+    struct sockaddr_in peer_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_EXAMPLE_PERF_PORT),
+    };
+    inet_pton(AF_INET, CONFIG_EXAMPLE_PERF_PEER_ADDR, &peer_addr.sin_addr);
+    int sock = socket(AF_INET, PERF_SOCK_TYPE, 0);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return -1;
+    }
+    // connected UDP sockets skip the route lookup of sendto() for every datagram
+    if (connect(sock, (struct sockaddr *)&peer_addr, sizeof(peer_addr)) != 0) {
+        ESP_LOGE(TAG, "Socket unable to connect to %s:%d: errno %d", CONFIG_EXAMPLE_PERF_PEER_ADDR, CONFIG_EXAMPLE_PERF_PORT, errno);
+        close(sock);
+        return -1;
+    }
+#if CONFIG_EXAMPLE_PERF_TCP && CONFIG_EXAMPLE_PERF_LATENCY
+    int nodelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+#endif
+    ESP_LOGI(TAG, PERF_PROTOCOL " socket connected to %s:%d", CONFIG_EXAMPLE_PERF_PEER_ADDR, CONFIG_EXAMPLE_PERF_PORT);
+    return sock;
+}
+
+#if CONFIG_EXAMPLE_PERF_SEND
+static void perf_send(char *buffer)
+{
+    int sock = perf_connect();
+    if (sock < 0) {
+        return;
+    }
+#if PERF_BATCH > 1
+    // all the datagrams of a batch send the same buffer
+    struct iovec iov = { .iov_base = buffer, .iov_len = PERF_LEN };
+    struct mmsghdr *msgs = calloc(PERF_BATCH, sizeof(struct mmsghdr));
+    if (msgs == NULL) {
+        ESP_LOGE(TAG, "No memory for the messages");
+        close(sock);
+        return;
+    }
+    for (int i = 0; i < PERF_BATCH; i++) {
+        msgs[i].msg_hdr.msg_iov = &iov;
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+    perf_stats_t stats;
+    perf_stats_start(&stats);
+#if CONFIG_EXAMPLE_PERF_UDP_BANDWIDTH
+    const int64_t datagram_period_us = PERF_BATCH * PERF_LEN * 8 * 1000LL / CONFIG_EXAMPLE_PERF_UDP_BANDWIDTH;
+    int64_t next_datagram_us = stats.start_us;
+#endif
+    int64_t now;
+    while ((now = esp_timer_get_time()) - stats.start_us < PERF_DURATION_US) {
+#if CONFIG_EXAMPLE_PERF_UDP_BANDWIDTH
+        if (next_datagram_us - now >= (int64_t)portTICK_PERIOD_MS * 1000) {
+            vTaskDelay((next_datagram_us - now) / 1000 / portTICK_PERIOD_MS);
+        }
+        next_datagram_us += datagram_period_us;
+#endif
+#if PERF_BATCH > 1
+        int len = sendmmsg(sock, msgs, PERF_BATCH, 0);
+#else
+        int len = send(sock, buffer, PERF_LEN, 0);
+#endif
+        if (len < 0) {
+            if (errno == ENOMEM) {
+                // UDP: no buffer to queue the datagram, as a network interface would drop it
+                continue;
+            }
+            ESP_LOGE(TAG, "Error occurred during sending: errno %d", errno);
+            break;
+        }
+#if PERF_BATCH > 1
+        for (int i = 0; i < len; i++) {
+            perf_stats_add(&stats, msgs[i].msg_len);
+        }
+#else
+        perf_stats_add(&stats, len);
+#endif
+    }
+    perf_stats_end(&stats, esp_timer_get_time());
+#if PERF_BATCH > 1
+    free(msgs);
+#endif
+    shutdown(sock, SHUT_RDWR);
+    close(sock);
+}
+#endif // CONFIG_EXAMPLE_PERF_SEND
+
+#if CONFIG_EXAMPLE_PERF_RECEIVE
+static void perf_receive_from(int sock, char *buffer)
+{
+    struct timeval timeout = { .tv_sec = PERF_IDLE_TIMEOUT_S };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    perf_stats_t stats = { 0 };
+    int64_t last_us = 0;
+    int len;
+#if PERF_BATCH > 1
+    // each datagram of a batch is received in its own part of the buffer
+    struct iovec *iov = calloc(PERF_BATCH, sizeof(struct iovec));
+    struct mmsghdr *msgs = calloc(PERF_BATCH, sizeof(struct mmsghdr));
+    if (iov == NULL || msgs == NULL) {
+        ESP_LOGE(TAG, "No memory for the messages");
+        free(iov);
+        free(msgs);
+        return;
+    }
+    for (int i = 0; i < PERF_BATCH; i++) {
+        iov[i].iov_base = buffer + i * PERF_LEN;
+        iov[i].iov_len = PERF_LEN;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    // waits for the first datagram only, then takes the queued ones
+    while ((len = recvmmsg(sock, msgs, PERF_BATCH, MSG_WAITFORONE, NULL)) > 0) {
+        if (last_us == 0) {
+            perf_stats_start(&stats);
+        }
+        for (int i = 0; i < len; i++) {
+            perf_stats_add(&stats, msgs[i].msg_len);
+        }
+        last_us = esp_timer_get_time();
+    }
+    free(iov);
+    free(msgs);
+#else
+    while ((len = recv(sock, buffer, PERF_LEN, 0)) > 0) {
+        if (last_us == 0) {
+            perf_stats_start(&stats);
+        }
+        perf_stats_add(&stats, len);
+        last_us = esp_timer_get_time();
+    }
+#endif
+    if (len < 0 && errno != EAGAIN) {
+        ESP_LOGE(TAG, "Error occurred during receiving: errno %d", errno);
+    }
+    if (last_us) {
+        // the idle timeout is not part of the test
+        perf_stats_end(&stats, last_us);
+    }
+}
+
+static void perf_receive(char *buffer)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_EXAMPLE_PERF_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int sock = socket(AF_INET, PERF_SOCK_TYPE, 0);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return;
+    }
+    int opt = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
+        close(sock);
+        return;
+    }
+    ESP_LOGI(TAG, PERF_PROTOCOL " socket listening on port %d", CONFIG_EXAMPLE_PERF_PORT);
+#if CONFIG_EXAMPLE_PERF_TCP
+    if (listen(sock, 1) != 0) {
+        ESP_LOGE(TAG, "Error occurred during listen: errno %d", errno);
+        close(sock);
+        return;
+    }
+    while (1) {
+        struct sockaddr_storage source_addr;
+        socklen_t addr_len = sizeof(source_addr);
+        int conn = accept(sock, (struct sockaddr *)&source_addr, &addr_len);
+        if (conn < 0) {
+            ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+            break;
+        }
+        ESP_LOGI(TAG, "Connection accepted");
+        perf_receive_from(conn, buffer);
+        close(conn);
+    }
+#else
+    while (1) {
+        // waits for the first datagram of each test
+        perf_receive_from(sock, buffer);
+    }
+#endif
+    close(sock);
+}
+#endif // CONFIG_EXAMPLE_PERF_RECEIVE
+
+#if CONFIG_EXAMPLE_PERF_LATENCY
+static int perf_compare_rtt(const void *a, const void *b)
+{
+    uint32_t rtt_a = *(const uint32_t *)a;
+    uint32_t rtt_b = *(const uint32_t *)b;
+    return rtt_a < rtt_b ? -1 : rtt_a > rtt_b;
+}
+
+/* Receives a whole response, TCP may return it in several parts */
+static int perf_recv_response(int sock, char *buffer)
+{
+    int received = 0;
+    while (received < PERF_LEN) {
+        int len = recv(sock, buffer + received, PERF_LEN - received, 0);
+        if (len <= 0) {
+            return len;
+        }
+        received += len;
+#if CONFIG_EXAMPLE_PERF_UDP
+        break;
+#endif
+    }
+    return received;
+}
+
+static void perf_latency(char *buffer)
+{
+    uint32_t *rtt = calloc(PERF_LATENCY_SAMPLES, sizeof(uint32_t));
+    if (rtt == NULL) {
+        ESP_LOGE(TAG, "No memory for the latency samples");
+        return;
+    }
+    int sock = perf_connect();
+    if (sock < 0) {
+        free(rtt);
+        return;
+    }
+    struct timeval timeout = { .tv_sec = PERF_IDLE_TIMEOUT_S };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    uint64_t round_trips = 0;
+    uint64_t lost = 0;
+    uint64_t rtt_sum = 0;
+    uint32_t rtt_min = UINT32_MAX;
+    uint32_t rtt_max = 0;
+    int64_t start = esp_timer_get_time();
+    int64_t sent;
+    while ((sent = esp_timer_get_time()) - start < PERF_DURATION_US) {
+        if (send(sock, buffer, PERF_LEN, 0) < 0) {
+            ESP_LOGE(TAG, "Error occurred during sending: errno %d", errno);
+            break;
+        }
+        int len = perf_recv_response(sock, buffer);
+        if (len < 0 && errno == EAGAIN && PERF_SOCK_TYPE == SOCK_DGRAM) {
+            lost++;
+            continue;
+        }
+        if (len <= 0) {
+            ESP_LOGE(TAG, "No response from the peer: errno %d", errno);
+            break;
+        }
+        uint32_t round_trip = esp_timer_get_time() - sent;
+        rtt[round_trips % PERF_LATENCY_SAMPLES] = round_trip;
+        rtt_sum += round_trip;
+        rtt_min = MIN(rtt_min, round_trip);
+        rtt_max = MAX(rtt_max, round_trip);
+        round_trips++;
+    }
+    if (round_trips) {
+        size_t samples = MIN(round_trips, PERF_LATENCY_SAMPLES);
+        qsort(rtt, samples, sizeof(uint32_t), perf_compare_rtt);
+        ESP_LOGI(TAG, "%llu round trips of %d bytes, %llu lost", (unsigned long long)round_trips, PERF_LEN, (unsigned long long)lost);
+        ESP_LOGI(TAG, "Round trip time (us): min %" PRIu32 " avg %" PRIu64 " max %" PRIu32 " p50 %" PRIu32 " p99 %" PRIu32,
+                 rtt_min, rtt_sum / round_trips, rtt_max, rtt[samples / 2], rtt[samples * 99 / 100]);
+    }
+    shutdown(sock, SHUT_RDWR);
+    close(sock);
+    free(rtt);
+}
+#endif // CONFIG_EXAMPLE_PERF_LATENCY
+
+static void perf_task(void *pvParameters)
+{
+    char *buffer = calloc(PERF_BATCH, PERF_LEN);
+    if (buffer == NULL) {
+        ESP_LOGE(TAG, "No memory for the buffer");
+        vTaskDelete(NULL);
+        return;
+    }
+#if CONFIG_EXAMPLE_PERF_SEND
+    perf_send(buffer);
+#elif CONFIG_EXAMPLE_PERF_RECEIVE
+    perf_receive(buffer);
+#else
+    perf_latency(buffer);
+#endif
+    free(buffer);
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    ESP_ERROR_CHECK(nvs_flash_init());
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+    /* This helper function configures Wi-Fi or Ethernet, as selected in menuconfig.
+     * Read "Establishing Wi-Fi or Ethernet Connection" section in
+     * examples/protocols/README.md for more information about this function.
+     */
+    ESP_ERROR_CHECK(example_connect());
+
+    xTaskCreate(perf_task, "socket_perf", 4096, NULL, 5, NULL);
+}
@@ -0,0 +1,222 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Formats the output of an application built with CONFIG_LOG_BINARY.
+#
+# Lines starting with "BLOG:" hold binary log records (see components/log/src/binary/log_binary.c),
+# the format strings are read from the ELF file of the application. Other lines are copied as is.
+#
+# Usage: idf.py monitor | esp_log_binary_decoder.py build/app.elf
+#        esp_log_binary_decoder.py build/app.elf captured_log.txt
+import argparse
+import base64
+import binascii
+import re
+import struct
+import sys
+from typing import List
+from typing import Optional
+from typing import TextIO
+from typing import Tuple
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+
+LINE_PREFIX = 'BLOG:'
+
+RECORD_LOG = 2
+RECORD_STREAM = 3
+RECORD_DROPPED = 4
+
+STR_PTR = 0
+STR_INLINE = 1
+
+STREAM_VERSION = 1
+
+# Symbol whose address is sent in the stream record, to find the load address of the executable
+ANCHOR_SYMBOL = 'esp_log_writev'
+
+CONVERSION_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcsfFeEgGaApn%])')
+
+
+class DecoderError(RuntimeError):
+    pass
+
+
+class ElfImage(object):
+    def __init__(self, path: str) -> None:
+        self._file = open(path, 'rb')
+        self.elf = ELFFile(self._file)
+        self.sections: List[Tuple[int, int, bytes]] = []
+        for section in self.elf.iter_sections():
+            if section['sh_flags'] & SH_FLAGS.SHF_ALLOC and section['sh_type'] != 'SHT_NOBITS':
+                self.sections.append((section['sh_addr'], section['sh_size'], section.data()))
+        self.anchor = None
+        symtab = self.elf.get_section_by_name('.symtab')
+        if symtab is not None:
+            symbols = symtab.get_symbol_by_name(ANCHOR_SYMBOL)
+            if symbols:
+                self.anchor = symbols[0]['st_value']
+
+    def read_str(self, addr: int) -> Optional[str]:
+        for start, size, data in self.sections:
+            if start <= addr < start + size:
+                offset = addr - start
+                end = data.find(b'\0', offset)
+                return data[offset:end if end >= 0 else len(data)].decode('utf-8', errors='replace')
+        return None
+
+
+class BinaryLogDecoder(object):
+    def __init__(self, image: ElfImage) -> None:
+        self.image = image
+        # Until a stream record is received, assume the sizes of the ELF file and no relocation
+        pointer_size = 8 if image.elf.elfclass == 64 else 4
+        self.pointer_size = pointer_size
+        self.load_offset = 0
+
+    def _pointer_format(self) -> str:
+        return '<Q' if self.pointer_size == 8 else '<I'
+
+    def _read_str(self, addr: int) -> str:
+        text = self.image.read_str(addr - self.load_offset)
+        return text if text is not None else '<string at 0x%x not found>' % addr
+
+    def _format(self, fmt: str, payload: bytes) -> str:
+        pos = 0
+
+        def take(size: int, signed: bool) -> int:
+            nonlocal pos
+            if pos + size > len(payload):
+                raise DecoderError('record is too short for format "%s"' % fmt)
+            value = int.from_bytes(payload[pos:pos + size], 'little', signed=signed)
+            pos += size
+            return value
+
+        def take_varint() -> int:
+            nonlocal pos
+            value = 0
+            shift = 0
+            while True:
+                if pos >= len(payload):
+                    raise DecoderError('record is too short for format "%s"' % fmt)
+                byte = payload[pos]
+                pos += 1
+                value |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    return value
+
+        def take_signed() -> int:
+            value = take_varint()
+            return (value >> 1) ^ -(value & 1)
+
+        def take_double() -> float:
+            nonlocal pos
+            if pos + 8 > len(payload):
+                raise DecoderError('record is too short for format "%s"' % fmt)
+            value: float = struct.unpack_from('<d', payload, pos)[0]
+            pos += 8
+            return value
+
+        def take_str() -> str:
+            nonlocal pos
+            kind = take(1, False)
+            if kind == STR_PTR:
+                return self._read_str(take(self.pointer_size, False))
+            length = take(1, False)
+            text = payload[pos:pos + length].decode('utf-8', errors='replace')
+            pos += length
+            return text
+
+        def convert(match: 're.Match[str]') -> str:
+            flags, width, precision, length, conversion = match.groups()
+            if conversion == '%':
+                return '%'
+            if width == '*':
+                width = str(take_signed())
+                if width.startswith('-'):
+                    flags += '-'
+                    width = width[1:]
+            if precision == '*':
+                precision = str(max(take_signed(), 0))
+            spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+            if conversion in 'di':
+                return (spec + 'd') % take_signed()
+            if conversion in 'ouxX':
+                return (spec + conversion.replace('u', 'd')) % take_varint()
+            if conversion == 'c':
+                return (spec + 'c') % (take_varint() & 0xFF)
+            if conversion in 'aA':
+                text = take_double().hex()
+                return (spec + 's') % (text.upper() if conversion == 'A' else text)
+            if conversion in 'fFeEgG':
+                return (spec + conversion) % take_double()
+            if conversion == 'p':
+                return (spec + 's') % hex(take(self.pointer_size, False))
+            if conversion == 's':
+                return (spec + 's') % take_str()
+            return ''  # %n
+
+        return CONVERSION_RE.sub(convert, fmt)
+
+    def decode(self, record: bytes) -> str:
+        if len(record) < 4:
+            raise DecoderError('record is too short')
+        header = struct.unpack_from('<I', record)[0]
+        size = (header & 0xFFFF) * 4
+        record_type = (header >> 16) & 0xFF
+        if size > len(record):
+            raise DecoderError('record is truncated')
+        payload = record[4:size]
+
+        if record_type == RECORD_STREAM:
+            version, self.pointer_size = struct.unpack_from('<BB', payload)
+            if version != STREAM_VERSION:
+                raise DecoderError('unsupported stream version %d' % version)
+            anchor = struct.unpack_from(self._pointer_format(), payload, 4)[0]
+            self.load_offset = anchor - self.image.anchor if self.image.anchor is not None else 0
+            return ''
+        if record_type == RECORD_DROPPED:
+            return '--- %d log records dropped since startup ---\n' % struct.unpack_from('<I', payload)[0]
+        if record_type == RECORD_LOG:
+            fmt_addr = struct.unpack_from(self._pointer_format(), payload)[0]
+            fmt = self.image.read_str(fmt_addr - self.load_offset)
+            if fmt is None:
+                raise DecoderError('format string at 0x%x not found in the ELF file' % fmt_addr)
+            return self._format(fmt, payload[self.pointer_size:])
+        raise DecoderError('unknown record type %d' % record_type)
+
+
+def decode_stream(decoder: BinaryLogDecoder, src: TextIO, dst: TextIO) -> None:
+    for line in src:
+        start = line.find(LINE_PREFIX)
+        if start < 0:
+            dst.write(line)
+            continue
+        # keep the text which was on the same line before the record, e.g. an unterminated print
+        dst.write(line[:start])
+        try:
+            record = base64.b64decode(line[start + len(LINE_PREFIX):].strip(), validate=True)
+            dst.write(decoder.decode(record))
+        except (DecoderError, binascii.Error, struct.error) as e:
+            dst.write('--- invalid binary log record (%s): %s' % (e, line[start:]))
+        dst.flush()
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Formats the output of an application built with CONFIG_LOG_BINARY')
+    parser.add_argument('elf_file', help='ELF file of the application')
+    parser.add_argument('log_file', nargs='?', type=argparse.FileType('r', errors='replace'), default=sys.stdin,
+                        help='Captured output of the application, standard input by default')
+    args = parser.parse_args()
+
+    decoder = BinaryLogDecoder(ElfImage(args.elf_file))
+    decode_stream(decoder, args.log_file, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
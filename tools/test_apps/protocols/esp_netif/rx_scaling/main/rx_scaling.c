@@ -0,0 +1,237 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Receive scaling benchmark
+
+   Two emulated Ethernet interfaces receive UDP datagrams as fast as the stack processes them,
+   each from a driver task pinned to its own CPU. Compares the input through the TCP/IP task
+   with the input tasks of the interfaces (CONFIG_ESP_NETIF_RX_WORKERS).
+*/
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_netif_defaults.h"
+#include "esp_timer.h"
+#include "lwip/udp.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/prot/ethernet.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
+
+#define SCALING_NETIFS      2
+#define SCALING_PORT        5001
+#define SCALING_FRAME_LEN   CONFIG_RX_SCALING_FRAME_LEN
+#define SCALING_WINDOW      CONFIG_RX_SCALING_WINDOW
+#define SCALING_DRIVER_PRIO 5
+
+static const char *TAG = "rx_scaling";
+
+typedef struct {
+    int index;
+    esp_netif_t *netif;
+    struct udp_pcb *pcb;
+    TaskHandle_t driver_task;
+    volatile bool driver_stopped;
+    uint8_t frame[SCALING_FRAME_LEN];   // copied to each received buffer
+    atomic_int in_flight;               // buffers passed to the stack and not freed yet
+    uint64_t received;                  // datagrams delivered to the pcb, counted in the lwip context
+    uint64_t sent;                      // frames passed to the stack
+} emulated_if_t;
+
+static emulated_if_t s_ifs[SCALING_NETIFS];
+static volatile bool s_running;
+
+static esp_err_t emulated_transmit(void *h, void *buffer, size_t len)
+{
+    return ESP_OK;
+}
+
+static void emulated_free_rx_buffer(void *h, void *buffer)
+{
+    emulated_if_t *emu = h;
+    free(buffer);
+    if (atomic_fetch_sub(&emu->in_flight, 1) == SCALING_WINDOW) {
+        xTaskNotifyGive(emu->driver_task);
+    }
+}
+
+/**
+ * @brief Builds the frame of an UDP datagram from 10.0.<index>.1 to the interface at 10.0.<index>.2
+ */
+static void emulated_build_frame(emulated_if_t *emu, const uint8_t mac[6])
+{
+    uint8_t *frame = emu->frame;
+    memset(frame, 0, SCALING_FRAME_LEN);
+    struct eth_hdr *eth = (struct eth_hdr *)frame;
+    memcpy(eth->dest.addr, mac, ETH_HWADDR_LEN);
+    memcpy(eth->src.addr, "\x02\x00\x00\x00\xff\x00", ETH_HWADDR_LEN);
+    eth->src.addr[5] = emu->index;
+    eth->type = PP_HTONS(ETHTYPE_IP);
+
+    struct ip_hdr *ip = (struct ip_hdr *)(frame + SIZEOF_ETH_HDR);
+    size_t ip_len = SCALING_FRAME_LEN - SIZEOF_ETH_HDR;
+    IPH_VHL_SET(ip, 4, IP_HLEN / 4);
+    IPH_LEN_SET(ip, lwip_htons(ip_len));
+    IPH_TTL_SET(ip, 64);
+    IPH_PROTO_SET(ip, IP_PROTO_UDP);
+    IP4_ADDR(&ip->src, 10, 0, emu->index, 1);
+    IP4_ADDR(&ip->dest, 10, 0, emu->index, 2);
+    IPH_CHKSUM_SET(ip, inet_chksum(ip, IP_HLEN));
+
+    struct udp_hdr *udp = (struct udp_hdr *)((uint8_t *)ip + IP_HLEN);
+    udp->src = PP_HTONS(SCALING_PORT);
+    udp->dest = PP_HTONS(SCALING_PORT);
+    udp->len = lwip_htons(ip_len - IP_HLEN);
+    udp->chksum = 0;    // no checksum
+}
+
+static void emulated_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    emulated_if_t *emu = arg;
+    emu->received++;
+    pbuf_free(p);
+}
+
+static esp_err_t emulated_bind(void *ctx)
+{
+    emulated_if_t *emu = ctx;
+    ip_addr_t ip = IPADDR4_INIT_BYTES(10, 0, emu->index, 2);
+    emu->pcb = udp_new();
+    if (emu->pcb == NULL || udp_bind(emu->pcb, &ip, SCALING_PORT) != ERR_OK) {
+        return ESP_FAIL;
+    }
+    udp_recv(emu->pcb, emulated_udp_recv, emu);
+    return ESP_OK;
+}
+
+static esp_err_t emulated_unbind(void *ctx)
+{
+    emulated_if_t *emu = ctx;
+    udp_remove(emu->pcb);
+    return ESP_OK;
+}
+
+/**
+ * @brief Driver task of the interface, receives the frames while fewer than SCALING_WINDOW are in flight
+ */
+static void emulated_driver_task(void *arg)
+{
+    emulated_if_t *emu = arg;
+    while (s_running) {
+        if (atomic_load(&emu->in_flight) >= SCALING_WINDOW) {
+            ulTaskNotifyTake(pdTRUE, 1);
+            continue;
+        }
+        uint8_t *buffer = malloc(SCALING_FRAME_LEN);
+        if (buffer == NULL) {
+            vTaskDelay(1);
+            continue;
+        }
+        memcpy(buffer, emu->frame, SCALING_FRAME_LEN);
+        atomic_fetch_add(&emu->in_flight, 1);
+        emu->sent++;
+        esp_netif_receive(emu->netif, buffer, SCALING_FRAME_LEN, buffer);
+    }
+    // kept until the stack frees the last buffers, which notify the task
+    emu->driver_stopped = true;
+    vTaskSuspend(NULL);
+}
+
+static void emulated_if_create(emulated_if_t *emu, int index)
+{
+    emu->index = index;
+    char if_key[] = "EMU0";
+    if_key[3] += index;
+    esp_netif_ip_info_t ip_info;
+    esp_netif_set_ip4_addr(&ip_info.ip, 10, 0, index, 2);
+    esp_netif_set_ip4_addr(&ip_info.netmask, 255, 255, 255, 0);
+    esp_netif_set_ip4_addr(&ip_info.gw, 10, 0, index, 1);
+    esp_netif_inherent_config_t base_config = {
+        .flags = ESP_NETIF_FLAG_AUTOUP,
+        .mac = { 0x02, 0x00, 0x00, 0x00, 0x00, index },
+        .ip_info = &ip_info,
+        .if_key = if_key,
+        .if_desc = "emulated",
+        .route_prio = 10 + index,
+    };
+    esp_netif_driver_ifconfig_t driver_config = {
+        .handle = emu,
+        .transmit = emulated_transmit,
+        .driver_free_rx_buffer = emulated_free_rx_buffer,
+        .rx_buffer_num = SCALING_WINDOW,
+    };
+    esp_netif_config_t cfg = {
+        .base = &base_config,
+        .driver = &driver_config,
+        .stack = ESP_NETIF_NETSTACK_DEFAULT_ETH,
+    };
+    emu->netif = esp_netif_new(&cfg);
+    assert(emu->netif);
+    esp_netif_action_start(emu->netif, NULL, 0, NULL);
+    emulated_build_frame(emu, base_config.mac);
+    ESP_ERROR_CHECK(esp_netif_tcpip_exec(emulated_bind, emu));
+}
+
+static void emulated_if_destroy(emulated_if_t *emu)
+{
+    esp_netif_tcpip_exec(emulated_unbind, emu);
+    esp_netif_action_stop(emu->netif, NULL, 0, NULL);
+    esp_netif_destroy(emu->netif);
+}
+
+void app_main(void)
+{
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    for (int i = 0; i < SCALING_NETIFS; i++) {
+        emulated_if_create(&s_ifs[i], i);
+    }
+
+#if CONFIG_ESP_NETIF_RX_WORKERS
+    ESP_LOGI(TAG, "Input through the input tasks of the interfaces, %d frames of %d bytes in flight per interface",
+             SCALING_WINDOW, SCALING_FRAME_LEN);
+#else
+    ESP_LOGI(TAG, "Input through the TCP/IP task, %d frames of %d bytes in flight per interface",
+             SCALING_WINDOW, SCALING_FRAME_LEN);
+#endif
+    s_running = true;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < SCALING_NETIFS; i++) {
+        xTaskCreatePinnedToCore(emulated_driver_task, "emu_driver", 4096, &s_ifs[i], SCALING_DRIVER_PRIO,
+                                &s_ifs[i].driver_task, i % portNUM_PROCESSORS);
+    }
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_RX_SCALING_DURATION * 1000));
+    s_running = false;
+    for (int i = 0; i < SCALING_NETIFS; i++) {
+        while (!s_ifs[i].driver_stopped || atomic_load(&s_ifs[i].in_flight) > 0) {
+            vTaskDelay(1);
+        }
+        vTaskDelete(s_ifs[i].driver_task);
+    }
+    double seconds = (esp_timer_get_time() - start) / 1e6;
+
+    uint64_t total = 0;
+    for (int i = 0; i < SCALING_NETIFS; i++) {
+        emulated_if_t *emu = &s_ifs[i];
+        esp_netif_stats_t stats = { 0 };
+        esp_netif_get_stats(emu->netif, &stats);
+        ESP_LOGI(TAG, "%s: %10.0f packets/sec, %" PRIu64 " received of %" PRIu64 ", %" PRIu64 " dropped, "
+                 "queue latency avg %" PRIu32 " us max %" PRIu32 " us",
+                 esp_netif_get_ifkey(emu->netif), emu->received / seconds, emu->received, emu->sent,
+                 stats.rx_dropped, stats.rx_queue_latency_avg_us, stats.rx_queue_latency_max_us);
+        total += emu->received;
+    }
+    ESP_LOGI(TAG, "Total: %10.0f packets/sec", total / seconds);
+
+    for (int i = 0; i < SCALING_NETIFS; i++) {
+        emulated_if_destroy(&s_ifs[i]);
+    }
+}